@@ -28,6 +28,7 @@
 
 #include "bta/gatt/bta_gattc_int.h"
 #include "gatt/database.h"
+#include "gatt/stored_database.h"
 #include "os/log.h"
 #include "stack/include/gattdefs.h"
 #include "types/bluetooth/uuid.h"
@@ -40,7 +41,6 @@ using std::vector;
 
 #ifdef TARGET_FLOSS
 #define GATT_CACHE_PREFIX "/var/lib/bluetooth/gatt/gatt_cache_"
-#define GATT_CACHE_VERSION 6
 
 #define GATT_HASH_MAX_SIZE 30
 #define GATT_HASH_PATH_PREFIX "/var/lib/bluetooth/gatt/gatt_hash_"
@@ -48,7 +48,6 @@ using std::vector;
 #define GATT_HASH_FILE_PREFIX "gatt_hash_"
 #else
 #define GATT_CACHE_PREFIX "/data/misc/bluetooth/gatt_cache_"
-#define GATT_CACHE_VERSION 6
 
 #define GATT_HASH_MAX_SIZE 30
 #define GATT_HASH_PATH_PREFIX "/data/misc/bluetooth/gatt_hash_"
@@ -83,54 +82,25 @@ static gatt::Database EMPTY_DB;
  * Description      Load GATT database from storage.
  *
  * Parameter        fname: input file name
+ *                  hash: expected database hash, or nullptr if unknown
  *
  * Returns          non-empty GATT database on success, empty GATT database
  *                  otherwise
  *
  ******************************************************************************/
-static gatt::Database bta_gattc_load_db(const char* fname) {
-  FILE* fd = fopen(fname, "rb");
-  if (!fd) {
-    log::error("can't open GATT cache file {} for reading, error: {}", fname,
-               strerror(errno));
-    return EMPTY_DB;
-  }
-
-  uint16_t cache_ver = 0;
-  uint16_t num_attr = 0;
-
-  if (fread(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't read GATT cache version from: {}", fname);
-    goto done;
-  }
-
-  if (cache_ver != GATT_CACHE_VERSION) {
-    log::error("wrong GATT cache version: {}", fname);
-    goto done;
-  }
-
-  if (fread(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't read number of GATT attributes: {}", fname);
-    goto done;
-  }
-
-  {
-    std::vector<StoredAttribute> attr(num_attr);
-
-    if (fread(attr.data(), sizeof(StoredAttribute), num_attr, fd) != num_attr) {
-      log::error("can't read GATT attributes: {}", fname);
-      goto done;
-    }
-    fclose(fd);
+static gatt::Database bta_gattc_load_db(const char* fname,
+                                        const Octet16* hash) {
+  auto stored_db = gatt::StoredDatabase::Open(fname);
+  if (!stored_db) return EMPTY_DB;
 
-    bool success = false;
-    gatt::Database result = gatt::Database::Deserialize(attr, &success);
-    return success ? result : EMPTY_DB;
+  if (hash != nullptr && stored_db->Hash() != *hash) {
+    log::error("GATT cache hash doesn't match its file name: {}", fname);
+    return EMPTY_DB;
   }
 
-done:
-  fclose(fd);
-  return EMPTY_DB;
+  bool success = false;
+  gatt::Database result = stored_db->ToDatabase(&success);
+  return success ? result : EMPTY_DB;
 }
 
 /*******************************************************************************
@@ -148,7 +118,7 @@ done:
 gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
   char fname[255] = {0};
   bta_gattc_generate_cache_file_name(fname, sizeof(fname), server_bda);
-  return bta_gattc_load_db(fname);
+  return bta_gattc_load_db(fname, nullptr);
 }
 
 /*******************************************************************************
@@ -166,7 +136,7 @@ gatt::Database bta_gattc_cache_load(const RawAddress& server_bda) {
 gatt::Database bta_gattc_hash_load(const Octet16& hash) {
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
-  return bta_gattc_load_db(fname);
+  return bta_gattc_load_db(fname, &hash);
 }
 
 void StoredAttribute::SerializeStoredAttribute(const StoredAttribute& attr,
@@ -231,42 +201,22 @@ void StoredAttribute::SerializeStoredAttribute(const StoredAttribute& attr,
  * Description      Storess GATT db.
  *
  * Parameter        fname: output file name
- *                  attr: attributes to save.
+ *                  db_bytes: serialized database to save.
  *
  * Returns          true on success, false otherwise
  *
  ******************************************************************************/
 static bool bta_gattc_store_db(const char* fname,
-                               const std::vector<StoredAttribute>& attr) {
+                               const std::vector<uint8_t>& db_bytes) {
   FILE* fd = fopen(fname, "wb");
   if (!fd) {
     log::error("can't open GATT cache file for writing: {}", fname);
     return false;
   }
 
-  uint16_t cache_ver = GATT_CACHE_VERSION;
-  if (fwrite(&cache_ver, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't write GATT cache version: {}", fname);
-    fclose(fd);
-    return false;
-  }
-
-  uint16_t num_attr = attr.size();
-  if (fwrite(&num_attr, sizeof(uint16_t), 1, fd) != 1) {
-    log::error("can't write GATT cache attribute count: {}", fname);
-    fclose(fd);
-    return false;
-  }
-
-  std::vector<uint8_t> db_bytes;
-  db_bytes.reserve(num_attr * StoredAttribute::kSizeOnDisk);
-  for (const auto attribute : attr) {
-    StoredAttribute::SerializeStoredAttribute(attribute, db_bytes);
-  }
-
   if (fwrite(db_bytes.data(), sizeof(uint8_t), db_bytes.size(), fd) !=
       db_bytes.size()) {
-    log::error("can't write GATT cache attributes: {}", fname);
+    log::error("can't write GATT cache: {}", fname);
     fclose(fd);
     return false;
   }
@@ -345,7 +295,8 @@ bool bta_gattc_hash_write(const Octet16& hash, const gatt::Database& database) {
   char fname[255] = {0};
   bta_gattc_generate_hash_file_name(fname, sizeof(fname), hash);
   bta_gattc_hash_remove_least_recently_used_if_possible();
-  return bta_gattc_store_db(fname, database.Serialize());
+  return bta_gattc_store_db(fname,
+                            gatt::StoredDatabase::Serialize(database, hash));
 }
 
 /*******************************************************************************
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <list>
 #include <sstream>
+#include <utility>
 
 #include "crypto_toolbox/crypto_toolbox.h"
 #include "internal_include/bt_trace.h"
@@ -46,6 +47,14 @@ const Uuid CHARACTERISTIC_EXTENDED_PROPERTIES =
 bool HandleInRange(const Service& svc, uint16_t handle) {
   return handle >= svc.handle && handle <= svc.end_handle;
 }
+
+const Service* FindServiceLinear(const std::list<Service>& services,
+                                 uint16_t handle) {
+  for (const Service& service : services) {
+    if (HandleInRange(service, handle)) return &service;
+  }
+  return nullptr;
+}
 }  // namespace
 
 static size_t UuidSize(const Uuid& uuid) {
@@ -62,6 +71,184 @@ Service* FindService(std::list<Service>& services, uint16_t handle) {
   return nullptr;
 }
 
+Database::Database(const Database& other)
+    : services(other.services),
+      handles(other.handles),
+      locations(other.locations) {
+  BuildServiceTable();
+}
+
+Database& Database::operator=(const Database& other) {
+  if (this != &other) {
+    services = other.services;
+    handles = other.handles;
+    locations = other.locations;
+    BuildServiceTable();
+  }
+  return *this;
+}
+
+void Database::BuildIndex() {
+  ClearIndex();
+  if (services.size() < kMinServicesToIndex) return;
+
+  size_t count = 0;
+  for (const Service& service : services) {
+    count += 1;
+    for (const Characteristic& charac : service.characteristics) {
+      count += 1 + charac.descriptors.size();
+    }
+  }
+
+  constexpr uint16_t kNone = AttributeLocation::kNone;
+  handles.reserve(count);
+  locations.reserve(count);
+  uint16_t s = 0;
+  for (const Service& service : services) {
+    handles.push_back(service.handle);
+    locations.push_back({s, kNone, kNone});
+
+    for (uint16_t c = 0; c < service.characteristics.size(); c++) {
+      const Characteristic& charac = service.characteristics[c];
+      handles.push_back(charac.value_handle);
+      locations.push_back({s, c, kNone});
+
+      for (uint16_t d = 0; d < charac.descriptors.size(); d++) {
+        handles.push_back(charac.descriptors[d].handle);
+        locations.push_back({s, c, d});
+      }
+    }
+    s++;
+  }
+
+  // Discovery and the cache both add attributes in handle order, but nothing
+  // enforces it
+  if (!std::is_sorted(handles.begin(), handles.end())) {
+    std::vector<std::pair<uint16_t, AttributeLocation>> index;
+    index.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      index.emplace_back(handles[i], locations[i]);
+    }
+    std::stable_sort(index.begin(), index.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.first < b.first;
+                     });
+    for (size_t i = 0; i < count; i++) {
+      handles[i] = index[i].first;
+      locations[i] = index[i].second;
+    }
+  }
+
+  BuildServiceTable();
+}
+
+void Database::BuildServiceTable() {
+  service_table.clear();
+  if (handles.empty()) return;
+
+  service_table.reserve(services.size());
+  for (const Service& service : services) service_table.push_back(&service);
+}
+
+void Database::ClearIndex() {
+  std::vector<uint16_t>().swap(handles);
+  std::vector<AttributeLocation>().swap(locations);
+  std::vector<const Service*>().swap(service_table);
+}
+
+const Database::AttributeLocation* Database::FindLocation(
+    uint16_t handle, bool exact) const {
+  // Binary search without branches on the comparison, as handles are looked
+  // up in no particular order and a branch on it would mispredict half of the
+  // time
+  const uint16_t* base = handles.data();
+  size_t len = handles.size();
+  while (len > 1) {
+    size_t half = len / 2;
+    base = (base[half] <= handle) ? base + half : base;
+    len -= half;
+  }
+
+  if (*base > handle || (exact && *base != handle)) return nullptr;
+  return &locations[base - handles.data()];
+}
+
+const Service* Database::FindService(uint16_t handle) const {
+  if (handles.empty()) return FindServiceLinear(services, handle);
+
+  // The last indexed attribute at or before |handle| belongs to the only
+  // service that can contain it
+  const AttributeLocation* location = FindLocation(handle, false);
+  if (!location) return nullptr;
+
+  const Service* service = service_table[location->service];
+  return HandleInRange(*service, handle) ? service : nullptr;
+}
+
+const Characteristic* Database::FindCharacteristic(uint16_t handle) const {
+  if (handles.empty()) {
+    const Service* service = FindServiceLinear(services, handle);
+    if (!service) return nullptr;
+
+    for (const Characteristic& charac : service->characteristics) {
+      if (handle == charac.value_handle) return &charac;
+    }
+    return nullptr;
+  }
+
+  const AttributeLocation* location = FindLocation(handle, true);
+  if (!location || location->characteristic == AttributeLocation::kNone ||
+      location->descriptor != AttributeLocation::kNone) {
+    return nullptr;
+  }
+  return &service_table[location->service]
+              ->characteristics[location->characteristic];
+}
+
+const Descriptor* Database::FindDescriptor(uint16_t handle) const {
+  if (handles.empty()) {
+    const Service* service = FindServiceLinear(services, handle);
+    if (!service) return nullptr;
+
+    for (const Characteristic& charac : service->characteristics) {
+      for (const Descriptor& desc : charac.descriptors) {
+        if (handle == desc.handle) return &desc;
+      }
+    }
+    return nullptr;
+  }
+
+  const AttributeLocation* location = FindLocation(handle, true);
+  if (!location || location->descriptor == AttributeLocation::kNone) {
+    return nullptr;
+  }
+  return &service_table[location->service]
+              ->characteristics[location->characteristic]
+              .descriptors[location->descriptor];
+}
+
+const Characteristic* Database::FindOwningCharacteristic(
+    uint16_t handle) const {
+  if (handles.empty()) {
+    const Service* service = FindServiceLinear(services, handle);
+    if (!service) return nullptr;
+
+    for (const Characteristic& charac : service->characteristics) {
+      for (const Descriptor& desc : charac.descriptors) {
+        if (handle == desc.handle) return &charac;
+      }
+    }
+    return nullptr;
+  }
+
+  const AttributeLocation* location = FindLocation(handle, true);
+  if (!location || location->descriptor == AttributeLocation::kNone) {
+    return nullptr;
+  }
+  return &service_table[location->service]
+              ->characteristics[location->characteristic];
+}
+
 std::string Database::ToString() const {
   std::stringstream tmp;
 
@@ -138,13 +325,67 @@ std::vector<StoredAttribute> Database::Serialize() const {
   return nv_attr;
 }
 
+bool AddStoredAttribute(Service& service, const StoredAttribute& attr) {
+  if (!HandleInRange(service, attr.handle)) {
+    log::error("Can't find service for attribute with handle: 0x{:x}",
+               attr.handle);
+    return false;
+  }
+
+  if (attr.type == INCLUDE) {
+    service.included_services.push_back(IncludedService{
+        .handle = attr.handle,
+        .uuid = attr.value.included_service.uuid,
+        .start_handle = attr.value.included_service.handle,
+        .end_handle = attr.value.included_service.end_handle,
+    });
+  } else if (attr.type == CHARACTERISTIC) {
+    service.characteristics.emplace_back(Characteristic{
+        .declaration_handle = attr.handle,
+        .uuid = attr.value.characteristic.uuid,
+        .value_handle = attr.value.characteristic.value_handle,
+        .properties = attr.value.characteristic.properties,
+        .descriptors = {},
+    });
+
+  } else {
+    if (service.characteristics.empty()) {
+      log::error("Descriptor with handle: 0x{:x} has no characteristic",
+                 attr.handle);
+      return false;
+    }
+
+    if (attr.type == CHARACTERISTIC_EXTENDED_PROPERTIES) {
+      service.characteristics.back().descriptors.emplace_back(
+          Descriptor{.handle = attr.handle,
+                     .uuid = attr.type,
+                     .characteristic_extended_properties =
+                         attr.value.characteristic_extended_properties});
+
+    } else {
+      service.characteristics.back().descriptors.emplace_back(Descriptor{
+          .handle = attr.handle,
+          .uuid = attr.type,
+          .characteristic_extended_properties = {},
+      });
+    }
+  }
+  return true;
+}
+
 Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
                                bool* success) {
+  return Deserialize(nv_attr.data(), nv_attr.size(), success);
+}
+
+Database Database::Deserialize(const StoredAttribute* nv_attr, size_t count,
+                               bool* success) {
   // clear reallocating
   Database result;
-  auto it = nv_attr.cbegin();
+  const StoredAttribute* it = nv_attr;
+  const StoredAttribute* end = nv_attr + count;
 
-  for (; it != nv_attr.cend(); ++it) {
+  for (; it != end; ++it) {
     const auto& attr = *it;
     if (attr.type != PRIMARY_SERVICE && attr.type != SECONDARY_SERVICE) break;
     result.services.emplace_back(Service{
@@ -158,7 +399,7 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
   }
 
   auto current_service_it = result.services.begin();
-  for (; it != nv_attr.cend(); it++) {
+  for (; it != end; it++) {
     const auto& attr = *it;
 
     // go to the service this attribute belongs to; attributes are stored in
@@ -168,55 +409,27 @@ Database Database::Deserialize(const std::vector<StoredAttribute>& nv_attr,
       current_service_it++;
     }
 
-    if (current_service_it == result.services.end() ||
-        !HandleInRange(*current_service_it, attr.handle)) {
+    if (current_service_it == result.services.end()) {
       log::error("Can't find service for attribute with handle: 0x{:x}",
                  attr.handle);
       *success = false;
       return result;
     }
 
-    if (attr.type == INCLUDE) {
-      Service* included_service =
-          FindService(result.services, attr.value.included_service.handle);
-      if (!included_service) {
-        log::error("Non-existing included service!");
-        *success = false;
-        return result;
-      }
-      current_service_it->included_services.push_back(IncludedService{
-          .handle = attr.handle,
-          .uuid = attr.value.included_service.uuid,
-          .start_handle = attr.value.included_service.handle,
-          .end_handle = attr.value.included_service.end_handle,
-      });
-    } else if (attr.type == CHARACTERISTIC) {
-      current_service_it->characteristics.emplace_back(Characteristic{
-          .declaration_handle = attr.handle,
-          .uuid = attr.value.characteristic.uuid,
-          .value_handle = attr.value.characteristic.value_handle,
-          .properties = attr.value.characteristic.properties,
-          .descriptors = {},
-      });
-
-    } else {
-      if (attr.type == CHARACTERISTIC_EXTENDED_PROPERTIES) {
-        current_service_it->characteristics.back().descriptors.emplace_back(
-            Descriptor{.handle = attr.handle,
-                       .uuid = attr.type,
-                       .characteristic_extended_properties =
-                           attr.value.characteristic_extended_properties});
+    if (attr.type == INCLUDE &&
+        !gatt::FindService(result.services,
+                           attr.value.included_service.handle)) {
+      log::error("Non-existing included service!");
+      *success = false;
+      return result;
+    }
 
-      } else {
-        current_service_it->characteristics.back().descriptors.emplace_back(
-            Descriptor{
-                .handle = attr.handle,
-                .uuid = attr.type,
-                .characteristic_extended_properties = {},
-            });
-      }
+    if (!AddStoredAttribute(*current_service_it, attr)) {
+      *success = false;
+      return result;
     }
   }
+  result.BuildIndex();
   *success = true;
   return result;
 }
@@ -104,22 +104,47 @@ class DatabaseBuilder;
 
 class Database {
  public:
+  Database() = default;
+  Database(const Database& other);
+  Database& operator=(const Database& other);
+  /* Moving keeps the list nodes, so the service table stays valid */
+  Database(Database&& other) = default;
+  Database& operator=(Database&& other) = default;
+
   /* Return true if there are no services in this database. */
   bool IsEmpty() const { return services.empty(); }
 
   /* Clear the GATT database. This method forces relocation to ensure no extra
    * space is used unnecesarly */
-  void Clear() { std::list<Service>().swap(services); }
+  void Clear() {
+    std::list<Service>().swap(services);
+    ClearIndex();
+  }
 
   /* Return list of services available in this database */
   const std::list<Service>& Services() const { return services; }
 
+  /* Return the service that contains |handle|, or nullptr */
+  const Service* FindService(uint16_t handle) const;
+
+  /* Return the characteristic with value handle |handle|, or nullptr */
+  const Characteristic* FindCharacteristic(uint16_t handle) const;
+
+  /* Return the descriptor with |handle|, or nullptr */
+  const Descriptor* FindDescriptor(uint16_t handle) const;
+
+  /* Return the characteristic that owns the descriptor with |handle|, or
+   * nullptr */
+  const Characteristic* FindOwningCharacteristic(uint16_t handle) const;
+
   std::string ToString() const;
 
   std::vector<gatt::StoredAttribute> Serialize() const;
 
   static Database Deserialize(const std::vector<gatt::StoredAttribute>& nv_attr,
                               bool* success);
+  static Database Deserialize(const gatt::StoredAttribute* nv_attr,
+                              size_t count, bool* success);
 
   /* Return 128 bit unique identifier of this GATT database */
   Octet16 Hash() const;
@@ -127,11 +152,49 @@ class Database {
   friend class DatabaseBuilder;
 
  private:
+  /* Below this many services, walking the services is faster than the handle
+   * index, which is then not built */
+  static constexpr size_t kMinServicesToIndex = 16;
+
+  /* Position of an indexed attribute in |services|: the service at |service|
+   * in |service_table|, its characteristic at |characteristic| and the
+   * descriptor of that characteristic at |descriptor|. Levels below the
+   * attribute itself are kNone. */
+  struct AttributeLocation {
+    static constexpr uint16_t kNone = 0xffff;
+
+    uint16_t service;
+    uint16_t characteristic;
+    uint16_t descriptor;
+  };
+
+  /* Build the handle index once the services are complete, if there are
+   * enough of them */
+  void BuildIndex();
+  void BuildServiceTable();
+  void ClearIndex();
+  /* Return the location of the attribute with |handle|. Unless |exact|, fall
+   * back to the last indexed attribute before |handle|. */
+  const AttributeLocation* FindLocation(uint16_t handle, bool exact) const;
+
   std::list<Service> services;
+
+  /* Handles of the service declarations, characteristic values and
+   * descriptors of |services| in ascending order, with the location of each
+   * one at the same position in |locations|. Both hold no pointers, so a copy
+   * of the database only has to rebuild |service_table|. */
+  std::vector<uint16_t> handles;
+  std::vector<AttributeLocation> locations;
+  std::vector<const Service*> service_table;
 };
 
 /* Find a service that should contain handle. Helper method for internal use
  * inside gatt namespace.*/
 Service* FindService(std::list<Service>& services, uint16_t handle);
 
+/* Add the included service, characteristic or descriptor stored in |attr| to
+ * |service|. Return false if it doesn't belong to the service. Helper method
+ * for internal use inside gatt namespace.*/
+bool AddStoredAttribute(Service& service, const StoredAttribute& attr);
+
 }  // namespace gatt
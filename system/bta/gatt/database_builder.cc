@@ -244,8 +244,9 @@ bool DatabaseBuilder::SetValueOfDescriptors(
 bool DatabaseBuilder::InProgress() const { return !database.services.empty(); }
 
 Database DatabaseBuilder::Build() {
-  Database tmp = database;
+  Database tmp = std::move(database);
   database.Clear();
+  tmp.BuildIndex();
   return tmp;
 }
 
@@ -0,0 +1,139 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "stored_database.h"
+
+#include <bluetooth/log.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+using namespace bluetooth;
+
+namespace gatt {
+
+/* All fields are little endian */
+struct StoredDatabase::Header {
+  uint16_t version;
+  uint16_t num_attr;
+  Octet16 hash;
+};
+
+static_assert(sizeof(StoredAttribute) == StoredAttribute::kSizeOnDisk);
+static_assert(alignof(StoredAttribute) <= 2);
+
+namespace {
+constexpr size_t kHeaderSize = 20;
+
+void AppendUint16(std::vector<uint8_t>& bytes, uint16_t value) {
+  bytes.push_back(value & 0xff);
+  bytes.push_back(value >> 8);
+}
+}  // namespace
+
+StoredDatabase::StoredDatabase(std::vector<uint16_t> data, size_t size)
+    : data_(std::move(data)), size_(size) {
+  static_assert(sizeof(Header) == kHeaderSize);
+}
+
+std::unique_ptr<StoredDatabase> StoredDatabase::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    log::error("can't open GATT cache file {} for reading, error: {}", path,
+               strerror(errno));
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size < (off_t)kHeaderSize) {
+    log::error("can't read GATT cache header from: {}", path);
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = st.st_size;
+  std::vector<uint16_t> data((size + 1) / 2);
+  ssize_t len = read(fd, data.data(), size);
+  close(fd);
+  if (len != (ssize_t)size) {
+    log::error("can't read GATT cache file {}, error: {}", path,
+               strerror(errno));
+    return nullptr;
+  }
+
+  std::unique_ptr<StoredDatabase> db(
+      new StoredDatabase(std::move(data), size));
+  if (!db->IsValid(path)) return nullptr;
+  return db;
+}
+
+bool StoredDatabase::IsValid(const std::string& path) const {
+  const Header* header = GetHeader();
+  if (header->version != kVersion) {
+    log::error("wrong GATT cache version: {}", path);
+    return false;
+  }
+
+  if (size_ != kHeaderSize + header->num_attr * StoredAttribute::kSizeOnDisk) {
+    log::error("wrong GATT cache size: {}, {} attributes", path,
+               header->num_attr);
+    return false;
+  }
+  return true;
+}
+
+std::vector<uint8_t> StoredDatabase::Serialize(const Database& database,
+                                               const Octet16& hash) {
+  std::vector<StoredAttribute> attr = database.Serialize();
+
+  std::vector<uint8_t> bytes;
+  bytes.reserve(kHeaderSize + attr.size() * StoredAttribute::kSizeOnDisk);
+
+  AppendUint16(bytes, kVersion);
+  AppendUint16(bytes, attr.size());
+  bytes.insert(bytes.end(), hash.begin(), hash.end());
+
+  for (const auto& attribute : attr) {
+    StoredAttribute::SerializeStoredAttribute(attribute, bytes);
+  }
+  return bytes;
+}
+
+const StoredDatabase::Header* StoredDatabase::GetHeader() const {
+  return reinterpret_cast<const Header*>(data_.data());
+}
+
+const StoredAttribute* StoredDatabase::GetAttributes() const {
+  return reinterpret_cast<const StoredAttribute*>(data_.data() +
+                                                  kHeaderSize / 2);
+}
+
+Octet16 StoredDatabase::Hash() const { return GetHeader()->hash; }
+
+size_t StoredDatabase::NumAttributes() const {
+  return GetHeader()->num_attr;
+}
+
+Database StoredDatabase::ToDatabase(bool* success) const {
+  return Database::Deserialize(GetAttributes(), GetHeader()->num_attr, success);
+}
+
+}  // namespace gatt
@@ -0,0 +1,74 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gatt/database.h"
+#include "stack/include/bt_octets.h"
+
+namespace gatt {
+
+/* GATT database of the client cache, as stored in its file.
+ *
+ * The file starts with a header holding the format version and the database
+ * hash, followed by the StoredAttribute records in the order of
+ * Database::Serialize(). Every part is laid out as it is in memory and 2 bytes
+ * aligned, so the file is read with a single read() and the database is built
+ * from the records in place. The file could be memory mapped as well, but for
+ * the few kilobytes of a cache, mapping it costs more than reading it.
+ */
+class StoredDatabase {
+ public:
+  /* Version of the on disk format, bumped on every incompatible change */
+  static constexpr uint16_t kVersion = 8;
+
+  /* Read the database stored in |path|. Return nullptr if the file can't be
+   * read, was written with another version or is malformed. */
+  static std::unique_ptr<StoredDatabase> Open(const std::string& path);
+
+  /* Return the on disk representation of |database|, whose hash is |hash| */
+  static std::vector<uint8_t> Serialize(const Database& database,
+                                        const Octet16& hash);
+
+  /* Return the database hash, as it was when the file was written */
+  Octet16 Hash() const;
+
+  size_t NumAttributes() const;
+
+  /* Build the database from the stored records */
+  Database ToDatabase(bool* success) const;
+
+ private:
+  struct Header;
+
+  StoredDatabase(std::vector<uint16_t> data, size_t size);
+  bool IsValid(const std::string& path) const;
+
+  const Header* GetHeader() const;
+  const StoredAttribute* GetAttributes() const;
+
+  /* Content of the file, in 2 bytes words to keep the records aligned */
+  std::vector<uint16_t> data_;
+  size_t size_;
+};
+
+}  // namespace gatt
@@ -28,6 +28,7 @@
 #include "bta/le_audio/le_audio_types.h"
 #include "bta/le_audio/le_audio_utils.h"
 #include "bta/le_audio/metrics_collector.h"
+#include "bta/le_audio/parallel_encoder.h"
 #include "bta_le_audio_api.h"
 #include "common/strings.h"
 #include "hci/controller_interface.h"
@@ -1152,6 +1153,8 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       auto const& codec_id = subgroup_config.GetLeAudioCodecId();
       /* TODO: We should act smart and reuse current configurations */
       sw_enc_.clear();
+      sw_enc_pool_ = bluetooth::le_audio::ParallelEncoder::CreateInstance(
+          subgroup_config.GetNumChannelsTotal());
       while (sw_enc_.size() != subgroup_config.GetNumChannelsTotal()) {
         auto codec =
             bluetooth::le_audio::CodecInterface::CreateInstance(codec_id);
@@ -1189,10 +1192,11 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       }
 
       for (uint8_t chan = 0; chan < encoders.size(); ++chan) {
-        IsoManager::GetInstance()->SendIsoData(
+        auto const& samples = encoders[chan]->GetDecodedSamples();
+        IsoManager::GetInstance()->SendIsoSdu(
             config->connection_handles[chan],
-            (const uint8_t*)encoders[chan]->GetDecodedSamples().data(),
-            encoders[chan]->GetDecodedSamples().size() * 2);
+            bluetooth::hci::iso_manager::AllocateIsoSdu(
+                (const uint8_t*)samples.data(), samples.size() * 2));
       }
     }
 
@@ -1218,12 +1222,16 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
       const auto bytes_per_sample = (subgroup_config.GetBitsPerSample() / 8);
 
       /* Prepare encoded data for all channels */
+      sw_enc_channels_.clear();
       for (uint8_t bis_idx = 0; bis_idx < num_bis; ++bis_idx) {
         auto initial_channel_offset = bis_idx * bytes_per_sample;
-        sw_enc_[bis_idx]->Encode(
-            data.data() + initial_channel_offset, num_bis,
-            subgroup_config.GetBisOctetsPerCodecFrame(bis_idx));
+        sw_enc_channels_.push_back(
+            {.encoder = sw_enc_[bis_idx].get(),
+             .data = data.data() + initial_channel_offset,
+             .stride = num_bis,
+             .out_size = subgroup_config.GetBisOctetsPerCodecFrame(bis_idx)});
       }
+      sw_enc_pool_->Encode(sw_enc_channels_);
 
       /* Currently there is no way to broadcast multiple distinct streams.
        * We just receive all system sounds mixed into a one stream and each
@@ -1285,6 +1293,8 @@ class LeAudioBroadcasterImpl : public LeAudioBroadcaster, public BigCallbacks {
    private:
     std::optional<BroadcastConfiguration> broadcast_config_;
     std::vector<std::unique_ptr<bluetooth::le_audio::CodecInterface>> sw_enc_;
+    std::unique_ptr<bluetooth::le_audio::ParallelEncoder> sw_enc_pool_;
+    std::vector<bluetooth::le_audio::ParallelEncoder::Channel> sw_enc_channels_;
   } audio_receiver_;
 
   bluetooth::le_audio::LeAudioBroadcasterCallbacks* callbacks_;
@@ -547,7 +547,7 @@ TEST_F(BroadcasterTest, StartAudioBroadcast) {
   MockBroadcastStateMachine::GetLastInstance()->SetExpectedBigConfig(big_cfg);
 
   // Inject the audio and verify call on the Iso manager side.
-  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData).Times(1);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoSdu).Times(1);
   std::vector<uint8_t> sample_data(320, 0);
   audio_receiver->OnAudioDataReady(sample_data);
 
@@ -594,7 +594,7 @@ TEST_F(BroadcasterTest, StartAudioBroadcastMedia) {
   mock_state_machine->SetExpectedBigConfig(big_cfg);
 
   // Inject the audio and verify call on the Iso manager side.
-  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoData).Times(2);
+  EXPECT_CALL(*MockIsoManager::GetInstance(), SendIsoSdu).Times(2);
   std::vector<uint8_t> sample_data(1920, 0);
   audio_receiver->OnAudioDataReady(sample_data);
   Mock::VerifyAndClearExpectations(mock_codec_manager_);
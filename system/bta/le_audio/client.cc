@@ -55,6 +55,7 @@
 #include "os/log.h"
 #include "osi/include/osi.h"
 #include "osi/include/properties.h"
+#include "parallel_encoder.h"
 #include "stack/btm/btm_sec.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/bt_types.h"
@@ -3769,9 +3770,8 @@ class LeAudioClientImpl : public LeAudioClient {
   }
 
   // mix stero signal into mono
-  std::vector<uint8_t> mono_blend(const std::vector<uint8_t>& buf,
-                                  int bytes_per_sample, size_t frames) {
-    std::vector<uint8_t> mono_out;
+  void mono_blend(const std::vector<uint8_t>& buf, int bytes_per_sample,
+                  size_t frames, std::vector<uint8_t>& mono_out) {
     mono_out.resize(frames * bytes_per_sample);
 
     if (bytes_per_sample == 2) {
@@ -3797,7 +3797,13 @@ class LeAudioClientImpl : public LeAudioClient {
     } else {
       log::error("Don't know how to mono blend that {}!", bytes_per_sample);
     }
-    return mono_out;
+  }
+
+  static void SendEncodedSamples(uint16_t cis_handle,
+                                 const std::vector<int16_t>& samples) {
+    IsoManager::GetInstance()->SendIsoSdu(
+        cis_handle, bluetooth::hci::iso_manager::AllocateIsoSdu(
+                        (const uint8_t*)samples.data(), samples.size() * 2));
   }
 
   void PrepareAndSendToTwoCises(
@@ -3828,34 +3834,36 @@ class LeAudioClientImpl : public LeAudioClient {
     uint16_t byte_count = stream_params.octets_per_codec_frame;
     bool mix_to_mono = (left_cis_handle == 0) || (right_cis_handle == 0);
     if (mix_to_mono) {
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
+      mono_blend(data, bytes_per_sample, number_of_required_samples_per_channel,
+                 sw_enc_mono);
       if (left_cis_handle) {
-        sw_enc_left->Encode(mono.data(), 1, byte_count);
+        sw_enc_left->Encode(sw_enc_mono.data(), 1, byte_count);
       }
 
       if (right_cis_handle) {
-        sw_enc_left->Encode(mono.data(), 1, byte_count);
+        sw_enc_left->Encode(sw_enc_mono.data(), 1, byte_count);
       }
     } else {
-      sw_enc_left->Encode(data.data(), 2, byte_count);
-      sw_enc_right->Encode(data.data() + bytes_per_sample, 2, byte_count);
+      sw_enc_channels.clear();
+      sw_enc_channels.push_back({.encoder = sw_enc_left.get(),
+                                 .data = data.data(),
+                                 .stride = 2,
+                                 .out_size = byte_count});
+      sw_enc_channels.push_back({.encoder = sw_enc_right.get(),
+                                 .data = data.data() + bytes_per_sample,
+                                 .stride = 2,
+                                 .out_size = byte_count});
+      sw_enc_pool->Encode(sw_enc_channels);
     }
 
     log::debug("left_cis_handle: {} right_cis_handle: {}", left_cis_handle,
                right_cis_handle);
     /* Send data to the controller */
     if (left_cis_handle)
-      IsoManager::GetInstance()->SendIsoData(
-          left_cis_handle,
-          (const uint8_t*)sw_enc_left->GetDecodedSamples().data(),
-          sw_enc_left->GetDecodedSamples().size() * 2);
+      SendEncodedSamples(left_cis_handle, sw_enc_left->GetDecodedSamples());
 
     if (right_cis_handle)
-      IsoManager::GetInstance()->SendIsoData(
-          right_cis_handle,
-          (const uint8_t*)sw_enc_right->GetDecodedSamples().data(),
-          sw_enc_right->GetDecodedSamples().size() * 2);
+      SendEncodedSamples(right_cis_handle, sw_enc_right->GetDecodedSamples());
   }
 
   void PrepareAndSendToSingleCis(
@@ -3878,19 +3886,27 @@ class LeAudioClientImpl : public LeAudioClient {
     if (mix_to_mono) {
       /* Since we always get two channels from framework, lets make it mono here
        */
-      std::vector<uint8_t> mono = mono_blend(
-          data, bytes_per_sample, number_of_required_samples_per_channel);
-      sw_enc_left->Encode(mono.data(), 1, byte_count);
+      mono_blend(data, bytes_per_sample, number_of_required_samples_per_channel,
+                 sw_enc_mono);
+      sw_enc_left->Encode(sw_enc_mono.data(), 1, byte_count);
     } else {
-      sw_enc_left->Encode((const uint8_t*)data.data(), 2, byte_count);
       // Output to the left channel buffer with `byte_count` offset
-      sw_enc_right->Encode((const uint8_t*)data.data() + 2, 2, byte_count,
-                           &sw_enc_left->GetDecodedSamples(), byte_count);
+      sw_enc_channels.clear();
+      sw_enc_channels.push_back({.encoder = sw_enc_left.get(),
+                                 .data = (const uint8_t*)data.data(),
+                                 .stride = 2,
+                                 .out_size = byte_count});
+      sw_enc_channels.push_back(
+          {.encoder = sw_enc_right.get(),
+           .data = (const uint8_t*)data.data() + 2,
+           .stride = 2,
+           .out_size = byte_count,
+           .out_buffer = &sw_enc_left->GetDecodedSamples(),
+           .out_offset = byte_count});
+      sw_enc_pool->Encode(sw_enc_channels);
     }
 
-    IsoManager::GetInstance()->SendIsoData(
-        cis_handle, (const uint8_t*)sw_enc_left->GetDecodedSamples().data(),
-        sw_enc_left->GetDecodedSamples().size() * 2);
+    SendEncodedSamples(cis_handle, sw_enc_left->GetDecodedSamples());
   }
 
   const struct bluetooth::le_audio::stream_configuration*
@@ -4137,6 +4153,8 @@ class LeAudioClientImpl : public LeAudioClient {
       if (sw_enc_left || sw_enc_right) {
         log::warn("The encoder instance should have been already released.");
       }
+      sw_enc_pool = bluetooth::le_audio::ParallelEncoder::CreateInstance(
+          2 /* channels */);
       sw_enc_left = bluetooth::le_audio::CodecInterface::CreateInstance(
           stream_conf->codec_id);
       auto codec_status = sw_enc_left->InitEncoder(
@@ -4297,6 +4315,7 @@ class LeAudioClientImpl : public LeAudioClient {
 
     if (sw_enc_left) sw_enc_left.reset();
     if (sw_enc_right) sw_enc_right.reset();
+    if (sw_enc_pool) sw_enc_pool.reset();
     if (sw_dec_left) sw_dec_left.reset();
     if (sw_dec_right) sw_dec_right.reset();
     CleanCachedMicrophoneData();
@@ -6485,6 +6504,7 @@ class LeAudioClientImpl : public LeAudioClient {
       case GroupStreamStatus::IDLE: {
         if (sw_enc_left) sw_enc_left.reset();
         if (sw_enc_right) sw_enc_right.reset();
+        if (sw_enc_pool) sw_enc_pool.reset();
         if (sw_dec_left) sw_dec_left.reset();
         if (sw_dec_right) sw_dec_right.reset();
         CleanCachedMicrophoneData();
@@ -6730,6 +6750,10 @@ class LeAudioClientImpl : public LeAudioClient {
 
   std::unique_ptr<bluetooth::le_audio::CodecInterface> sw_enc_left;
   std::unique_ptr<bluetooth::le_audio::CodecInterface> sw_enc_right;
+  std::unique_ptr<bluetooth::le_audio::ParallelEncoder> sw_enc_pool;
+  /* Per frame encoding buffers, kept to not allocate them on each frame */
+  std::vector<bluetooth::le_audio::ParallelEncoder::Channel> sw_enc_channels;
+  std::vector<uint8_t> sw_enc_mono;
 
   std::unique_ptr<bluetooth::le_audio::CodecInterface> sw_dec_left;
   std::unique_ptr<bluetooth::le_audio::CodecInterface> sw_dec_right;
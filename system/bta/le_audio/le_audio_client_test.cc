@@ -2720,11 +2720,11 @@ class UnicastTestNoInit : public Test {
     // Expect two channels ISO Data to be sent
     std::vector<uint16_t> handles;
     if (cis_count_out) {
-      EXPECT_CALL(*mock_iso_manager_, SendIsoData(_, _, _))
+      EXPECT_CALL(*mock_iso_manager_, SendIsoSdu(_, _))
           .Times(cis_count_out)
-          .WillRepeatedly(
-              [&handles](uint16_t iso_handle, const uint8_t* data,
-                         uint16_t data_len) { handles.push_back(iso_handle); });
+          .WillRepeatedly([&handles](uint16_t iso_handle, BT_HDR* /* sdu */) {
+            handles.push_back(iso_handle);
+          });
     }
     std::vector<uint8_t> data(data_len);
     unicast_source_hal_cb_->OnAudioDataReady(data);
@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "parallel_encoder.h"
+
+#include <bluetooth/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "os/log.h"
+#include "osi/include/properties.h"
+
+namespace bluetooth::le_audio {
+
+namespace {
+constexpr char kNumEncoderWorkersProp[] = "bluetooth.leaudio.encoder_workers";
+}  // namespace
+
+struct ParallelEncoder::Impl {
+  explicit Impl(size_t num_workers) {
+    num_workers = std::min(num_workers, kMaxNumWorkers);
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers_.emplace_back(&Impl::RunWorker, this);
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  CodecInterface::Status Encode(const std::vector<Channel>& channels) {
+    /* Encoders only grow the output buffers, which must not happen while
+     * another channel writes into the same buffer.
+     */
+    for (auto const& channel : channels) {
+      if (channel.out_buffer == nullptr) continue;
+
+      size_t channel_samples = (channel.out_offset + channel.out_size) / 2;
+      if (channel.out_buffer->size() < channel_samples) {
+        channel.out_buffer->resize(channel_samples);
+      }
+    }
+
+    status_ = CodecInterface::Status::STATUS_OK;
+    if (workers_.empty() || channels.size() < 2) {
+      for (auto const& channel : channels) {
+        EncodeChannel(channel);
+      }
+      return status_;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      channels_ = &channels;
+      next_channel_ = 0;
+      busy_workers_ = workers_.size();
+      ++generation_;
+    }
+    work_cv_.notify_all();
+
+    EncodeChannels();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+    channels_ = nullptr;
+    return status_;
+  }
+
+  size_t GetNumWorkers() const { return workers_.size(); }
+
+ private:
+  void RunWorker() {
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_cv_.wait(lock, [this, generation] {
+        return stopping_ || generation_ != generation;
+      });
+      if (stopping_) return;
+      generation = generation_;
+
+      lock.unlock();
+      EncodeChannels();
+      lock.lock();
+
+      if (--busy_workers_ == 0) done_cv_.notify_one();
+    }
+  }
+
+  /* Called from the workers and the calling thread: each of them takes the
+   * next channel not yet taken, until all channels are encoded.
+   */
+  void EncodeChannels() {
+    for (size_t idx = next_channel_++; idx < channels_->size();
+         idx = next_channel_++) {
+      EncodeChannel((*channels_)[idx]);
+    }
+  }
+
+  void EncodeChannel(const Channel& channel) {
+    auto status =
+        channel.encoder->Encode(channel.data, channel.stride, channel.out_size,
+                                channel.out_buffer, channel.out_offset);
+    if (status != CodecInterface::Status::STATUS_OK) {
+      auto expected = CodecInterface::Status::STATUS_OK;
+      status_.compare_exchange_strong(expected, status);
+    }
+  }
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_ = 0;
+  bool stopping_ = false;
+  size_t busy_workers_ = 0;
+
+  /* Frame being encoded, valid from the generation change until all workers
+   * are done with it
+   */
+  const std::vector<Channel>* channels_ = nullptr;
+  std::atomic<size_t> next_channel_ = 0;
+  std::atomic<CodecInterface::Status> status_ =
+      CodecInterface::Status::STATUS_OK;
+};
+
+ParallelEncoder::ParallelEncoder(size_t num_workers)
+    : impl(std::make_unique<Impl>(num_workers)) {}
+
+ParallelEncoder::~ParallelEncoder() = default;
+
+std::unique_ptr<ParallelEncoder> ParallelEncoder::CreateInstance(
+    size_t num_channels) {
+  int num_workers = osi_property_get_int32(kNumEncoderWorkersProp, 0);
+  if (num_workers < 0) num_workers = 0;
+
+  /* The calling thread encodes one of the channels */
+  size_t max_workers = (num_channels > 1) ? num_channels - 1 : 0;
+  auto workers = std::min(static_cast<size_t>(num_workers), max_workers);
+  log::info("{} encoder workers for {} channels", workers, num_channels);
+  return std::make_unique<ParallelEncoder>(workers);
+}
+
+CodecInterface::Status ParallelEncoder::Encode(
+    const std::vector<Channel>& channels) {
+  return impl->Encode(channels);
+}
+
+size_t ParallelEncoder::GetNumWorkers() const { return impl->GetNumWorkers(); }
+
+}  // namespace bluetooth::le_audio
@@ -0,0 +1,75 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "codec_interface.h"
+
+namespace bluetooth::le_audio {
+
+/* ParallelEncoder encodes the channels of one audio frame concurrently, each
+ * with its own CodecInterface instance. The calling thread encodes channels as
+ * well, next to a small pool of worker threads, and Encode() returns once every
+ * channel of the frame is encoded.
+ * The channels read the interleaved PCM in place, using the stride, and output
+ * buffers passed explicitly are resized before the encoding starts, so that two
+ * channels can safely share one output buffer at different offsets.
+ * Without worker threads the channels are encoded one after the other on the
+ * calling thread.
+ */
+class ParallelEncoder {
+ public:
+  /* Arguments of a single CodecInterface::Encode() call */
+  struct Channel {
+    CodecInterface* encoder;
+    const uint8_t* data;
+    int stride;
+    uint16_t out_size;
+    std::vector<int16_t>* out_buffer = nullptr;
+    uint16_t out_offset = 0;
+  };
+
+  /* Upper bound of the worker pool, which is enough for 8 channels */
+  static constexpr size_t kMaxNumWorkers = 7;
+
+  explicit ParallelEncoder(size_t num_workers);
+  ~ParallelEncoder();
+  ParallelEncoder(const ParallelEncoder&) = delete;
+  ParallelEncoder& operator=(const ParallelEncoder&) = delete;
+
+  /* Creates an encoder for up to |num_channels| channels, with as many workers
+   * as allowed by the bluetooth.leaudio.encoder_workers property. The property
+   * defaults to 0, which keeps the encoding on the calling thread.
+   */
+  static std::unique_ptr<ParallelEncoder> CreateInstance(size_t num_channels);
+
+  /* Encodes all |channels| and returns the first error, if any */
+  CodecInterface::Status Encode(const std::vector<Channel>& channels);
+  size_t GetNumWorkers() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+}  // namespace bluetooth::le_audio
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "codec_interface.h"
+#include "le_audio_types.h"
+#include "parallel_encoder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth::le_audio {
+namespace {
+
+// 48_2 configuration, as used by high quality broadcasts
+constexpr uint16_t kOctetsPerFrame = 100;
+
+// Encode one ISO interval of |state.range(0)| interleaved channels, each into
+// its own BIS frame as done by the broadcaster. Reports the time until the
+// last channel is encoded, either on the calling thread alone or with one
+// worker for each additional channel.
+void BM_EncodeInterval(State& state, bool parallel) {
+  size_t num_channels = state.range(0);
+  LeAudioCodecConfiguration config = {
+      .num_channels = LeAudioCodecConfiguration::kChannelNumberMono,
+      .sample_rate = LeAudioCodecConfiguration::kSampleRate48000,
+      .bits_per_sample = LeAudioCodecConfiguration::kBitsPerSample16,
+      .data_interval_us = LeAudioCodecConfiguration::kInterval10000Us,
+  };
+  types::LeAudioCodecId codec_id = {
+      .coding_format = types::kLeAudioCodingFormatLC3,
+      .vendor_company_id = types::kLeAudioVendorCompanyIdUndefined,
+      .vendor_codec_id = types::kLeAudioVendorCodecIdUndefined};
+
+  std::vector<std::unique_ptr<CodecInterface>> encoders;
+  for (size_t ch = 0; ch < num_channels; ++ch) {
+    encoders.push_back(CodecInterface::CreateInstance(codec_id));
+    encoders.back()->InitEncoder(config, config);
+  }
+
+  size_t samples_per_channel = encoders[0]->GetNumOfSamplesPerChannel();
+  std::vector<int16_t> pcm(samples_per_channel * num_channels);
+  for (size_t i = 0; i < pcm.size(); ++i) {
+    pcm[i] = 20000 * std::sin(i * 0.01);
+  }
+
+  std::vector<ParallelEncoder::Channel> channels;
+  for (size_t ch = 0; ch < num_channels; ++ch) {
+    channels.push_back(
+        {.encoder = encoders[ch].get(),
+         .data = reinterpret_cast<const uint8_t*>(pcm.data() + ch),
+         .stride = static_cast<int>(num_channels),
+         .out_size = kOctetsPerFrame});
+  }
+
+  ParallelEncoder encoder(parallel ? num_channels - 1 : 0);
+  for (auto _ : state) {
+    encoder.Encode(channels);
+  }
+  state.SetItemsProcessed(state.iterations() * num_channels);
+}
+
+}  // namespace
+}  // namespace bluetooth::le_audio
+
+BENCHMARK_CAPTURE(bluetooth::le_audio::BM_EncodeInterval, serial, false)
+    ->ArgName("channels")
+    ->DenseRange(1, 8)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(bluetooth::le_audio::BM_EncodeInterval, parallel, true)
+    ->ArgName("channels")
+    ->DenseRange(1, 8)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
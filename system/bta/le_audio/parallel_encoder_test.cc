@@ -0,0 +1,175 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "parallel_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "codec_interface.h"
+#include "le_audio_types.h"
+
+namespace bluetooth::le_audio {
+namespace {
+
+constexpr int kNumFrames = 16;
+constexpr uint16_t kOctetsPerFrame = 100;
+
+LeAudioCodecConfiguration CodecConfig() {
+  return {
+      .num_channels = LeAudioCodecConfiguration::kChannelNumberMono,
+      .sample_rate = LeAudioCodecConfiguration::kSampleRate48000,
+      .bits_per_sample = LeAudioCodecConfiguration::kBitsPerSample16,
+      .data_interval_us = LeAudioCodecConfiguration::kInterval10000Us,
+  };
+}
+
+std::vector<std::unique_ptr<CodecInterface>> CreateEncoders(
+    size_t num_channels) {
+  std::vector<std::unique_ptr<CodecInterface>> encoders;
+  types::LeAudioCodecId codec_id = {
+      .coding_format = types::kLeAudioCodingFormatLC3,
+      .vendor_company_id = types::kLeAudioVendorCompanyIdUndefined,
+      .vendor_codec_id = types::kLeAudioVendorCodecIdUndefined};
+  for (size_t i = 0; i < num_channels; ++i) {
+    auto encoder = CodecInterface::CreateInstance(codec_id);
+    EXPECT_EQ(encoder->InitEncoder(CodecConfig(), CodecConfig()),
+              CodecInterface::Status::STATUS_OK);
+    encoders.push_back(std::move(encoder));
+  }
+  return encoders;
+}
+
+// Interleaved 16 bit PCM with a different tone and some noise on each channel
+std::vector<uint8_t> MakePcm(size_t samples_per_channel, size_t num_channels,
+                             int frame) {
+  std::mt19937 generator(frame);
+  std::uniform_int_distribution<int> noise(-1000, 1000);
+  std::vector<uint8_t> pcm(samples_per_channel * num_channels *
+                           sizeof(int16_t));
+  int16_t* samples = reinterpret_cast<int16_t*>(pcm.data());
+  for (size_t i = 0; i < samples_per_channel; ++i) {
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      double t = frame * samples_per_channel + i;
+      samples[i * num_channels + ch] =
+          20000 * std::sin(t * 0.01 * (ch + 1)) + noise(generator);
+    }
+  }
+  return pcm;
+}
+
+std::vector<ParallelEncoder::Channel> MakeChannels(
+    const std::vector<std::unique_ptr<CodecInterface>>& encoders,
+    const std::vector<uint8_t>& pcm) {
+  std::vector<ParallelEncoder::Channel> channels;
+  for (size_t ch = 0; ch < encoders.size(); ++ch) {
+    channels.push_back({.encoder = encoders[ch].get(),
+                        .data = pcm.data() + ch * sizeof(int16_t),
+                        .stride = static_cast<int>(encoders.size()),
+                        .out_size = kOctetsPerFrame});
+  }
+  return channels;
+}
+
+class ParallelEncoderTest : public ::testing::TestWithParam<size_t> {};
+
+// Spreading the channels over the workers must give the same frames as
+// encoding them one after the other
+TEST_P(ParallelEncoderTest, matches_serial_encoding) {
+  size_t num_channels = GetParam();
+  auto serial_encoders = CreateEncoders(num_channels);
+  auto parallel_encoders = CreateEncoders(num_channels);
+  ParallelEncoder serial(0);
+  ParallelEncoder parallel(num_channels - 1);
+  ASSERT_EQ(serial.GetNumWorkers(), 0u);
+  ASSERT_EQ(parallel.GetNumWorkers(), num_channels - 1);
+
+  auto samples_per_channel = serial_encoders[0]->GetNumOfSamplesPerChannel();
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    auto pcm = MakePcm(samples_per_channel, num_channels, frame);
+    ASSERT_EQ(serial.Encode(MakeChannels(serial_encoders, pcm)),
+              CodecInterface::Status::STATUS_OK);
+    ASSERT_EQ(parallel.Encode(MakeChannels(parallel_encoders, pcm)),
+              CodecInterface::Status::STATUS_OK);
+
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      ASSERT_EQ(serial_encoders[ch]->GetDecodedSamples(),
+                parallel_encoders[ch]->GetDecodedSamples())
+          << "frame " << frame << " channel " << ch;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelEncoder, ParallelEncoderTest,
+                         ::testing::Range<size_t>(1, 9));
+
+// Two channels encoded into the buffer of the first one, as done for a single
+// CIS carrying both channels
+TEST(ParallelEncoderSharedBufferTest, channels_share_output_buffer) {
+  auto expected_encoders = CreateEncoders(2);
+  auto encoders = CreateEncoders(2);
+  ParallelEncoder parallel(1);
+
+  auto samples_per_channel = encoders[0]->GetNumOfSamplesPerChannel();
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    auto pcm = MakePcm(samples_per_channel, 2, frame);
+    for (auto const& channel : MakeChannels(expected_encoders, pcm)) {
+      channel.encoder->Encode(channel.data, channel.stride, channel.out_size);
+    }
+
+    auto channels = MakeChannels(encoders, pcm);
+    channels[1].out_buffer = &encoders[0]->GetDecodedSamples();
+    channels[1].out_offset = kOctetsPerFrame;
+    ASSERT_EQ(parallel.Encode(channels), CodecInterface::Status::STATUS_OK);
+
+    auto const& shared = encoders[0]->GetDecodedSamples();
+    ASSERT_EQ(shared.size(), kOctetsPerFrame);
+    auto const& left = expected_encoders[0]->GetDecodedSamples();
+    auto const& right = expected_encoders[1]->GetDecodedSamples();
+    ASSERT_TRUE(std::equal(left.begin(), left.end(), shared.begin()));
+    ASSERT_TRUE(std::equal(right.begin(), right.end(),
+                           shared.begin() + kOctetsPerFrame / 2));
+  }
+}
+
+TEST(ParallelEncoderErrorTest, reports_channel_error) {
+  auto encoders = CreateEncoders(4);
+  ParallelEncoder parallel(3);
+
+  auto pcm = MakePcm(encoders[0]->GetNumOfSamplesPerChannel(), 4, 0);
+  auto channels = MakeChannels(encoders, pcm);
+  channels[2].out_size = 0;
+  ASSERT_EQ(parallel.Encode(channels),
+            CodecInterface::Status::STATUS_ERR_CODING_ERROR);
+
+  // The failure does not stick to the next frames
+  channels[2].out_size = kOctetsPerFrame;
+  ASSERT_EQ(parallel.Encode(channels), CodecInterface::Status::STATUS_OK);
+}
+
+TEST(ParallelEncoderWorkersTest, workers_are_bounded) {
+  ParallelEncoder parallel(ParallelEncoder::kMaxNumWorkers + 4);
+  ASSERT_EQ(parallel.GetNumWorkers(), ParallelEncoder::kMaxNumWorkers);
+  ASSERT_EQ(parallel.Encode({}), CodecInterface::Status::STATUS_OK);
+}
+
+}  // namespace
+}  // namespace bluetooth::le_audio
@@ -0,0 +1,170 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "gatt/database.h"
+#include "gatt/database_builder.h"
+#include "types/bluetooth/uuid.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+using gatt::Characteristic;
+using gatt::Database;
+using gatt::DatabaseBuilder;
+using gatt::Service;
+
+namespace {
+// Heap bytes allocated while |count_allocations| is set, to tell how much
+// memory a database copy takes
+size_t allocated_bytes = 0;
+bool count_allocations = false;
+}  // namespace
+
+void* operator new(size_t size) {
+  if (count_allocations) allocated_bytes += size;
+  void* p = malloc(size);
+  if (p == nullptr) abort();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t /* size */) noexcept { free(p); }
+
+namespace {
+
+constexpr int kCharacteristicsPerService = 8;
+
+// A database shaped like those of hearing aids and LE Audio devices: services
+// of |kCharacteristicsPerService| notifying characteristics, each with its
+// Client Characteristic Configuration descriptor
+Database BuildDatabase(int num_services) {
+  DatabaseBuilder builder;
+  uint16_t handle = 0x0001;
+  for (int s = 0; s < num_services; s++) {
+    uint16_t end_handle = handle + kCharacteristicsPerService * 3;
+    builder.AddService(handle, end_handle, Uuid::From16Bit(0x1800 + s), true);
+    handle++;
+    for (int c = 0; c < kCharacteristicsPerService; c++) {
+      builder.AddCharacteristic(handle, handle + 1,
+                                Uuid::From16Bit(0x2a00 + c), 0x12);
+      builder.AddDescriptor(handle + 2, Uuid::From16Bit(0x2902));
+      handle += 3;
+    }
+  }
+  return builder.Build();
+}
+
+std::vector<uint16_t> ValueHandles(const Database& db) {
+  std::vector<uint16_t> handles;
+  for (const Service& service : db.Services()) {
+    for (const Characteristic& charac : service.characteristics) {
+      handles.push_back(charac.value_handle);
+    }
+  }
+  return handles;
+}
+
+// Characteristic lookup without the handle index: find the service in the
+// list, then walk its characteristics. Not inlined, as a lookup through
+// Database isn't either.
+__attribute__((noinline)) const Characteristic* FindCharacteristicLinear(
+    const Database& db, uint16_t handle) {
+  for (const Service& service : db.Services()) {
+    if (handle < service.handle || handle > service.end_handle) continue;
+
+    for (const Characteristic& charac : service.characteristics) {
+      if (handle == charac.value_handle) return &charac;
+    }
+    return nullptr;
+  }
+  return nullptr;
+}
+
+// One lookup per notification, with notifications coming from all
+// characteristics of the database in no particular order. Database only
+// indexes databases with enough services for the index to be faster.
+void BM_FindCharacteristic(State& state, bool use_database) {
+  Database db = BuildDatabase(state.range(0));
+  std::vector<uint16_t> handles = ValueHandles(db);
+  std::shuffle(handles.begin(), handles.end(), std::mt19937(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    if (use_database) {
+      benchmark::DoNotOptimize(db.FindCharacteristic(handles[i]));
+    } else {
+      benchmark::DoNotOptimize(FindCharacteristicLinear(db, handles[i]));
+    }
+    if (++i == handles.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Heap memory held by the database of one cached device, and time to copy it
+void BM_DatabaseMemory(State& state) {
+  Database db = BuildDatabase(state.range(0));
+  size_t num_attributes = 0;
+  for (const Service& service : db.Services()) {
+    num_attributes += 1;
+    for (const Characteristic& charac : service.characteristics) {
+      num_attributes += 2 + charac.descriptors.size();
+    }
+  }
+
+  size_t bytes = 0;
+  for (auto _ : state) {
+    allocated_bytes = 0;
+    count_allocations = true;
+    Database copy = db;
+    count_allocations = false;
+    bytes = allocated_bytes;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.counters["bytes"] = bytes;
+  state.counters["bytes_per_attribute"] =
+      static_cast<double>(bytes) / num_attributes;
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_FindCharacteristic, linear, false)
+    ->ArgName("services")
+    ->RangeMultiplier(2)
+    ->Range(4, 32);
+BENCHMARK_CAPTURE(BM_FindCharacteristic, database, true)
+    ->ArgName("services")
+    ->RangeMultiplier(2)
+    ->Range(4, 32);
+BENCHMARK(BM_DatabaseMemory)
+    ->ArgName("services")
+    ->RangeMultiplier(2)
+    ->Range(4, 32);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
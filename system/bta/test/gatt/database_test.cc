@@ -553,4 +553,135 @@ TEST(GattDatabaseTest, serialized_hash_test) {
   EXPECT_EQ(db_from_disk.Hash(), db_from_serialized.Hash());
 }
 
+/* This test makes sure that attributes are found by handle, with the service
+ * and characteristic they belong to */
+TEST(GattDatabaseTest, find_by_handle_test) {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0020, 0x002f, SERVICE_2_UUID, true);
+  builder.AddIncludedService(0x0002, SERVICE_2_UUID, 0x0020, 0x002f);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, SERVICE_1_CHAR_1_DESC_1_UUID);
+  builder.AddDescriptor(0x0006, CHARACTERISTIC_EXTENDED_PROPERTIES);
+  builder.AddCharacteristic(0x0021, 0x0022, SERVICE_1_CHAR_1_UUID, 0x10);
+  builder.AddDescriptor(0x0023, SERVICE_1_CHAR_1_DESC_1_UUID);
+  builder.SetValueOfDescriptors({0x0001});
+
+  Database db = builder.Build();
+  const Service& service_1 = db.Services().front();
+  const Service& service_2 = db.Services().back();
+
+  EXPECT_EQ(db.FindService(0x0000), nullptr);
+  EXPECT_EQ(db.FindService(0x0001), &service_1);
+  EXPECT_EQ(db.FindService(0x0005), &service_1);
+  EXPECT_EQ(db.FindService(0x000f), &service_1);
+  EXPECT_EQ(db.FindService(0x0010), nullptr);
+  EXPECT_EQ(db.FindService(0x0025), &service_2);
+  EXPECT_EQ(db.FindService(0x0030), nullptr);
+
+  EXPECT_EQ(db.FindCharacteristic(0x0004), &service_1.characteristics[0]);
+  EXPECT_EQ(db.FindCharacteristic(0x0022), &service_2.characteristics[0]);
+  // Only value handles identify characteristics
+  EXPECT_EQ(db.FindCharacteristic(0x0003), nullptr);
+  EXPECT_EQ(db.FindCharacteristic(0x0005), nullptr);
+
+  EXPECT_EQ(db.FindDescriptor(0x0006),
+            &service_1.characteristics[0].descriptors[1]);
+  EXPECT_EQ(db.FindDescriptor(0x0023),
+            &service_2.characteristics[0].descriptors[0]);
+  EXPECT_EQ(db.FindDescriptor(0x0004), nullptr);
+
+  EXPECT_EQ(db.FindOwningCharacteristic(0x0005),
+            &service_1.characteristics[0]);
+  EXPECT_EQ(db.FindOwningCharacteristic(0x0023),
+            &service_2.characteristics[0]);
+  EXPECT_EQ(db.FindOwningCharacteristic(0x0021), nullptr);
+
+  db.Clear();
+  EXPECT_EQ(db.FindService(0x0001), nullptr);
+  EXPECT_EQ(db.FindCharacteristic(0x0004), nullptr);
+}
+
+/* This test makes sure that lookups point into the database they are made on
+ * after copies and moves */
+TEST(GattDatabaseTest, find_by_handle_after_copy_test) {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, SERVICE_1_CHAR_1_DESC_1_UUID);
+
+  Database copy;
+  {
+    Database db = builder.Build();
+    copy = db;
+  }
+  EXPECT_EQ(copy.FindCharacteristic(0x0004),
+            &copy.Services().front().characteristics[0]);
+
+  Database moved = std::move(copy);
+  EXPECT_EQ(moved.FindDescriptor(0x0005),
+            &moved.Services().front().characteristics[0].descriptors[0]);
+
+  bool success = false;
+  Database deserialized = Database::Deserialize(moved.Serialize(), &success);
+  ASSERT_TRUE(success);
+  EXPECT_EQ(deserialized.FindService(0x0005),
+            &deserialized.Services().front());
+  EXPECT_EQ(deserialized.FindOwningCharacteristic(0x0005),
+            &deserialized.Services().front().characteristics[0]);
+}
+
+/* This test makes sure that databases with enough services to be indexed by
+ * handle find the same attributes as a walk over their services, also after a
+ * copy */
+TEST(GattDatabaseTest, find_by_handle_indexed_test) {
+  constexpr uint16_t kNumServices = 20;
+  DatabaseBuilder builder;
+  for (uint16_t s = 0; s < kNumServices; s++) {
+    uint16_t handle = 0x0010 * (s + 1);
+    builder.AddService(handle, handle + 0x0008, SERVICE_1_UUID, true);
+  }
+  builder.AddIncludedService(0x0011, SERVICE_2_UUID, 0x0020, 0x0028);
+  for (uint16_t s = 0; s < kNumServices; s++) {
+    uint16_t handle = 0x0010 * (s + 1);
+    builder.AddCharacteristic(handle + 2, handle + 3, SERVICE_1_CHAR_1_UUID,
+                              0x10);
+    builder.AddDescriptor(handle + 4, SERVICE_1_CHAR_1_DESC_1_UUID);
+    builder.AddCharacteristic(handle + 5, handle + 6, SERVICE_1_CHAR_1_UUID,
+                              0x02);
+    builder.AddDescriptor(handle + 7, SERVICE_1_CHAR_1_DESC_1_UUID);
+    builder.AddDescriptor(handle + 8, SERVICE_1_CHAR_1_DESC_1_UUID);
+  }
+
+  Database built = builder.Build();
+  Database copy = built;
+  for (const Database* db : {&built, &copy}) {
+    ASSERT_EQ(db->Services().size(), kNumServices);
+
+    for (uint32_t handle = 0; handle <= 0x0160; handle++) {
+      const Service* service = nullptr;
+      const Characteristic* characteristic = nullptr;
+      const Descriptor* descriptor = nullptr;
+      const Characteristic* owner = nullptr;
+      for (const Service& svc : db->Services()) {
+        if (handle < svc.handle || handle > svc.end_handle) continue;
+        service = &svc;
+        for (const Characteristic& charac : svc.characteristics) {
+          if (handle == charac.value_handle) characteristic = &charac;
+          for (const Descriptor& desc : charac.descriptors) {
+            if (handle != desc.handle) continue;
+            descriptor = &desc;
+            owner = &charac;
+          }
+        }
+      }
+
+      EXPECT_EQ(db->FindService(handle), service) << handle;
+      EXPECT_EQ(db->FindCharacteristic(handle), characteristic) << handle;
+      EXPECT_EQ(db->FindDescriptor(handle), descriptor) << handle;
+      EXPECT_EQ(db->FindOwningCharacteristic(handle), owner) << handle;
+    }
+  }
+}
+
 }  // namespace gatt
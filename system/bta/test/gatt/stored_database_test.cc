@@ -0,0 +1,153 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include "gatt/stored_database.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gatt/database_builder.h"
+#include "stack/include/gattdefs.h"
+#include "types/bluetooth/uuid.h"
+
+using bluetooth::Uuid;
+
+namespace gatt {
+
+namespace {
+const Uuid CHARACTERISTIC_EXTENDED_PROPERTIES =
+    Uuid::From16Bit(GATT_UUID_CHAR_EXT_PROP);
+
+Uuid SERVICE_1_UUID = Uuid::FromString("1800");
+Uuid SERVICE_2_UUID = Uuid::FromString("1801");
+Uuid SERVICE_3_UUID = Uuid::FromString("180f");
+Uuid SERVICE_1_CHAR_1_UUID = Uuid::FromString("2a00");
+Uuid SERVICE_1_CHAR_2_UUID = Uuid::FromString("2a01");
+Uuid SERVICE_3_CHAR_1_UUID = Uuid::FromString("2a19");
+Uuid CCC_UUID = Uuid::FromString("2902");
+
+Database BuildDatabase() {
+  DatabaseBuilder builder;
+  builder.AddService(0x0001, 0x000f, SERVICE_1_UUID, true);
+  builder.AddService(0x0010, 0x001f, SERVICE_2_UUID, false);
+  builder.AddService(0x0040, 0x0045, SERVICE_3_UUID, true);
+  builder.AddIncludedService(0x0002, SERVICE_2_UUID, 0x0010, 0x001f);
+  builder.AddCharacteristic(0x0003, 0x0004, SERVICE_1_CHAR_1_UUID, 0x02);
+  builder.AddDescriptor(0x0005, CCC_UUID);
+  builder.AddDescriptor(0x0006, CHARACTERISTIC_EXTENDED_PROPERTIES);
+  builder.AddCharacteristic(0x0007, 0x0008, SERVICE_1_CHAR_2_UUID, 0x12);
+  builder.AddCharacteristic(0x0041, 0x0042, SERVICE_3_CHAR_1_UUID, 0x12);
+  builder.AddDescriptor(0x0043, CCC_UUID);
+
+  // Set value of only «Characteristic Extended Properties» descriptor
+  builder.SetValueOfDescriptors({0x0001});
+  return builder.Build();
+}
+
+Octet16 TestHash() {
+  Octet16 hash;
+  for (size_t i = 0; i < hash.size(); i++) hash[i] = i;
+  return hash;
+}
+
+class StoredDatabaseTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "/gatt_stored_database_test";
+  }
+
+  void TearDown() override { unlink(path_.c_str()); }
+
+  void WriteFile(const std::vector<uint8_t>& bytes) {
+    FILE* fd = fopen(path_.c_str(), "wb");
+    ASSERT_NE(fd, nullptr);
+    ASSERT_EQ(fwrite(bytes.data(), 1, bytes.size(), fd), bytes.size());
+    fclose(fd);
+  }
+
+  std::string path_;
+};
+}  // namespace
+
+TEST_F(StoredDatabaseTest, round_trip) {
+  Database db = BuildDatabase();
+  WriteFile(StoredDatabase::Serialize(db, TestHash()));
+
+  auto stored_db = StoredDatabase::Open(path_);
+  ASSERT_NE(stored_db, nullptr);
+  EXPECT_EQ(stored_db->Hash(), TestHash());
+  EXPECT_EQ(stored_db->NumAttributes(), db.Serialize().size());
+
+  bool success = false;
+  Database loaded = stored_db->ToDatabase(&success);
+  ASSERT_TRUE(success);
+  EXPECT_EQ(loaded.ToString(), db.ToString());
+}
+
+TEST_F(StoredDatabaseTest, empty_database) {
+  WriteFile(StoredDatabase::Serialize(Database(), TestHash()));
+  auto stored_db = StoredDatabase::Open(path_);
+  ASSERT_NE(stored_db, nullptr);
+  EXPECT_EQ(stored_db->NumAttributes(), 0u);
+
+  bool success = false;
+  EXPECT_TRUE(stored_db->ToDatabase(&success).IsEmpty());
+  EXPECT_TRUE(success);
+}
+
+TEST_F(StoredDatabaseTest, reject_missing_file) {
+  EXPECT_EQ(StoredDatabase::Open(path_), nullptr);
+}
+
+TEST_F(StoredDatabaseTest, reject_other_version) {
+  auto bytes = StoredDatabase::Serialize(BuildDatabase(), TestHash());
+  // Version 6 files hold the attribute count right after the version
+  bytes[0] = 6;
+  WriteFile(bytes);
+  EXPECT_EQ(StoredDatabase::Open(path_), nullptr);
+}
+
+TEST_F(StoredDatabaseTest, reject_truncated_file) {
+  auto bytes = StoredDatabase::Serialize(BuildDatabase(), TestHash());
+  bytes.pop_back();
+  WriteFile(bytes);
+  EXPECT_EQ(StoredDatabase::Open(path_), nullptr);
+
+  bytes.resize(10);
+  WriteFile(bytes);
+  EXPECT_EQ(StoredDatabase::Open(path_), nullptr);
+}
+
+TEST_F(StoredDatabaseTest, reject_attribute_outside_services) {
+  auto bytes = StoredDatabase::Serialize(BuildDatabase(), TestHash());
+  // Move the last attribute past the end handle of the last service
+  bytes[bytes.size() - StoredAttribute::kSizeOnDisk] = 0x50;
+  WriteFile(bytes);
+  auto stored_db = StoredDatabase::Open(path_);
+  ASSERT_NE(stored_db, nullptr);
+
+  bool success = true;
+  stored_db->ToDatabase(&success);
+  EXPECT_FALSE(success);
+}
+
+}  // namespace gatt
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "btif/include/btif_sock_thread.h"
+#include "osi/include/allocator.h"
+#include "osi/include/osi.h"  // OSI_NO_INTR
+#include "stack/include/bt_hdr.h"
+
+using ::benchmark::State;
+
+// Room reserved in front of the payload, as for an outgoing RFCOMM frame
+static constexpr uint16_t kHeaderOffset = 13 + 5;
+static constexpr size_t kPayloadSize = 4096;
+
+struct bench_socket_t {
+  int app_fd;
+  int stack_fd;
+  BT_HDR* p_buf;
+};
+
+static int g_thread_handle = -1;
+static std::vector<bench_socket_t> g_sockets;
+static std::atomic<uint64_t> g_bytes_received = 0;
+static uint64_t g_bytes_expected = 0;
+static std::unique_ptr<std::promise<void>> g_done_promise;
+
+// Runs on the socket poll thread: read straight into the payload area of a
+// preallocated BT_HDR, then arm the fd again
+static void on_signaled(int fd, int type, int flags, uint32_t user_id) {
+  if (!(flags & SOCK_THREAD_FD_RD)) return;
+
+  BT_HDR* p_buf = g_sockets[user_id].p_buf;
+  ssize_t count;
+  OSI_NO_INTR(count = recv(fd, (uint8_t*)(p_buf + 1) + p_buf->offset,
+                           kPayloadSize, MSG_DONTWAIT));
+  if (count > 0) {
+    p_buf->len = count;
+    uint64_t total = g_bytes_received += count;
+    if (total == g_bytes_expected) g_done_promise->set_value();
+  }
+
+  btsock_thread_add_fd(g_thread_handle, fd, type,
+                       SOCK_THREAD_FD_RD | SOCK_THREAD_ADD_FD_SYNC, user_id);
+}
+
+class BM_BtsockThread : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    btsock_thread_init();
+    g_thread_handle = btsock_thread_create(on_signaled, nullptr);
+
+    size_t num_sockets = st.range(0);
+    g_sockets.resize(num_sockets);
+    for (size_t i = 0; i < num_sockets; i++) {
+      int fds[2];
+      socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+      g_sockets[i].app_fd = fds[0];
+      g_sockets[i].stack_fd = fds[1];
+      g_sockets[i].p_buf =
+          (BT_HDR*)osi_malloc(sizeof(BT_HDR) + kHeaderOffset + kPayloadSize);
+      g_sockets[i].p_buf->offset = kHeaderOffset;
+    }
+    for (size_t i = 0; i < num_sockets; i++) {
+      btsock_thread_add_fd(g_thread_handle, g_sockets[i].stack_fd, 0,
+                           SOCK_THREAD_FD_RD, i);
+    }
+  }
+
+  void TearDown(State& st) override {
+    btsock_thread_exit(g_thread_handle);
+    g_thread_handle = -1;
+    for (bench_socket_t& socket : g_sockets) {
+      close(socket.app_fd);
+      close(socket.stack_fd);
+      osi_free(socket.p_buf);
+    }
+    g_sockets.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+};
+
+BENCHMARK_DEFINE_F(BM_BtsockThread, app_to_stack_throughput)(State& state) {
+  size_t write_size = state.range(1);
+  std::vector<uint8_t> data(write_size, 0xa5);
+  constexpr size_t kWritesPerSocket = 64;
+
+  for (auto _ : state) {
+    g_bytes_received = 0;
+    g_bytes_expected = g_sockets.size() * kWritesPerSocket * write_size;
+    g_done_promise = std::make_unique<std::promise<void>>();
+    std::future<void> done = g_done_promise->get_future();
+
+    // Interleave the sockets so the poll thread sees many of them ready at once
+    for (size_t n = 0; n < kWritesPerSocket; n++) {
+      for (bench_socket_t& socket : g_sockets) {
+        ssize_t sent;
+        OSI_NO_INTR(sent = send(socket.app_fd, data.data(), data.size(), 0));
+      }
+    }
+    done.wait();
+  }
+  state.SetBytesProcessed(state.iterations() * g_bytes_expected);
+}
+
+BENCHMARK_REGISTER_F(BM_BtsockThread, app_to_stack_throughput)
+    ->ArgNames({"sockets", "write_size"})
+    ->Args({1, 990})
+    ->Args({1, 4096})
+    ->Args({8, 990})
+    ->Args({64, 990})
+    ->Args({256, 990})
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -362,7 +362,9 @@ bool btif_a2dp_source_startup(void) {
 
   btif_a2dp_source_cb.Reset();
   btif_a2dp_source_cb.SetState(BtifA2dpSource::kStateStartingUp);
-  btif_a2dp_source_cb.tx_audio_queue = fixed_queue_new(SIZE_MAX);
+  // The overflow check in btif_a2dp_source_enqueue_callback() bounds the queue
+  // by btif_a2dp_source_dynamic_audio_buffer_size, which is a uint8_t
+  btif_a2dp_source_cb.tx_audio_queue = fixed_queue_new_ring(UINT8_MAX + 1);
 
   // Schedule the rest of the operations
   btif_a2dp_source_thread.DoInThread(
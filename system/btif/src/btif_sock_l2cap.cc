@@ -45,8 +45,8 @@ using namespace bluetooth;
 
 struct packet {
   struct packet *next, *prev;
-  uint32_t len;
-  uint8_t* data;
+  uint32_t len;   // bytes not delivered to the app yet
+  uint8_t* data;  // first byte not delivered to the app yet
 };
 
 typedef struct l2cap_socket {
@@ -108,75 +108,43 @@ static void btsock_l2cap_cbk(tBTA_JV_EVT event, tBTA_JV* p_data,
  * wait
  *       confirming the l2cap_ind until we have more space in the buffer. */
 
-/* returns false if none - caller must free "data" memory when done with it */
-static char packet_get_head_l(l2cap_socket* sock, uint8_t** data,
-                              uint32_t* len) {
+/* The payload follows the packet in the same allocation, so data received
+ * from L2CAP is read straight into the buffer that is later sent to the app. */
+static struct packet* packet_alloc(uint32_t len) {
+  struct packet* p = (struct packet*)osi_malloc(sizeof(*p) + len);
+
+  p->next = NULL;
+  p->prev = NULL;
+  p->data = (uint8_t*)(p + 1);
+  p->len = len;
+  return p;
+}
+
+/* returns NULL if none - caller must osi_free() the packet when done with it */
+static struct packet* packet_get_head_l(l2cap_socket* sock) {
   struct packet* p = sock->first_packet;
 
-  if (!p) return false;
+  if (!p) return NULL;
 
-  if (data) *data = sock->first_packet->data;
-  if (len) *len = sock->first_packet->len;
   sock->first_packet = p->next;
   if (sock->first_packet)
     sock->first_packet->prev = NULL;
   else
     sock->last_packet = NULL;
 
-  if (len) sock->bytes_buffered -= *len;
+  sock->bytes_buffered -= p->len;
 
-  osi_free(p);
-
-  return true;
-}
-
-static struct packet* packet_alloc(const uint8_t* data, uint32_t len) {
-  struct packet* p = (struct packet*)osi_calloc(sizeof(*p));
-  uint8_t* buf = (uint8_t*)osi_malloc(len);
-
-  p->data = buf;
-  p->len = len;
-  memcpy(p->data, data, len);
   return p;
 }
 
-/* makes a copy of the data, returns true on success */
-static char packet_put_head_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
-
-  /*
-   * We do not check size limits here since this is used to undo "getting" a
-   * packet that the user read incompletely. That is to say the packet was
-   * already in the queue. We do check thos elimits in packet_put_tail_l() since
-   * that function is used to put new data into the queue.
-   */
-
-  if (!p) return false;
-
-  p->prev = NULL;
-  p->next = sock->first_packet;
-  sock->first_packet = p;
-  if (p->next)
-    p->next->prev = p;
-  else
-    sock->last_packet = p;
-
-  sock->bytes_buffered += len;
-
-  return true;
-}
-
-/* makes a copy of the data, returns true on success */
-static char packet_put_tail_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
+/* queues the packet, returns false if the buffer is full */
+static bool packet_put_tail_l(l2cap_socket* sock, struct packet* p) {
   if (sock->bytes_buffered >= L2CAP_MAX_RX_BUFFER) {
     log::error("Unable to add to buffer due to buffer overflow socket_id:{}",
                sock->id);
     return false;
   }
 
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
   p->next = NULL;
   p->prev = sock->last_packet;
   sock->last_packet = p;
@@ -185,11 +153,23 @@ static char packet_put_tail_l(l2cap_socket* sock, const void* data,
   else
     sock->first_packet = p;
 
-  sock->bytes_buffered += len;
+  sock->bytes_buffered += p->len;
 
   return true;
 }
 
+/* sends as much of an unqueued packet as the app accepts without blocking,
+ * returns true if all of it was delivered */
+static bool packet_send_to_app_l(l2cap_socket* sock, struct packet* p) {
+  ssize_t sent;
+  OSI_NO_INTR(sent = send(sock->our_fd, p->data, p->len, MSG_DONTWAIT));
+  if (sent <= 0) return false;
+
+  p->data += sent;
+  p->len -= sent;
+  return p->len == 0;
+}
+
 static char is_inited(void) {
   std::unique_lock<std::mutex> lock(state_lock);
   return pth != -1;
@@ -219,7 +199,7 @@ static l2cap_socket* btsock_l2cap_find_by_conn_uuid_l(Uuid& conn_uuid) {
 }
 
 static void btsock_l2cap_free_l(l2cap_socket* sock) {
-  uint8_t* buf;
+  struct packet* p;
   l2cap_socket* t = socks;
 
   while (t && t != sock) t = t->next;
@@ -252,7 +232,7 @@ static void btsock_l2cap_free_l(l2cap_socket* sock) {
               sock->id);
   }
 
-  while (packet_get_head_l(sock, &buf, NULL)) osi_free(buf);
+  while ((p = packet_get_head_l(sock)) != NULL) osi_free(p);
 
   // lower-level close() should be idempotent... so let's call it and see...
   if (sock->is_le_coc) {
@@ -709,21 +689,27 @@ static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
   uint32_t count;
 
   if (BTA_JvL2capReady(sock->handle, &count) == tBTA_JV_STATUS::SUCCESS) {
-    std::vector<uint8_t> buffer(count);
-    if (BTA_JvL2capRead(sock->handle, sock->id, buffer.data(), count) ==
+    struct packet* p = packet_alloc(count);
+    if (BTA_JvL2capRead(sock->handle, sock->id, p->data, count) ==
         tBTA_JV_STATUS::SUCCESS) {
-      if (packet_put_tail_l(sock, buffer.data(), count)) {
-        bytes_read = count;
+      bytes_read = count;
+      if (!sock->first_packet && packet_send_to_app_l(sock, p)) {
+        // delivered right away, no need to wait for the app to be writable
+        osi_free(p);
+      } else if (packet_put_tail_l(sock, p)) {
         btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_WR,
                              sock->id);
       } else {  // connection must be dropped
         log::warn(
             "Closing socket as unable to push data to socket socket_id:{}",
             sock->id);
+        osi_free(p);
         BTA_JvL2capClose(sock->handle);
         btsock_l2cap_free_l(sock);
         return;
       }
+    } else {
+      osi_free(p);
     }
   }
 
@@ -918,24 +904,24 @@ bt_status_t btsock_l2cap_connect(const RawAddress* bd_addr, int channel,
  * (for example: unrecoverable error or no data)
  */
 static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
-  uint8_t* buf;
-  uint32_t len;
+  struct packet* p;
 
-  while (packet_get_head_l(sock, &buf, &len)) {
+  while ((p = sock->first_packet) != NULL) {
+    uint32_t len = p->len;
     ssize_t sent;
-    OSI_NO_INTR(sent = send(sock->our_fd, buf, len, MSG_DONTWAIT));
+    OSI_NO_INTR(sent = send(sock->our_fd, p->data, len, MSG_DONTWAIT));
     int saved_errno = errno;
 
     if (sent == (signed)len)
-      osi_free(buf);
+      osi_free(packet_get_head_l(sock));
     else if (sent >= 0) {
-      packet_put_head_l(sock, buf + sent, len - sent);
-      osi_free(buf);
+      /* keep the rest at the head of the queue */
+      p->data += sent;
+      p->len -= sent;
+      sock->bytes_buffered -= sent;
       if (!sent) /* special case if other end not keeping up */
         return true;
     } else {
-      packet_put_head_l(sock, buf, len);
-      osi_free(buf);
       return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
     }
   }
@@ -945,8 +931,8 @@ static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
 
 inline BT_HDR* malloc_l2cap_buf(uint16_t len) {
   // We need FCS only for L2CAP_FCR_ERTM_MODE, but it's just 2 bytes so it's ok
-  BT_HDR* msg = (BT_HDR*)osi_malloc(BT_HDR_SIZE + L2CAP_MIN_OFFSET + len +
-                                    L2CAP_FCS_LENGTH);
+  BT_HDR* msg = (BT_HDR*)osi_pool_malloc(BT_HDR_SIZE + L2CAP_MIN_OFFSET + len +
+                                         L2CAP_FCS_LENGTH);
   msg->offset = L2CAP_MIN_OFFSET;
   msg->len = len;
   return msg;
@@ -20,7 +20,7 @@
  *
  *  Filename:      btif_sock_thread.cc
  *
- *  Description:   socket select thread
+ *  Description:   socket epoll thread
  *
  ******************************************************************************/
 
@@ -28,15 +28,13 @@
 
 #include "btif_sock_thread.h"
 
-#include <alloca.h>
 #include <bluetooth/log.h>
 #include <fcntl.h>
 #include <features.h>
-#include <poll.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -46,6 +44,7 @@
 #include <array>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 
 #include "os/log.h"
 #include "osi/include/osi.h"  // OSI_NO_INTR
@@ -56,11 +55,12 @@
   } while (0)
 
 #define MAX_THREAD 8
-#define MAX_POLL 64
-#define POLL_EXCEPTION_EVENTS (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)
-#define IS_EXCEPTION(e) ((e)&POLL_EXCEPTION_EVENTS)
-#define IS_READ(e) ((e)&POLLIN)
-#define IS_WRITE(e) ((e)&POLLOUT)
+/* Number of events fetched by one epoll_wait(), not a limit on the fds */
+#define MAX_EPOLL_EVENTS 64
+#define EPOLL_EXCEPTION_EVENTS (EPOLLHUP | EPOLLRDHUP | EPOLLERR)
+#define IS_EXCEPTION(e) ((e)&EPOLL_EXCEPTION_EVENTS)
+#define IS_READ(e) ((e)&EPOLLIN)
+#define IS_WRITE(e) ((e)&EPOLLOUT)
 /*cmd executes in socket poll thread */
 #define CMD_WAKEUP 1
 #define CMD_EXIT 2
@@ -71,16 +71,16 @@
 using namespace bluetooth;
 
 struct poll_slot_t {
-  struct pollfd pfd;
+  int fd;
   uint32_t user_id;
   int type;
   int flags;
 };
 struct thread_slot_t {
   int cmd_fdr, cmd_fdw;
-  int poll_count;
-  poll_slot_t ps[MAX_POLL];
-  int psi[MAX_POLL];  // index of poll slot
+  int epoll_fd;
+  /* monitored fds, only accessed from the socket poll thread once it runs */
+  std::unordered_map<int, poll_slot_t> ps;
   std::optional<pthread_t> thread_id;
   btsock_signaled_cb callback;
   btsock_cmd_cb cmd_callback;
@@ -121,7 +121,7 @@ static inline int create_thread(void* (*start_routine)(void*), void* arg,
   pthread_setschedparam(*thread_id, policy, &param);
   return ret;
 }
-static void init_poll(int cmd_fd);
+static int init_poll(int cmd_fd);
 static int alloc_thread_slot() {
   std::unique_lock<std::recursive_mutex> lock(thread_slot_lock);
   int i;
@@ -138,6 +138,11 @@ static int alloc_thread_slot() {
 static void free_thread_slot(int h) {
   if (0 <= h && h < MAX_THREAD) {
     close_cmd_fd(h);
+    ts[h].ps.clear();
+    if (ts[h].epoll_fd != -1) {
+      close(ts[h].epoll_fd);
+      ts[h].epoll_fd = -1;
+    }
     ts[h].used = 0;
   } else
     log::error("invalid thread handle:{}", h);
@@ -149,9 +154,9 @@ void btsock_thread_init() {
     int h;
     for (h = 0; h < MAX_THREAD; h++) {
       ts[h].cmd_fdr = ts[h].cmd_fdw = -1;
+      ts[h].epoll_fd = -1;
       ts[h].used = 0;
       ts[h].thread_id = std::nullopt;
-      ts[h].poll_count = 0;
       ts[h].callback = NULL;
       ts[h].cmd_callback = NULL;
     }
@@ -162,7 +167,10 @@ int btsock_thread_create(btsock_signaled_cb callback,
   asrt(callback || cmd_callback);
   int h = alloc_thread_slot();
   if (h >= 0) {
-    init_poll(h);
+    if (!init_poll(h)) {
+      free_thread_slot(h);
+      return -1;
+    }
     pthread_t thread;
     int status = create_thread(sock_poll_thread, (void*)(uintptr_t)h, &thread);
     if (status) {
@@ -178,15 +186,22 @@ int btsock_thread_create(btsock_signaled_cb callback,
   return h;
 }
 
-/* create dummy socket pair used to wake up select loop */
-static inline void init_cmd_fd(int h) {
+/* create dummy socket pair used to wake up the epoll loop */
+static inline bool init_cmd_fd(int h) {
   asrt(ts[h].cmd_fdr == -1 && ts[h].cmd_fdw == -1);
   if (socketpair(AF_UNIX, SOCK_STREAM, 0, &ts[h].cmd_fdr) < 0) {
     log::error("socketpair failed: {}", strerror(errno));
-    return;
+    return false;
   }
-  // add the cmd fd for read & write
-  add_poll(h, ts[h].cmd_fdr, 0, SOCK_THREAD_FD_RD, 0);
+  // the cmd fd stays level triggered: one command is consumed per wakeup
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = ts[h].cmd_fdr;
+  if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, ts[h].cmd_fdr, &event) == -1) {
+    log::error("unable to monitor cmd fd: {}", strerror(errno));
+    return false;
+  }
+  return true;
 }
 static inline void close_cmd_fd(int h) {
   if (ts[h].cmd_fdr != -1) {
@@ -272,74 +287,75 @@ int btsock_thread_exit(int h) {
   }
   return false;
 }
-static void init_poll(int h) {
-  int i;
-  ts[h].poll_count = 0;
+static int init_poll(int h) {
   ts[h].thread_id = std::nullopt;
   ts[h].callback = NULL;
   ts[h].cmd_callback = NULL;
-  for (i = 0; i < MAX_POLL; i++) {
-    ts[h].ps[i].pfd.fd = -1;
-    ts[h].psi[i] = -1;
+  ts[h].ps.clear();
+  ts[h].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (ts[h].epoll_fd == -1) {
+    log::error("epoll_create1 failed: {}", strerror(errno));
+    return false;
   }
-  init_cmd_fd(h);
+  return init_cmd_fd(h);
 }
-static inline unsigned int flags2pevents(int flags) {
-  unsigned int pevents = 0;
-  if (flags & SOCK_THREAD_FD_WR) pevents |= POLLOUT;
-  if (flags & SOCK_THREAD_FD_RD) pevents |= POLLIN;
-  pevents |= POLL_EXCEPTION_EVENTS;
-  return pevents;
+
+/* Data fds are edge triggered. A signaled flag is only disarmed in the slot,
+ * later edges for it are ignored until the owner arms it again with
+ * btsock_thread_add_fd(). Arming goes through EPOLL_CTL_MOD, which re-evaluates
+ * the readiness, so no edge is lost in between. */
+static inline uint32_t flags2events(int flags) {
+  uint32_t events = EPOLLET;
+  if (flags & SOCK_THREAD_FD_WR) events |= EPOLLOUT;
+  if (flags & SOCK_THREAD_FD_RD) events |= EPOLLIN;
+  events |= EPOLL_EXCEPTION_EVENTS;
+  return events;
 }
 
-static inline void set_poll(poll_slot_t* ps, int fd, int type, int flags,
-                            uint32_t user_id) {
-  ps->pfd.fd = fd;
-  ps->user_id = user_id;
-  if (ps->type != 0 && ps->type != type)
-    log::error("poll socket type should not changed! type was:{}, type now:{}",
-               ps->type, type);
-  ps->type = type;
-  ps->flags = flags;
-  ps->pfd.events = flags2pevents(flags);
-  ps->pfd.revents = 0;
+static bool set_epoll(int h, int op, int fd, int flags) {
+  struct epoll_event event = {};
+  event.events = flags2events(flags);
+  event.data.fd = fd;
+  return epoll_ctl(ts[h].epoll_fd, op, fd, &event) == 0;
 }
+
 static inline void add_poll(int h, int fd, int type, int flags,
                             uint32_t user_id) {
   asrt(fd != -1);
-  int i;
-  int empty = -1;
-  poll_slot_t* ps = ts[h].ps;
-
-  for (i = 0; i < MAX_POLL; i++) {
-    if (ps[i].pfd.fd == fd) {
-      asrt(ts[h].poll_count < MAX_POLL);
-
-      set_poll(&ps[i], fd, type, flags | ps[i].flags, user_id);
+  auto it = ts[h].ps.find(fd);
+  if (it != ts[h].ps.end()) {
+    poll_slot_t* ps = &it->second;
+    if (set_epoll(h, EPOLL_CTL_MOD, fd, flags | ps->flags)) {
+      if (ps->type != 0 && ps->type != type)
+        log::error(
+            "poll socket type should not changed! type was:{}, type now:{}",
+            ps->type, type);
+      ps->type = type;
+      ps->flags |= flags;
+      ps->user_id = user_id;
       return;
-    } else if (empty < 0 && ps[i].pfd.fd == -1)
-      empty = i;
+    }
+    if (errno != ENOENT) {
+      log::error("epoll_ctl mod fd:{} failed: {}", fd, strerror(errno));
+      return;
+    }
+    // The fd was closed and its number reused, so the slot is stale
+    ts[h].ps.erase(it);
   }
-  if (empty >= 0) {
-    asrt(ts[h].poll_count < MAX_POLL);
-    set_poll(&ps[empty], fd, type, flags, user_id);
-    ++ts[h].poll_count;
+
+  if (!set_epoll(h, EPOLL_CTL_ADD, fd, flags)) {
+    log::error("epoll_ctl add fd:{} failed: {}", fd, strerror(errno));
     return;
   }
-  log::error("exceeded max poll slot:{}!", MAX_POLL);
+  ts[h].ps[fd] = {fd, user_id, type, flags};
 }
-static inline void remove_poll(int h, poll_slot_t* ps, int flags) {
-  if (flags == ps->flags) {
-    // all monitored events signaled. To remove it, just clear the slot
-    --ts[h].poll_count;
-    memset(ps, 0, sizeof(*ps));
-    ps->pfd.fd = -1;
-  } else {
-    // one read or one write monitor event signaled, removed the accordding bit
-    ps->flags &= ~flags;
-    // update the poll events mask
-    ps->pfd.events = flags2pevents(ps->flags);
+static inline void remove_poll(int h, poll_slot_t* ps) {
+  int fd = ps->fd;
+  if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, fd, NULL) == -1 &&
+      errno != ENOENT && errno != EBADF) {
+    log::warn("epoll_ctl del fd:{} failed: {}", fd, strerror(errno));
   }
+  ts[h].ps.erase(fd);
 }
 static int process_cmd_sock(int h) {
   sock_cmd_t cmd = {-1, 0, 0, 0, 0};
@@ -356,16 +372,13 @@ static int process_cmd_sock(int h) {
     case CMD_ADD_FD:
       add_poll(h, cmd.fd, cmd.type, cmd.flags, cmd.user_id);
       break;
-    case CMD_REMOVE_FD:
-      for (int i = 1; i < MAX_POLL; ++i) {
-        poll_slot_t* poll_slot = &ts[h].ps[i];
-        if (poll_slot->pfd.fd == cmd.fd) {
-          remove_poll(h, poll_slot, poll_slot->flags);
-          break;
-        }
+    case CMD_REMOVE_FD: {
+      auto it = ts[h].ps.find(cmd.fd);
+      if (it != ts[h].ps.end()) {
+        remove_poll(h, &it->second);
       }
       close(cmd.fd);
-      break;
+    } break;
     case CMD_WAKEUP:
       break;
     case CMD_USER_PRIVATE:
@@ -382,98 +395,78 @@ static int process_cmd_sock(int h) {
   return true;
 }
 
-static void process_data_sock(int h, struct pollfd* pfds, int pfds_count,
+static void process_data_sock(int h, const struct epoll_event* events,
                               int event_count) {
-  asrt(event_count <= pfds_count);
   int i;
-  for (i = 1; i < pfds_count; i++) {
-    if (pfds[i].revents) {
-      int ps_i = ts[h].psi[i];
-      if (ts[h].ps[ps_i].pfd.fd == -1) {
-        log::info("Socket has been removed from poll set");
-        continue;
-      }
-      asrt(pfds[i].fd == ts[h].ps[ps_i].pfd.fd);
-      uint32_t user_id = ts[h].ps[ps_i].user_id;
-      int type = ts[h].ps[ps_i].type;
-      int flags = 0;
-      if (IS_READ(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_RD;
-      }
-      if (IS_WRITE(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_WR;
-      }
-      if (IS_EXCEPTION(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_EXCEPTION;
-        // remove the whole slot not flags
-        remove_poll(h, &ts[h].ps[ps_i], ts[h].ps[ps_i].flags);
-      } else if (flags)
-        remove_poll(h, &ts[h].ps[ps_i],
-                    flags);  // remove the monitor flags that already processed
-      if (flags) ts[h].callback(pfds[i].fd, type, flags, user_id);
-    }
-  }
-}
+  for (i = 0; i < event_count; i++) {
+    int fd = events[i].data.fd;
+    uint32_t revents = events[i].events;
+    if (fd == ts[h].cmd_fdr) continue;
 
-static void prepare_poll_fds(int h, struct pollfd* pfds) {
-  int count = 0;
-  int ps_i = 0;
-  int pfd_i = 0;
-  asrt(ts[h].poll_count <= MAX_POLL);
-  while (count < ts[h].poll_count) {
-    if (ps_i >= MAX_POLL) {
-      log::error(
-          "exceed max poll range, ps_i:{}, MAX_POLL:{}, count:{}, "
-          "ts[h].poll_count:{}",
-          ps_i, MAX_POLL, count, ts[h].poll_count);
-      return;
+    auto it = ts[h].ps.find(fd);
+    if (it == ts[h].ps.end()) {
+      log::info("Socket has been removed from poll set");
+      continue;
+    }
+    poll_slot_t* ps = &it->second;
+    // nothing armed, the owner is still busy with the previous signal
+    if (ps->flags == 0) continue;
+    uint32_t user_id = ps->user_id;
+    int type = ps->type;
+    int flags = 0;
+    if (IS_READ(revents)) {
+      flags |= SOCK_THREAD_FD_RD;
     }
-    if (ts[h].ps[ps_i].pfd.fd >= 0) {
-      pfds[pfd_i] = ts[h].ps[ps_i].pfd;
-      ts[h].psi[pfd_i] = ps_i;
-      count++;
-      pfd_i++;
+    if (IS_WRITE(revents)) {
+      flags |= SOCK_THREAD_FD_WR;
     }
-    ps_i++;
+    // only report what the owner asked for, the rest stays armed
+    flags &= ps->flags;
+    if (IS_EXCEPTION(revents)) {
+      flags |= SOCK_THREAD_FD_EXCEPTION;
+      // remove the whole slot not flags
+      remove_poll(h, ps);
+    } else if (flags) {
+      // disarm the monitor flags that already processed, the fd stays in the
+      // epoll set until the next btsock_thread_add_fd()
+      ps->flags &= ~flags;
+    }
+    if (flags) ts[h].callback(fd, type, flags, user_id);
   }
 }
+
 static void* sock_poll_thread(void* arg) {
-  std::array<struct pollfd, MAX_POLL> pfds;
+  std::array<struct epoll_event, MAX_EPOLL_EVENTS> events;
   if (pthread_setname_np(pthread_self(), "btif_sock_poll") != 0) {
     log::error("set thread name=btif_sock_poll failed");
   }
 
   int h = (intptr_t)arg;
   for (;;) {
-    pfds = {};
-    prepare_poll_fds(h, pfds.data());
     int ret;
-    OSI_NO_INTR(ret = poll(pfds.data(), ts[h].poll_count, -1));
+    OSI_NO_INTR(
+        ret = epoll_wait(ts[h].epoll_fd, events.data(), MAX_EPOLL_EVENTS, -1));
     if (ret == -1) {
-      log::error("poll ret -1, exit the thread, errno:{}, err:{}", errno,
+      log::error("epoll_wait ret -1, exit the thread, errno:{}, err:{}", errno,
                  strerror(errno));
       break;
     }
-    if (ret != 0) {
-      int need_process_data_fd = true;
-      int pfds_count = ts[h].poll_count;
-      if (pfds[0].revents)  // cmd fd always is the first one
-      {
-        asrt(pfds[0].fd == ts[h].cmd_fdr);
-        if (!process_cmd_sock(h)) {
-          log::info("h:{}, process_cmd_sock return false, exit...", h);
-          break;
-        }
-        if (ret == 1)
-          need_process_data_fd = false;
-        else
-          ret--;  // exclude the cmd fd
+    if (ret == 0) {
+      log::info("no data, epoll_wait ret: {}", ret);
+      continue;
+    }
+
+    // commands go first, they may remove fds signaled in the same batch
+    bool exit_thread = false;
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd == ts[h].cmd_fdr && !process_cmd_sock(h)) {
+        log::info("h:{}, process_cmd_sock return false, exit...", h);
+        exit_thread = true;
       }
-      if (need_process_data_fd)
-        process_data_sock(h, pfds.data(), pfds_count, ret);
-    } else {
-      log::info("no data, select ret: {}", ret);
-    };
+    }
+    if (exit_thread) break;
+
+    process_data_sock(h, events.data(), ret);
   }
   log::info("socket poll thread exiting, h:{}", h);
   return 0;
@@ -326,6 +326,44 @@ BENCHMARK_F(BM_OsiReactorThread, sequential_execution_using_reactor)
   }
 };
 
+class BM_OsiReactorRingQueueThread : public BM_OsiReactorThread {
+ protected:
+  void SetUp(State& st) override {
+    BM_OsiReactorThread::SetUp(st);
+    fixed_queue_free(bt_msg_queue_, nullptr);
+    bt_msg_queue_ = fixed_queue_new_ring(1024);
+  }
+};
+
+BENCHMARK_F(BM_OsiReactorRingQueueThread, batch_enque_dequeue_using_reactor)
+(State& state) {
+  fixed_queue_register_dequeue(bt_msg_queue_, thread_get_reactor(thread_),
+                               callback_batch, nullptr);
+  for (auto _ : state) {
+    g_counter = 0;
+    g_counter_promise = std::make_unique<std::promise<void>>();
+    std::future<void> counter_future = g_counter_promise->get_future();
+    for (int i = 0; i < NUM_MESSAGES_TO_SEND; i++) {
+      fixed_queue_enqueue(bt_msg_queue_, (void*)&g_counter);
+    }
+    counter_future.wait();
+  }
+};
+
+BENCHMARK_F(BM_OsiReactorRingQueueThread, sequential_execution_using_reactor)
+(State& state) {
+  fixed_queue_register_dequeue(bt_msg_queue_, thread_get_reactor(thread_),
+                               callback_sequential_queue, nullptr);
+  for (auto _ : state) {
+    for (int i = 0; i < NUM_MESSAGES_TO_SEND; i++) {
+      g_counter_promise = std::make_unique<std::promise<void>>();
+      std::future<void> counter_future = g_counter_promise->get_future();
+      fixed_queue_enqueue(bt_msg_queue_, (void*)&g_counter);
+      counter_future.wait();
+    }
+  }
+};
+
 class BM_MessageLooopThread : public BM_ThreadPerformance {
  protected:
   void SetUp(State& st) override {
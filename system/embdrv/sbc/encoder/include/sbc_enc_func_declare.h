@@ -40,11 +40,37 @@ extern const int32_t gas32CoeffFor8SBs[];
 void sbc_enc_bit_alloc_mono(SBC_ENC_PARAMS* CodecParams);
 void sbc_enc_bit_alloc_ste(SBC_ENC_PARAMS* CodecParams);
 
-void SbcAnalysisInit(void);
+void SbcAnalysisInit(SBC_ENC_PARAMS* strEncParams);
 
 void SbcAnalysisFilter4(SBC_ENC_PARAMS* strEncParams, int16_t* input);
 void SbcAnalysisFilter8(SBC_ENC_PARAMS* strEncParams, int16_t* input);
 
+/* Rows of windowed samples buffered per frame, one per block and channel */
+#define SBC_ANALYSIS_MAX_ROWS (SBC_MAX_NUM_OF_BLOCKS * SBC_MAX_NUM_OF_CHANNELS)
+
+/* Vectorized analysis filter. The window functions compute the windowed
+ * samples of one block and channel from the history at |x| and store them in
+ * column |row| of |y|, a 2 * subbands x SBC_ANALYSIS_MAX_ROWS matrix. The DCT
+ * functions then turn the first |rows| columns of |y| into subband samples,
+ * laid out as in s32SbBuffer. Columns past |rows| are used as scratch space. */
+typedef struct {
+  void (*Window4)(const int16_t* x, int32_t* y, int32_t row);
+  void (*Window8)(const int16_t* x, int32_t* y, int32_t row);
+  void (*Dct4)(int32_t* y, int32_t* output, int32_t rows);
+  void (*Dct8)(int32_t* y, int32_t* output, int32_t rows);
+} tSBC_ANALYSIS_SIMD;
+
+/* Returns the implementation of |impl|, or NULL if it is SBC_ANALYSIS_SCALAR
+ * or not supported by this CPU */
+const tSBC_ANALYSIS_SIMD* SbcAnalysisGetSimd(uint8_t impl);
+
+/* Windowing coefficients: row j holds the factors of the samples at
+ * x[j * 2 * subbands + n], for the n-th windowed sample */
+extern const int16_t gas16AnalysisWindow4[5][8];
+extern const int16_t gas16AnalysisWindow8[5][16];
+extern const int32_t gas32AnalysisWindow4[5][8];
+extern const int32_t gas32AnalysisWindow8[5][16];
+
 void SBC_FastIDCT8(int32_t* pInVect, int32_t* pOutVect);
 void SBC_FastIDCT4(int32_t* x0, int32_t* pOutVect);
 
@@ -69,6 +69,13 @@
 #define SBC_FORMAT_GENERAL 0
 #define SBC_FORMAT_MSBC 1
 
+/* Implementations of the analysis filter (polyphase windowing and DCT). They
+ * all produce bit-identical subband samples. */
+#define SBC_ANALYSIS_SCALAR 0
+#define SBC_ANALYSIS_SSE2 1
+#define SBC_ANALYSIS_AVX2 2
+#define SBC_ANALYSIS_NEON 3
+
 #ifndef SBC_MAX_NUM_FRAME
 #define SBC_MAX_NUM_FRAME 1
 #endif
@@ -188,7 +195,15 @@ typedef struct SBC_ENC_PARAMS_TAG {
   uint16_t FrameHeader;
   uint8_t Format; /* Default to be SBC_FORMAT_GENERAL for SBC if not assigned.
                     Assigning to SBC_FORMAT_MSBC for mSBC */
-
+  uint8_t AnalysisImpl; /* SBC_ANALYSIS_*, the fastest one supported is
+                           selected by SBC_Encoder_Init */
+
+  /* Analysis filter state, kept per encoder so that several streams can be
+   * encoded at the same time */
+  int16_t s16ShiftCounter;
+  int16_t s16MaxShiftCounter;
+  int32_t as32AnalysisX[ENC_VX_BUFFER_SIZE / 2]; /* int16_t samples, 32 bits
+                                                    aligned for SHIFTUP_X8_2 */
 } SBC_ENC_PARAMS;
 
 #ifdef __cplusplus
@@ -201,6 +216,11 @@ uint32_t SBC_Encode(SBC_ENC_PARAMS* strEncParams, int16_t* input,
                     uint8_t* output);
 void SBC_Encoder_Init(SBC_ENC_PARAMS* strEncParams);
 
+/* Select the analysis filter implementation used by |strEncParams|, e.g. to
+ * compare it with SBC_ANALYSIS_SCALAR. Returns false if |impl| is not
+ * supported on this CPU, in which case the selection is unchanged. */
+bool SBC_Encoder_SetAnalysis(SBC_ENC_PARAMS* strEncParams, uint8_t impl);
+
 #ifdef __cplusplus
 }
 #endif
@@ -197,15 +197,66 @@
 #define WIND_8_SUBBANDS_8_2 (int16_t)0x12CF /* 40 = 0x12CF6C75 */
 #endif
 
-#if (SBC_USE_ARM_PRAGMA == TRUE)
-#pragma arm section zidata = "sbc_s32_analysis_section"
-#endif
-static int32_t s32DCTY[16] = {0};
-static int32_t s32X[ENC_VX_BUFFER_SIZE / 2];
-static int16_t* s16X =
-    (int16_t*)s32X; /* s16X must be 32 bits aligned cf  SHIFTUP_X8_2*/
-#if (SBC_USE_ARM_PRAGMA == TRUE)
-#pragma arm section zidata
+#if (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE)
+/* The WINDOW_ACCU_* coefficients, arranged for the vectorized filters. The
+ * windowed samples 0 and 8 (2 with 4 subbands) combine differences and sums of
+ * history samples; they are expanded into one factor per sample here. */
+#define SBC_ANALYSIS_WINDOW4(T)                                               \
+  {                                                                           \
+    {0, (T)WIND_4_SUBBANDS_1_0, (T)WIND_4_SUBBANDS_2_0, (T)WIND_4_SUBBANDS_3_0, \
+     (T)WIND_4_SUBBANDS_4_0, (T)WIND_4_SUBBANDS_3_4, (T)WIND_4_SUBBANDS_2_4,  \
+     (T)WIND_4_SUBBANDS_1_4},                                                 \
+    {(T)WIND_4_SUBBANDS_0_1, (T)WIND_4_SUBBANDS_1_1, (T)WIND_4_SUBBANDS_2_1,  \
+     (T)WIND_4_SUBBANDS_3_1, (T)WIND_4_SUBBANDS_4_1, (T)WIND_4_SUBBANDS_3_3,  \
+     (T)WIND_4_SUBBANDS_2_3, (T)WIND_4_SUBBANDS_1_3},                         \
+    {(T)WIND_4_SUBBANDS_0_2, (T)WIND_4_SUBBANDS_1_2, (T)WIND_4_SUBBANDS_2_2,  \
+     (T)WIND_4_SUBBANDS_3_2, (T)WIND_4_SUBBANDS_4_2, (T)WIND_4_SUBBANDS_3_2,  \
+     (T)WIND_4_SUBBANDS_2_2, (T)WIND_4_SUBBANDS_1_2},                         \
+    {(T)-WIND_4_SUBBANDS_0_2, (T)WIND_4_SUBBANDS_1_3, (T)WIND_4_SUBBANDS_2_3, \
+     (T)WIND_4_SUBBANDS_3_3, (T)WIND_4_SUBBANDS_4_1, (T)WIND_4_SUBBANDS_3_1,  \
+     (T)WIND_4_SUBBANDS_2_1, (T)WIND_4_SUBBANDS_1_1},                         \
+    {(T)-WIND_4_SUBBANDS_0_1, (T)WIND_4_SUBBANDS_1_4, (T)WIND_4_SUBBANDS_2_4, \
+     (T)WIND_4_SUBBANDS_3_4, (T)WIND_4_SUBBANDS_4_0, (T)WIND_4_SUBBANDS_3_0,  \
+     (T)WIND_4_SUBBANDS_2_0, (T)WIND_4_SUBBANDS_1_0},                         \
+  }
+
+#define SBC_ANALYSIS_WINDOW8(T)                                               \
+  {                                                                           \
+    {0, (T)WIND_8_SUBBANDS_1_0, (T)WIND_8_SUBBANDS_2_0, (T)WIND_8_SUBBANDS_3_0, \
+     (T)WIND_8_SUBBANDS_4_0, (T)WIND_8_SUBBANDS_5_0, (T)WIND_8_SUBBANDS_6_0,  \
+     (T)WIND_8_SUBBANDS_7_0, (T)WIND_8_SUBBANDS_8_0, (T)WIND_8_SUBBANDS_7_4,  \
+     (T)WIND_8_SUBBANDS_6_4, (T)WIND_8_SUBBANDS_5_4, (T)WIND_8_SUBBANDS_4_4,  \
+     (T)WIND_8_SUBBANDS_3_4, (T)WIND_8_SUBBANDS_2_4, (T)WIND_8_SUBBANDS_1_4}, \
+    {(T)WIND_8_SUBBANDS_0_1, (T)WIND_8_SUBBANDS_1_1, (T)WIND_8_SUBBANDS_2_1,  \
+     (T)WIND_8_SUBBANDS_3_1, (T)WIND_8_SUBBANDS_4_1, (T)WIND_8_SUBBANDS_5_1,  \
+     (T)WIND_8_SUBBANDS_6_1, (T)WIND_8_SUBBANDS_7_1, (T)WIND_8_SUBBANDS_8_1,  \
+     (T)WIND_8_SUBBANDS_7_3, (T)WIND_8_SUBBANDS_6_3, (T)WIND_8_SUBBANDS_5_3,  \
+     (T)WIND_8_SUBBANDS_4_3, (T)WIND_8_SUBBANDS_3_3, (T)WIND_8_SUBBANDS_2_3,  \
+     (T)WIND_8_SUBBANDS_1_3},                                                 \
+    {(T)WIND_8_SUBBANDS_0_2, (T)WIND_8_SUBBANDS_1_2, (T)WIND_8_SUBBANDS_2_2,  \
+     (T)WIND_8_SUBBANDS_3_2, (T)WIND_8_SUBBANDS_4_2, (T)WIND_8_SUBBANDS_5_2,  \
+     (T)WIND_8_SUBBANDS_6_2, (T)WIND_8_SUBBANDS_7_2, (T)WIND_8_SUBBANDS_8_2,  \
+     (T)WIND_8_SUBBANDS_7_2, (T)WIND_8_SUBBANDS_6_2, (T)WIND_8_SUBBANDS_5_2,  \
+     (T)WIND_8_SUBBANDS_4_2, (T)WIND_8_SUBBANDS_3_2, (T)WIND_8_SUBBANDS_2_2,  \
+     (T)WIND_8_SUBBANDS_1_2},                                                 \
+    {(T)-WIND_8_SUBBANDS_0_2, (T)WIND_8_SUBBANDS_1_3, (T)WIND_8_SUBBANDS_2_3, \
+     (T)WIND_8_SUBBANDS_3_3, (T)WIND_8_SUBBANDS_4_3, (T)WIND_8_SUBBANDS_5_3,  \
+     (T)WIND_8_SUBBANDS_6_3, (T)WIND_8_SUBBANDS_7_3, (T)WIND_8_SUBBANDS_8_1,  \
+     (T)WIND_8_SUBBANDS_7_1, (T)WIND_8_SUBBANDS_6_1, (T)WIND_8_SUBBANDS_5_1,  \
+     (T)WIND_8_SUBBANDS_4_1, (T)WIND_8_SUBBANDS_3_1, (T)WIND_8_SUBBANDS_2_1,  \
+     (T)WIND_8_SUBBANDS_1_1},                                                 \
+    {(T)-WIND_8_SUBBANDS_0_1, (T)WIND_8_SUBBANDS_1_4, (T)WIND_8_SUBBANDS_2_4, \
+     (T)WIND_8_SUBBANDS_3_4, (T)WIND_8_SUBBANDS_4_4, (T)WIND_8_SUBBANDS_5_4,  \
+     (T)WIND_8_SUBBANDS_6_4, (T)WIND_8_SUBBANDS_7_4, (T)WIND_8_SUBBANDS_8_0,  \
+     (T)WIND_8_SUBBANDS_7_0, (T)WIND_8_SUBBANDS_6_0, (T)WIND_8_SUBBANDS_5_0,  \
+     (T)WIND_8_SUBBANDS_4_0, (T)WIND_8_SUBBANDS_3_0, (T)WIND_8_SUBBANDS_2_0,  \
+     (T)WIND_8_SUBBANDS_1_0},                                                 \
+  }
+
+const int16_t gas16AnalysisWindow4[5][8] = SBC_ANALYSIS_WINDOW4(int16_t);
+const int16_t gas16AnalysisWindow8[5][16] = SBC_ANALYSIS_WINDOW8(int16_t);
+const int32_t gas32AnalysisWindow4[5][8] = SBC_ANALYSIS_WINDOW4(int32_t);
+const int32_t gas32AnalysisWindow8[5][16] = SBC_ANALYSIS_WINDOW8(int32_t);
 #endif
 
 /* This macro is for 4 subbands */
@@ -1185,8 +1236,6 @@ static int16_t* s16X =
 #endif
 #endif
 
-static int16_t ShiftCounter = 0;
-extern int16_t EncMaxShiftCounter;
 /****************************************************************************
 * SbcAnalysisFilter - performs Analysis of the input audio stream
 *
@@ -1217,6 +1266,15 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #endif
 #endif
 
+  int16_t* s16X = (int16_t*)pstrEncParams->as32AnalysisX;
+  int32_t ShiftCounter = pstrEncParams->s16ShiftCounter;
+  int32_t EncMaxShiftCounter = pstrEncParams->s16MaxShiftCounter;
+  int32_t s32DCTY[16];
+  const tSBC_ANALYSIS_SIMD* pSimd =
+      SbcAnalysisGetSimd(pstrEncParams->AnalysisImpl);
+  int32_t as32Y[2 * SUB_BANDS_4 * SBC_ANALYSIS_MAX_ROWS];
+  int32_t s32Row = 0;
+
   s32NumOfChannels = pstrEncParams->s16NumOfChannels;
   s32NumOfBlocks = pstrEncParams->s16NumOfBlocks;
 
@@ -1257,6 +1315,12 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
+      if (pSimd != NULL) {
+        /* The DCT runs over the whole frame once all blocks are windowed */
+        pSimd->Window4(s16X + ChOffset, as32Y, s32Row++);
+        continue;
+      }
+
       WINDOW_PARTIAL_4
 
       SBC_FastIDCT4(s32DCTY, ps32SbBuf);
@@ -1279,6 +1343,9 @@ void SbcAnalysisFilter4(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
       }
     }
   }
+  pstrEncParams->s16ShiftCounter = (int16_t)ShiftCounter;
+
+  if (pSimd != NULL) pSimd->Dct4(as32Y, pstrEncParams->s32SbBuffer, s32Row);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -1306,6 +1373,15 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
 #endif
 #endif
 
+  int16_t* s16X = (int16_t*)pstrEncParams->as32AnalysisX;
+  int32_t ShiftCounter = pstrEncParams->s16ShiftCounter;
+  int32_t EncMaxShiftCounter = pstrEncParams->s16MaxShiftCounter;
+  int32_t s32DCTY[16];
+  const tSBC_ANALYSIS_SIMD* pSimd =
+      SbcAnalysisGetSimd(pstrEncParams->AnalysisImpl);
+  int32_t as32Y[2 * SUB_BANDS_8 * SBC_ANALYSIS_MAX_ROWS];
+  int32_t s32Row = 0;
+
   s32NumOfChannels = pstrEncParams->s16NumOfChannels;
   s32NumOfBlocks = pstrEncParams->s16NumOfBlocks;
 
@@ -1370,6 +1446,12 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
     for (s32Ch = 0; s32Ch < s32NumOfChannels; s32Ch++) {
       ChOffset = s32Ch * Offset2 + Offset;
 
+      if (pSimd != NULL) {
+        /* The DCT runs over the whole frame once all blocks are windowed */
+        pSimd->Window8(s16X + ChOffset, as32Y, s32Row++);
+        continue;
+      }
+
       WINDOW_PARTIAL_8
 
       SBC_FastIDCT8(s32DCTY, ps32SbBuf);
@@ -1392,9 +1474,13 @@ void SbcAnalysisFilter8(SBC_ENC_PARAMS* pstrEncParams, int16_t* input) {
       }
     }
   }
+  pstrEncParams->s16ShiftCounter = (int16_t)ShiftCounter;
+
+  if (pSimd != NULL) pSimd->Dct8(as32Y, pstrEncParams->s32SbBuffer, s32Row);
 }
 
-void SbcAnalysisInit(void) {
-  memset(s16X, 0, ENC_VX_BUFFER_SIZE * sizeof(int16_t));
-  ShiftCounter = 0;
+void SbcAnalysisInit(SBC_ENC_PARAMS* pstrEncParams) {
+  memset(pstrEncParams->as32AnalysisX, 0,
+         sizeof(pstrEncParams->as32AnalysisX));
+  pstrEncParams->s16ShiftCounter = 0;
 }
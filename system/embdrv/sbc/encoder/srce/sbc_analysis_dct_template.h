@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  DCT of the vectorized analysis filters. Every lane transforms one column of
+ *  windowed samples, following SBC_FastIDCT4 and SBC_FastIDCT8 operation by
+ *  operation so that the subband samples are bit-identical.
+ *
+ *  This file is included by sbc_analysis_simd.c once per instruction set,
+ *  after defining:
+ *    SBC_VEC              vector of int32_t lanes
+ *    SBC_VEC_LANES        number of lanes
+ *    SBC_VEC_NAME(name)   name suffixed with the instruction set
+ *    SBC_VEC_TARGET       function attributes enabling the instruction set
+ *    SBC_VEC_LOAD(p)      SBC_VEC_STORE(p, v)
+ *    SBC_VEC_ADD(a, b)    SBC_VEC_SUB(a, b)
+ *    SBC_VEC_SRA(v, n)    SBC_VEC_SHL(v, n)
+ *    SBC_VEC_MULQ15(c, v) (int32_t)(((int64_t)c * v) >> 15) for 0 <= c < 2^15
+ *
+ ******************************************************************************/
+
+/* Store |num| output vectors into the rows of |output| starting at |row| */
+static void SBC_VEC_TARGET SBC_VEC_NAME(SbcStoreColumns)(const SBC_VEC* out,
+                                                         int32_t num,
+                                                         int32_t* output,
+                                                         int32_t row,
+                                                         int32_t rows) {
+  int32_t tmp[SUB_BANDS_8][SBC_VEC_LANES];
+  int32_t k, l;
+
+  for (k = 0; k < num; k++) SBC_VEC_STORE(tmp[k], out[k]);
+  for (l = 0; l < SBC_VEC_LANES && row + l < rows; l++) {
+    for (k = 0; k < num; k++) output[(row + l) * num + k] = tmp[k][l];
+  }
+}
+
+static void SBC_VEC_TARGET SBC_VEC_NAME(SbcAnalysisDct4)(int32_t* y,
+                                                         int32_t* output,
+                                                         int32_t rows) {
+  SBC_VEC x2, temp, tmp[8], out[SUB_BANDS_4];
+  int32_t row;
+
+  SbcClearPadding(y, 2 * SUB_BANDS_4, rows, SBC_VEC_LANES);
+  for (row = 0; row < rows; row += SBC_VEC_LANES) {
+#define Y(n) SBC_VEC_LOAD(y + (n) * SBC_ANALYSIS_MAX_ROWS + row)
+    x2 = SBC_VEC_SRA(Y(2), 1);
+    temp = SBC_VEC_ADD(Y(0), Y(4));
+    tmp[0] = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4 >> 1, temp);
+    tmp[1] = SBC_VEC_SUB(x2, tmp[0]);
+    tmp[0] = SBC_VEC_ADD(tmp[0], x2);
+    temp = SBC_VEC_ADD(Y(1), Y(3));
+    tmp[3] = SBC_VEC_MULQ15(SBC_COS_3PI_SUR_8 >> 1, temp);
+    tmp[2] = SBC_VEC_MULQ15(SBC_COS_PI_SUR_8 >> 1, temp);
+    temp = SBC_VEC_SUB(Y(5), Y(7));
+    tmp[5] = SBC_VEC_MULQ15(SBC_COS_3PI_SUR_8 >> 1, temp);
+    tmp[4] = SBC_VEC_MULQ15(SBC_COS_PI_SUR_8 >> 1, temp);
+#undef Y
+    tmp[6] = SBC_VEC_ADD(tmp[2], tmp[5]);
+    tmp[7] = SBC_VEC_SUB(tmp[3], tmp[4]);
+    out[0] = SBC_VEC_ADD(tmp[0], tmp[6]);
+    out[1] = SBC_VEC_ADD(tmp[1], tmp[7]);
+    out[2] = SBC_VEC_SUB(tmp[1], tmp[7]);
+    out[3] = SBC_VEC_SUB(tmp[0], tmp[6]);
+    SBC_VEC_NAME(SbcStoreColumns)(out, SUB_BANDS_4, output, row, rows);
+  }
+}
+
+static void SBC_VEC_TARGET SBC_VEC_NAME(SbcAnalysisDct8)(int32_t* y,
+                                                         int32_t* output,
+                                                         int32_t rows) {
+  SBC_VEC x0, x1, x2, x3, x4, x5, x6, x7, temp;
+  SBC_VEC res_even[4], res_odd[4], out[SUB_BANDS_8];
+  int32_t row;
+
+  SbcClearPadding(y, 2 * SUB_BANDS_8, rows, SBC_VEC_LANES);
+  for (row = 0; row < rows; row += SBC_VEC_LANES) {
+#define Y(n) SBC_VEC_LOAD(y + (n) * SBC_ANALYSIS_MAX_ROWS + row)
+    x0 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, Y(4));
+    x1 = SBC_VEC_SRA(SBC_VEC_ADD(Y(3), Y(5)), 1);
+    x2 = SBC_VEC_SRA(SBC_VEC_ADD(Y(2), Y(6)), 1);
+    x3 = SBC_VEC_SRA(SBC_VEC_ADD(Y(1), Y(7)), 1);
+    x4 = SBC_VEC_SRA(SBC_VEC_ADD(Y(0), Y(8)), 1);
+    x5 = SBC_VEC_SRA(SBC_VEC_SUB(Y(9), Y(15)), 1);
+    x6 = SBC_VEC_SRA(SBC_VEC_SUB(Y(10), Y(14)), 1);
+    x7 = SBC_VEC_SRA(SBC_VEC_SUB(Y(11), Y(13)), 1);
+#undef Y
+
+    temp = x0;
+    x0 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, SBC_VEC_ADD(x0, x4));
+    x4 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, SBC_VEC_SUB(temp, x4));
+
+    x2 = SBC_VEC_SUB(x2, x6);
+    x6 = SBC_VEC_SHL(x6, 1);
+
+    x6 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, x6);
+    temp = x2;
+    x2 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_8, SBC_VEC_ADD(x2, x6));
+    x6 = SBC_VEC_MULQ15(SBC_COS_3PI_SUR_8, SBC_VEC_SUB(temp, x6));
+
+    res_even[0] = SBC_VEC_ADD(x0, x2);
+    res_even[1] = SBC_VEC_ADD(x4, x6);
+    res_even[2] = SBC_VEC_SUB(x4, x6);
+    res_even[3] = SBC_VEC_SUB(x0, x2);
+
+    x7 = SBC_VEC_SHL(x7, 1);
+    x5 = SBC_VEC_SUB(SBC_VEC_SHL(x5, 1), x7);
+    x3 = SBC_VEC_SUB(SBC_VEC_SHL(x3, 1), x5);
+    x1 = SBC_VEC_SUB(x1, SBC_VEC_SRA(x3, 1));
+
+    x5 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, x5);
+    temp = x1;
+    x1 = SBC_VEC_ADD(x1, x5);
+    x5 = SBC_VEC_SUB(temp, x5);
+
+    x3 = SBC_VEC_SUB(x3, x7);
+    x7 = SBC_VEC_SHL(x7, 1);
+    x7 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_4, x7);
+
+    temp = x3;
+    x3 = SBC_VEC_MULQ15(SBC_COS_PI_SUR_8, SBC_VEC_ADD(x3, x7));
+    x7 = SBC_VEC_MULQ15(SBC_COS_3PI_SUR_8, SBC_VEC_SUB(temp, x7));
+
+    res_odd[0] = SBC_VEC_MULQ15(SBC_COS_PI_SUR_16, SBC_VEC_ADD(x1, x3));
+    res_odd[1] = SBC_VEC_MULQ15(SBC_COS_3PI_SUR_16, SBC_VEC_ADD(x5, x7));
+    res_odd[2] = SBC_VEC_MULQ15(SBC_COS_5PI_SUR_16, SBC_VEC_SUB(x5, x7));
+    res_odd[3] = SBC_VEC_MULQ15(SBC_COS_7PI_SUR_16, SBC_VEC_SUB(x1, x3));
+
+    out[0] = SBC_VEC_ADD(res_even[0], res_odd[0]);
+    out[1] = SBC_VEC_ADD(res_even[1], res_odd[1]);
+    out[2] = SBC_VEC_ADD(res_even[2], res_odd[2]);
+    out[3] = SBC_VEC_ADD(res_even[3], res_odd[3]);
+    out[7] = SBC_VEC_SUB(res_even[0], res_odd[0]);
+    out[6] = SBC_VEC_SUB(res_even[1], res_odd[1]);
+    out[5] = SBC_VEC_SUB(res_even[2], res_odd[2]);
+    out[4] = SBC_VEC_SUB(res_even[3], res_odd[3]);
+    SBC_VEC_NAME(SbcStoreColumns)(out, SUB_BANDS_8, output, row, rows);
+  }
+}
@@ -0,0 +1,333 @@
+/******************************************************************************
+ *
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Vectorized analysis filter (SSE2, AVX2 and NEON). The windowing and the DCT
+ *  use exact integer arithmetic in the same order of magnitude as the scalar
+ *  filter in sbc_analysis.c, so the subband samples are bit-identical.
+ *
+ ******************************************************************************/
+#include <stddef.h>
+
+#include "sbc_dct.h"
+#include "sbc_enc_func_declare.h"
+#include "sbc_encoder.h"
+
+/* Only the default fixed point configuration is vectorized */
+#if (SBC_IS_64_MULT_IN_WINDOW_ACCU == FALSE) &&                      \
+    (SBC_IS_64_MULT_IN_IDCT == FALSE) && (SBC_FAST_DCT == TRUE) &&   \
+    (SBC_ARM_ASM_OPT == FALSE) && (SBC_DSP_OPT == FALSE) &&          \
+    (SBC_IPAQ_OPT == TRUE)
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SBC_SIMD_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SBC_SIMD_NEON
+#endif
+#endif
+
+#if defined(SBC_SIMD_X86) || defined(SBC_SIMD_NEON)
+
+/* Zero the columns between |rows| and the next multiple of |lanes|, so that
+ * the DCT only reads initialized samples */
+static void SbcClearPadding(int32_t* y, int32_t num, int32_t rows,
+                            int32_t lanes) {
+  int32_t end = (rows + lanes - 1) / lanes * lanes;
+  int32_t n, row;
+
+  for (n = 0; n < num; n++) {
+    for (row = rows; row < end; row++) y[n * SBC_ANALYSIS_MAX_ROWS + row] = 0;
+  }
+}
+
+/* Store the windowed samples of one block and channel in column |row| */
+static void SbcStoreWindowed(const int32_t* windowed, int32_t num, int32_t* y,
+                             int32_t row) {
+  int32_t n;
+
+  for (n = 0; n < num; n++) y[n * SBC_ANALYSIS_MAX_ROWS + row] = windowed[n];
+}
+
+#endif
+
+#if defined(SBC_SIMD_X86)
+
+/* The history samples are zero-extended to 32 bits, so pmaddwd multiplies each
+ * of them by the low half of the sign-extended coefficient and adds zero */
+static void __attribute__((target("sse2")))
+SbcAnalysisWindow4Sse2(const int16_t* x, int32_t* y, int32_t row) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc0 = zero, acc1 = zero;
+  int32_t windowed[2 * SUB_BANDS_4];
+  int32_t j;
+
+  for (j = 0; j < 5; j++) {
+    __m128i samples = _mm_loadu_si128((const __m128i*)(x + 8 * j));
+    const __m128i* coeffs = (const __m128i*)gas32AnalysisWindow4[j];
+    acc0 = _mm_add_epi32(acc0,
+                         _mm_madd_epi16(_mm_unpacklo_epi16(samples, zero),
+                                        _mm_loadu_si128(coeffs)));
+    acc1 = _mm_add_epi32(acc1,
+                         _mm_madd_epi16(_mm_unpackhi_epi16(samples, zero),
+                                        _mm_loadu_si128(coeffs + 1)));
+  }
+  _mm_storeu_si128((__m128i*)windowed, acc0);
+  _mm_storeu_si128((__m128i*)(windowed + 4), acc1);
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_4, y, row);
+}
+
+static void __attribute__((target("sse2")))
+SbcAnalysisWindow8Sse2(const int16_t* x, int32_t* y, int32_t row) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc[4] = {zero, zero, zero, zero};
+  int32_t windowed[2 * SUB_BANDS_8];
+  int32_t j, k;
+
+  for (j = 0; j < 5; j++) {
+    __m128i lo = _mm_loadu_si128((const __m128i*)(x + 16 * j));
+    __m128i hi = _mm_loadu_si128((const __m128i*)(x + 16 * j + 8));
+    __m128i samples[4] = {
+        _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+        _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+    const __m128i* coeffs = (const __m128i*)gas32AnalysisWindow8[j];
+    for (k = 0; k < 4; k++) {
+      acc[k] = _mm_add_epi32(
+          acc[k], _mm_madd_epi16(samples[k], _mm_loadu_si128(coeffs + k)));
+    }
+  }
+  for (k = 0; k < 4; k++) {
+    _mm_storeu_si128((__m128i*)(windowed + 4 * k), acc[k]);
+  }
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_8, y, row);
+}
+
+/* With c < 2^15, c * v = 2 * c * (v >> 16) * 2^15 + c * (v & 0xffff), where
+ * both products fit in 32 bits: the first one with pmaddwd on the sign-extended
+ * high half, the second one with the 16 bit unsigned multiplies */
+static inline __m128i __attribute__((target("sse2")))
+SbcMulQ15Sse2(int32_t c, __m128i v) {
+  const __m128i coeff = _mm_set1_epi32(c);
+  __m128i hi = _mm_madd_epi16(_mm_srai_epi32(v, 16), coeff);
+  __m128i lo = _mm_or_si128(
+      _mm_mullo_epi16(v, coeff),
+      _mm_slli_epi32(_mm_mulhi_epu16(v, coeff), 16));
+  return _mm_add_epi32(_mm_slli_epi32(hi, 1), _mm_srli_epi32(lo, 15));
+}
+
+#define SBC_VEC __m128i
+#define SBC_VEC_LANES 4
+#define SBC_VEC_NAME(name) name##Sse2
+#define SBC_VEC_TARGET __attribute__((target("sse2")))
+#define SBC_VEC_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SBC_VEC_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define SBC_VEC_ADD(a, b) _mm_add_epi32(a, b)
+#define SBC_VEC_SUB(a, b) _mm_sub_epi32(a, b)
+#define SBC_VEC_SRA(v, n) _mm_srai_epi32(v, n)
+#define SBC_VEC_SHL(v, n) _mm_slli_epi32(v, n)
+#define SBC_VEC_MULQ15(c, v) SbcMulQ15Sse2(c, v)
+#include "sbc_analysis_dct_template.h"
+#undef SBC_VEC
+#undef SBC_VEC_LANES
+#undef SBC_VEC_NAME
+#undef SBC_VEC_TARGET
+#undef SBC_VEC_LOAD
+#undef SBC_VEC_STORE
+#undef SBC_VEC_ADD
+#undef SBC_VEC_SUB
+#undef SBC_VEC_SRA
+#undef SBC_VEC_SHL
+#undef SBC_VEC_MULQ15
+
+static void __attribute__((target("avx2")))
+SbcAnalysisWindow4Avx2(const int16_t* x, int32_t* y, int32_t row) {
+  __m256i acc = _mm256_setzero_si256();
+  int32_t windowed[2 * SUB_BANDS_4];
+  int32_t j;
+
+  for (j = 0; j < 5; j++) {
+    __m256i samples = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i*)(x + 8 * j)));
+    __m256i coeffs =
+        _mm256_loadu_si256((const __m256i*)gas32AnalysisWindow4[j]);
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(samples, coeffs));
+  }
+  _mm256_storeu_si256((__m256i*)windowed, acc);
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_4, y, row);
+}
+
+static void __attribute__((target("avx2")))
+SbcAnalysisWindow8Avx2(const int16_t* x, int32_t* y, int32_t row) {
+  __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+  int32_t windowed[2 * SUB_BANDS_8];
+  int32_t j;
+
+  for (j = 0; j < 5; j++) {
+    __m256i lo = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i*)(x + 16 * j)));
+    __m256i hi = _mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i*)(x + 16 * j + 8)));
+    const __m256i* coeffs = (const __m256i*)gas32AnalysisWindow8[j];
+    acc0 = _mm256_add_epi32(
+        acc0, _mm256_madd_epi16(lo, _mm256_loadu_si256(coeffs)));
+    acc1 = _mm256_add_epi32(
+        acc1, _mm256_madd_epi16(hi, _mm256_loadu_si256(coeffs + 1)));
+  }
+  _mm256_storeu_si256((__m256i*)windowed, acc0);
+  _mm256_storeu_si256((__m256i*)(windowed + 8), acc1);
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_8, y, row);
+}
+
+static inline __m256i __attribute__((target("avx2")))
+SbcMulQ15Avx2(int32_t c, __m256i v) {
+  const __m256i coeff = _mm256_set1_epi32(c);
+  __m256i hi = _mm256_madd_epi16(_mm256_srai_epi32(v, 16), coeff);
+  __m256i lo = _mm256_or_si256(
+      _mm256_mullo_epi16(v, coeff),
+      _mm256_slli_epi32(_mm256_mulhi_epu16(v, coeff), 16));
+  return _mm256_add_epi32(_mm256_slli_epi32(hi, 1), _mm256_srli_epi32(lo, 15));
+}
+
+#define SBC_VEC __m256i
+#define SBC_VEC_LANES 8
+#define SBC_VEC_NAME(name) name##Avx2
+#define SBC_VEC_TARGET __attribute__((target("avx2")))
+#define SBC_VEC_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define SBC_VEC_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define SBC_VEC_ADD(a, b) _mm256_add_epi32(a, b)
+#define SBC_VEC_SUB(a, b) _mm256_sub_epi32(a, b)
+#define SBC_VEC_SRA(v, n) _mm256_srai_epi32(v, n)
+#define SBC_VEC_SHL(v, n) _mm256_slli_epi32(v, n)
+#define SBC_VEC_MULQ15(c, v) SbcMulQ15Avx2(c, v)
+#include "sbc_analysis_dct_template.h"
+#undef SBC_VEC
+#undef SBC_VEC_LANES
+#undef SBC_VEC_NAME
+#undef SBC_VEC_TARGET
+#undef SBC_VEC_LOAD
+#undef SBC_VEC_STORE
+#undef SBC_VEC_ADD
+#undef SBC_VEC_SUB
+#undef SBC_VEC_SRA
+#undef SBC_VEC_SHL
+#undef SBC_VEC_MULQ15
+
+static const tSBC_ANALYSIS_SIMD sbc_analysis_sse2 = {
+    SbcAnalysisWindow4Sse2, SbcAnalysisWindow8Sse2, SbcAnalysisDct4Sse2,
+    SbcAnalysisDct8Sse2};
+
+static const tSBC_ANALYSIS_SIMD sbc_analysis_avx2 = {
+    SbcAnalysisWindow4Avx2, SbcAnalysisWindow8Avx2, SbcAnalysisDct4Avx2,
+    SbcAnalysisDct8Avx2};
+
+#endif /* SBC_SIMD_X86 */
+
+#if defined(SBC_SIMD_NEON)
+
+static void SbcAnalysisWindow4Neon(const int16_t* x, int32_t* y,
+                                   int32_t row) {
+  int32x4_t acc0 = vdupq_n_s32(0), acc1 = vdupq_n_s32(0);
+  int32_t windowed[2 * SUB_BANDS_4];
+  int32_t j;
+
+  for (j = 0; j < 5; j++) {
+    int16x8_t samples = vld1q_s16(x + 8 * j);
+    int16x8_t coeffs = vld1q_s16(gas16AnalysisWindow4[j]);
+    acc0 = vmlal_s16(acc0, vget_low_s16(samples), vget_low_s16(coeffs));
+    acc1 = vmlal_s16(acc1, vget_high_s16(samples), vget_high_s16(coeffs));
+  }
+  vst1q_s32(windowed, acc0);
+  vst1q_s32(windowed + 4, acc1);
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_4, y, row);
+}
+
+static void SbcAnalysisWindow8Neon(const int16_t* x, int32_t* y,
+                                   int32_t row) {
+  int32x4_t acc[4];
+  int32_t windowed[2 * SUB_BANDS_8];
+  int32_t j, k;
+
+  for (k = 0; k < 4; k++) acc[k] = vdupq_n_s32(0);
+  for (j = 0; j < 5; j++) {
+    for (k = 0; k < 2; k++) {
+      int16x8_t samples = vld1q_s16(x + 16 * j + 8 * k);
+      int16x8_t coeffs = vld1q_s16(gas16AnalysisWindow8[j] + 8 * k);
+      acc[2 * k] = vmlal_s16(acc[2 * k], vget_low_s16(samples),
+                             vget_low_s16(coeffs));
+      acc[2 * k + 1] = vmlal_s16(acc[2 * k + 1], vget_high_s16(samples),
+                                 vget_high_s16(coeffs));
+    }
+  }
+  for (k = 0; k < 4; k++) vst1q_s32(windowed + 4 * k, acc[k]);
+  SbcStoreWindowed(windowed, 2 * SUB_BANDS_8, y, row);
+}
+
+/* The 64 bit products are exact and the shifted result fits in 32 bits */
+static inline int32x4_t SbcMulQ15Neon(int32_t c, int32x4_t v) {
+  const int32x2_t coeff = vdup_n_s32(c);
+  return vcombine_s32(vshrn_n_s64(vmull_s32(vget_low_s32(v), coeff), 15),
+                      vshrn_n_s64(vmull_s32(vget_high_s32(v), coeff), 15));
+}
+
+#define SBC_VEC int32x4_t
+#define SBC_VEC_LANES 4
+#define SBC_VEC_NAME(name) name##Neon
+#define SBC_VEC_TARGET
+#define SBC_VEC_LOAD(p) vld1q_s32(p)
+#define SBC_VEC_STORE(p, v) vst1q_s32(p, v)
+#define SBC_VEC_ADD(a, b) vaddq_s32(a, b)
+#define SBC_VEC_SUB(a, b) vsubq_s32(a, b)
+#define SBC_VEC_SRA(v, n) vshrq_n_s32(v, n)
+#define SBC_VEC_SHL(v, n) vshlq_n_s32(v, n)
+#define SBC_VEC_MULQ15(c, v) SbcMulQ15Neon(c, v)
+#include "sbc_analysis_dct_template.h"
+#undef SBC_VEC
+#undef SBC_VEC_LANES
+#undef SBC_VEC_NAME
+#undef SBC_VEC_TARGET
+#undef SBC_VEC_LOAD
+#undef SBC_VEC_STORE
+#undef SBC_VEC_ADD
+#undef SBC_VEC_SUB
+#undef SBC_VEC_SRA
+#undef SBC_VEC_SHL
+#undef SBC_VEC_MULQ15
+
+static const tSBC_ANALYSIS_SIMD sbc_analysis_neon = {
+    SbcAnalysisWindow4Neon, SbcAnalysisWindow8Neon, SbcAnalysisDct4Neon,
+    SbcAnalysisDct8Neon};
+
+#endif /* SBC_SIMD_NEON */
+
+const tSBC_ANALYSIS_SIMD* SbcAnalysisGetSimd(uint8_t impl) {
+  switch (impl) {
+#if defined(SBC_SIMD_X86)
+    case SBC_ANALYSIS_SSE2:
+      return __builtin_cpu_supports("sse2") ? &sbc_analysis_sse2 : NULL;
+    case SBC_ANALYSIS_AVX2:
+      return __builtin_cpu_supports("avx2") ? &sbc_analysis_avx2 : NULL;
+#endif
+#if defined(SBC_SIMD_NEON)
+    case SBC_ANALYSIS_NEON:
+      return &sbc_analysis_neon;
+#endif
+    default:
+      return NULL;
+  }
+}
@@ -24,17 +24,12 @@
 
 #include "sbc_encoder.h"
 
+#include <stddef.h>
+
 #include "sbc_enc_func_declare.h"
 
 #define abs32(x) (((x) >= 0) ? (x) : (-(x)))
 
-int16_t EncMaxShiftCounter;
-
-#if (SBC_JOINT_STE_INCLUDED == TRUE)
-int32_t s32LRDiff[SBC_MAX_NUM_OF_BLOCKS] = {0};
-int32_t s32LRSum[SBC_MAX_NUM_OF_BLOCKS] = {0};
-#endif
-
 uint32_t SBC_Encode(SBC_ENC_PARAMS* pstrEncParams, int16_t* input,
                     uint8_t* output) {
   int32_t s32Ch;                 /* counter for ch*/
@@ -50,6 +45,8 @@ uint32_t SBC_Encode(SBC_ENC_PARAMS* pstrEncParams, int16_t* input,
   int32_t s32MaxValue2;
   uint32_t u32CountSum, u32CountDiff;
   int32_t *pSum, *pDiff;
+  int32_t s32LRDiff[SBC_MAX_NUM_OF_BLOCKS];
+  int32_t s32LRSum[SBC_MAX_NUM_OF_BLOCKS];
 #endif
   register int32_t s32NumOfSubBands = pstrEncParams->s16NumOfSubBands;
 
@@ -245,15 +242,32 @@ void SBC_Encoder_Init(SBC_ENC_PARAMS* pstrEncParams) {
 
   if (pstrEncParams->s16NumOfSubBands == 4) {
     if (pstrEncParams->s16NumOfChannels == 1)
-      EncMaxShiftCounter = ((ENC_VX_BUFFER_SIZE - 4 * 10) >> 2) << 2;
+      pstrEncParams->s16MaxShiftCounter =
+          ((ENC_VX_BUFFER_SIZE - 4 * 10) >> 2) << 2;
     else
-      EncMaxShiftCounter = ((ENC_VX_BUFFER_SIZE - 4 * 10 * 2) >> 3) << 2;
+      pstrEncParams->s16MaxShiftCounter =
+          ((ENC_VX_BUFFER_SIZE - 4 * 10 * 2) >> 3) << 2;
   } else {
     if (pstrEncParams->s16NumOfChannels == 1)
-      EncMaxShiftCounter = ((ENC_VX_BUFFER_SIZE - 8 * 10) >> 3) << 3;
+      pstrEncParams->s16MaxShiftCounter =
+          ((ENC_VX_BUFFER_SIZE - 8 * 10) >> 3) << 3;
     else
-      EncMaxShiftCounter = ((ENC_VX_BUFFER_SIZE - 8 * 10 * 2) >> 4) << 3;
+      pstrEncParams->s16MaxShiftCounter =
+          ((ENC_VX_BUFFER_SIZE - 8 * 10 * 2) >> 4) << 3;
   }
 
-  SbcAnalysisInit();
+  pstrEncParams->AnalysisImpl = SBC_ANALYSIS_SCALAR;
+  if (!SBC_Encoder_SetAnalysis(pstrEncParams, SBC_ANALYSIS_AVX2) &&
+      !SBC_Encoder_SetAnalysis(pstrEncParams, SBC_ANALYSIS_SSE2)) {
+    SBC_Encoder_SetAnalysis(pstrEncParams, SBC_ANALYSIS_NEON);
+  }
+
+  SbcAnalysisInit(pstrEncParams);
+}
+
+bool SBC_Encoder_SetAnalysis(SBC_ENC_PARAMS* pstrEncParams, uint8_t impl) {
+  if (impl != SBC_ANALYSIS_SCALAR && SbcAnalysisGetSimd(impl) == NULL)
+    return false;
+  pstrEncParams->AnalysisImpl = impl;
+  return true;
 }
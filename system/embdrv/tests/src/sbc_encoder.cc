@@ -0,0 +1,184 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "sbc_encoder.h"
+
+namespace {
+
+constexpr int kNumFrames = 64;
+constexpr size_t kMaxFrameSize = 1024;
+
+struct EncoderConfig {
+  int16_t sampling_freq;
+  int16_t channel_mode;
+  int16_t num_subbands;
+  int16_t num_blocks;
+  int16_t allocation_method;
+  uint16_t bit_rate;
+};
+
+void InitEncoder(SBC_ENC_PARAMS* params, const EncoderConfig& config) {
+  memset(params, 0, sizeof(*params));
+  params->s16SamplingFreq = config.sampling_freq;
+  params->s16ChannelMode = config.channel_mode;
+  params->s16NumOfSubBands = config.num_subbands;
+  params->s16NumOfBlocks = config.num_blocks;
+  params->s16AllocationMethod = config.allocation_method;
+  params->u16BitRate = config.bit_rate;
+  params->Format = SBC_FORMAT_GENERAL;
+  SBC_Encoder_Init(params);
+}
+
+// Mix of full scale noise, a loud sine and silence, to exercise both the
+// saturation of the windowing and small subband values
+std::vector<int16_t> MakePcm(size_t num_samples, int num_channels,
+                             uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> noise(INT16_MIN, INT16_MAX);
+  std::vector<int16_t> pcm(num_samples);
+  for (size_t i = 0; i < num_samples; i++) {
+    size_t frame = i / num_channels;
+    switch ((frame / 512) % 3) {
+      case 0:
+        pcm[i] = noise(generator);
+        break;
+      case 1:
+        pcm[i] = 32767 * std::sin(frame * 0.05 * (1 + i % num_channels));
+        break;
+      default:
+        pcm[i] = 0;
+        break;
+    }
+  }
+  return pcm;
+}
+
+size_t SamplesPerFrame(const SBC_ENC_PARAMS& params) {
+  return params.s16NumOfBlocks * params.s16NumOfSubBands *
+         params.s16NumOfChannels;
+}
+
+class SbcEncoderAnalysisTest : public ::testing::TestWithParam<EncoderConfig> {
+ protected:
+  // Encode the same input with the scalar filter and with |impl|, and check
+  // that the subband samples and the frames are identical
+  void ExpectBitExact(uint8_t impl) {
+    SBC_ENC_PARAMS scalar, simd;
+    InitEncoder(&scalar, GetParam());
+    InitEncoder(&simd, GetParam());
+    ASSERT_TRUE(SBC_Encoder_SetAnalysis(&scalar, SBC_ANALYSIS_SCALAR));
+    if (!SBC_Encoder_SetAnalysis(&simd, impl)) {
+      GTEST_SKIP() << "Analysis " << int{impl} << " is not supported";
+    }
+
+    size_t frame_samples = SamplesPerFrame(scalar);
+    std::vector<int16_t> pcm = MakePcm(
+        frame_samples * kNumFrames, scalar.s16NumOfChannels, impl);
+    for (int frame = 0; frame < kNumFrames; frame++) {
+      uint8_t scalar_frame[kMaxFrameSize] = {};
+      uint8_t simd_frame[kMaxFrameSize] = {};
+      int16_t* input = pcm.data() + frame * frame_samples;
+      uint32_t scalar_size = SBC_Encode(&scalar, input, scalar_frame);
+      uint32_t simd_size = SBC_Encode(&simd, input, simd_frame);
+
+      ASSERT_EQ(0, memcmp(scalar.s32SbBuffer, simd.s32SbBuffer,
+                          sizeof(int32_t) * frame_samples))
+          << "frame " << frame;
+      ASSERT_EQ(scalar_size, simd_size);
+      ASSERT_EQ(0, memcmp(scalar_frame, simd_frame, scalar_size))
+          << "frame " << frame;
+    }
+  }
+};
+
+TEST_P(SbcEncoderAnalysisTest, sse2_matches_scalar) {
+  ExpectBitExact(SBC_ANALYSIS_SSE2);
+}
+
+TEST_P(SbcEncoderAnalysisTest, avx2_matches_scalar) {
+  ExpectBitExact(SBC_ANALYSIS_AVX2);
+}
+
+TEST_P(SbcEncoderAnalysisTest, neon_matches_scalar) {
+  ExpectBitExact(SBC_ANALYSIS_NEON);
+}
+
+// The encoder keeps no global state: interleaving two streams must give the
+// same frames as encoding each of them alone
+TEST_P(SbcEncoderAnalysisTest, interleaved_encoders_are_independent) {
+  SBC_ENC_PARAMS alone, first, second;
+  InitEncoder(&alone, GetParam());
+  InitEncoder(&first, GetParam());
+  InitEncoder(&second, GetParam());
+
+  size_t frame_samples = SamplesPerFrame(alone);
+  std::vector<int16_t> pcm =
+      MakePcm(frame_samples * kNumFrames, alone.s16NumOfChannels, 1);
+  std::vector<int16_t> other =
+      MakePcm(frame_samples * kNumFrames, alone.s16NumOfChannels, 2);
+  for (int frame = 0; frame < kNumFrames; frame++) {
+    uint8_t expected[kMaxFrameSize] = {};
+    uint8_t actual[kMaxFrameSize] = {};
+    uint8_t unused[kMaxFrameSize];
+    uint32_t expected_size =
+        SBC_Encode(&alone, pcm.data() + frame * frame_samples, expected);
+    SBC_Encode(&second, other.data() + frame * frame_samples, unused);
+    uint32_t actual_size =
+        SBC_Encode(&first, pcm.data() + frame * frame_samples, actual);
+
+    ASSERT_EQ(expected_size, actual_size);
+    ASSERT_EQ(0, memcmp(expected, actual, expected_size)) << "frame " << frame;
+  }
+}
+
+TEST(SbcEncoderAnalysisSelectionTest, scalar_is_always_supported) {
+  SBC_ENC_PARAMS params;
+  InitEncoder(&params, {SBC_sf44100, SBC_JOINT_STEREO, 8, 16, SBC_LOUDNESS,
+                        328});
+  EXPECT_TRUE(SBC_Encoder_SetAnalysis(&params, SBC_ANALYSIS_SCALAR));
+  EXPECT_EQ(params.AnalysisImpl, SBC_ANALYSIS_SCALAR);
+}
+
+TEST(SbcEncoderAnalysisSelectionTest, unsupported_keeps_selection) {
+  SBC_ENC_PARAMS params;
+  InitEncoder(&params, {SBC_sf44100, SBC_JOINT_STEREO, 8, 16, SBC_LOUDNESS,
+                        328});
+  uint8_t selected = params.AnalysisImpl;
+  EXPECT_FALSE(SBC_Encoder_SetAnalysis(&params, 0xff));
+  EXPECT_EQ(params.AnalysisImpl, selected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SbcEncoderAnalysis, SbcEncoderAnalysisTest,
+    ::testing::Values(
+        EncoderConfig{SBC_sf44100, SBC_JOINT_STEREO, 8, 16, SBC_LOUDNESS, 328},
+        EncoderConfig{SBC_sf48000, SBC_STEREO, 8, 16, SBC_SNR, 345},
+        EncoderConfig{SBC_sf48000, SBC_DUAL, 8, 12, SBC_LOUDNESS, 345},
+        EncoderConfig{SBC_sf44100, SBC_MONO, 8, 8, SBC_LOUDNESS, 200},
+        EncoderConfig{SBC_sf32000, SBC_JOINT_STEREO, 4, 16, SBC_LOUDNESS, 240},
+        EncoderConfig{SBC_sf44100, SBC_STEREO, 4, 4, SBC_SNR, 200},
+        EncoderConfig{SBC_sf16000, SBC_MONO, 4, 12, SBC_LOUDNESS, 64},
+        EncoderConfig{SBC_sf16000, SBC_MONO, 8, 15, SBC_LOUDNESS, 60}));
+
+}  // namespace
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "sbc_encoder.h"
+
+using ::benchmark::State;
+
+static constexpr int kNumFrames = 256;
+
+// Encode a stream of A2DP frames (44.1 kHz, joint stereo, 8 subbands, 16
+// blocks, bitpool 53) with the analysis filter |impl|, and report frames/sec
+static void BM_SbcEncode(State& state, uint8_t impl, int16_t num_subbands) {
+  SBC_ENC_PARAMS params;
+  memset(&params, 0, sizeof(params));
+  params.s16SamplingFreq = SBC_sf44100;
+  params.s16ChannelMode = SBC_JOINT_STEREO;
+  params.s16NumOfSubBands = num_subbands;
+  params.s16NumOfBlocks = 16;
+  params.s16AllocationMethod = SBC_LOUDNESS;
+  params.u16BitRate = 328;
+  params.Format = SBC_FORMAT_GENERAL;
+  SBC_Encoder_Init(&params);
+  if (!SBC_Encoder_SetAnalysis(&params, impl)) {
+    state.SkipWithError("Analysis filter not supported");
+    return;
+  }
+
+  size_t frame_samples = params.s16NumOfBlocks * params.s16NumOfSubBands *
+                         params.s16NumOfChannels;
+  std::vector<int16_t> pcm(frame_samples * kNumFrames);
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> noise(INT16_MIN, INT16_MAX);
+  for (int16_t& sample : pcm) sample = noise(generator);
+
+  uint8_t output[1024];
+  int frame = 0;
+  for (auto _ : state) {
+    SBC_Encode(&params, pcm.data() + frame * frame_samples, output);
+    benchmark::DoNotOptimize(output);
+    frame = (frame + 1) % kNumFrames;
+  }
+  state.counters["frames_per_sec"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_CAPTURE(BM_SbcEncode, scalar_8_subbands, SBC_ANALYSIS_SCALAR, 8);
+BENCHMARK_CAPTURE(BM_SbcEncode, sse2_8_subbands, SBC_ANALYSIS_SSE2, 8);
+BENCHMARK_CAPTURE(BM_SbcEncode, avx2_8_subbands, SBC_ANALYSIS_AVX2, 8);
+BENCHMARK_CAPTURE(BM_SbcEncode, neon_8_subbands, SBC_ANALYSIS_NEON, 8);
+BENCHMARK_CAPTURE(BM_SbcEncode, scalar_4_subbands, SBC_ANALYSIS_SCALAR, 4);
+BENCHMARK_CAPTURE(BM_SbcEncode, sse2_4_subbands, SBC_ANALYSIS_SSE2, 4);
+BENCHMARK_CAPTURE(BM_SbcEncode, avx2_4_subbands, SBC_ANALYSIS_AVX2, 4);
+BENCHMARK_CAPTURE(BM_SbcEncode, neon_4_subbands, SBC_ANALYSIS_NEON, 4);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
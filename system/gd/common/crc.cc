@@ -0,0 +1,189 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/crc.h"
+
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC_HAS_CLMUL 1
+#else
+#define CRC_HAS_CLMUL 0
+#endif
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+// x^16 + x^15 + x^2 + 1, bit reversed with the x^16 term implied
+constexpr uint16_t kCrc16ReflectedPolynomial = 0xa001;
+// x^8 + x^2 + x + 1, bit reversed with the x^8 term implied
+constexpr uint8_t kCrc8ReflectedPolynomial = 0xe0;
+
+constexpr size_t kSliceCount = 8;
+using Crc16Tables = std::array<std::array<uint16_t, 256>, kSliceCount>;
+
+// tables[0][b] is the CRC of byte b; tables[k][b] is the CRC of byte b followed by k zero bytes.
+constexpr Crc16Tables MakeCrc16Tables() {
+  Crc16Tables tables{};
+  for (uint32_t b = 0; b < 256; b++) {
+    uint16_t crc = b;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ kCrc16ReflectedPolynomial : (crc >> 1);
+    }
+    tables[0][b] = crc;
+  }
+  for (size_t k = 1; k < kSliceCount; k++) {
+    for (size_t b = 0; b < 256; b++) {
+      uint16_t prev = tables[k - 1][b];
+      tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xff];
+    }
+  }
+  return tables;
+}
+
+constexpr std::array<uint8_t, 256> MakeCrc8Table() {
+  std::array<uint8_t, 256> table{};
+  for (uint32_t b = 0; b < 256; b++) {
+    uint8_t crc = b;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ kCrc8ReflectedPolynomial : (crc >> 1);
+    }
+    table[b] = crc;
+  }
+  return table;
+}
+
+constexpr Crc16Tables kCrc16Tables = MakeCrc16Tables();
+constexpr std::array<uint8_t, 256> kCrc8Table = MakeCrc8Table();
+
+#if CRC_HAS_CLMUL
+
+// x^n mod P for the CRC-16 generator, in natural bit order (bit d is the coefficient of x^d)
+constexpr uint64_t Crc16XPowMod(unsigned n) {
+  constexpr uint32_t kPolynomial = 0x18005;
+  uint32_t value = 1;
+  for (unsigned i = 0; i < n; i++) {
+    value <<= 1;
+    if (value & 0x10000) value ^= kPolynomial;
+  }
+  return value;
+}
+
+// Map a polynomial of degree < 64 to the 64 bit lane of a reflected CRC, where bit j holds the coefficient of x^(63-j)
+constexpr uint64_t Reflect64(uint64_t value) {
+  uint64_t reflected = 0;
+  for (int bit = 0; bit < 64; bit++) {
+    if (value & (uint64_t{1} << bit)) reflected |= uint64_t{1} << (63 - bit);
+  }
+  return reflected;
+}
+
+// Folding a 16 byte block A = A_hi * x^64 + A_lo across the next 128 bits multiplies A_hi by x^192 and A_lo by x^128.
+// A carry-less product of two reflected lanes ends up one degree short in the 128 bit lane, hence x^191 and x^127.
+constexpr uint64_t kFoldHi = Reflect64(Crc16XPowMod(191));
+constexpr uint64_t kFoldLo = Reflect64(Crc16XPowMod(127));
+
+constexpr size_t kClmulBlockSize = 16;
+constexpr size_t kClmulMinLength = 2 * kClmulBlockSize;
+
+__attribute__((target("pclmul,sse2"))) uint16_t Crc16ClmulFold(uint16_t crc, const uint8_t* data, size_t length) {
+  const __m128i fold_constants = _mm_set_epi64x(kFoldLo, kFoldHi);
+
+  // The initial CRC is equivalent to XOR-ing it into the first two bytes of the message
+  __m128i accumulator = _mm_xor_si128(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), _mm_cvtsi32_si128(crc));
+  data += kClmulBlockSize;
+  length -= kClmulBlockSize;
+
+  while (length >= kClmulBlockSize) {
+    __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i hi = _mm_clmulepi64_si128(accumulator, fold_constants, 0x00);
+    __m128i lo = _mm_clmulepi64_si128(accumulator, fold_constants, 0x11);
+    accumulator = _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+    data += kClmulBlockSize;
+    length -= kClmulBlockSize;
+  }
+
+  // The accumulator is congruent to everything consumed so far; reduce it with the tables, then finish the tail
+  uint8_t folded[kClmulBlockSize];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), accumulator);
+  crc = crc::Crc16SliceBy8(0, folded, sizeof(folded));
+  return crc::Crc16SliceBy8(crc, data, length);
+}
+
+#endif  // CRC_HAS_CLMUL
+
+}  // namespace
+
+namespace crc {
+
+const std::array<uint16_t, 256> kCrc16ByteTable = kCrc16Tables[0];
+
+uint16_t Crc16Bytewise(uint16_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc = Crc16Byte(crc, data[i]);
+  }
+  return crc;
+}
+
+uint16_t Crc16SliceBy8(uint16_t crc, const uint8_t* data, size_t length) {
+  while (length >= kSliceCount) {
+    // The CRC register overlaps the first two bytes of every 8 byte slice
+    crc = kCrc16Tables[7][(data[0] ^ crc) & 0xff] ^ kCrc16Tables[6][(data[1] ^ (crc >> 8)) & 0xff] ^
+          kCrc16Tables[5][data[2]] ^ kCrc16Tables[4][data[3]] ^ kCrc16Tables[3][data[4]] ^
+          kCrc16Tables[2][data[5]] ^ kCrc16Tables[1][data[6]] ^ kCrc16Tables[0][data[7]];
+    data += kSliceCount;
+    length -= kSliceCount;
+  }
+  return Crc16Bytewise(crc, data, length);
+}
+
+bool Crc16ClmulSupported() {
+#if CRC_HAS_CLMUL
+  static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+uint16_t Crc16Clmul(uint16_t crc, const uint8_t* data, size_t length) {
+#if CRC_HAS_CLMUL
+  if (length >= kClmulMinLength) {
+    return Crc16ClmulFold(crc, data, length);
+  }
+#endif
+  return Crc16SliceBy8(crc, data, length);
+}
+
+}  // namespace crc
+
+uint16_t Crc16(uint16_t crc, const uint8_t* data, size_t length) {
+  static const auto implementation = crc::Crc16ClmulSupported() ? crc::Crc16Clmul : crc::Crc16SliceBy8;
+  return implementation(crc, data, length);
+}
+
+uint8_t Crc8(uint8_t crc, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc = kCrc8Table[crc ^ data[i]];
+  }
+  return crc;
+}
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace bluetooth {
+namespace common {
+
+// CRC-16 of the L2CAP Frame Check Sequence (Core Vol 3, Part A, 3.3.5): generator polynomial x^16 + x^15 + x^2 + 1,
+// bits processed least significant first, no final XOR. Continues the computation from |crc|, so a PDU may be fed in
+// several pieces. Uses the fastest implementation supported by the CPU.
+uint16_t Crc16(uint16_t crc, const uint8_t* data, size_t length);
+
+// CRC-8 of the RFCOMM Frame Check Sequence (TS 07.10, 5.2.1.6): generator polynomial x^8 + x^2 + x + 1, bits
+// processed least significant first. Continues the computation from |crc|; the caller applies the ones complement.
+uint8_t Crc8(uint8_t crc, const uint8_t* data, size_t length);
+
+namespace crc {
+
+// CRC-16 of each byte value, the table behind Crc16Byte()
+extern const std::array<uint16_t, 256> kCrc16ByteTable;
+
+}  // namespace crc
+
+// One byte step of Crc16(), inline for callers that can only feed a PDU one byte at a time.
+inline uint16_t Crc16Byte(uint16_t crc, uint8_t byte) {
+  return (crc >> 8) ^ crc::kCrc16ByteTable[(crc ^ byte) & 0xff];
+}
+
+namespace crc {
+
+// The individual CRC-16 implementations behind Crc16(), exposed for tests and benchmarks. All of them produce the
+// same result for the same input.
+uint16_t Crc16Bytewise(uint16_t crc, const uint8_t* data, size_t length);
+uint16_t Crc16SliceBy8(uint16_t crc, const uint8_t* data, size_t length);
+
+// Carry-less multiplication folding (x86 PCLMULQDQ). Must only be called when Crc16ClmulSupported() returns true.
+bool Crc16ClmulSupported();
+uint16_t Crc16Clmul(uint16_t crc, const uint8_t* data, size_t length);
+
+}  // namespace crc
+}  // namespace common
+}  // namespace bluetooth
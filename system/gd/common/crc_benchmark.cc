@@ -0,0 +1,57 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/crc.h"
+
+using ::benchmark::State;
+using ::bluetooth::common::crc::Crc16Bytewise;
+using ::bluetooth::common::crc::Crc16Clmul;
+using ::bluetooth::common::crc::Crc16ClmulSupported;
+using ::bluetooth::common::crc::Crc16SliceBy8;
+
+namespace {
+
+template <uint16_t (*Crc16Function)(uint16_t, const uint8_t*, size_t)>
+void BM_Crc16(State& state) {
+  std::vector<uint8_t> pdu(state.range(0));
+  for (size_t i = 0; i < pdu.size(); i++) {
+    pdu[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Crc16Function(0, pdu.data(), pdu.size()));
+  }
+  // Reported as bytes_per_second, i.e. the throughput of each implementation
+  state.SetBytesProcessed(state.iterations() * pdu.size());
+}
+
+void BM_Crc16Clmul(State& state) {
+  if (!Crc16ClmulSupported()) {
+    state.SkipWithError("PCLMULQDQ is not supported on this CPU");
+    return;
+  }
+  BM_Crc16<Crc16Clmul>(state);
+}
+
+}  // namespace
+
+// From the smallest S-frame up to the largest BR/EDR ERTM MPS
+BENCHMARK_TEMPLATE(BM_Crc16, Crc16Bytewise)->RangeMultiplier(4)->Range(8, 65536);
+BENCHMARK_TEMPLATE(BM_Crc16, Crc16SliceBy8)->RangeMultiplier(4)->Range(8, 65536);
+BENCHMARK(BM_Crc16Clmul)->RangeMultiplier(4)->Range(8, 65536);
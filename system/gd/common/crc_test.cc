@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/crc.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+// I-frame from the L2CAP spec (Core Vol 3, Part A, 3.3.5) with its FCS of 0x6138
+const std::vector<uint8_t> kL2capIFrame = {0x0e, 0x00, 0x40, 0x00, 0x02, 0x00, 0x00, 0x01, 0x02,
+                                           0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+constexpr uint16_t kL2capIFrameFcs = 0x6138;
+
+// RR S-frame from the same section with its FCS of 0x14d4
+const std::vector<uint8_t> kL2capSFrame = {0x04, 0x00, 0x40, 0x00, 0x01, 0x01};
+constexpr uint16_t kL2capSFrameFcs = 0x14d4;
+
+std::vector<uint8_t> RandomBytes(size_t length) {
+  std::mt19937 generator(length);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> bytes(length);
+  for (auto& byte : bytes) {
+    byte = distribution(generator);
+  }
+  return bytes;
+}
+
+TEST(CrcTest, crc16_l2cap_spec_examples) {
+  EXPECT_EQ(Crc16(0, kL2capIFrame.data(), kL2capIFrame.size()), kL2capIFrameFcs);
+  EXPECT_EQ(Crc16(0, kL2capSFrame.data(), kL2capSFrame.size()), kL2capSFrameFcs);
+  EXPECT_EQ(crc::Crc16Bytewise(0, kL2capIFrame.data(), kL2capIFrame.size()), kL2capIFrameFcs);
+  EXPECT_EQ(crc::Crc16SliceBy8(0, kL2capIFrame.data(), kL2capIFrame.size()), kL2capIFrameFcs);
+}
+
+TEST(CrcTest, crc16_implementations_match_bytewise) {
+  for (size_t length = 0; length < 600; length++) {
+    auto bytes = RandomBytes(length);
+    for (uint16_t initial : {0x0000, 0xffff, 0x1234}) {
+      uint16_t expected = crc::Crc16Bytewise(initial, bytes.data(), bytes.size());
+      EXPECT_EQ(crc::Crc16SliceBy8(initial, bytes.data(), bytes.size()), expected) << "length " << length;
+      if (crc::Crc16ClmulSupported()) {
+        EXPECT_EQ(crc::Crc16Clmul(initial, bytes.data(), bytes.size()), expected) << "length " << length;
+      }
+      EXPECT_EQ(Crc16(initial, bytes.data(), bytes.size()), expected) << "length " << length;
+    }
+  }
+}
+
+TEST(CrcTest, crc16_incremental) {
+  auto bytes = RandomBytes(1021);
+  uint16_t expected = crc::Crc16Bytewise(0, bytes.data(), bytes.size());
+  for (size_t split : {1, 7, 16, 33, 500, 1020}) {
+    uint16_t crc = Crc16(0, bytes.data(), split);
+    crc = Crc16(crc, bytes.data() + split, bytes.size() - split);
+    EXPECT_EQ(crc, expected) << "split " << split;
+  }
+}
+
+TEST(CrcTest, crc8_rfcomm) {
+  // SABM on DLCI 0: address 0x03, control 0x3f, length 0x01, FCS 0x1c
+  const uint8_t sabm[] = {0x03, 0x3f, 0x01};
+  uint8_t fcs = 0xff - Crc8(0xff, sabm, sizeof(sabm));
+  EXPECT_EQ(fcs, 0x1c);
+  // Running the received FCS through the CRC leaves the fixed remainder
+  EXPECT_EQ(Crc8(Crc8(0xff, sabm, sizeof(sabm)), &fcs, 1), 0xcf);
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
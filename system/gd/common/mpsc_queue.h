@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace bluetooth {
+namespace common {
+
+// Unbounded lock-free multi-producer/single-consumer FIFO queue.
+// push() may be called concurrently from any number of threads and never blocks. try_pop() and empty() must only be
+// called from a single consumer thread at a time. A push() that is still in flight may be briefly invisible to the
+// consumer, so callers that need a wakeup must signal the consumer after push() returns.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    while (tail_ != nullptr) {
+      Node* next = tail_->next_.load(std::memory_order_relaxed);
+      delete tail_;
+      tail_ = next;
+    }
+  }
+
+  void push(T data) {
+    Node* node = new Node(std::move(data));
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next_.store(node, std::memory_order_release);
+  }
+
+  // Move the oldest element into |data| and return true, or return false if no element is visible yet
+  bool try_pop(T* data) {
+    Node* next = tail_->next_.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *data = std::move(next->data_);
+    // |next| becomes the new stub node; its data has already been moved out
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+  bool empty() const {
+    return tail_->next_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T data) : data_(std::move(data)) {}
+    std::atomic<Node*> next_{nullptr};
+    T data_{};
+  };
+
+  // Producers append at |head_|, the consumer removes from |tail_|, which always points to a stub node
+  std::atomic<Node*> head_;
+  Node* tail_;
+};
+
+}  // namespace common
+}  // namespace bluetooth
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace common {
+namespace {
+
+TEST(MpscQueueTest, initial_empty) {
+  MpscQueue<int> queue;
+  int data = 0;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.try_pop(&data));
+}
+
+TEST(MpscQueueTest, same_thread_fifo) {
+  MpscQueue<int> queue;
+  for (int i = 0; i < 10; i++) {
+    queue.push(i);
+  }
+  EXPECT_FALSE(queue.empty());
+  for (int i = 0; i < 10; i++) {
+    int data = -1;
+    EXPECT_TRUE(queue.try_pop(&data));
+    EXPECT_EQ(data, i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueueTest, move_only_type) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.push(std::make_unique<int>(42));
+  std::unique_ptr<int> data;
+  EXPECT_TRUE(queue.try_pop(&data));
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(*data, 42);
+}
+
+TEST(MpscQueueTest, pending_elements_released_on_destruction) {
+  auto shared = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.push(shared);
+    queue.push(shared);
+    EXPECT_EQ(shared.use_count(), 3);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(MpscQueueTest, multiple_producers_keep_per_producer_order) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumPerProducer = 10000;
+  MpscQueue<std::pair<int, int>> queue;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kNumPerProducer; i++) {
+        queue.push({p, i});
+      }
+    });
+  }
+
+  std::vector<int> next_expected(kNumProducers, 0);
+  int received = 0;
+  while (received < kNumProducers * kNumPerProducer) {
+    std::pair<int, int> data;
+    if (!queue.try_pop(&data)) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(data.second, next_expected[data.first]);
+    next_expected[data.first] = data.second + 1;
+    received++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace common
+}  // namespace bluetooth
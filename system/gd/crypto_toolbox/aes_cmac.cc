@@ -29,6 +29,7 @@
 
 #include "aes.h"
 #include "crypto_toolbox.h"
+#include "crypto_toolbox/aes_kernels.h"
 #include "hci/octets.h"
 
 using bluetooth::hci::kOctet16Length;
@@ -62,6 +63,8 @@ static void xor_128(Octet16* a, const Octet16& b) {
 }
 }  // namespace
 
+namespace table {
+
 /* This function computes AES_128(key, message) */
 Octet16 aes_128(const Octet16& key, const Octet16& message) {
   Octet16 key_reversed;
@@ -79,6 +82,8 @@ Octet16 aes_128(const Octet16& key, const Octet16& message) {
   return output;
 }
 
+}  // namespace table
+
 /** utility function to padding the given text to be a 128 bits data. The
  * parameter dest is input and output parameter, it must point to a
  * kOctet16Length memory space; where include length bytes valid data. */
@@ -110,7 +115,7 @@ static Octet16 cmac_aes_k_calculate(const Octet16& key) {
     /* Mi' := Mi (+) X  */
     xor_128((Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length], x);
 
-    output = aes_128(key, *(Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length]);
+    output = table::aes_128(key, *(Octet16*)&cmac_cb.text[(cmac_cb.round - i) * kOctet16Length]);
     x = output;
     i++;
   }
@@ -143,7 +148,7 @@ static void cmac_prepare_last_block(const Octet16& k1, const Octet16& k2) {
  */
 static void cmac_generate_subkey(const Octet16& key) {
   Octet16 zero{};
-  Octet16 p = aes_128(key, zero);
+  Octet16 p = table::aes_128(key, zero);
 
   Octet16 k1, k2;
   uint8_t* pp = p.data();
@@ -169,6 +174,8 @@ static void cmac_generate_subkey(const Octet16& key) {
   cmac_prepare_last_block(k1, k2);
 }
 
+namespace table {
+
 /** key - CMAC key in little endian order
  *  input - text to be signed in little endian byte order.
  *  length - length of the input in byte.
@@ -208,4 +215,46 @@ Octet16 aes_cmac(const Octet16& key, const uint8_t* input, uint16_t length) {
   return signature;
 }
 
+}  // namespace table
+
+/* The AES instructions work in the byte order of FIPS-197, the reverse of the
+ * little endian order used here */
+Octet16 aes_128(const Octet16& key, const Octet16& message) {
+  if (!aes_kernels::HardwareSupported()) {
+    return table::aes_128(key, message);
+  }
+
+  uint8_t key_reversed[kOctet16Length];
+  uint8_t message_reversed[kOctet16Length];
+  uint8_t output[kOctet16Length];
+  std::reverse_copy(key.begin(), key.end(), key_reversed);
+  std::reverse_copy(message.begin(), message.end(), message_reversed);
+
+  aes_kernels::HardwareEncryptBlock(key_reversed, message_reversed, output);
+
+  Octet16 result;
+  std::reverse_copy(output, output + kOctet16Length, result.begin());
+  return result;
+}
+
+Octet16 aes_cmac(const Octet16& key, const uint8_t* input, uint16_t length) {
+  if (!aes_kernels::HardwareSupported()) {
+    return table::aes_cmac(key, input, length);
+  }
+  if (input == NULL) length = 0;
+
+  /* The whole message is little endian, so its first block is at the end */
+  uint8_t key_reversed[kOctet16Length];
+  uint8_t* message = (length > 0) ? (uint8_t*)alloca(length) : NULL;
+  uint8_t mac[kOctet16Length];
+  std::reverse_copy(key.begin(), key.end(), key_reversed);
+  if (length > 0) std::reverse_copy(input, input + length, message);
+
+  aes_kernels::HardwareCmac(key_reversed, message, length, mac);
+
+  Octet16 signature;
+  std::reverse_copy(mac, mac + kOctet16Length, signature.begin());
+  return signature;
+}
+
 }  // namespace crypto_toolbox
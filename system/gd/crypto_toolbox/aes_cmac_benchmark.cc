@@ -0,0 +1,68 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "crypto_toolbox/aes_kernels.h"
+#include "crypto_toolbox/crypto_toolbox.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::Octet16;
+
+namespace {
+
+const Octet16 kKey{0x3c, 0x4f, 0xcf, 0x09, 0x88, 0x15, 0xf7, 0xab, 0xa6, 0xd2, 0xae, 0x28, 0x16, 0x15, 0x7e, 0x2b};
+
+template <Octet16 (*AesCmacFunction)(const Octet16&, const uint8_t*, uint16_t)>
+void BM_AesCmac(State& state) {
+  if (AesCmacFunction != crypto_toolbox::table::aes_cmac && !crypto_toolbox::aes_kernels::HardwareSupported()) {
+    state.SkipWithError("AES instructions are not supported on this CPU");
+    return;
+  }
+  std::vector<uint8_t> message(state.range(0));
+  for (size_t i = 0; i < message.size(); i++) {
+    message[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(AesCmacFunction(kKey, message.data(), message.size()));
+  }
+  // Reported as bytes_per_second, i.e. the throughput of each implementation
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+
+template <Octet16 (*Aes128Function)(const Octet16&, const Octet16&)>
+void BM_Aes128(State& state) {
+  if (Aes128Function != crypto_toolbox::table::aes_128 && !crypto_toolbox::aes_kernels::HardwareSupported()) {
+    state.SkipWithError("AES instructions are not supported on this CPU");
+    return;
+  }
+  Octet16 message{};
+  for (auto _ : state) {
+    message = Aes128Function(kKey, message);
+  }
+  benchmark::DoNotOptimize(message);
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+
+}  // namespace
+
+// From h6() and the 65 byte message of f4() up to a large encrypted advertising or GATT database hash message
+BENCHMARK_TEMPLATE(BM_AesCmac, crypto_toolbox::table::aes_cmac)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_AesCmac, crypto_toolbox::aes_cmac)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_Aes128, crypto_toolbox::table::aes_128);
+BENCHMARK_TEMPLATE(BM_Aes128, crypto_toolbox::aes_128);
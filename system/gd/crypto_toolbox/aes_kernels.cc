@@ -0,0 +1,670 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/aes_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AES_KERNELS_HAVE_AESNI 1
+#else
+#define AES_KERNELS_HAVE_AESNI 0
+#endif
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_AES
+#define HWCAP_AES (1 << 3)
+#endif
+#define AES_KERNELS_HAVE_ARMV8_CE 1
+#else
+#define AES_KERNELS_HAVE_ARMV8_CE 0
+#endif
+
+namespace crypto_toolbox {
+namespace aes_kernels {
+namespace {
+
+// Bit 16 * lane + i of a plane is byte i of that lane, where i = 4 * column + row is the FIPS-197 order of the bytes
+// of the state. All the masks below are given for one lane and repeated for the others.
+using Planes = std::array<uint64_t, 8>;
+
+constexpr uint64_t Lanes(uint16_t mask) {
+  return mask * 0x0001000100010001ull;
+}
+
+constexpr uint64_t kLaneMask = 0xffff;
+
+uint64_t LoadLittleEndian64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+void StoreLittleEndian64(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    p[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+}
+
+// Transpose of the 8x8 bit matrix whose rows are the bytes of |x|: bit j of byte k moves to bit k of byte j
+uint64_t Transpose8x8(uint64_t x) {
+  uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+Planes Pack(const uint8_t in[kLanes][kBlockSize]) {
+  Planes planes{};
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    uint64_t low = Transpose8x8(LoadLittleEndian64(in[lane]));
+    uint64_t high = Transpose8x8(LoadLittleEndian64(in[lane] + 8));
+    for (size_t bit = 0; bit < 8; bit++) {
+      uint64_t bytes = ((low >> (8 * bit)) & 0xff) | (((high >> (8 * bit)) & 0xff) << 8);
+      planes[bit] |= bytes << (16 * lane);
+    }
+  }
+  return planes;
+}
+
+void Unpack(const Planes& planes, uint8_t out[kLanes][kBlockSize]) {
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (size_t bit = 0; bit < 8; bit++) {
+      uint64_t bytes = (planes[bit] >> (16 * lane)) & kLaneMask;
+      low |= (bytes & 0xff) << (8 * bit);
+      high |= (bytes >> 8) << (8 * bit);
+    }
+    StoreLittleEndian64(out[lane], Transpose8x8(low));
+    StoreLittleEndian64(out[lane] + 8, Transpose8x8(high));
+  }
+}
+
+// The S-box circuit of Boyar and Peralta ("A depth-16 circuit for the AES S-box", 2011): 113 logic gates instead of
+// a table lookup, so that the memory accesses are independent of the key and the data. x0 is the most significant
+// bit.
+Planes SubBytes(const Planes& x) {
+  uint64_t x0 = x[7], x1 = x[6], x2 = x[5], x3 = x[4], x4 = x[3], x5 = x[2], x6 = x[1], x7 = x[0];
+
+  // Top linear transformation
+  uint64_t y14 = x3 ^ x5;
+  uint64_t y13 = x0 ^ x6;
+  uint64_t y9 = x0 ^ x3;
+  uint64_t y8 = x0 ^ x5;
+  uint64_t t0 = x1 ^ x2;
+  uint64_t y1 = t0 ^ x7;
+  uint64_t y4 = y1 ^ x3;
+  uint64_t y12 = y13 ^ y14;
+  uint64_t y2 = y1 ^ x0;
+  uint64_t y5 = y1 ^ x6;
+  uint64_t y3 = y5 ^ y8;
+  uint64_t t1 = x4 ^ y12;
+  uint64_t y15 = t1 ^ x5;
+  uint64_t y20 = t1 ^ x1;
+  uint64_t y6 = y15 ^ x7;
+  uint64_t y10 = y15 ^ t0;
+  uint64_t y11 = y20 ^ y9;
+  uint64_t y7 = x7 ^ y11;
+  uint64_t y17 = y10 ^ y11;
+  uint64_t y19 = y10 ^ y8;
+  uint64_t y16 = t0 ^ y11;
+  uint64_t y21 = y13 ^ y16;
+  uint64_t y18 = x0 ^ y16;
+
+  // Shared non-linear middle section
+  uint64_t t2 = y12 & y15;
+  uint64_t t3 = y3 & y6;
+  uint64_t t4 = t3 ^ t2;
+  uint64_t t5 = y4 & x7;
+  uint64_t t6 = t5 ^ t2;
+  uint64_t t7 = y13 & y16;
+  uint64_t t8 = y5 & y1;
+  uint64_t t9 = t8 ^ t7;
+  uint64_t t10 = y2 & y7;
+  uint64_t t11 = t10 ^ t7;
+  uint64_t t12 = y9 & y11;
+  uint64_t t13 = y14 & y17;
+  uint64_t t14 = t13 ^ t12;
+  uint64_t t15 = y8 & y10;
+  uint64_t t16 = t15 ^ t12;
+  uint64_t t17 = t4 ^ t14;
+  uint64_t t18 = t6 ^ t16;
+  uint64_t t19 = t9 ^ t14;
+  uint64_t t20 = t11 ^ t16;
+  uint64_t t21 = t17 ^ y20;
+  uint64_t t22 = t18 ^ y19;
+  uint64_t t23 = t19 ^ y21;
+  uint64_t t24 = t20 ^ y18;
+
+  uint64_t t25 = t21 ^ t22;
+  uint64_t t26 = t21 & t23;
+  uint64_t t27 = t24 ^ t26;
+  uint64_t t28 = t25 & t27;
+  uint64_t t29 = t28 ^ t22;
+  uint64_t t30 = t23 ^ t24;
+  uint64_t t31 = t22 ^ t26;
+  uint64_t t32 = t31 & t30;
+  uint64_t t33 = t32 ^ t24;
+  uint64_t t34 = t23 ^ t33;
+  uint64_t t35 = t27 ^ t33;
+  uint64_t t36 = t24 & t35;
+  uint64_t t37 = t36 ^ t34;
+  uint64_t t38 = t27 ^ t36;
+  uint64_t t39 = t29 & t38;
+  uint64_t t40 = t25 ^ t39;
+
+  uint64_t t41 = t40 ^ t37;
+  uint64_t t42 = t29 ^ t33;
+  uint64_t t43 = t29 ^ t40;
+  uint64_t t44 = t33 ^ t37;
+  uint64_t t45 = t42 ^ t41;
+  uint64_t z0 = t44 & y15;
+  uint64_t z1 = t37 & y6;
+  uint64_t z2 = t33 & x7;
+  uint64_t z3 = t43 & y16;
+  uint64_t z4 = t40 & y1;
+  uint64_t z5 = t29 & y7;
+  uint64_t z6 = t42 & y11;
+  uint64_t z7 = t45 & y17;
+  uint64_t z8 = t41 & y10;
+  uint64_t z9 = t44 & y12;
+  uint64_t z10 = t37 & y3;
+  uint64_t z11 = t33 & y4;
+  uint64_t z12 = t43 & y13;
+  uint64_t z13 = t40 & y5;
+  uint64_t z14 = t29 & y2;
+  uint64_t z15 = t42 & y9;
+  uint64_t z16 = t45 & y14;
+  uint64_t z17 = t41 & y8;
+
+  // Bottom linear transformation, including the affine constant 0x63
+  uint64_t t46 = z15 ^ z16;
+  uint64_t t47 = z10 ^ z11;
+  uint64_t t48 = z5 ^ z13;
+  uint64_t t49 = z9 ^ z10;
+  uint64_t t50 = z2 ^ z12;
+  uint64_t t51 = z2 ^ z5;
+  uint64_t t52 = z7 ^ z8;
+  uint64_t t53 = z0 ^ z3;
+  uint64_t t54 = z6 ^ z7;
+  uint64_t t55 = z16 ^ z17;
+  uint64_t t56 = z12 ^ t48;
+  uint64_t t57 = t50 ^ t53;
+  uint64_t t58 = z4 ^ t46;
+  uint64_t t59 = z3 ^ t54;
+  uint64_t t60 = t46 ^ t57;
+  uint64_t t61 = z14 ^ t57;
+  uint64_t t62 = t52 ^ t58;
+  uint64_t t63 = t49 ^ t58;
+  uint64_t t64 = z4 ^ t59;
+  uint64_t t65 = t61 ^ t62;
+  uint64_t t66 = z1 ^ t63;
+  uint64_t s0 = t59 ^ t63;
+  uint64_t s6 = t56 ^ ~t62;
+  uint64_t s7 = t48 ^ ~t60;
+  uint64_t t67 = t64 ^ t65;
+  uint64_t s3 = t53 ^ t66;
+  uint64_t s4 = t51 ^ t66;
+  uint64_t s5 = t47 ^ t65;
+  uint64_t s1 = t64 ^ ~s3;
+  uint64_t s2 = t55 ^ ~t67;
+
+  return {s7, s6, s5, s4, s3, s2, s1, s0};
+}
+
+// Row r of the state is rotated left by r columns, i.e. byte i of the lane takes byte (i + 4 * r) % 16
+uint64_t ShiftRows(uint64_t x) {
+  return (x & Lanes(0x1111)) | ((x >> 4) & Lanes(0x0222)) | ((x << 12) & Lanes(0x2000)) |
+         ((x >> 8) & Lanes(0x0044)) | ((x << 8) & Lanes(0x4400)) | ((x >> 12) & Lanes(0x0008)) |
+         ((x << 4) & Lanes(0x8880));
+}
+
+// Row r of each column takes row (r + 1) % 4, resp. (r + 2) % 4, of the same column
+uint64_t RotateRows1(uint64_t x) {
+  return ((x >> 1) & Lanes(0x7777)) | ((x << 3) & Lanes(0x8888));
+}
+
+uint64_t RotateRows2(uint64_t x) {
+  return ((x >> 2) & Lanes(0x3333)) | ((x << 2) & Lanes(0xcccc));
+}
+
+// a'[r] = 2 a[r] + 3 a[r + 1] + a[r + 2] + a[r + 3] = 2 (a[r] + a[r + 1]) + a[r + 1] + (a[r + 2] + a[r + 3])
+Planes MixColumns(const Planes& a) {
+  Planes r1;
+  Planes t;
+  for (int i = 0; i < 8; i++) {
+    r1[i] = RotateRows1(a[i]);
+    t[i] = a[i] ^ r1[i];
+  }
+  // Multiplication of t by x modulo x^8 + x^4 + x^3 + x + 1
+  Planes t2 = {t[7], t[0] ^ t[7], t[1], t[2] ^ t[7], t[3] ^ t[7], t[4], t[5], t[6]};
+  Planes m;
+  for (int i = 0; i < 8; i++) {
+    m[i] = t2[i] ^ r1[i] ^ RotateRows2(t[i]);
+  }
+  return m;
+}
+
+void AddRoundKey(Planes& state, const uint64_t round_key[8]) {
+  for (int i = 0; i < 8; i++) {
+    state[i] ^= round_key[i];
+  }
+}
+
+#if AES_KERNELS_HAVE_AESNI || AES_KERNELS_HAVE_ARMV8_CE
+// Doubling in GF(2^128) of RFC 4493 2.3, the block being big endian
+void Double(uint8_t block[kBlockSize]) {
+  uint8_t carry = block[0] >> 7;
+  for (size_t i = 0; i + 1 < kBlockSize; i++) {
+    block[i] = static_cast<uint8_t>((block[i] << 1) | (block[i + 1] >> 7));
+  }
+  block[kBlockSize - 1] = static_cast<uint8_t>((block[kBlockSize - 1] << 1) ^ (0x87 & -carry));
+}
+
+// Number of blocks of the CMAC of a |length| byte message, an empty message being one incomplete block
+size_t CmacBlocks(size_t length) {
+  return length == 0 ? 1 : (length + kBlockSize - 1) / kBlockSize;
+}
+
+// M_n XOR K1 when the last block of |message| is complete, padding(M_n) XOR K2 otherwise (RFC 4493 2.4), where
+// |l| = AES(key, 0)
+void CmacLastBlock(const uint8_t* message, size_t length, const uint8_t l[kBlockSize], uint8_t last[kBlockSize]) {
+  size_t offset = (CmacBlocks(length) - 1) * kBlockSize;
+  size_t remaining = length - offset;
+
+  uint8_t subkey[kBlockSize];
+  std::copy(l, l + kBlockSize, subkey);
+  Double(subkey);
+  std::fill(last, last + kBlockSize, 0);
+  if (remaining > 0) {
+    std::copy(message + offset, message + length, last);
+  }
+  if (remaining < kBlockSize) {
+    last[remaining] = 0x80;
+    Double(subkey);
+  }
+  for (size_t i = 0; i < kBlockSize; i++) {
+    last[i] ^= subkey[i];
+  }
+}
+#endif
+
+#if AES_KERNELS_HAVE_AESNI
+template <size_t N>
+__attribute__((target("aes,sse2"))) void EncryptAesNi(const RoundKeys* keys, __m128i block,
+                                                       uint8_t (*out)[kBlockSize]) {
+  // Independent blocks are interleaved to hide the latency of AESENC
+  __m128i s[N];
+  for (size_t k = 0; k < N; k++) {
+    s[k] = _mm_xor_si128(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[k].data())));
+  }
+  for (size_t round = 1; round < kRounds; round++) {
+    for (size_t k = 0; k < N; k++) {
+      __m128i round_key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[k].data() + round * kBlockSize));
+      s[k] = _mm_aesenc_si128(s[k], round_key);
+    }
+  }
+  for (size_t k = 0; k < N; k++) {
+    __m128i round_key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[k].data() + kRounds * kBlockSize));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out[k]), _mm_aesenclast_si128(s[k], round_key));
+  }
+}
+
+__attribute__((target("aes,sse2"))) void EncryptAesNi(const RoundKeys* keys, size_t num_keys,
+                                                       const uint8_t in[kBlockSize], uint8_t (*out)[kBlockSize]) {
+  constexpr size_t kInterleave = 8;
+  __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+  size_t i = 0;
+  for (; i + kInterleave <= num_keys; i += kInterleave) {
+    EncryptAesNi<kInterleave>(keys + i, block, out + i);
+  }
+  for (; i < num_keys; i++) {
+    EncryptAesNi<1>(keys + i, block, out + i);
+  }
+}
+
+template <int kRcon>
+__attribute__((target("aes,sse2"))) __m128i ExpandKeyStepAesNi(__m128i key) {
+  __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, kRcon), 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+__attribute__((target("aes,sse2"))) void ExpandKeyAesNi(const uint8_t key[kBlockSize],
+                                                         __m128i round_keys[kRounds + 1]) {
+  round_keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+  round_keys[1] = ExpandKeyStepAesNi<0x01>(round_keys[0]);
+  round_keys[2] = ExpandKeyStepAesNi<0x02>(round_keys[1]);
+  round_keys[3] = ExpandKeyStepAesNi<0x04>(round_keys[2]);
+  round_keys[4] = ExpandKeyStepAesNi<0x08>(round_keys[3]);
+  round_keys[5] = ExpandKeyStepAesNi<0x10>(round_keys[4]);
+  round_keys[6] = ExpandKeyStepAesNi<0x20>(round_keys[5]);
+  round_keys[7] = ExpandKeyStepAesNi<0x40>(round_keys[6]);
+  round_keys[8] = ExpandKeyStepAesNi<0x80>(round_keys[7]);
+  round_keys[9] = ExpandKeyStepAesNi<0x1b>(round_keys[8]);
+  round_keys[10] = ExpandKeyStepAesNi<0x36>(round_keys[9]);
+}
+
+__attribute__((target("aes,sse2"))) __m128i EncryptBlockAesNi(const __m128i round_keys[kRounds + 1],
+                                                               __m128i block) {
+  block = _mm_xor_si128(block, round_keys[0]);
+  for (size_t round = 1; round < kRounds; round++) {
+    block = _mm_aesenc_si128(block, round_keys[round]);
+  }
+  return _mm_aesenclast_si128(block, round_keys[kRounds]);
+}
+
+__attribute__((target("aes,sse2"))) void CmacAesNi(const uint8_t key[kBlockSize], const uint8_t* message,
+                                                    size_t length, uint8_t mac[kBlockSize]) {
+  __m128i round_keys[kRounds + 1];
+  ExpandKeyAesNi(key, round_keys);
+  size_t num_blocks = CmacBlocks(length);
+
+  // L = AES(key, 0) does not depend on the message, so it goes through the pipeline along with the first block
+  __m128i l = round_keys[0];
+  __m128i x = _mm_setzero_si128();
+  size_t i = 0;
+  if (num_blocks > 1) {
+    x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(message)), round_keys[0]);
+    for (size_t round = 1; round < kRounds; round++) {
+      l = _mm_aesenc_si128(l, round_keys[round]);
+      x = _mm_aesenc_si128(x, round_keys[round]);
+    }
+    l = _mm_aesenclast_si128(l, round_keys[kRounds]);
+    x = _mm_aesenclast_si128(x, round_keys[kRounds]);
+    i = 1;
+  } else {
+    l = EncryptBlockAesNi(round_keys, _mm_setzero_si128());
+  }
+  for (; i + 1 < num_blocks; i++) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(message + i * kBlockSize));
+    x = EncryptBlockAesNi(round_keys, _mm_xor_si128(x, block));
+  }
+
+  uint8_t l_bytes[kBlockSize];
+  uint8_t last[kBlockSize];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(l_bytes), l);
+  CmacLastBlock(message, length, l_bytes, last);
+  x = EncryptBlockAesNi(round_keys, _mm_xor_si128(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(last))));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(mac), x);
+}
+#endif
+
+#if AES_KERNELS_HAVE_ARMV8_CE
+template <size_t N>
+__attribute__((target("arch=armv8-a+aes"))) void EncryptArmv8Ce(const RoundKeys* keys, uint8x16_t block,
+                                                                 uint8_t (*out)[kBlockSize]) {
+  // AESE adds the round key before SubBytes and ShiftRows, so the last round key is added separately
+  uint8x16_t s[N];
+  for (size_t k = 0; k < N; k++) {
+    s[k] = block;
+  }
+  for (size_t round = 0; round < kRounds - 1; round++) {
+    for (size_t k = 0; k < N; k++) {
+      s[k] = vaesmcq_u8(vaeseq_u8(s[k], vld1q_u8(keys[k].data() + round * kBlockSize)));
+    }
+  }
+  for (size_t k = 0; k < N; k++) {
+    s[k] = vaeseq_u8(s[k], vld1q_u8(keys[k].data() + (kRounds - 1) * kBlockSize));
+    vst1q_u8(out[k], veorq_u8(s[k], vld1q_u8(keys[k].data() + kRounds * kBlockSize)));
+  }
+}
+
+__attribute__((target("arch=armv8-a+aes"))) void EncryptArmv8Ce(const RoundKeys* keys, size_t num_keys,
+                                                                 const uint8_t in[kBlockSize],
+                                                                 uint8_t (*out)[kBlockSize]) {
+  constexpr size_t kInterleave = 8;
+  uint8x16_t block = vld1q_u8(in);
+  size_t i = 0;
+  for (; i + kInterleave <= num_keys; i += kInterleave) {
+    EncryptArmv8Ce<kInterleave>(keys + i, block, out + i);
+  }
+  for (; i < num_keys; i++) {
+    EncryptArmv8Ce<1>(keys + i, block, out + i);
+  }
+}
+
+__attribute__((target("arch=armv8-a+aes"))) uint32_t SubWordArmv8Ce(uint32_t word) {
+  // With the word in every column, ShiftRows leaves it in place and AESE with a zero key is SubBytes
+  uint8x16_t state = vaeseq_u8(vreinterpretq_u8_u32(vdupq_n_u32(word)), vdupq_n_u8(0));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(state), 0);
+}
+
+__attribute__((target("arch=armv8-a+aes"))) void ExpandKeyArmv8Ce(const uint8_t key[kBlockSize],
+                                                                   uint8x16_t round_keys[kRounds + 1]) {
+  // FIPS-197 5.2 on little endian words, byte 0 of a word being its least significant byte
+  uint32_t w[4 * (kRounds + 1)];
+  std::memcpy(w, key, kBlockSize);
+  uint32_t rcon = 0x01;
+  for (size_t i = 4; i < 4 * (kRounds + 1); i++) {
+    uint32_t t = w[i - 1];
+    if (i % 4 == 0) {
+      t = SubWordArmv8Ce(t);
+      t = ((t >> 8) | (t << 24)) ^ rcon;
+      rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x11b : 0x00);
+    }
+    w[i] = w[i - 4] ^ t;
+  }
+  for (size_t round = 0; round <= kRounds; round++) {
+    round_keys[round] = vreinterpretq_u8_u32(vld1q_u32(w + 4 * round));
+  }
+}
+
+__attribute__((target("arch=armv8-a+aes"))) uint8x16_t EncryptBlockArmv8Ce(const uint8x16_t round_keys[kRounds + 1],
+                                                                            uint8x16_t block) {
+  for (size_t round = 0; round < kRounds - 1; round++) {
+    block = vaesmcq_u8(vaeseq_u8(block, round_keys[round]));
+  }
+  block = vaeseq_u8(block, round_keys[kRounds - 1]);
+  return veorq_u8(block, round_keys[kRounds]);
+}
+
+__attribute__((target("arch=armv8-a+aes"))) void CmacArmv8Ce(const uint8_t key[kBlockSize], const uint8_t* message,
+                                                              size_t length, uint8_t mac[kBlockSize]) {
+  uint8x16_t round_keys[kRounds + 1];
+  ExpandKeyArmv8Ce(key, round_keys);
+  size_t num_blocks = CmacBlocks(length);
+
+  // L = AES(key, 0) does not depend on the message, so it goes through the pipeline along with the first block
+  uint8x16_t l = vdupq_n_u8(0);
+  uint8x16_t x = vdupq_n_u8(0);
+  size_t i = 0;
+  if (num_blocks > 1) {
+    x = vld1q_u8(message);
+    for (size_t round = 0; round < kRounds - 1; round++) {
+      l = vaesmcq_u8(vaeseq_u8(l, round_keys[round]));
+      x = vaesmcq_u8(vaeseq_u8(x, round_keys[round]));
+    }
+    l = veorq_u8(vaeseq_u8(l, round_keys[kRounds - 1]), round_keys[kRounds]);
+    x = veorq_u8(vaeseq_u8(x, round_keys[kRounds - 1]), round_keys[kRounds]);
+    i = 1;
+  } else {
+    l = EncryptBlockArmv8Ce(round_keys, l);
+  }
+  for (; i + 1 < num_blocks; i++) {
+    x = EncryptBlockArmv8Ce(round_keys, veorq_u8(x, vld1q_u8(message + i * kBlockSize)));
+  }
+
+  uint8_t l_bytes[kBlockSize];
+  uint8_t last[kBlockSize];
+  vst1q_u8(l_bytes, l);
+  CmacLastBlock(message, length, l_bytes, last);
+  vst1q_u8(mac, EncryptBlockArmv8Ce(round_keys, veorq_u8(x, vld1q_u8(last))));
+}
+#endif
+
+}  // namespace
+
+void BitslicedExpandKey(const uint8_t key[kBlockSize], BitslicedKeys* keys) {
+  uint8_t in[kLanes][kBlockSize];
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    std::copy(key, key + kBlockSize, in[lane]);
+  }
+  Planes round_key = Pack(in);
+  std::copy(round_key.begin(), round_key.end(), keys->planes[0]);
+
+  // FIPS-197 5.2, four words at a time: w0 ^= SubWord(RotWord(w3)) ^ Rcon, then w1 ^= w0, w2 ^= w1 and w3 ^= w2
+  uint8_t rcon = 0x01;
+  for (size_t round = 1; round <= kRounds; round++) {
+    Planes s = SubBytes(round_key);
+    for (int i = 0; i < 8; i++) {
+      // Bytes 13, 14, 15 and 12 of the previous round key
+      uint64_t t = ((s[i] >> 13) & Lanes(0x0007)) | ((s[i] >> 9) & Lanes(0x0008));
+      if ((rcon >> i) & 1) {
+        t ^= Lanes(0x0001);
+      }
+      uint64_t w = round_key[i] ^ t;
+      w ^= (w << 4) & Lanes(0xfff0);
+      w ^= (w << 8) & Lanes(0xff00);
+      round_key[i] = w;
+    }
+    std::copy(round_key.begin(), round_key.end(), keys->planes[round]);
+    rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0x00);
+  }
+}
+
+void BitslicedCopyLane(const BitslicedKeys& from, size_t from_lane, BitslicedKeys* to, size_t to_lane) {
+  for (size_t round = 0; round <= kRounds; round++) {
+    for (int i = 0; i < 8; i++) {
+      uint64_t key = (from.planes[round][i] >> (16 * from_lane)) & kLaneMask;
+      uint64_t others = to->planes[round][i] & ~(kLaneMask << (16 * to_lane));
+      to->planes[round][i] = others | (key << (16 * to_lane));
+    }
+  }
+}
+
+void BitslicedEncrypt(const BitslicedKeys& keys, const uint8_t in[kLanes][kBlockSize],
+                      uint8_t out[kLanes][kBlockSize]) {
+  Planes state = Pack(in);
+  AddRoundKey(state, keys.planes[0]);
+  for (size_t round = 1; round <= kRounds; round++) {
+    state = SubBytes(state);
+    for (int i = 0; i < 8; i++) {
+      state[i] = ShiftRows(state[i]);
+    }
+    if (round != kRounds) {
+      state = MixColumns(state);
+    }
+    AddRoundKey(state, keys.planes[round]);
+  }
+  Unpack(state, out);
+}
+
+void ExpandKey(const uint8_t key[kBlockSize], RoundKeys* round_keys) {
+#if AES_KERNELS_HAVE_AESNI
+  if (HardwareSupported()) {
+    __m128i expanded[kRounds + 1];
+    ExpandKeyAesNi(key, expanded);
+    for (size_t round = 0; round <= kRounds; round++) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(round_keys->data() + round * kBlockSize), expanded[round]);
+    }
+    return;
+  }
+#elif AES_KERNELS_HAVE_ARMV8_CE
+  if (HardwareSupported()) {
+    uint8x16_t expanded[kRounds + 1];
+    ExpandKeyArmv8Ce(key, expanded);
+    for (size_t round = 0; round <= kRounds; round++) {
+      vst1q_u8(round_keys->data() + round * kBlockSize, expanded[round]);
+    }
+    return;
+  }
+#endif
+  BitslicedKeys keys;
+  BitslicedExpandKey(key, &keys);
+  for (size_t round = 0; round <= kRounds; round++) {
+    Planes planes;
+    std::copy(keys.planes[round], keys.planes[round] + 8, planes.begin());
+    uint8_t lanes[kLanes][kBlockSize];
+    Unpack(planes, lanes);
+    std::copy(lanes[0], lanes[0] + kBlockSize, round_keys->data() + round * kBlockSize);
+  }
+}
+
+bool HardwareSupported() {
+#if AES_KERNELS_HAVE_AESNI
+  // IrkSet instances may be constructed before the CPU features are detected by the runtime
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse2");
+  }();
+  return supported;
+#elif AES_KERNELS_HAVE_ARMV8_CE
+  static const bool supported = (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+  return supported;
+#else
+  return false;
+#endif
+}
+
+void HardwareEncrypt(const RoundKeys* keys, size_t num_keys, const uint8_t in[kBlockSize],
+                     uint8_t (*out)[kBlockSize]) {
+#if AES_KERNELS_HAVE_AESNI
+  EncryptAesNi(keys, num_keys, in, out);
+#elif AES_KERNELS_HAVE_ARMV8_CE
+  EncryptArmv8Ce(keys, num_keys, in, out);
+#else
+  (void)keys;
+  (void)num_keys;
+  (void)in;
+  (void)out;
+#endif
+}
+
+void HardwareEncryptBlock(const uint8_t key[kBlockSize], const uint8_t in[kBlockSize], uint8_t out[kBlockSize]) {
+#if AES_KERNELS_HAVE_AESNI
+  __m128i round_keys[kRounds + 1];
+  ExpandKeyAesNi(key, round_keys);
+  __m128i block = EncryptBlockAesNi(round_keys, _mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+#elif AES_KERNELS_HAVE_ARMV8_CE
+  uint8x16_t round_keys[kRounds + 1];
+  ExpandKeyArmv8Ce(key, round_keys);
+  vst1q_u8(out, EncryptBlockArmv8Ce(round_keys, vld1q_u8(in)));
+#else
+  (void)key;
+  (void)in;
+  (void)out;
+#endif
+}
+
+void HardwareCmac(const uint8_t key[kBlockSize], const uint8_t* message, size_t length, uint8_t mac[kBlockSize]) {
+#if AES_KERNELS_HAVE_AESNI
+  CmacAesNi(key, message, length, mac);
+#elif AES_KERNELS_HAVE_ARMV8_CE
+  CmacArmv8Ce(key, message, length, mac);
+#else
+  (void)key;
+  (void)message;
+  (void)length;
+  (void)mac;
+#endif
+}
+
+}  // namespace aes_kernels
+}  // namespace crypto_toolbox
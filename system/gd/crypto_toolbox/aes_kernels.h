@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto_toolbox {
+namespace aes_kernels {
+
+// AES-128 implementations that encrypt a block under many keys at once. Unlike the little endian Octet16 of the rest
+// of crypto_toolbox, keys and blocks are in the byte order of FIPS-197.
+
+constexpr size_t kBlockSize = 16;
+constexpr size_t kRounds = 10;
+
+// Bitsliced implementation, constant time and portable. Encrypts kLanes blocks at once, each under the key of its
+// lane: planes[round][bit] holds bit |bit| of every byte of the round key of every lane.
+constexpr size_t kLanes = 4;
+struct BitslicedKeys {
+  uint64_t planes[kRounds + 1][8];
+};
+
+// Expand |key| into every lane of |keys|
+void BitslicedExpandKey(const uint8_t key[kBlockSize], BitslicedKeys* keys);
+
+// Copy the key of lane |from_lane| of |from| to lane |to_lane| of |to|, leaving the other lanes of |to| as they are
+void BitslicedCopyLane(const BitslicedKeys& from, size_t from_lane, BitslicedKeys* to, size_t to_lane);
+
+void BitslicedEncrypt(const BitslicedKeys& keys, const uint8_t in[kLanes][kBlockSize], uint8_t out[kLanes][kBlockSize]);
+
+// The kRounds + 1 round keys of FIPS-197 5.2, one after the other
+using RoundKeys = std::array<uint8_t, (kRounds + 1) * kBlockSize>;
+
+void ExpandKey(const uint8_t key[kBlockSize], RoundKeys* round_keys);
+
+// AES instructions of the CPU: AES-NI on x86, the Cryptographic Extension on ARMv8. The Hardware functions must only
+// be called when HardwareSupported() returns true. HardwareEncrypt() encrypts |in| under each of the |num_keys| keys.
+bool HardwareSupported();
+void HardwareEncrypt(const RoundKeys* keys, size_t num_keys, const uint8_t in[kBlockSize], uint8_t (*out)[kBlockSize]);
+
+// AES-128 of a single block and AES-CMAC (RFC 4493) of |length| bytes under |key|, with the same instructions
+void HardwareEncryptBlock(const uint8_t key[kBlockSize], const uint8_t in[kBlockSize], uint8_t out[kBlockSize]);
+void HardwareCmac(const uint8_t key[kBlockSize], const uint8_t* message, size_t length, uint8_t mac[kBlockSize]);
+
+}  // namespace aes_kernels
+}  // namespace crypto_toolbox
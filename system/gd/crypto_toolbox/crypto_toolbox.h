@@ -89,4 +89,13 @@ inline bluetooth::hci::Octet16 aes_cmac(
   return aes_cmac(key, message.data(), message.size());
 }
 
+// aes_128() and aes_cmac() use the AES instructions of the CPU when it has some, and these table driven
+// implementations otherwise. Exposed for tests and benchmarks.
+namespace table {
+bluetooth::hci::Octet16 aes_128(
+    const bluetooth::hci::Octet16& key, const bluetooth::hci::Octet16& message);
+bluetooth::hci::Octet16 aes_cmac(
+    const bluetooth::hci::Octet16& key, const uint8_t* message, uint16_t length);
+}  // namespace table
+
 }  // namespace crypto_toolbox
@@ -21,6 +21,7 @@
 #include <bluetooth/log.h>
 #include <gtest/gtest.h>
 
+#include <random>
 #include <vector>
 
 #include "crypto_toolbox/aes.h"
@@ -353,4 +354,31 @@ TEST(CryptoToolboxTest, bt_spec_example_d_12_test) {
   EXPECT_EQ(expected_ltk, ltk);
 }
 
+// aes_128() and aes_cmac() use the AES instructions of the CPU when it has some
+TEST(CryptoToolboxTest, matches_table_implementation) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  auto random_bytes = [&](uint8_t* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      bytes[i] = distribution(generator);
+    }
+  };
+
+  for (int i = 0; i < 100; i++) {
+    Octet16 key, message;
+    random_bytes(key.data(), key.size());
+    random_bytes(message.data(), message.size());
+    EXPECT_EQ(aes_128(key, message), table::aes_128(key, message));
+  }
+
+  for (uint16_t length : {0, 1, 15, 16, 17, 31, 32, 33, 48, 53, 65, 100, 255, 256, 4096}) {
+    Octet16 key;
+    std::vector<uint8_t> message(length);
+    random_bytes(key.data(), key.size());
+    random_bytes(message.data(), message.size());
+    EXPECT_EQ(aes_cmac(key, message.data(), length), table::aes_cmac(key, message.data(), length))
+        << "length " << length;
+  }
+}
+
 }  // namespace crypto_toolbox
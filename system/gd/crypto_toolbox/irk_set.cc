@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/irk_set.h"
+
+#include <bluetooth/log.h>
+
+#include <algorithm>
+
+using bluetooth::hci::Octet16;
+
+namespace crypto_toolbox {
+
+using aes_kernels::kBlockSize;
+using aes_kernels::kLanes;
+
+namespace {
+
+// Keys encrypted per call to the hardware kernel, so that the ciphertexts stay in the L1 cache
+constexpr size_t kHardwareBatch = 32;
+
+// The byte order of FIPS-197 is the reverse of the little endian order of crypto_toolbox, so r' = padding || prand
+// ends with prand and ah(k, r) is in the last three bytes
+bool HashMatches(const uint8_t ciphertext[kBlockSize], const std::array<uint8_t, 3>& hash) {
+  return ciphertext[15] == hash[0] && ciphertext[14] == hash[1] && ciphertext[13] == hash[2];
+}
+
+const aes_kernels::BitslicedKeys kNoKeys{};
+
+}  // namespace
+
+IrkSet::IrkSet()
+    : IrkSet(IsSupported(Implementation::kHardware) ? Implementation::kHardware : Implementation::kBitsliced) {}
+
+IrkSet::IrkSet(Implementation implementation) : implementation_(implementation) {
+  bluetooth::log::assert_that(IsSupported(implementation), "AES instructions are not supported by this CPU");
+}
+
+bool IrkSet::IsSupported(Implementation implementation) {
+  return implementation == Implementation::kBitsliced || aes_kernels::HardwareSupported();
+}
+
+void IrkSet::Add(const Octet16& irk) {
+  uint8_t key[kBlockSize];
+  std::reverse_copy(irk.begin(), irk.end(), key);
+
+  if (implementation_ == Implementation::kHardware) {
+    round_keys_.emplace_back();
+    aes_kernels::ExpandKey(key, &round_keys_.back());
+  } else {
+    aes_kernels::BitslicedKeys expanded;
+    aes_kernels::BitslicedExpandKey(key, &expanded);
+    if (size_ % kLanes == 0) {
+      bitsliced_keys_.emplace_back();
+    }
+    aes_kernels::BitslicedCopyLane(expanded, 0, &bitsliced_keys_.back(), size_ % kLanes);
+  }
+  size_++;
+}
+
+void IrkSet::Remove(size_t index) {
+  bluetooth::log::assert_that(index < size_, "index {} out of {} keys", index, size_);
+  size_t last = size_ - 1;
+
+  if (implementation_ == Implementation::kHardware) {
+    round_keys_[index] = round_keys_[last];
+    round_keys_.pop_back();
+  } else {
+    aes_kernels::BitslicedCopyLane(bitsliced_keys_[last / kLanes], last % kLanes, &bitsliced_keys_[index / kLanes],
+                                   index % kLanes);
+    aes_kernels::BitslicedCopyLane(kNoKeys, 0, &bitsliced_keys_[last / kLanes], last % kLanes);
+    if (last % kLanes == 0) {
+      bitsliced_keys_.pop_back();
+    }
+  }
+  size_--;
+}
+
+void IrkSet::Clear() {
+  round_keys_.clear();
+  bitsliced_keys_.clear();
+  size_ = 0;
+}
+
+size_t IrkSet::Find(const std::array<uint8_t, 3>& prand, const std::array<uint8_t, 3>& hash, size_t start) const {
+  uint8_t r[kBlockSize] = {};
+  r[13] = prand[2];
+  r[14] = prand[1];
+  r[15] = prand[0];
+
+  if (implementation_ == Implementation::kHardware) {
+    uint8_t ciphertexts[kHardwareBatch][kBlockSize];
+    for (size_t first = start; first < size_; first += kHardwareBatch) {
+      size_t count = std::min(kHardwareBatch, size_ - first);
+      aes_kernels::HardwareEncrypt(&round_keys_[first], count, r, ciphertexts);
+      for (size_t i = 0; i < count; i++) {
+        if (HashMatches(ciphertexts[i], hash)) {
+          return first + i;
+        }
+      }
+    }
+    return size_;
+  }
+
+  uint8_t blocks[kLanes][kBlockSize];
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    std::copy(r, r + kBlockSize, blocks[lane]);
+  }
+  for (size_t group = start / kLanes; group < bitsliced_keys_.size(); group++) {
+    uint8_t ciphertexts[kLanes][kBlockSize];
+    aes_kernels::BitslicedEncrypt(bitsliced_keys_[group], blocks, ciphertexts);
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      size_t index = group * kLanes + lane;
+      if (index >= start && index < size_ && HashMatches(ciphertexts[lane], hash)) {
+        return index;
+      }
+    }
+  }
+  return size_;
+}
+
+}  // namespace crypto_toolbox
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "crypto_toolbox/aes_kernels.h"
+#include "hci/octets.h"
+
+namespace crypto_toolbox {
+
+// Identity Resolving Keys of many peers, expanded once and kept side by side so that a Resolvable Private Address is
+// checked against all of them in one batch with the random address hash function ah (Core Vol 3, Part H, 2.2.2).
+class IrkSet {
+ public:
+  enum class Implementation {
+    kBitsliced,
+    kHardware,
+  };
+
+  // Uses the AES instructions of the CPU when there are some
+  IrkSet();
+  explicit IrkSet(Implementation implementation);
+
+  static bool IsSupported(Implementation implementation);
+
+  // Append |irk|, in the little endian order of the rest of crypto_toolbox. Its index is Size() - 1.
+  void Add(const bluetooth::hci::Octet16& irk);
+
+  // Remove the key at |index|. The last key takes its index.
+  void Remove(size_t index);
+
+  void Clear();
+
+  size_t Size() const {
+    return size_;
+  }
+
+  // Return the index of the first key from |start| on such that ah(key, prand) == hash, or Size() if there is none.
+  // |prand| and |hash| are the upper and lower 24 bits of the address, least significant byte first.
+  size_t Find(const std::array<uint8_t, 3>& prand, const std::array<uint8_t, 3>& hash, size_t start = 0) const;
+
+ private:
+  Implementation implementation_;
+  size_t size_ = 0;
+  // kHardware: the round keys of each key
+  std::vector<aes_kernels::RoundKeys> round_keys_;
+  // kBitsliced: the round keys of aes_kernels::kLanes keys each, key i in lane i % kLanes of group i / kLanes
+  std::vector<aes_kernels::BitslicedKeys> bitsliced_keys_;
+};
+
+}  // namespace crypto_toolbox
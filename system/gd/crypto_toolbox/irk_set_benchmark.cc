@@ -0,0 +1,86 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "crypto_toolbox/crypto_toolbox.h"
+#include "crypto_toolbox/irk_set.h"
+
+using ::benchmark::State;
+using ::bluetooth::hci::Octet16;
+using ::crypto_toolbox::IrkSet;
+
+namespace {
+
+// An address that none of the keys resolves, so that every key is tried
+const std::array<uint8_t, 3> kPrand{0x94, 0x81, 0x70};
+const std::array<uint8_t, 3> kHash{0xaa, 0xfb, 0x0d};
+
+std::vector<Octet16> Keys(size_t count) {
+  std::vector<Octet16> keys(count);
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < keys[i].size(); j++) {
+      keys[i][j] = static_cast<uint8_t>(i * 131 + j * 17 + 1);
+    }
+  }
+  return keys;
+}
+
+// One aes_128() per key, as btm_ble_resolve_random_addr() used to do
+void BM_ResolveOneKeyAtATime(State& state) {
+  auto keys = Keys(state.range(0));
+  Octet16 r{};
+  r[0] = kPrand[0];
+  r[1] = kPrand[1];
+  r[2] = kPrand[2];
+  for (auto _ : state) {
+    size_t match = keys.size();
+    for (size_t i = 0; i < keys.size(); i++) {
+      Octet16 ciphertext = crypto_toolbox::aes_128(keys[i], r);
+      if (ciphertext[0] == kHash[0] && ciphertext[1] == kHash[1] && ciphertext[2] == kHash[2]) {
+        match = i;
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(match);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+void BM_ResolveIrkSet(State& state, IrkSet::Implementation implementation) {
+  if (!IrkSet::IsSupported(implementation)) {
+    state.SkipWithError("AES instructions are not supported on this CPU");
+    return;
+  }
+  IrkSet irks(implementation);
+  for (const auto& key : Keys(state.range(0))) {
+    irks.Add(key);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(irks.Find(kPrand, kHash));
+  }
+  // Reported as items_per_second, i.e. the number of keys tried per second
+  state.SetItemsProcessed(state.iterations() * irks.Size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ResolveOneKeyAtATime)->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_ResolveIrkSet, bitsliced, IrkSet::Implementation::kBitsliced)->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_ResolveIrkSet, hardware, IrkSet::Implementation::kHardware)->Arg(1)->Arg(100)->Arg(1000);
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/irk_set.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "crypto_toolbox/aes_kernels.h"
+#include "crypto_toolbox/crypto_toolbox.h"
+
+namespace crypto_toolbox {
+namespace {
+
+using aes_kernels::kBlockSize;
+using aes_kernels::kLanes;
+using bluetooth::hci::Octet16;
+
+// BT Spec 5.0 | Vol 3, Part H D.7, little endian: ah(IRK, 0x708194) = 0x0dfbaa
+const Octet16 kSpecIrk{0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34, 0x05, 0xad, 0xc8, 0x57, 0xa3, 0x34, 0x02, 0xec};
+const std::array<uint8_t, 3> kSpecPrand{0x94, 0x81, 0x70};
+const std::array<uint8_t, 3> kSpecHash{0xaa, 0xfb, 0x0d};
+
+std::vector<IrkSet::Implementation> SupportedImplementations() {
+  std::vector<IrkSet::Implementation> implementations{IrkSet::Implementation::kBitsliced};
+  if (IrkSet::IsSupported(IrkSet::Implementation::kHardware)) {
+    implementations.push_back(IrkSet::Implementation::kHardware);
+  }
+  return implementations;
+}
+
+std::vector<Octet16> RandomKeys(size_t count, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<Octet16> keys(count);
+  for (auto& key : keys) {
+    for (auto& byte : key) {
+      byte = distribution(generator);
+    }
+  }
+  return keys;
+}
+
+// aes_128() works on little endian Octet16, the kernels in FIPS-197 byte order
+Octet16 Reversed(const uint8_t bytes[kBlockSize]) {
+  Octet16 reversed;
+  std::reverse_copy(bytes, bytes + kBlockSize, reversed.begin());
+  return reversed;
+}
+
+TEST(AesKernelsTest, fips_197_example) {
+  // FIPS-197 Appendix C.1
+  const uint8_t key[kBlockSize] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+  const uint8_t plaintext[kBlockSize] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                         0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+  const uint8_t ciphertext[kBlockSize] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+                                          0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+  aes_kernels::BitslicedKeys bitsliced_keys;
+  aes_kernels::BitslicedExpandKey(key, &bitsliced_keys);
+  uint8_t in[kLanes][kBlockSize];
+  uint8_t out[kLanes][kBlockSize];
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    std::copy(plaintext, plaintext + kBlockSize, in[lane]);
+  }
+  aes_kernels::BitslicedEncrypt(bitsliced_keys, in, out);
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    EXPECT_TRUE(std::equal(out[lane], out[lane] + kBlockSize, ciphertext)) << "lane " << lane;
+  }
+
+  aes_kernels::RoundKeys round_keys;
+  aes_kernels::ExpandKey(key, &round_keys);
+  // FIPS-197 Appendix C.1, round[10].k_sch
+  const uint8_t last_round_key[kBlockSize] = {0x13, 0x11, 0x1d, 0x7f, 0xe3, 0x94, 0x4a, 0x17,
+                                              0xf3, 0x07, 0xa7, 0x8b, 0x4d, 0x2b, 0x30, 0xc5};
+  EXPECT_TRUE(std::equal(last_round_key, last_round_key + kBlockSize, round_keys.end() - kBlockSize));
+
+  if (aes_kernels::HardwareSupported()) {
+    uint8_t hardware_out[1][kBlockSize];
+    aes_kernels::HardwareEncrypt(&round_keys, 1, plaintext, hardware_out);
+    EXPECT_TRUE(std::equal(hardware_out[0], hardware_out[0] + kBlockSize, ciphertext));
+  }
+}
+
+TEST(AesKernelsTest, kernels_match_aes_128) {
+  auto keys = RandomKeys(64, 1);
+  auto plaintexts = RandomKeys(64, 2);
+
+  for (size_t first = 0; first < keys.size(); first += kLanes) {
+    aes_kernels::BitslicedKeys bitsliced_keys;
+    uint8_t in[kLanes][kBlockSize];
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      uint8_t key[kBlockSize];
+      std::reverse_copy(keys[first + lane].begin(), keys[first + lane].end(), key);
+      aes_kernels::BitslicedKeys expanded;
+      aes_kernels::BitslicedExpandKey(key, &expanded);
+      aes_kernels::BitslicedCopyLane(expanded, lane, &bitsliced_keys, lane);
+      std::reverse_copy(plaintexts[first + lane].begin(), plaintexts[first + lane].end(), in[lane]);
+    }
+
+    uint8_t out[kLanes][kBlockSize];
+    aes_kernels::BitslicedEncrypt(bitsliced_keys, in, out);
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      EXPECT_EQ(Reversed(out[lane]), aes_128(keys[first + lane], plaintexts[first + lane])) << "key " << first + lane;
+    }
+  }
+
+  if (!aes_kernels::HardwareSupported()) {
+    return;
+  }
+  // One plaintext under 61 keys, so that both the interleaved and the single block paths are used
+  constexpr size_t kNumKeys = 61;
+  std::vector<aes_kernels::RoundKeys> round_keys(kNumKeys);
+  for (size_t i = 0; i < round_keys.size(); i++) {
+    uint8_t key[kBlockSize];
+    std::reverse_copy(keys[i].begin(), keys[i].end(), key);
+    aes_kernels::ExpandKey(key, &round_keys[i]);
+  }
+  uint8_t in[kBlockSize];
+  std::reverse_copy(plaintexts[0].begin(), plaintexts[0].end(), in);
+  uint8_t out[kNumKeys][kBlockSize];
+  aes_kernels::HardwareEncrypt(round_keys.data(), kNumKeys, in, out);
+  for (size_t i = 0; i < round_keys.size(); i++) {
+    EXPECT_EQ(Reversed(out[i]), aes_128(keys[i], plaintexts[0])) << "key " << i;
+  }
+}
+
+TEST(IrkSetTest, bt_spec_example_d_7) {
+  for (auto implementation : SupportedImplementations()) {
+    IrkSet irks(implementation);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 0u);
+
+    irks.Add(kSpecIrk);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 0u);
+    EXPECT_EQ(irks.Find(kSpecPrand, {0xab, 0xfb, 0x0d}), 1u);
+    EXPECT_EQ(irks.Find({0x95, 0x81, 0x70}, kSpecHash), 1u);
+  }
+}
+
+TEST(IrkSetTest, find_among_many_keys) {
+  auto keys = RandomKeys(1000, 3);
+  for (auto implementation : SupportedImplementations()) {
+    for (size_t position : {0, 1, 3, 4, 31, 32, 33, 517, 999}) {
+      IrkSet irks(implementation);
+      for (size_t i = 0; i < keys.size(); i++) {
+        irks.Add(i == position ? kSpecIrk : keys[i]);
+      }
+      ASSERT_EQ(irks.Size(), keys.size());
+      EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), position);
+      EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash, position), position);
+      EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash, position + 1), keys.size());
+    }
+  }
+}
+
+TEST(IrkSetTest, first_match_from_start) {
+  for (auto implementation : SupportedImplementations()) {
+    IrkSet irks(implementation);
+    auto keys = RandomKeys(10, 4);
+    for (size_t i = 0; i < keys.size(); i++) {
+      irks.Add((i == 2 || i == 6) ? kSpecIrk : keys[i]);
+    }
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 2u);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash, 3), 6u);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash, 7), 10u);
+  }
+}
+
+TEST(IrkSetTest, remove_moves_last_key) {
+  for (auto implementation : SupportedImplementations()) {
+    IrkSet irks(implementation);
+    auto keys = RandomKeys(9, 5);
+    for (const auto& key : keys) {
+      irks.Add(key);
+    }
+    irks.Add(kSpecIrk);
+    ASSERT_EQ(irks.Find(kSpecPrand, kSpecHash), 9u);
+
+    irks.Remove(1);
+    EXPECT_EQ(irks.Size(), 9u);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 1u);
+
+    // Removing the last key leaves the others in place
+    irks.Remove(8);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 1u);
+
+    irks.Remove(1);
+    EXPECT_EQ(irks.Size(), 7u);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 7u);
+
+    irks.Add(kSpecIrk);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 7u);
+
+    irks.Clear();
+    EXPECT_EQ(irks.Size(), 0u);
+    EXPECT_EQ(irks.Find(kSpecPrand, kSpecHash), 0u);
+  }
+}
+
+}  // namespace
+}  // namespace crypto_toolbox
@@ -0,0 +1,453 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/p256.h"
+
+#include <array>
+
+namespace crypto_toolbox {
+namespace p256 {
+
+namespace {
+
+// Field elements are in Montgomery form, a * 2^256 mod p, in four little endian 64-bit limbs
+constexpr size_t kLimbs = 4;
+using Fe = std::array<uint64_t, kLimbs>;
+
+// p = 2^256 - 2^224 + 2^192 + 2^96 - 1. Since p = -1 mod 2^64, the Montgomery factor -p^-1 mod 2^64 is 1.
+constexpr Fe kP = {0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001};
+// 2^512 mod p, to convert into Montgomery form
+constexpr Fe kRR = {0x0000000000000003, 0xfffffffbffffffff, 0xfffffffffffffffe, 0x00000004fffffffd};
+// 1 and the coefficient b of the curve, in Montgomery form
+constexpr Fe kOne = {0x0000000000000001, 0xffffffff00000000, 0xffffffffffffffff, 0x00000000fffffffe};
+constexpr Fe kB = {0xd89cdf6229c4bddf, 0xacf005cd78843090, 0xe5a220abf7212ed6, 0xdc30061d04874834};
+
+// Base point G, as in curve_p256
+constexpr uint32_t kGx[kWords] = {
+    0xd898c296, 0xf4a13945, 0x2deb33a0, 0x77037d81, 0x63a440f2, 0xf8bce6e5, 0xe12c4247, 0x6b17d1f2};
+constexpr uint32_t kGy[kWords] = {
+    0x37bf51f5, 0xcbb64068, 0x6b315ece, 0x2bce3357, 0x7c0f9e16, 0x8ee7eb4a, 0xfe1a7f9b, 0x4fe342e2};
+
+// a * b + c + d, which does not overflow 128 bits
+inline uint64_t MulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t* high) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 product = static_cast<unsigned __int128>(a) * b + c + d;
+  *high = static_cast<uint64_t>(product >> 64);
+  return static_cast<uint64_t>(product);
+#else
+  uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+  uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+  uint64_t low_low = a_low * b_low;
+  uint64_t low_high = a_low * b_high;
+  uint64_t high_low = a_high * b_low;
+  uint64_t middle = (low_low >> 32) + (low_high & 0xffffffff) + (high_low & 0xffffffff);
+  uint64_t low = (low_low & 0xffffffff) | (middle << 32);
+  uint64_t result_high = a_high * b_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+  low += c;
+  result_high += low < c;
+  low += d;
+  result_high += low < d;
+  *high = result_high;
+  return low;
+#endif
+}
+
+inline uint64_t AddCarry(uint64_t a, uint64_t b, uint64_t carry_in, uint64_t* carry_out) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 sum = static_cast<unsigned __int128>(a) + b + carry_in;
+  *carry_out = static_cast<uint64_t>(sum >> 64);
+  return static_cast<uint64_t>(sum);
+#else
+  uint64_t sum = a + carry_in;
+  uint64_t carry = sum < carry_in;
+  sum += b;
+  *carry_out = carry | (sum < b);
+  return sum;
+#endif
+}
+
+inline uint64_t SubBorrow(uint64_t a, uint64_t b, uint64_t borrow_in, uint64_t* borrow_out) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 difference = static_cast<unsigned __int128>(a) - b - borrow_in;
+  *borrow_out = static_cast<uint64_t>(difference >> 64) & 1;
+  return static_cast<uint64_t>(difference);
+#else
+  uint64_t difference = a - b;
+  uint64_t borrow = a < b;
+  *borrow_out = borrow | (difference < borrow_in);
+  return difference - borrow_in;
+#endif
+}
+
+// r = (top * 2^256 + a) mod p, for a value below 2p. The limbs are spelled out, as in the rest of the field
+// arithmetic, so that they stay in registers.
+inline void ReduceOnce(Fe& r, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3, uint64_t top) {
+  uint64_t borrow;
+  uint64_t d0 = SubBorrow(a0, kP[0], 0, &borrow);
+  uint64_t d1 = SubBorrow(a1, kP[1], borrow, &borrow);
+  uint64_t d2 = SubBorrow(a2, kP[2], borrow, &borrow);
+  uint64_t d3 = SubBorrow(a3, kP[3], borrow, &borrow);
+  // Keep |a| when a - p borrows out of the top limb
+  uint64_t keep = 0 - (borrow & (top ^ 1));
+  r[0] = (a0 & keep) | (d0 & ~keep);
+  r[1] = (a1 & keep) | (d1 & ~keep);
+  r[2] = (a2 & keep) | (d2 & ~keep);
+  r[3] = (a3 & keep) | (d3 & ~keep);
+}
+
+void FieldAdd(Fe& r, const Fe& a, const Fe& b) {
+  uint64_t carry;
+  uint64_t s0 = AddCarry(a[0], b[0], 0, &carry);
+  uint64_t s1 = AddCarry(a[1], b[1], carry, &carry);
+  uint64_t s2 = AddCarry(a[2], b[2], carry, &carry);
+  uint64_t s3 = AddCarry(a[3], b[3], carry, &carry);
+  ReduceOnce(r, s0, s1, s2, s3, carry);
+}
+
+void FieldSub(Fe& r, const Fe& a, const Fe& b) {
+  uint64_t borrow;
+  uint64_t d0 = SubBorrow(a[0], b[0], 0, &borrow);
+  uint64_t d1 = SubBorrow(a[1], b[1], borrow, &borrow);
+  uint64_t d2 = SubBorrow(a[2], b[2], borrow, &borrow);
+  uint64_t d3 = SubBorrow(a[3], b[3], borrow, &borrow);
+  // Add p back when a < b
+  uint64_t mask = 0 - borrow;
+  uint64_t carry;
+  r[0] = AddCarry(d0, kP[0] & mask, 0, &carry);
+  r[1] = AddCarry(d1, kP[1] & mask, carry, &carry);
+  r[2] = AddCarry(d2, kP[2] & mask, carry, &carry);
+  r[3] = AddCarry(d3, kP[3] & mask, carry, &carry);
+}
+
+// One row of the Montgomery multiplication: t = (t + a * b + m * p) / 2^64, with m chosen so that the division is
+// exact. Since -p^-1 = 1 mod 2^64, m is the low limb of t + a * b, and the shape of p leaves two multiplications.
+inline void MulRow(uint64_t t[kLimbs + 1], const Fe& a, uint64_t b) {
+  uint64_t carry, top;
+  uint64_t t0 = MulAdd(a[0], b, t[0], 0, &carry);
+  uint64_t t1 = MulAdd(a[1], b, t[1], carry, &carry);
+  uint64_t t2 = MulAdd(a[2], b, t[2], carry, &carry);
+  uint64_t t3 = MulAdd(a[3], b, t[3], carry, &carry);
+  uint64_t t4 = AddCarry(t[4], carry, 0, &top);
+
+  // t0 + m * p[0] = m * 2^64, which carries m into the next limb, and p[2] = 0
+  uint64_t m = t0;
+  t[0] = MulAdd(m, kP[1], t1, m, &carry);
+  t[1] = AddCarry(t2, carry, 0, &carry);
+  t[2] = MulAdd(m, kP[3], t3, carry, &carry);
+  t[3] = AddCarry(t4, carry, 0, &carry);
+  t[4] = top + carry;
+}
+
+// Montgomery multiplication, r = a * b / 2^256 mod p
+void FieldMul(Fe& r, const Fe& a, const Fe& b) {
+  uint64_t t[kLimbs + 1] = {};
+  MulRow(t, a, b[0]);
+  MulRow(t, a, b[1]);
+  MulRow(t, a, b[2]);
+  MulRow(t, a, b[3]);
+  ReduceOnce(r, t[0], t[1], t[2], t[3], t[4]);
+}
+
+void FieldSquare(Fe& r, const Fe& a) {
+  FieldMul(r, a, a);
+}
+
+// r = a^-1 = a^(p - 2), with a fixed sequence of squarings and multiplications
+void FieldInvert(Fe& r, const Fe& a) {
+  // a^(2^n - 1) for the runs of ones of p - 2 = 2^256 - 2^224 + 2^192 + 2^96 - 3
+  Fe x2, x3, x6, x12, x15, x30, x32, t;
+  FieldSquare(t, a);
+  FieldMul(x2, t, a);
+  FieldSquare(t, x2);
+  FieldMul(x3, t, a);
+  t = x3;
+  for (int i = 0; i < 3; i++) FieldSquare(t, t);
+  FieldMul(x6, t, x3);
+  t = x6;
+  for (int i = 0; i < 6; i++) FieldSquare(t, t);
+  FieldMul(x12, t, x6);
+  t = x12;
+  for (int i = 0; i < 3; i++) FieldSquare(t, t);
+  FieldMul(x15, t, x3);
+  t = x15;
+  for (int i = 0; i < 15; i++) FieldSquare(t, t);
+  FieldMul(x30, t, x15);
+  t = x30;
+  for (int i = 0; i < 2; i++) FieldSquare(t, t);
+  FieldMul(x32, t, x2);
+
+  // 0xffffffff 00000001 00000000 00000000 00000000 ffffffff ffffffff fffffffd
+  t = x32;
+  for (int i = 0; i < 32; i++) FieldSquare(t, t);
+  FieldMul(t, t, a);
+  for (int i = 0; i < 128; i++) FieldSquare(t, t);
+  FieldMul(t, t, x32);
+  for (int i = 0; i < 32; i++) FieldSquare(t, t);
+  FieldMul(t, t, x32);
+  for (int i = 0; i < 30; i++) FieldSquare(t, t);
+  FieldMul(t, t, x30);
+  for (int i = 0; i < 2; i++) FieldSquare(t, t);
+  FieldMul(r, t, a);
+}
+
+void FromWords(Fe& r, const uint32_t words[kWords]) {
+  for (size_t i = 0; i < kLimbs; i++) {
+    r[i] = words[2 * i] | (static_cast<uint64_t>(words[2 * i + 1]) << 32);
+  }
+}
+
+void ToWords(uint32_t words[kWords], const Fe& a) {
+  for (size_t i = 0; i < kLimbs; i++) {
+    words[2 * i] = static_cast<uint32_t>(a[i]);
+    words[2 * i + 1] = static_cast<uint32_t>(a[i] >> 32);
+  }
+}
+
+// Projective coordinates (X : Y : Z), with x = X / Z and y = Y / Z. The point at infinity is (0 : 1 : 0).
+struct ProjectivePoint {
+  Fe x, y, z;
+};
+
+constexpr ProjectivePoint kInfinity = {{}, kOne, {}};
+
+// Complete formulas for a = -3 of Renes, Costello and Batina, "Complete addition formulas for prime order elliptic
+// curves" (2016), algorithms 4 and 6. They have no special cases: infinity and doublings go through the same
+// operations, which keeps the scalar multiplications constant time.
+void PointAdd(ProjectivePoint& r, const ProjectivePoint& p, const ProjectivePoint& q) {
+  Fe t0, t1, t2, t3, t4, x3, y3, z3;
+  FieldMul(t0, p.x, q.x);
+  FieldMul(t1, p.y, q.y);
+  FieldMul(t2, p.z, q.z);
+  FieldAdd(t3, p.x, p.y);
+  FieldAdd(t4, q.x, q.y);
+  FieldMul(t3, t3, t4);
+  FieldAdd(t4, t0, t1);
+  FieldSub(t3, t3, t4);
+  FieldAdd(t4, p.y, p.z);
+  FieldAdd(x3, q.y, q.z);
+  FieldMul(t4, t4, x3);
+  FieldAdd(x3, t1, t2);
+  FieldSub(t4, t4, x3);
+  FieldAdd(x3, p.x, p.z);
+  FieldAdd(y3, q.x, q.z);
+  FieldMul(x3, x3, y3);
+  FieldAdd(y3, t0, t2);
+  FieldSub(y3, x3, y3);
+  FieldMul(z3, kB, t2);
+  FieldSub(x3, y3, z3);
+  FieldAdd(z3, x3, x3);
+  FieldAdd(x3, x3, z3);
+  FieldSub(z3, t1, x3);
+  FieldAdd(x3, t1, x3);
+  FieldMul(y3, kB, y3);
+  FieldAdd(t1, t2, t2);
+  FieldAdd(t2, t1, t2);
+  FieldSub(y3, y3, t2);
+  FieldSub(y3, y3, t0);
+  FieldAdd(t1, y3, y3);
+  FieldAdd(y3, t1, y3);
+  FieldAdd(t1, t0, t0);
+  FieldAdd(t0, t1, t0);
+  FieldSub(t0, t0, t2);
+  FieldMul(t1, t4, y3);
+  FieldMul(t2, t0, y3);
+  FieldMul(y3, x3, z3);
+  FieldAdd(y3, y3, t2);
+  FieldMul(x3, t3, x3);
+  FieldSub(x3, x3, t1);
+  FieldMul(z3, t4, z3);
+  FieldMul(t1, t3, t0);
+  FieldAdd(z3, z3, t1);
+  r.x = x3;
+  r.y = y3;
+  r.z = z3;
+}
+
+void PointDouble(ProjectivePoint& r, const ProjectivePoint& p) {
+  Fe t0, t1, t2, t3, x3, y3, z3;
+  FieldSquare(t0, p.x);
+  FieldSquare(t1, p.y);
+  FieldSquare(t2, p.z);
+  FieldMul(t3, p.x, p.y);
+  FieldAdd(t3, t3, t3);
+  FieldMul(z3, p.x, p.z);
+  FieldAdd(z3, z3, z3);
+  FieldMul(y3, kB, t2);
+  FieldSub(y3, y3, z3);
+  FieldAdd(x3, y3, y3);
+  FieldAdd(y3, x3, y3);
+  FieldSub(x3, t1, y3);
+  FieldAdd(y3, t1, y3);
+  FieldMul(y3, x3, y3);
+  FieldMul(x3, x3, t3);
+  FieldAdd(t3, t2, t2);
+  FieldAdd(t2, t2, t3);
+  FieldMul(z3, kB, z3);
+  FieldSub(z3, z3, t2);
+  FieldSub(z3, z3, t0);
+  FieldAdd(t3, z3, z3);
+  FieldAdd(z3, z3, t3);
+  FieldAdd(t3, t0, t0);
+  FieldAdd(t0, t3, t0);
+  FieldSub(t0, t0, t2);
+  FieldMul(t0, t0, z3);
+  FieldAdd(y3, y3, t0);
+  FieldMul(t0, p.y, p.z);
+  FieldAdd(t0, t0, t0);
+  FieldMul(z3, t0, z3);
+  FieldSub(x3, x3, z3);
+  FieldMul(z3, t0, t1);
+  FieldAdd(z3, z3, z3);
+  FieldAdd(z3, z3, z3);
+  r.x = x3;
+  r.y = y3;
+  r.z = z3;
+}
+
+// 16 points indexed by 4 bits of the scalar
+constexpr size_t kTableSize = 16;
+using Table = std::array<ProjectivePoint, kTableSize>;
+
+// r = table[index], reading every entry so that the memory accesses do not depend on |index|
+void Select(ProjectivePoint& r, const Table& table, uint32_t index) {
+  r = {};
+  for (uint32_t i = 0; i < kTableSize; i++) {
+    uint64_t difference = i ^ index;
+    // All ones when |difference| is 0
+    uint64_t mask = ((difference | (0 - difference)) >> 63) - 1;
+    for (size_t j = 0; j < kLimbs; j++) {
+      r.x[j] |= table[i].x[j] & mask;
+      r.y[j] |= table[i].y[j] & mask;
+      r.z[j] |= table[i].z[j] & mask;
+    }
+  }
+}
+
+uint32_t Bit(const uint32_t k[kWords], size_t i) {
+  return (k[i / 32] >> (i % 32)) & 1;
+}
+
+ProjectivePoint FromAffine(const uint32_t x[kWords], const uint32_t y[kWords]) {
+  ProjectivePoint p;
+  FromWords(p.x, x);
+  FromWords(p.y, y);
+  FieldMul(p.x, p.x, kRR);
+  FieldMul(p.y, p.y, kRR);
+  p.z = kOne;
+  return p;
+}
+
+// Infinity has Z = 0, which inverts to 0 and gives (0, 0)
+void ToAffine(uint32_t x[kWords], uint32_t y[kWords], const ProjectivePoint& p) {
+  const Fe kOneStandard = {1, 0, 0, 0};
+  Fe z_inverse, affine;
+  FieldInvert(z_inverse, p.z);
+  FieldMul(affine, p.x, z_inverse);
+  FieldMul(affine, affine, kOneStandard);
+  ToWords(x, affine);
+  FieldMul(affine, p.y, z_inverse);
+  FieldMul(affine, affine, kOneStandard);
+  ToWords(y, affine);
+}
+
+// Fixed base comb with kCombs combs of kTeeth teeth: bit j + kSpacing * (comb + kCombs * tooth) of the scalar selects
+// 2^(kSpacing * (comb + kCombs * tooth)) * G in the table of |comb|. Each of the kSpacing steps takes one doubling and
+// kCombs additions, against four doublings and one addition per 4 bits for an arbitrary point.
+constexpr size_t kTeeth = 4;
+constexpr size_t kCombs = 2;
+constexpr size_t kSpacing = 256 / (kTeeth * kCombs);
+
+using BaseTables = std::array<Table, kCombs>;
+
+BaseTables BuildBaseTables() {
+  // 2^(kSpacing * i) * G
+  ProjectivePoint multiples[kTeeth * kCombs];
+  multiples[0] = FromAffine(kGx, kGy);
+  for (size_t i = 1; i < kTeeth * kCombs; i++) {
+    multiples[i] = multiples[i - 1];
+    for (size_t j = 0; j < kSpacing; j++) {
+      PointDouble(multiples[i], multiples[i]);
+    }
+  }
+
+  BaseTables tables;
+  for (size_t comb = 0; comb < kCombs; comb++) {
+    tables[comb][0] = kInfinity;
+    for (size_t index = 1; index < kTableSize; index++) {
+      // Add the tooth of the highest bit of |index| to the entry without it
+      size_t tooth = 0;
+      while ((index >> (tooth + 1)) != 0) tooth++;
+      PointAdd(tables[comb][index], tables[comb][index ^ (1u << tooth)], multiples[comb + kCombs * tooth]);
+    }
+  }
+  return tables;
+}
+
+}  // namespace
+
+void ScalarMultBase(const uint32_t k[kWords], uint32_t x[kWords], uint32_t y[kWords]) {
+  static const BaseTables tables = BuildBaseTables();
+
+  ProjectivePoint q = kInfinity;
+  ProjectivePoint entry;
+  for (size_t j = kSpacing; j-- > 0;) {
+    PointDouble(q, q);
+    for (size_t comb = 0; comb < kCombs; comb++) {
+      uint32_t index = 0;
+      for (size_t tooth = 0; tooth < kTeeth; tooth++) {
+        index |= Bit(k, j + kSpacing * (comb + kCombs * tooth)) << tooth;
+      }
+      Select(entry, tables[comb], index);
+      PointAdd(q, q, entry);
+    }
+  }
+  ToAffine(x, y, q);
+}
+
+void ScalarMult(
+    const uint32_t k[kWords],
+    const uint32_t px[kWords],
+    const uint32_t py[kWords],
+    uint32_t x[kWords],
+    uint32_t y[kWords]) {
+  // table[i] = i * P
+  Table table;
+  table[0] = kInfinity;
+  table[1] = FromAffine(px, py);
+  for (size_t i = 2; i < kTableSize; i++) {
+    if (i % 2 == 0) {
+      PointDouble(table[i], table[i / 2]);
+    } else {
+      PointAdd(table[i], table[i - 1], table[1]);
+    }
+  }
+
+  // Fixed window of 4 bits, from the most significant one
+  ProjectivePoint q = kInfinity;
+  ProjectivePoint entry;
+  for (size_t window = 256 / 4; window-- > 0;) {
+    for (int i = 0; i < 4; i++) {
+      PointDouble(q, q);
+    }
+    uint32_t index = (k[window / 8] >> (4 * (window % 8))) & 0xf;
+    Select(entry, table, index);
+    PointAdd(q, q, entry);
+  }
+  ToAffine(x, y, q);
+}
+
+}  // namespace p256
+}  // namespace crypto_toolbox
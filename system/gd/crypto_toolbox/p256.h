@@ -0,0 +1,45 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto_toolbox {
+namespace p256 {
+
+// Point multiplication on the P-256 curve of LE Secure Connections (BT Spec 5.1 Vol 2, Part H 7.6), in constant time:
+// the sequence of operations and of memory accesses does not depend on the scalar.
+//
+// Scalars and coordinates are 256-bit integers in kWords little endian 32-bit words, as in the Point of the SMP
+// implementations. Points are affine, the point at infinity is (0, 0).
+
+constexpr size_t kWords = 8;
+
+// (x, y) = k * G, with a table of multiples of the base point G that is built on first use
+void ScalarMultBase(const uint32_t k[kWords], uint32_t x[kWords], uint32_t y[kWords]);
+
+// (x, y) = k * (px, py). The point must be on the curve, which the callers check with ECC_ValidatePoint().
+void ScalarMult(
+    const uint32_t k[kWords],
+    const uint32_t px[kWords],
+    const uint32_t py[kWords],
+    uint32_t x[kWords],
+    uint32_t y[kWords]);
+
+}  // namespace p256
+}  // namespace crypto_toolbox
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "crypto_toolbox/p256.h"
+
+using ::benchmark::State;
+using ::crypto_toolbox::p256::kWords;
+
+namespace {
+
+const uint32_t kPrivateKey[kWords] = {
+    0x322ac83e, 0xba7675b3, 0x7bb4b87d, 0xc3a38aa0, 0x531a03f2, 0x322652f6, 0x3f57aeb6, 0x51291513};
+const uint32_t kPeerX[kWords] = {
+    0xfeec1a23, 0x2f20c17d, 0xaa9a3e03, 0x86785599, 0x6837cb58, 0x19ffe17d, 0x7acbf833, 0x730bab17};
+const uint32_t kPeerY[kWords] = {
+    0x42e2254c, 0x3b0e693c, 0x0994efc0, 0xbb963f4d, 0x8155f218, 0xc4de5a71, 0xa96ff93e, 0x864e04af};
+
+// Public key of a key pair, as in GenerateECDHKeyPair()
+void BM_P256_KeyGeneration(State& state) {
+  uint32_t x[kWords], y[kWords];
+  for (auto _ : state) {
+    crypto_toolbox::p256::ScalarMultBase(kPrivateKey, x, y);
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(y);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// DHKey of the peer public key, as in ComputeDHKey()
+void BM_P256_DhKey(State& state) {
+  uint32_t x[kWords], y[kWords];
+  for (auto _ : state) {
+    crypto_toolbox::p256::ScalarMult(kPrivateKey, kPeerX, kPeerY, x, y);
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(y);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_P256_KeyGeneration);
+BENCHMARK(BM_P256_DhKey);
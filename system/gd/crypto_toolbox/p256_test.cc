@@ -0,0 +1,123 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crypto_toolbox/p256.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+
+namespace crypto_toolbox {
+namespace p256 {
+namespace {
+
+using Words = std::array<uint32_t, kWords>;
+
+const Words kZero{};
+const Words kGx{0xd898c296, 0xf4a13945, 0x2deb33a0, 0x77037d81, 0x63a440f2, 0xf8bce6e5, 0xe12c4247, 0x6b17d1f2};
+const Words kGy{0x37bf51f5, 0xcbb64068, 0x6b315ece, 0x2bce3357, 0x7c0f9e16, 0x8ee7eb4a, 0xfe1a7f9b, 0x4fe342e2};
+// Order of G
+const Words kN{0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff};
+
+struct Multiple {
+  Words k;
+  Words x;
+  Words y;
+};
+
+// k * G, computed with affine arithmetic in Python
+const Multiple kMultiples[] = {
+    {{0}, kZero, kZero},
+    {{1}, kGx, kGy},
+    {{2},
+     {0x47669978, 0xa60b48fc, 0x77f21b35, 0xc08969e2, 0x04b51ac3, 0x8a523803, 0x8d034f7e, 0x7cf27b18},
+     {0x227873d1, 0x9e04b79d, 0x3ce98229, 0xba7dade6, 0x9f7430db, 0x293d9ac6, 0xdb8ed040, 0x07775510}},
+    // n - 1, i.e. -G
+    {{0xfc632550, 0xf3b9cac2, 0xa7179e84, 0xbce6faad, 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff},
+     kGx,
+     {0xc840ae0a, 0x3449bf97, 0x94cea131, 0xd431cca9, 0x83f061e9, 0x711814b5, 0x01e58065, 0xb01cbd1c}},
+    {kN, kZero, kZero},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+     {0x9db9d31a, 0x1a3d132b, 0x9c3677cc, 0x2c6102c4, 0x9586eb53, 0x1b102317, 0x0e26c0d2, 0xf72cbd24},
+     {0xa83408a7, 0xe453d93f, 0xcdca831e, 0x23250ef0, 0xbfe7a5d2, 0xdc0dbd91, 0xe2a36621, 0x43e4ca77}},
+    // The key pair A of EcdhKeysTest.test_static
+    {{0x322ac83e, 0xba7675b3, 0x7bb4b87d, 0xc3a38aa0, 0x531a03f2, 0x322652f6, 0x3f57aeb6, 0x51291513},
+     {0xe5d088dc, 0x41f27359, 0x45b46c88, 0x103b618b, 0x5bd2d4f5, 0x947fa14e, 0xf838a9e3, 0x1098d484},
+     {0x4f76133d, 0xec6e29d1, 0x3370f68d, 0xea18a78b, 0x8ce81584, 0x4576c84a, 0x52ba9890, 0xaf69008b}},
+};
+
+Words RandomScalar(std::mt19937& generator) {
+  Words k;
+  for (auto& word : k) {
+    word = generator();
+  }
+  return k;
+}
+
+TEST(P256Test, base_point_multiples) {
+  for (const auto& multiple : kMultiples) {
+    Words x, y;
+    ScalarMultBase(multiple.k.data(), x.data(), y.data());
+    EXPECT_EQ(x, multiple.x);
+    EXPECT_EQ(y, multiple.y);
+
+    ScalarMult(multiple.k.data(), kGx.data(), kGy.data(), x.data(), y.data());
+    EXPECT_EQ(x, multiple.x);
+    EXPECT_EQ(y, multiple.y);
+  }
+}
+
+TEST(P256Test, dhkey) {
+  // EcdhKeysTest.test_static: the private key A with the public key B
+  const Words private_key{
+      0x322ac83e, 0xba7675b3, 0x7bb4b87d, 0xc3a38aa0, 0x531a03f2, 0x322652f6, 0x3f57aeb6, 0x51291513};
+  const Words public_x{0xfeec1a23, 0x2f20c17d, 0xaa9a3e03, 0x86785599, 0x6837cb58, 0x19ffe17d, 0x7acbf833, 0x730bab17};
+  const Words public_y{0x42e2254c, 0x3b0e693c, 0x0994efc0, 0xbb963f4d, 0x8155f218, 0xc4de5a71, 0xa96ff93e, 0x864e04af};
+  const Words dhkey{0x33dff83b, 0x55669499, 0x784a2c4f, 0x49d1512b, 0x6396f10f, 0x659e7551, 0x77fe3c7f, 0x937a3fb4};
+
+  Words x, y;
+  ScalarMult(private_key.data(), public_x.data(), public_y.data(), x.data(), y.data());
+  EXPECT_EQ(x, dhkey);
+}
+
+TEST(P256Test, random_scalars) {
+  std::mt19937 generator(1);
+  for (int i = 0; i < 20; i++) {
+    Words a = RandomScalar(generator);
+    Words b = RandomScalar(generator);
+
+    Words a_x, a_y, b_x, b_y;
+    ScalarMultBase(a.data(), a_x.data(), a_y.data());
+    ScalarMultBase(b.data(), b_x.data(), b_y.data());
+
+    Words x, y;
+    ScalarMult(a.data(), kGx.data(), kGy.data(), x.data(), y.data());
+    EXPECT_EQ(x, a_x);
+    EXPECT_EQ(y, a_y);
+
+    // Both sides of a key exchange agree
+    Words ab_x, ab_y, ba_x, ba_y;
+    ScalarMult(b.data(), a_x.data(), a_y.data(), ab_x.data(), ab_y.data());
+    ScalarMult(a.data(), b_x.data(), b_y.data(), ba_x.data(), ba_y.data());
+    EXPECT_EQ(ab_x, ba_x);
+    EXPECT_EQ(ab_y, ba_y);
+  }
+}
+
+}  // namespace
+}  // namespace p256
+}  // namespace crypto_toolbox
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/ranging_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kLanes = ChannelSoundingEstimator::kLanes;
+
+// Steps of a procedure, which the buffers are reserved for
+constexpr size_t kReservedSteps = 256;
+// With fewer tones, the delay spectrum has no meaningful peak
+constexpr size_t kMinTones = 8;
+// Points of the fine search on each side of the coarse peak, which cover one coarse step
+constexpr size_t kFineSteps = 16;
+// Phase based distances this close below kAmbiguityMeters are taken as small negative ones, which noise and
+// uncalibrated antenna delays produce at short range
+constexpr double kMaxNegativeMeters = 10.0;
+
+// ToA_ToD_Initiator and ToD_ToA_Reflector are in units of 0.5 ns, and the distance is half of the round trip
+constexpr double kMetersPerRttUnit = ChannelSoundingEstimator::kSpeedOfLight * 0.5e-9 / 2;
+// Deviation of the round trip distances at which the confidence of an estimate without tones drops to 0
+constexpr double kMaxRttDeviationMeters = 10.0;
+
+size_t PaddedSize(size_t size) {
+  return (size + kLanes - 1) / kLanes * kLanes;
+}
+
+size_t NumCoarsePoints() {
+  return static_cast<size_t>(
+      std::ceil(ChannelSoundingEstimator::kAmbiguityMeters / ChannelSoundingEstimator::kCoarseStepMeters));
+}
+
+// Weight of a tone from its Tone_Quality_Indicator: high, medium, low and unavailable
+float ToneWeight(uint8_t tone_quality_indicator) {
+  switch (tone_quality_indicator & 0x3) {
+    case 0:
+      return 1.0f;
+    case 1:
+      return 0.5f;
+    default:
+      return 0.0f;
+  }
+}
+
+size_t MaxIndex(const float* values, size_t size) {
+  return std::max_element(values, values + size) - values;
+}
+
+}  // namespace
+
+ChannelSoundingEstimator::ChannelSoundingEstimator() : coarse_power_(NumCoarsePoints()) {
+  for (auto* buffer :
+       {&frequency_mhz_,
+        &tone_real_,
+        &tone_imag_,
+        &weight_,
+        &rotation_real_,
+        &rotation_imag_,
+        &step_real_,
+        &step_imag_,
+        &round_trip_meters_}) {
+    buffer->reserve(kReservedSteps);
+  }
+}
+
+bool ChannelSoundingEstimator::Estimate(const ChannelSoundingRawData& raw_data, RangingResult* result) {
+  double rtt_meters = 0;
+  double rtt_deviation = 0;
+  bool has_rtt = EstimateRttDistance(raw_data, &rtt_meters, &rtt_deviation);
+
+  size_t num_tones = LoadTones(raw_data);
+  if (num_tones < kMinTones) {
+    if (!has_rtt) {
+      return false;
+    }
+    result->result_meters_ = std::max(0.0, rtt_meters);
+    result->confidence_level_ =
+        static_cast<int8_t>(std::lround(100 * std::max(0.0, 1 - rtt_deviation / kMaxRttDeviationMeters)));
+    return true;
+  }
+
+  double meters = 0;
+  double coherence = 0;
+  EstimatePhaseDistance(num_tones, &meters, &coherence);
+  if (has_rtt) {
+    // The multiple of the ambiguity closest to the round trip distance
+    meters += kAmbiguityMeters * std::round((rtt_meters - meters) / kAmbiguityMeters);
+  } else if (meters > kAmbiguityMeters - kMaxNegativeMeters) {
+    meters -= kAmbiguityMeters;
+  }
+  result->result_meters_ = std::max(0.0, meters);
+  result->confidence_level_ = static_cast<int8_t>(std::lround(100 * coherence));
+  return true;
+}
+
+size_t ChannelSoundingEstimator::LoadTones(const ChannelSoundingRawData& raw_data) {
+  // The PCT after the antenna paths is the one of the tone extension slot, which is not used
+  size_t num_paths = raw_data.num_antenna_paths_;
+  if (num_paths == 0 || raw_data.tone_pct_initiator_.size() < num_paths ||
+      raw_data.tone_pct_reflector_.size() < num_paths ||
+      raw_data.tone_quality_indicator_initiator_.size() < num_paths ||
+      raw_data.tone_quality_indicator_reflector_.size() < num_paths) {
+    return 0;
+  }
+  size_t num_steps = raw_data.tone_pct_initiator_[0].size();
+  for (size_t path = 0; path < num_paths; path++) {
+    num_steps = std::min(
+        {num_steps,
+         raw_data.tone_pct_initiator_[path].size(),
+         raw_data.tone_pct_reflector_[path].size(),
+         raw_data.tone_quality_indicator_initiator_[path].size(),
+         raw_data.tone_quality_indicator_reflector_[path].size()});
+  }
+
+  size_t padded_size = PaddedSize(num_steps);
+  for (auto* buffer :
+       {&frequency_mhz_,
+        &tone_real_,
+        &tone_imag_,
+        &weight_,
+        &rotation_real_,
+        &rotation_imag_,
+        &step_real_,
+        &step_imag_}) {
+    buffer->resize(padded_size);
+  }
+
+  // Tones are reported for the mode 2 and 3 steps only, in the order of the steps
+  size_t num_tones = 0;
+  size_t step = 0;
+  size_t num_modes = std::min(raw_data.step_mode_.size(), raw_data.step_channel_.size());
+  for (size_t i = 0; i < num_modes && step < num_steps; i++) {
+    if (raw_data.step_mode_[i] != 2 && raw_data.step_mode_[i] != 3) {
+      continue;
+    }
+    size_t tone_step = step++;
+
+    // Per step phase correction: the initiator and reflector PCTs are multiplied to cancel the phase of the local
+    // oscillators, and normalized so that the amplitude of the antenna paths does not weigh on the phase
+    double real = 0;
+    double imag = 0;
+    float weight = 0;
+    for (size_t path = 0; path < num_paths; path++) {
+      float path_weight = std::min(
+          ToneWeight(raw_data.tone_quality_indicator_initiator_[path][tone_step]),
+          ToneWeight(raw_data.tone_quality_indicator_reflector_[path][tone_step]));
+      auto product = raw_data.tone_pct_initiator_[path][tone_step] * raw_data.tone_pct_reflector_[path][tone_step];
+      double magnitude = std::abs(product);
+      if (path_weight == 0 || magnitude == 0) {
+        continue;
+      }
+      real += path_weight * product.real() / magnitude;
+      imag += path_weight * product.imag() / magnitude;
+      weight = std::max(weight, path_weight);
+    }
+    double magnitude = std::hypot(real, imag);
+    if (weight == 0 || magnitude == 0) {
+      continue;
+    }
+
+    frequency_mhz_[num_tones] = raw_data.step_channel_[i];
+    tone_real_[num_tones] = static_cast<float>(weight * real / magnitude);
+    tone_imag_[num_tones] = static_cast<float>(weight * imag / magnitude);
+    weight_[num_tones] = weight;
+    num_tones++;
+  }
+
+  for (size_t i = num_tones; i < PaddedSize(num_tones); i++) {
+    frequency_mhz_[i] = 0;
+    tone_real_[i] = 0;
+    tone_imag_[i] = 0;
+    weight_[i] = 0;
+  }
+  return num_tones;
+}
+
+void ChannelSoundingEstimator::EstimatePhaseDistance(size_t num_tones, double* meters, double* coherence) {
+  DelaySpectrum(num_tones, 0, kCoarseStepMeters, coarse_power_.size(), coarse_power_.data());
+  size_t coarse_peak = MaxIndex(coarse_power_.data(), coarse_power_.size());
+
+  // The main lobe is about 2 m wide, so the coarse peak is within a coarse step of the true one
+  constexpr size_t kNumFinePoints = 2 * kFineSteps + 1;
+  float fine_power[kNumFinePoints];
+  double fine_step = kCoarseStepMeters / kFineSteps;
+  double start = (static_cast<double>(coarse_peak) - 1) * kCoarseStepMeters;
+  DelaySpectrum(num_tones, start, fine_step, kNumFinePoints, fine_power);
+  size_t fine_peak = MaxIndex(fine_power, kNumFinePoints);
+
+  // Parabolic interpolation around the fine peak
+  double offset = 0;
+  if (fine_peak > 0 && fine_peak < kNumFinePoints - 1) {
+    double before = fine_power[fine_peak - 1];
+    double peak = fine_power[fine_peak];
+    double after = fine_power[fine_peak + 1];
+    double curvature = before - 2 * peak + after;
+    if (curvature < 0) {
+      offset = 0.5 * (before - after) / curvature;
+    }
+  }
+  double distance = std::fmod(start + (fine_peak + offset) * fine_step, kAmbiguityMeters);
+  *meters = distance < 0 ? distance + kAmbiguityMeters : distance;
+
+  // Every tone has the magnitude of its weight, so the spectrum peaks at the sum of the weights when they all agree
+  double total_weight = 0;
+  for (size_t i = 0; i < num_tones; i++) {
+    total_weight += weight_[i];
+  }
+  *coherence = std::min(1.0, std::sqrt(fine_power[fine_peak]) / total_weight);
+}
+
+void ChannelSoundingEstimator::DelaySpectrum(
+    size_t num_tones, double start_meters, double step_meters, size_t num_points, float* power) {
+  size_t padded_size = PaddedSize(num_tones);
+  for (size_t i = 0; i < padded_size; i++) {
+    // The round trip phase of the tone turns by 4 pi f / c per meter; the phase of 2402 MHz is common to all tones
+    double radians_per_meter = 4 * kPi * frequency_mhz_[i] * 1e6 / kSpeedOfLight;
+    rotation_real_[i] = static_cast<float>(std::cos(radians_per_meter * start_meters));
+    rotation_imag_[i] = static_cast<float>(std::sin(radians_per_meter * start_meters));
+    step_real_[i] = static_cast<float>(std::cos(radians_per_meter * step_meters));
+    step_imag_[i] = static_cast<float>(std::sin(radians_per_meter * step_meters));
+  }
+
+  const float* tone_real = tone_real_.data();
+  const float* tone_imag = tone_imag_.data();
+  const float* step_real = step_real_.data();
+  const float* step_imag = step_imag_.data();
+  float* rotation_real = rotation_real_.data();
+  float* rotation_imag = rotation_imag_.data();
+  for (size_t point = 0; point < num_points; point++) {
+    // One partial sum per lane, so that the sums vectorize without reordering the float additions
+    float sum_real[kLanes] = {};
+    float sum_imag[kLanes] = {};
+    for (size_t first = 0; first < padded_size; first += kLanes) {
+      for (size_t lane = 0; lane < kLanes; lane++) {
+        size_t i = first + lane;
+        float real = rotation_real[i];
+        float imag = rotation_imag[i];
+        sum_real[lane] += tone_real[i] * real - tone_imag[i] * imag;
+        sum_imag[lane] += tone_real[i] * imag + tone_imag[i] * real;
+        rotation_real[i] = real * step_real[i] - imag * step_imag[i];
+        rotation_imag[i] = real * step_imag[i] + imag * step_real[i];
+      }
+    }
+    float total_real = 0;
+    float total_imag = 0;
+    for (size_t lane = 0; lane < kLanes; lane++) {
+      total_real += sum_real[lane];
+      total_imag += sum_imag[lane];
+    }
+    power[point] = total_real * total_real + total_imag * total_imag;
+  }
+}
+
+bool ChannelSoundingEstimator::EstimateRttDistance(
+    const ChannelSoundingRawData& raw_data, double* meters, double* deviation) {
+  size_t num_rtts = std::min(raw_data.toa_tod_initiators_.size(), raw_data.tod_toa_reflectors_.size());
+  if (num_rtts == 0) {
+    return false;
+  }
+  round_trip_meters_.resize(num_rtts);
+  for (size_t i = 0; i < num_rtts; i++) {
+    round_trip_meters_[i] =
+        static_cast<float>((raw_data.toa_tod_initiators_[i] - raw_data.tod_toa_reflectors_[i]) * kMetersPerRttUnit);
+  }
+
+  // Medians, which the occasional wrong time of arrival does not move
+  auto middle = round_trip_meters_.begin() + num_rtts / 2;
+  std::nth_element(round_trip_meters_.begin(), middle, round_trip_meters_.end());
+  float median = *middle;
+  for (auto& value : round_trip_meters_) {
+    value = std::abs(value - median);
+  }
+  std::nth_element(round_trip_meters_.begin(), middle, round_trip_meters_.end());
+
+  *meters = median;
+  *deviation = *middle;
+  return true;
+}
+
+}  // namespace hal
+}  // namespace bluetooth
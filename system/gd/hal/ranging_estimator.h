@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "hal/ranging_hal.h"
+
+namespace bluetooth {
+namespace hal {
+
+// Distance estimation from the Channel Sounding data of one procedure, for the hosts without a ranging HAL.
+//
+// Phase based ranging: the product of the initiator and reflector PCTs of a mode 2 or 3 step cancels the phase
+// offset of the local oscillators and leaves the round trip phase -4 pi f d / c. The tones of a procedure are
+// normalized, weighted by their quality indicator, and correlated against the response of every distance (the delay
+// spectrum of an IFFT, at a finer resolution); the strongest peak gives the distance. Tones are 1 MHz apart, so the
+// distance is only known modulo c / 2 MHz, about 150 m, which the round trip times of the mode 1 and 3 steps resolve.
+// They are also the estimate when the procedure has no tones.
+//
+// The per tone data is kept in preallocated structure of arrays float buffers, padded to kLanes, so that the loops
+// over the tones vectorize. The buffers only grow, and a stream of procedures does not allocate.
+class ChannelSoundingEstimator {
+ public:
+  static constexpr double kSpeedOfLight = 299792458.0;
+  // Distance modulo which the phase based estimate is known
+  static constexpr double kAmbiguityMeters = kSpeedOfLight / (2 * 1e6);
+  // Spacing of the coarse delay spectrum
+  static constexpr double kCoarseStepMeters = 0.25;
+  static constexpr size_t kLanes = 8;
+
+  ChannelSoundingEstimator();
+
+  // Returns false when |raw_data| has neither usable tones nor round trip times
+  bool Estimate(const ChannelSoundingRawData& raw_data, RangingResult* result);
+
+ private:
+  // Fill the tone buffers from |raw_data| and return the number of usable tones
+  size_t LoadTones(const ChannelSoundingRawData& raw_data);
+  // Distance in [0, kAmbiguityMeters), and the coherence of the tones at that distance, in [0, 1]
+  void EstimatePhaseDistance(size_t num_tones, double* meters, double* coherence);
+  // Power of the delay spectrum at |num_points| distances from |start_meters|, every |step_meters|
+  void DelaySpectrum(size_t num_tones, double start_meters, double step_meters, size_t num_points, float* power);
+  // Median one way distance of the round trip times, and their median absolute deviation
+  bool EstimateRttDistance(const ChannelSoundingRawData& raw_data, double* meters, double* deviation);
+
+  // One entry per usable tone, padded with zero tones to a multiple of kLanes
+  std::vector<float> frequency_mhz_;  // above 2402 MHz
+  std::vector<float> tone_real_;
+  std::vector<float> tone_imag_;
+  std::vector<float> weight_;
+  // Rotation of each tone at the current distance of DelaySpectrum(), and per step
+  std::vector<float> rotation_real_;
+  std::vector<float> rotation_imag_;
+  std::vector<float> step_real_;
+  std::vector<float> step_imag_;
+
+  std::vector<float> coarse_power_;
+  std::vector<float> round_trip_meters_;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "hal/ranging_estimator.h"
+
+using ::benchmark::State;
+using ::bluetooth::hal::ChannelSoundingEstimator;
+using ::bluetooth::hal::ChannelSoundingRawData;
+using ::bluetooth::hal::RangingResult;
+
+namespace {
+
+// One procedure over the 72 data channels, with a mode 1 step every |rtt_interval| steps
+ChannelSoundingRawData Procedure(uint8_t num_antenna_paths, size_t rtt_interval) {
+  constexpr double kMeters = 4.2;
+  ChannelSoundingRawData raw_data;
+  raw_data.num_antenna_paths_ = num_antenna_paths;
+  raw_data.tone_pct_initiator_.resize(num_antenna_paths + 1);
+  raw_data.tone_pct_reflector_.resize(num_antenna_paths + 1);
+  raw_data.tone_quality_indicator_initiator_.resize(num_antenna_paths + 1);
+  raw_data.tone_quality_indicator_reflector_.resize(num_antenna_paths + 1);
+  for (uint8_t channel = 2; channel <= 76; channel++) {
+    if (channel >= 23 && channel <= 25) {
+      continue;
+    }
+    if (rtt_interval != 0 && channel % rtt_interval == 0) {
+      raw_data.step_mode_.push_back(1);
+      raw_data.step_channel_.push_back(channel);
+      raw_data.toa_tod_initiators_.push_back(static_cast<int16_t>(28 + channel % 3));
+      raw_data.tod_toa_reflectors_.push_back(0);
+    }
+    raw_data.step_mode_.push_back(2);
+    raw_data.step_channel_.push_back(channel);
+    double phase = -2 * M_PI * (2402 + channel) * 1e6 * kMeters / ChannelSoundingEstimator::kSpeedOfLight;
+    for (uint8_t path = 0; path <= num_antenna_paths; path++) {
+      raw_data.tone_pct_initiator_[path].push_back(std::polar(1.0, phase + channel));
+      raw_data.tone_pct_reflector_[path].push_back(std::polar(1.0, phase - channel));
+      raw_data.tone_quality_indicator_initiator_[path].push_back(0);
+      raw_data.tone_quality_indicator_reflector_[path].push_back(0);
+    }
+  }
+  return raw_data;
+}
+
+// Estimate() of one procedure, as RangingHalHost::WriteRawData() does for every completed procedure
+void BM_EstimateProcedure(State& state) {
+  auto raw_data = Procedure(static_cast<uint8_t>(state.range(0)), state.range(1));
+  ChannelSoundingEstimator estimator;
+  RangingResult result;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(estimator.Estimate(raw_data, &result));
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_EstimateProcedure)->ArgNames({"paths", "rtt_interval"})->Args({1, 0})->Args({4, 0})->Args({1, 4});
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/ranging_estimator.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kSpeedOfLight = ChannelSoundingEstimator::kSpeedOfLight;
+
+struct Path {
+  double meters;
+  double amplitude;
+};
+
+struct Channel {
+  std::vector<Path> paths;
+  uint8_t num_antenna_paths = 1;
+  double noise = 0;
+  // Added to the distance seen by the tones, as an uncalibrated antenna delay would
+  double phase_offset_meters = 0;
+  bool with_tones = true;
+  size_t num_rtts = 0;
+  double rtt_noise_meters = 0;
+};
+
+// Channels 2 to 76 without the advertising channels, as in a typical channel map
+std::vector<uint8_t> Channels() {
+  std::vector<uint8_t> channels;
+  for (uint8_t channel = 2; channel <= 76; channel++) {
+    if (channel < 23 || channel > 25) {
+      channels.push_back(channel);
+    }
+  }
+  return channels;
+}
+
+// A procedure of mode 1 steps followed by mode 2 steps, laid out as DistanceMeasurementManager reports it
+ChannelSoundingRawData Procedure(const Channel& channel, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> uniform(0, 2 * kPi);
+  std::normal_distribution<double> normal(0, 1);
+
+  ChannelSoundingRawData raw_data;
+  raw_data.num_antenna_paths_ = channel.num_antenna_paths;
+  raw_data.tone_pct_initiator_.resize(channel.num_antenna_paths + 1);
+  raw_data.tone_pct_reflector_.resize(channel.num_antenna_paths + 1);
+  raw_data.tone_quality_indicator_initiator_.resize(channel.num_antenna_paths + 1);
+  raw_data.tone_quality_indicator_reflector_.resize(channel.num_antenna_paths + 1);
+
+  // Turnaround time of the reflector, in units of 0.5 ns
+  constexpr double kTurnaround = 80000;
+  for (size_t i = 0; i < channel.num_rtts; i++) {
+    double meters = channel.paths[0].meters + channel.rtt_noise_meters * normal(generator);
+    double round_trip = 2 * meters / kSpeedOfLight / 0.5e-9;
+    raw_data.step_mode_.push_back(1);
+    raw_data.step_channel_.push_back(Channels()[i % Channels().size()]);
+    raw_data.toa_tod_initiators_.push_back(static_cast<int16_t>(std::lround(kTurnaround + round_trip) - 60000));
+    raw_data.tod_toa_reflectors_.push_back(static_cast<int16_t>(std::lround(kTurnaround) - 60000));
+  }
+
+  if (!channel.with_tones) {
+    return raw_data;
+  }
+  for (uint8_t channel_index : Channels()) {
+    raw_data.step_mode_.push_back(2);
+    raw_data.step_channel_.push_back(channel_index);
+    double frequency = (2402 + channel_index) * 1e6;
+    // Phase of the local oscillators, which the product of the PCTs cancels
+    double oscillator = uniform(generator);
+    for (uint8_t path = 0; path <= channel.num_antenna_paths; path++) {
+      std::complex<double> one_way = 0;
+      for (const auto& propagation : channel.paths) {
+        double meters = propagation.meters + channel.phase_offset_meters + 0.02 * path;
+        one_way += std::polar(propagation.amplitude, -2 * kPi * frequency * meters / kSpeedOfLight);
+      }
+      std::complex<double> initiator_noise(normal(generator), normal(generator));
+      std::complex<double> reflector_noise(normal(generator), normal(generator));
+      raw_data.tone_pct_initiator_[path].push_back(
+          one_way * std::polar(1.0, oscillator) + channel.noise * initiator_noise);
+      raw_data.tone_pct_reflector_[path].push_back(
+          one_way * std::polar(1.0, -oscillator) + channel.noise * reflector_noise);
+      raw_data.tone_quality_indicator_initiator_[path].push_back(0);
+      raw_data.tone_quality_indicator_reflector_[path].push_back(0);
+    }
+  }
+  return raw_data;
+}
+
+TEST(ChannelSoundingEstimatorTest, single_path) {
+  ChannelSoundingEstimator estimator;
+  for (double meters : {0.5, 3.7, 12.25, 42.0, 120.0}) {
+    RangingResult result;
+    ASSERT_TRUE(estimator.Estimate(Procedure({.paths = {{meters, 1.0}}}, 1), &result));
+    EXPECT_NEAR(result.result_meters_, meters, 0.05);
+    EXPECT_GE(result.confidence_level_, 95);
+  }
+}
+
+TEST(ChannelSoundingEstimatorTest, multipath_and_noise) {
+  ChannelSoundingEstimator estimator;
+  for (uint32_t seed = 0; seed < 10; seed++) {
+    RangingResult result;
+    Channel channel = {.paths = {{5.0, 1.0}, {9.0, 0.3}}, .num_antenna_paths = 2, .noise = 0.1};
+    ASSERT_TRUE(estimator.Estimate(Procedure(channel, seed), &result));
+    EXPECT_NEAR(result.result_meters_, 5.0, 0.5) << "seed " << seed;
+    EXPECT_GT(result.confidence_level_, 0);
+    EXPECT_LT(result.confidence_level_, 100);
+  }
+}
+
+TEST(ChannelSoundingEstimatorTest, round_trip_time_resolves_ambiguity) {
+  ChannelSoundingEstimator estimator;
+  RangingResult result;
+  Channel channel = {.paths = {{170.0, 1.0}}, .num_rtts = 10, .rtt_noise_meters = 3};
+  ASSERT_TRUE(estimator.Estimate(Procedure(channel, 2), &result));
+  EXPECT_NEAR(result.result_meters_, 170.0, 0.05);
+
+  // Without the round trip times, the distance is only known modulo about 150 m
+  channel.num_rtts = 0;
+  ASSERT_TRUE(estimator.Estimate(Procedure(channel, 2), &result));
+  EXPECT_NEAR(result.result_meters_, 170.0 - ChannelSoundingEstimator::kAmbiguityMeters, 0.05);
+}
+
+TEST(ChannelSoundingEstimatorTest, short_distance_with_negative_phase) {
+  ChannelSoundingEstimator estimator;
+  RangingResult result;
+  Channel channel = {.paths = {{0.3, 1.0}}, .phase_offset_meters = -1.0};
+  ASSERT_TRUE(estimator.Estimate(Procedure(channel, 3), &result));
+  EXPECT_EQ(result.result_meters_, 0.0);
+
+  channel.phase_offset_meters = -0.2;
+  ASSERT_TRUE(estimator.Estimate(Procedure(channel, 3), &result));
+  EXPECT_NEAR(result.result_meters_, 0.1, 0.05);
+}
+
+TEST(ChannelSoundingEstimatorTest, round_trip_time_only) {
+  ChannelSoundingEstimator estimator;
+  RangingResult result;
+  Channel channel = {.paths = {{20.0, 1.0}}, .with_tones = false, .num_rtts = 21, .rtt_noise_meters = 2};
+  ASSERT_TRUE(estimator.Estimate(Procedure(channel, 4), &result));
+  EXPECT_NEAR(result.result_meters_, 20.0, 1.5);
+  EXPECT_GT(result.confidence_level_, 0);
+  EXPECT_LT(result.confidence_level_, 100);
+}
+
+TEST(ChannelSoundingEstimatorTest, tone_quality) {
+  ChannelSoundingEstimator estimator;
+  auto raw_data = Procedure({.paths = {{7.5, 1.0}}}, 5);
+  // Unavailable tones with a wrong phase are ignored
+  for (size_t i = 0; i < raw_data.tone_pct_initiator_[0].size(); i += 2) {
+    raw_data.tone_pct_initiator_[0][i] *= std::polar(1.0, 1.0);
+    raw_data.tone_quality_indicator_reflector_[0][i] = 3;
+  }
+  RangingResult result;
+  ASSERT_TRUE(estimator.Estimate(raw_data, &result));
+  EXPECT_NEAR(result.result_meters_, 7.5, 0.05);
+
+  for (auto& quality : raw_data.tone_quality_indicator_initiator_[0]) {
+    quality = 2;
+  }
+  EXPECT_FALSE(estimator.Estimate(raw_data, &result));
+}
+
+TEST(ChannelSoundingEstimatorTest, no_data) {
+  ChannelSoundingEstimator estimator;
+  RangingResult result;
+  EXPECT_FALSE(estimator.Estimate(ChannelSoundingRawData{}, &result));
+
+  ChannelSoundingRawData raw_data{};
+  raw_data.num_antenna_paths_ = 2;
+  raw_data.step_mode_ = {2, 2};
+  raw_data.step_channel_ = {10, 11};
+  EXPECT_FALSE(estimator.Estimate(raw_data, &result));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
@@ -19,34 +19,57 @@
 #undef LOG_INFO
 #undef LOG_WARNING
 
+#include <bluetooth/log.h>
+
+#include "hal/ranging_estimator.h"
 #include "ranging_hal.h"
 
 namespace bluetooth {
 namespace hal {
 
+// Ranging HAL of the hosts without a vendor implementation: the distance is estimated in software from the raw
+// Channel Sounding data of each procedure, and there are no vendor specific characteristics to exchange.
 class RangingHalHost : public RangingHal {
  public:
   bool IsBound() override {
-    return false;
+    return true;
+  }
+  void RegisterCallback(RangingHalCallback* callback) override {
+    callback_ = callback;
   }
-  void RegisterCallback(RangingHalCallback* /* callback */) override {}
   std::vector<VendorSpecificCharacteristic> GetVendorSpecificCharacteristics() override {
     std::vector<VendorSpecificCharacteristic> vendor_specific_characteristics = {};
     return vendor_specific_characteristics;
   };
   void OpenSession(
-      uint16_t /* connection_handle */,
+      uint16_t connection_handle,
       uint16_t /* att_handle */,
-      const std::vector<hal::VendorSpecificCharacteristic>& /* vendor_specific_data */) override{};
+      const std::vector<hal::VendorSpecificCharacteristic>& /* vendor_specific_data */) override {
+    if (callback_ != nullptr) {
+      callback_->OnOpened(connection_handle, {});
+    }
+  };
 
   void HandleVendorSpecificReply(
-      uint16_t /* connection_handle */,
-      const std::vector<hal::VendorSpecificCharacteristic>& /* vendor_specific_reply */) override{};
+      uint16_t connection_handle,
+      const std::vector<hal::VendorSpecificCharacteristic>& /* vendor_specific_reply */) override {
+    if (callback_ != nullptr) {
+      callback_->OnHandleVendorSpecificReplyComplete(connection_handle, true);
+    }
+  };
 
-  void WriteRawData(
-      uint16_t /* connection_handle */, const ChannelSoundingRawData& /* raw_data */) override{};
+  void WriteRawData(uint16_t connection_handle, const ChannelSoundingRawData& raw_data) override {
+    RangingResult result;
+    if (!estimator_.Estimate(raw_data, &result)) {
+      log::warn("No distance for connection_handle 0x{:04x}, {} steps", connection_handle, raw_data.step_mode_.size());
+      return;
+    }
+    if (callback_ != nullptr) {
+      callback_->OnResult(connection_handle, result);
+    }
+  };
 
-  void close(uint16_t connection_handle) override{};
+  void close(uint16_t /* connection_handle */) override{};
 
  protected:
   void ListDependencies(ModuleList* /*list*/) const {}
@@ -58,6 +81,10 @@ class RangingHalHost : public RangingHal {
   std::string ToString() const override {
     return std::string("RangingHalHost");
   }
+
+ private:
+  RangingHalCallback* callback_ = nullptr;
+  ChannelSoundingEstimator estimator_;
 };
 
 const ModuleFactory RangingHal::Factory = ModuleFactory([]() { return new RangingHalHost(); });
@@ -23,9 +23,7 @@
 #include <algorithm>
 #include <bitset>
 #include <chrono>
-#include <sstream>
 
-#include "common/circular_buffer.h"
 #include "common/init_flags.h"
 #include "common/strings.h"
 #include "hal/snoop_logger_common.h"
@@ -302,6 +300,11 @@ using namespace std::chrono_literals;
 constexpr std::chrono::hours kBtSnoozLogLifeTime = 12h;
 constexpr std::chrono::hours kBtSnoozLogDeleteRepeatingAlarmInterval = 1h;
 
+// Memory preallocated for packets waiting for the asynchronous writer, enough for a few thousand ACL packets
+constexpr size_t kBtSnoopAsyncRingSize = 1024 * 1024;
+// Records written per flush of the btsnoop log in asynchronous mode
+constexpr size_t kBtSnoopAsyncMaxRecordsPerBatch = 256;
+
 std::mutex filter_tracker_list_mutex;
 std::unordered_map<uint16_t, FilterTracker> filter_tracker_list;
 std::unordered_map<uint16_t, uint16_t> local_cid_to_acl;
@@ -452,6 +455,9 @@ const std::string SnoopLogger::kBtSnoopLogFilterProfilePbapModeProperty =
 // Truncates RFCOMM UIH packet to fixed (L2CAP_HEADER_SIZE) number of bytes
 const std::string SnoopLogger::kBtSnoopLogFilterProfileRfcommProperty =
     "persist.bluetooth.snooplogfilter.profiles.rfcomm.enabled";
+// Flush interval in milliseconds of the asynchronous btsnoop writer, 0 (the default) writes synchronously
+const std::string SnoopLogger::kBtSnoopLogAsyncFlushIntervalProperty =
+    "persist.bluetooth.btsnoopasyncflushinterval";
 const std::string SnoopLogger::kSoCManufacturerProperty = "ro.soc.manufacturer";
 
 // persist.bluetooth.btsnooplogmode
@@ -481,20 +487,22 @@ SnoopLogger::SnoopLogger(
     std::string snoop_log_path,
     std::string snooz_log_path,
     size_t max_packets_per_file,
-    size_t max_packets_per_buffer,
+    size_t max_bytes_per_buffer,
     const std::string& btsnoop_mode,
     bool qualcomm_debug_log_enabled,
     const std::chrono::milliseconds snooz_log_life_time,
     const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-    bool snoop_log_persists)
+    bool snoop_log_persists,
+    const std::chrono::milliseconds async_flush_interval)
     : snoop_log_path_(std::move(snoop_log_path)),
       snooz_log_path_(std::move(snooz_log_path)),
       max_packets_per_file_(max_packets_per_file),
-      btsnooz_buffer_(max_packets_per_buffer),
+      btsnooz_buffer_(max_bytes_per_buffer),
       qualcomm_debug_log_enabled_(qualcomm_debug_log_enabled),
       snooz_log_life_time_(snooz_log_life_time),
       snooz_log_delete_alarm_interval_(snooz_log_delete_alarm_interval),
-      snoop_log_persists(snoop_log_persists) {
+      snoop_log_persists(snoop_log_persists),
+      async_flush_interval_(async_flush_interval) {
   btsnoop_mode_ = btsnoop_mode;
 
   if (btsnoop_mode_ == kBtSnoopLogModeFiltered) {
@@ -1144,20 +1152,21 @@ void SnoopLogger::SetL2capChannelClose(uint16_t handle, uint16_t local_cid, uint
   filters.ProfileL2capClose(filters.CidToProfile(true, local_cid));
 }
 
-void SnoopLogger::FilterCapturedPacket(
-    HciPacket& packet,
+const HciPacket& SnoopLogger::FilterCapturedPacket(
+    const HciPacket& packet,
+    HciPacket& rewritten_packet,
     Direction direction,
     PacketType type,
     uint32_t& length,
     PacketHeaderType header) {
   if (btsnoop_mode_ != kBtSnoopLogModeFiltered || type != PacketType::ACL) {
-    return;
+    return packet;
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterProfileA2dpProperty)) {
     if (IsA2dpMediaPacket(direction == Direction::INCOMING, (uint8_t*)packet.data())) {
       length = 0;
-      return;
+      return packet;
     }
   }
 
@@ -1165,35 +1174,36 @@ void SnoopLogger::FilterCapturedPacket(
     CalculateAclPacketLength(length, (uint8_t*)packet.data(), direction == Direction::INCOMING);
   }
 
+  const HciPacket* filtered_packet = &packet;
   if (IsFilterEnabled(kBtSnoopLogFilterProfilePbapModeProperty) ||
       IsFilterEnabled(kBtSnoopLogFilterProfileMapModeProperty)) {
     // If HeadersFiltered applied, do not use ProfilesFiltered
     if (length == ntohl(header.length_original)) {
-      if (packet.size() + EXTRA_BUF_SIZE > DEFAULT_PACKET_SIZE) {
+      // Only the profile filters modify the payload, so only they copy the packet
+      rewritten_packet = packet;
+      if (rewritten_packet.size() + EXTRA_BUF_SIZE > DEFAULT_PACKET_SIZE) {
         // Add additional bytes for magic string in case
         // payload length is less than the length of magic string.
-        packet.resize((size_t)(packet.size() + EXTRA_BUF_SIZE));
+        rewritten_packet.resize((size_t)(rewritten_packet.size() + EXTRA_BUF_SIZE));
       }
+      filtered_packet = &rewritten_packet;
 
-      length = FilterProfiles(direction == Direction::INCOMING, (uint8_t*)packet.data());
-      if (length == 0) return;
+      length = FilterProfiles(direction == Direction::INCOMING, rewritten_packet.data());
+      if (length == 0) return *filtered_packet;
     }
   }
 
   if (IsFilterEnabled(kBtSnoopLogFilterProfileRfcommProperty)) {
     bool shouldFilter =
-        SnoopLogger::ShouldFilterLog(direction == Direction::INCOMING, (uint8_t*)packet.data());
+        SnoopLogger::ShouldFilterLog(direction == Direction::INCOMING, (uint8_t*)filtered_packet->data());
     if (shouldFilter) {
       length = L2CAP_HEADER_SIZE + PACKET_TYPE_LENGTH;
     }
   }
+  return *filtered_packet;
 }
 
 void SnoopLogger::Capture(const HciPacket& immutable_packet, Direction direction, PacketType type) {
-  //// TODO(b/335520123) update FilterCapture to stop modifying packets ////
-  HciPacket mutable_packet(immutable_packet);
-  HciPacket& packet = mutable_packet;
-  //////////////////////////////////////////////////////////////////////////
   uint64_t timestamp_us =
       std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
           .count();
@@ -1222,65 +1232,143 @@ void SnoopLogger::Capture(const HciPacket& immutable_packet, Direction direction
       flags.set(1, true);
       break;
   }
-  uint32_t length = packet.size() + /* type byte */ PACKET_TYPE_LENGTH;
+  uint32_t length = immutable_packet.size() + /* type byte */ PACKET_TYPE_LENGTH;
   PacketHeaderType header = {.length_original = htonl(length),
                              .length_captured = htonl(length),
                              .flags = htonl(static_cast<uint32_t>(flags.to_ulong())),
                              .dropped_packets = 0,
                              .timestamp = htonll(timestamp_us + kBtSnoopEpochDelta),
                              .type = static_cast<uint8_t>(type)};
-  {
-    std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  // The asynchronous capture does not take |file_mutex_|, which the writer thread holds while it rotates the log
+  // file. |async_ring_| is only created and destroyed with both locks held, so either lock keeps it alive.
+  std::shared_lock<std::shared_mutex> ring_lock(async_ring_mutex_);
+  std::unique_lock<std::recursive_mutex> file_lock(file_mutex_, std::defer_lock);
+  if (async_ring_ == nullptr) {
+    ring_lock.unlock();
+    file_lock.lock();
     if (btsnoop_mode_ == kBtSnoopLogModeDisabled) {
-      // btsnoop disabled, log in-memory btsnooz log only
-      std::stringstream ss;
-      size_t included_length = get_btsnooz_packet_length_to_write(packet, type, qualcomm_debug_log_enabled_);
+      // btsnoop disabled, log in-memory btsnooz log only. The truncated record is copied straight into the arena
+      // and the packet itself is not copied, so nothing is allocated per packet.
+      size_t included_length =
+          get_btsnooz_packet_length_to_write(immutable_packet, type, qualcomm_debug_log_enabled_);
       header.length_captured = htonl(included_length + /* type byte */ PACKET_TYPE_LENGTH);
-      if (!ss.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
-        log::error("Failed to write packet header for btsnooz, error: \"{}\"", strerror(errno));
-      }
-      if (!ss.write(reinterpret_cast<const char*>(packet.data()), included_length)) {
-        log::error("Failed to write packet payload for btsnooz, error: \"{}\"", strerror(errno));
-      }
-      btsnooz_buffer_.Push(ss.str());
+      btsnooz_buffer_.Push(&header, sizeof(PacketHeaderType), immutable_packet.data(), included_length);
       return;
     }
+  }
 
-    FilterCapturedPacket(packet, direction, type, length, header);
+  HciPacket rewritten_packet;
+  const HciPacket& packet =
+      FilterCapturedPacket(immutable_packet, rewritten_packet, direction, type, length, header);
 
-    if (length == 0) {
-      return;
-    } else if (length != ntohl(header.length_original)) {
-      header.length_captured = htonl(length);
+  if (length == 0) {
+    return;
+  } else if (length != ntohl(header.length_original)) {
+    header.length_captured = htonl(length);
+  }
+
+  if (async_ring_ != nullptr) {
+    // The btsnoop header carries the cumulative number of dropped packets
+    header.dropped_packets = htonl(static_cast<uint32_t>(async_ring_->GetDroppedCount()));
+    async_ring_->Push(&header, sizeof(PacketHeaderType), packet.data(), length - 1);
+    // Wake the writer early when the ring fills up. A wakeup lost to the race with the writer going to sleep
+    // only delays the write until the next flush interval.
+    if (async_ring_->GetUsedBytes() > async_ring_->GetCapacity() / 2) {
+      async_writer_cv_.notify_one();
     }
+    return;
+  }
 
-    packet_counter_++;
-    if (packet_counter_ > max_packets_per_file_) {
-      OpenNextSnoopLogFile();
-    }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
-      log::error("Failed to write packet header for btsnoop, error: \"{}\"", strerror(errno));
-    }
-    if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), length - 1)) {
-      log::error("Failed to write packet payload for btsnoop, error: \"{}\"", strerror(errno));
-    }
+  packet_counter_++;
+  if (packet_counter_ > max_packets_per_file_) {
+    OpenNextSnoopLogFile();
+  }
+  if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(&header), sizeof(PacketHeaderType))) {
+    log::error("Failed to write packet header for btsnoop, error: \"{}\"", strerror(errno));
+  }
+  if (!btsnoop_ostream_.write(reinterpret_cast<const char*>(packet.data()), length - 1)) {
+    log::error("Failed to write packet payload for btsnoop, error: \"{}\"", strerror(errno));
+  }
 
-    if (socket_ != nullptr) {
-      socket_->Write(&header, sizeof(PacketHeaderType));
-      socket_->Write(packet.data(), (size_t)(length - 1));
-    }
+  SnoopLoggerSocketInterface* socket = socket_.load();
+  if (socket != nullptr) {
+    socket->Write(&header, sizeof(PacketHeaderType));
+    socket->Write(packet.data(), (size_t)(length - 1));
+  }
+
+  // std::ofstream::flush() pushes user data into kernel memory. The data will be written even if this process
+  // crashes. However, data will be lost if there is a kernel panic, which is out of scope of BT snoop log.
+  // NOTE: std::ofstream::write() followed by std::ofstream::flush() has similar effect as UNIX write(fd, data, len)
+  //       as write() syscall dumps data into kernel memory directly
+  if (!btsnoop_ostream_.flush()) {
+    log::error("Failed to flush, error: \"{}\"", strerror(errno));
+  }
+}
 
-    // std::ofstream::flush() pushes user data into kernel memory. The data will be written even if this process
-    // crashes. However, data will be lost if there is a kernel panic, which is out of scope of BT snoop log.
-    // NOTE: std::ofstream::write() followed by std::ofstream::flush() has similar effect as UNIX write(fd, data, len)
-    //       as write() syscall dumps data into kernel memory directly
+void SnoopLogger::StartAsyncWriter() {
+  log::info("Writing btsnoop log asynchronously every {} ms", async_flush_interval_.count());
+  {
+    std::unique_lock<std::shared_mutex> ring_lock(async_ring_mutex_);
+    async_ring_ = std::make_unique<SnoopLoggerRing>(kBtSnoopAsyncRingSize);
+  }
+  async_writer_stop_ = false;
+  async_writer_thread_ = std::thread(&SnoopLogger::RunAsyncWriter, this);
+}
+
+void SnoopLogger::StopAsyncWriter() {
+  if (!async_writer_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(async_writer_mutex_);
+    async_writer_stop_ = true;
+  }
+  async_writer_cv_.notify_one();
+  async_writer_thread_.join();
+}
+
+void SnoopLogger::RunAsyncWriter() {
+  std::unique_lock<std::mutex> lock(async_writer_mutex_);
+  while (!async_writer_stop_) {
+    async_writer_cv_.wait_for(lock, async_flush_interval_, [this] {
+      return async_writer_stop_ || async_ring_->GetUsedBytes() > async_ring_->GetCapacity() / 2;
+    });
+    lock.unlock();
+    WriteAsyncRecords();
+    lock.lock();
+  }
+}
+
+void SnoopLogger::WriteAsyncRecords() {
+  while (async_ring_->Peek(&async_records_, kBtSnoopAsyncMaxRecordsPerBatch) > 0) {
+    SnoopLoggerSocketInterface* socket = socket_.load();
+    for (const auto& record : async_records_) {
+      packet_counter_++;
+      if (packet_counter_ > max_packets_per_file_) {
+        OpenNextSnoopLogFile();
+      }
+      if (!btsnoop_ostream_.write(static_cast<const char*>(record.iov_base), record.iov_len)) {
+        log::error("Failed to write packet for btsnoop, error: \"{}\"", strerror(errno));
+      }
+      if (socket != nullptr) {
+        socket->Write(record.iov_base, record.iov_len);
+      }
+    }
+    // One flush per batch instead of one per packet
     if (!btsnoop_ostream_.flush()) {
       log::error("Failed to flush, error: \"{}\"", strerror(errno));
     }
+    async_ring_->Release();
+    async_records_.clear();
   }
 }
 
-void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const {
+uint64_t SnoopLogger::GetDroppedPacketCount() const {
+  std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  return async_ring_ != nullptr ? async_ring_->GetDroppedCount() : async_dropped_packets_;
+}
+
+void SnoopLogger::DumpSnoozLogToFile() const {
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
   if (btsnoop_mode_ != kBtSnoopLogModeDisabled) {
     log::debug("btsnoop log is enabled, skip dumping btsnooz log");
@@ -1315,10 +1403,17 @@ void SnoopLogger::DumpSnoozLogToFile(const std::vector<std::string>& data) const
     log::warn(
         "Unable to write file header to \"{}\", error: \"{}\"", snooz_log_path_, strerror(errno));
   }
-  for (const auto& packet : data) {
-    if (!btsnooz_ostream.write(packet.data(), packet.size())) {
-      log::error("Failed to write packet payload for btsnooz, error: \"{}\"", strerror(errno));
-    }
+  // Records are streamed from the arena while file_mutex_ keeps Capture() from overwriting them
+  bool write_failed = false;
+  btsnooz_buffer_.ForEach(
+      [&](const uint8_t* data, size_t length, const uint8_t* wrapped_data, size_t wrapped_length) {
+        if (!btsnooz_ostream.write(reinterpret_cast<const char*>(data), length) ||
+            !btsnooz_ostream.write(reinterpret_cast<const char*>(wrapped_data), wrapped_length)) {
+          write_failed = true;
+        }
+      });
+  if (write_failed) {
+    log::error("Failed to write packet payload for btsnooz, error: \"{}\"", strerror(errno));
   }
   if (!btsnooz_ostream.flush()) {
     log::error("Failed to flush, error: \"{}\"", strerror(errno));
@@ -1359,6 +1454,10 @@ void SnoopLogger::Start() {
       snoop_logger_socket_thread_.reset();
       snoop_logger_socket_thread_ = nullptr;
     }
+
+    if (async_flush_interval_ > std::chrono::milliseconds::zero()) {
+      StartAsyncWriter();
+    }
   }
   alarm_ = std::make_unique<os::RepeatingAlarm>(GetHandler());
   alarm_->Schedule(
@@ -1366,7 +1465,20 @@ void SnoopLogger::Start() {
 }
 
 void SnoopLogger::Stop() {
+  // The writer may need |file_mutex_| to rotate the log file
+  StopAsyncWriter();
+
   std::lock_guard<std::recursive_mutex> lock(file_mutex_);
+  if (async_ring_ != nullptr) {
+    // Packets captured after the writer stopped
+    WriteAsyncRecords();
+    async_dropped_packets_ = async_ring_->GetDroppedCount();
+    if (async_dropped_packets_ != 0) {
+      log::warn("{} packets dropped from btsnoop log", async_dropped_packets_);
+    }
+    std::unique_lock<std::shared_mutex> ring_lock(async_ring_mutex_);
+    async_ring_.reset();
+  }
   log::debug("Closing btsnoop log data at {}", snoop_log_path_);
   CloseCurrentSnoopLogFile();
 
@@ -1392,7 +1504,7 @@ void SnoopLogger::Stop() {
 
 DumpsysDataFinisher SnoopLogger::GetDumpsysData(
     flatbuffers::FlatBufferBuilder* /* builder */) const {
-  DumpSnoozLogToFile(btsnooz_buffer_.Pull());
+  DumpSnoozLogToFile();
   return EmptyDumpsysDataFinisher;
 }
 
@@ -1411,14 +1523,11 @@ size_t SnoopLogger::GetMaxPacketsPerFile() {
   return max_packets_per_file;
 }
 
-size_t SnoopLogger::GetMaxPacketsPerBuffer() {
+size_t SnoopLogger::GetMaxBytesPerBuffer() {
   // We want to use at most 256 KB memory for btsnooz log for release builds
-  // and 512 KB memory for userdebug/eng builds
+  // and 1 MB memory for userdebug/eng builds
   auto is_debuggable = os::GetSystemPropertyBool(kIsDebuggableProperty, false);
-
-  size_t btsnooz_max_memory_usage_bytes = (is_debuggable ? 1024 : 256) * 1024;
-  // Calculate max number of packets based on max memory usage and max packet size
-  return btsnooz_max_memory_usage_bytes / kDefaultBtSnoozMaxBytesPerPacket;
+  return (is_debuggable ? 1024 : 256) * 1024;
 }
 
 std::string SnoopLogger::GetBtSnoopMode() {
@@ -1466,6 +1575,10 @@ bool SnoopLogger::IsBtSnoopLogPersisted() {
   return is_debuggable && os::GetSystemPropertyBool(kBtSnoopLogPersists, false);
 }
 
+std::chrono::milliseconds SnoopLogger::GetAsyncFlushInterval() {
+  return std::chrono::milliseconds(os::GetSystemPropertyUint32(kBtSnoopLogAsyncFlushIntervalProperty, 0));
+}
+
 bool SnoopLogger::IsQualcommDebugLogEnabled() {
   // Check system prop if the soc manufacturer is Qualcomm
   bool qualcomm_debug_log_enabled = false;
@@ -1482,12 +1595,13 @@ const ModuleFactory SnoopLogger::Factory = ModuleFactory([]() {
       os::ParameterProvider::SnoopLogFilePath(),
       os::ParameterProvider::SnoozLogFilePath(),
       GetMaxPacketsPerFile(),
-      GetMaxPacketsPerBuffer(),
+      GetMaxBytesPerBuffer(),
       GetBtSnoopMode(),
       IsQualcommDebugLogEnabled(),
       kBtSnoozLogLifeTime,
       kBtSnoozLogDeleteRepeatingAlarmInterval,
-      IsBtSnoopLogPersisted());
+      IsBtSnoopLogPersisted(),
+      GetAsyncFlushInterval());
 });
 
 }  // namespace hal
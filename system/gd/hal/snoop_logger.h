@@ -18,16 +18,21 @@
 
 #include <bluetooth/log.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-#include "common/circular_buffer.h"
 #include "hal/hci_hal.h"
+#include "hal/snoop_logger_ring.h"
 #include "hal/snoop_logger_socket_interface.h"
 #include "hal/snoop_logger_socket_thread.h"
+#include "hal/snooz_log_buffer.h"
 #include "hal/syscall_wrapper_impl.h"
 #include "module.h"
 #include "os/repeating_alarm.h"
@@ -153,6 +158,7 @@ class SnoopLogger : public ::bluetooth::Module {
   static const std::string kBtSnoopLogFilterProfileMapModeProperty;
   static const std::string kBtSnoopLogFilterProfilePbapModeProperty;
   static const std::string kBtSnoopLogFilterProfileRfcommProperty;
+  static const std::string kBtSnoopLogAsyncFlushIntervalProperty;
   static const std::string kSoCManufacturerProperty;
 
   static const std::string kBtSnoopLogModeDisabled;
@@ -196,7 +202,8 @@ class SnoopLogger : public ::bluetooth::Module {
   // Changes to this value is only effective after restarting Bluetooth
   static size_t GetMaxPacketsPerFile();
 
-  static size_t GetMaxPacketsPerBuffer();
+  // Returns the size in bytes of the in-memory btsnooz log
+  static size_t GetMaxBytesPerBuffer();
 
   // Get snoop logger mode based on current system setup
   // Changes to this values is only effective after restarting Bluetooth
@@ -209,6 +216,11 @@ class SnoopLogger : public ::bluetooth::Module {
   // Returns whether snoop log persists even after restarting Bluetooth
   static bool IsBtSnoopLogPersisted();
 
+  // Returns how often captured packets are written to the btsnoop log by a dedicated thread, or zero if every
+  // packet is written synchronously by Capture()
+  // Changes to this value is only effective after restarting Bluetooth
+  static std::chrono::milliseconds GetAsyncFlushInterval();
+
   // Has to be defined from 1 to 4 per btsnoop format
   enum PacketType {
     CMD = 1,
@@ -264,6 +276,9 @@ class SnoopLogger : public ::bluetooth::Module {
 
   void RegisterSocket(SnoopLoggerSocketInterface* socket);
 
+  // Number of packets dropped because the asynchronous capture ring was full
+  uint64_t GetDroppedPacketCount() const;
+
  protected:
   // Packet type length
   static const size_t PACKET_TYPE_LENGTH;
@@ -285,15 +300,16 @@ class SnoopLogger : public ::bluetooth::Module {
       std::string snoop_log_path,
       std::string snooz_log_path,
       size_t max_packets_per_file,
-      size_t max_packets_per_buffer,
+      size_t max_bytes_per_buffer,
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
       const std::chrono::milliseconds snooz_log_life_time,
       const std::chrono::milliseconds snooz_log_delete_alarm_interval,
-      bool snoop_log_persists);
+      bool snoop_log_persists,
+      const std::chrono::milliseconds async_flush_interval = std::chrono::milliseconds::zero());
   void CloseCurrentSnoopLogFile();
   void OpenNextSnoopLogFile();
-  void DumpSnoozLogToFile(const std::vector<std::string>& data) const;
+  void DumpSnoozLogToFile() const;
   // Enable filters according to their sysprops
   void EnableFilters();
   // Disable all filters
@@ -326,12 +342,19 @@ class SnoopLogger : public ::bluetooth::Module {
       uint16_t l2cap_channel,
       uint32_t& offset,
       uint32_t total_length);
-  void FilterCapturedPacket(
-      HciPacket& packet,
+  // Returns |packet|, or |rewritten_packet| holding a copy of it when a filter rewrites the payload
+  const HciPacket& FilterCapturedPacket(
+      const HciPacket& packet,
+      HciPacket& rewritten_packet,
       Direction direction,
       PacketType type,
       uint32_t& length,
       PacketHeaderType header);
+  void StartAsyncWriter();
+  void StopAsyncWriter();
+  void RunAsyncWriter();
+  // Write all records in the capture ring to the btsnoop log and socket
+  void WriteAsyncRecords();
 
   std::unique_ptr<SnoopLoggerSocketThread> snoop_logger_socket_thread_;
 
@@ -341,16 +364,29 @@ class SnoopLogger : public ::bluetooth::Module {
   std::string snooz_log_path_;
   std::ofstream btsnoop_ostream_;
   size_t max_packets_per_file_;
-  common::CircularBuffer<std::string> btsnooz_buffer_;
+  SnoozLogBuffer btsnooz_buffer_;  // Guarded by file_mutex_
   bool qualcomm_debug_log_enabled_ = false;
   size_t packet_counter_ = 0;
   mutable std::recursive_mutex file_mutex_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   std::chrono::milliseconds snooz_log_life_time_;
   std::chrono::milliseconds snooz_log_delete_alarm_interval_;
-  SnoopLoggerSocketInterface* socket_;
+  // Read without |file_mutex_| by the asynchronous writer
+  std::atomic<SnoopLoggerSocketInterface*> socket_;
   SyscallWrapperImpl syscall_if;
   bool snoop_log_persists = false;
+
+  // Asynchronous capture: Capture() only copies packets into |async_ring_|, |async_writer_thread_| writes them
+  // out in batches. While it runs, the writer thread owns |btsnoop_ostream_| and |packet_counter_|.
+  std::chrono::milliseconds async_flush_interval_;
+  std::unique_ptr<SnoopLoggerRing> async_ring_;  // Guarded by |async_ring_mutex_| and |file_mutex_|
+  std::shared_mutex async_ring_mutex_;
+  std::vector<struct iovec> async_records_;
+  std::thread async_writer_thread_;
+  std::mutex async_writer_mutex_;
+  std::condition_variable async_writer_cv_;
+  bool async_writer_stop_ = false;
+  uint64_t async_dropped_packets_ = 0;
 };
 
 }  // namespace hal
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hal/snoop_logger.h"
+
+using ::benchmark::State;
+using ::bluetooth::hal::HciPacket;
+using ::bluetooth::hal::SnoopLogger;
+
+namespace {
+
+class BenchmarkSnoopLogger : public SnoopLogger {
+ public:
+  explicit BenchmarkSnoopLogger(const std::filesystem::path& directory)
+      : SnoopLogger(
+            directory / "btsnoop_hci.log",
+            directory / "btsnooz_hci.log",
+            0xffff,
+            SnoopLogger::GetMaxBytesPerBuffer(),
+            SnoopLogger::kBtSnoopLogModeDisabled,
+            false,
+            std::chrono::hours(1),
+            std::chrono::hours(1),
+            false) {}
+
+  std::string ToString() const override {
+    return std::string("BenchmarkSnoopLogger");
+  }
+};
+
+// Capture() with btsnoop disabled, i.e. only the in-memory btsnooz log is kept. The buffer wraps after a few
+// thousand iterations, so most iterations also evict old records.
+void BM_CaptureSnoozOnly(State& state, SnoopLogger::PacketType type, SnoopLogger::Direction direction) {
+  auto directory = std::filesystem::temp_directory_path() / "snoop_logger_benchmark";
+  std::filesystem::create_directories(directory);
+  auto snoop_logger = std::make_unique<BenchmarkSnoopLogger>(directory);
+
+  HciPacket packet(state.range(0));
+  for (size_t i = 0; i < packet.size(); i++) {
+    packet[i] = static_cast<uint8_t>(i);
+  }
+  if (type == SnoopLogger::PacketType::ACL && packet.size() >= 8) {
+    // Connection handle 0x0001, L2CAP CID 0x0040: truncated to the headers like any data channel
+    packet[0] = 0x01;
+    packet[1] = 0x20;
+    packet[6] = 0x40;
+    packet[7] = 0x00;
+  }
+
+  for (auto _ : state) {
+    snoop_logger->Capture(packet, direction, type);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  snoop_logger.reset();
+  std::filesystem::remove_all(directory);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_CaptureSnoozOnly, command, SnoopLogger::PacketType::CMD, SnoopLogger::Direction::OUTGOING)
+    ->Arg(4)
+    ->Arg(64)
+    ->Arg(258);
+BENCHMARK_CAPTURE(BM_CaptureSnoozOnly, event, SnoopLogger::PacketType::EVT, SnoopLogger::Direction::INCOMING)
+    ->Arg(16)
+    ->Arg(257);
+BENCHMARK_CAPTURE(BM_CaptureSnoozOnly, acl_data, SnoopLogger::PacketType::ACL, SnoopLogger::Direction::INCOMING)
+    ->Arg(27)
+    ->Arg(1021);
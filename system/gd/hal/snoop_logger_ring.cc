@@ -0,0 +1,123 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bluetooth {
+namespace hal {
+
+namespace {
+
+// Records start on 8 byte boundaries so that every record header is aligned
+constexpr size_t kRecordAlignment = 8;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = kRecordAlignment;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+SnoopLoggerRing::SnoopLoggerRing(size_t capacity)
+    : buffer_(new uint8_t[RoundUpToPowerOfTwo(capacity)]()), capacity_(RoundUpToPowerOfTwo(capacity)) {}
+
+size_t SnoopLoggerRing::RecordSize(size_t length) {
+  return (sizeof(RecordHeader) + length + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+bool SnoopLoggerRing::Push(const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  size_t length = header_length + payload_length;
+  size_t record_size = RecordSize(length);
+  if (record_size > capacity_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // A record never wraps around the end of the buffer; the space left there is reserved as padding instead
+  uint64_t position = reserve_position_.load(std::memory_order_relaxed);
+  size_t padding;
+  do {
+    size_t offset = position & (capacity_ - 1);
+    padding = offset + record_size > capacity_ ? capacity_ - offset : 0;
+    if (position + padding + record_size - release_position_.load(std::memory_order_acquire) > capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  } while (!reserve_position_.compare_exchange_weak(
+      position, position + padding + record_size, std::memory_order_relaxed, std::memory_order_relaxed));
+
+  if (padding != 0) {
+    auto* padding_header = reinterpret_cast<RecordHeader*>(&buffer_[position & (capacity_ - 1)]);
+    padding_header->length = padding;
+    __atomic_store_n(&padding_header->state, kPadding, __ATOMIC_RELEASE);
+    position += padding;
+  }
+
+  uint8_t* record = &buffer_[position & (capacity_ - 1)];
+  auto* record_header = reinterpret_cast<RecordHeader*>(record);
+  record_header->length = length;
+  std::memcpy(record + sizeof(RecordHeader), header, header_length);
+  std::memcpy(record + sizeof(RecordHeader) + header_length, payload, payload_length);
+  __atomic_store_n(&record_header->state, kCommitted, __ATOMIC_RELEASE);
+  return true;
+}
+
+size_t SnoopLoggerRing::Peek(std::vector<struct iovec>* records, size_t max_records) {
+  uint64_t reserved = reserve_position_.load(std::memory_order_acquire);
+  size_t count = 0;
+  while (count < max_records && peek_position_ < reserved) {
+    uint8_t* record = &buffer_[peek_position_ & (capacity_ - 1)];
+    auto* record_header = reinterpret_cast<RecordHeader*>(record);
+    uint32_t state = __atomic_load_n(&record_header->state, __ATOMIC_ACQUIRE);
+    if (state == kEmpty) {
+      // Reserved but not written yet
+      break;
+    }
+    if (state == kPadding) {
+      peek_position_ += record_header->length;
+      continue;
+    }
+    records->push_back({.iov_base = record + sizeof(RecordHeader), .iov_len = record_header->length});
+    peek_position_ += RecordSize(record_header->length);
+    count++;
+  }
+  return count;
+}
+
+void SnoopLoggerRing::Release() {
+  uint64_t position = release_position_.load(std::memory_order_relaxed);
+  // Producers rely on unreserved space reading as kEmpty
+  while (position < peek_position_) {
+    size_t offset = position & (capacity_ - 1);
+    size_t length = std::min<uint64_t>(peek_position_ - position, capacity_ - offset);
+    std::memset(&buffer_[offset], 0, length);
+    position += length;
+  }
+  release_position_.store(peek_position_, std::memory_order_release);
+}
+
+size_t SnoopLoggerRing::GetUsedBytes() const {
+  return reserve_position_.load(std::memory_order_relaxed) - release_position_.load(std::memory_order_relaxed);
+}
+
+}  // namespace hal
+}  // namespace bluetooth
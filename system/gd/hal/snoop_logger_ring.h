@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+
+// Bounded multi-producer/single-consumer ring of variable length records, stored in one preallocated buffer.
+// Producers never block and never allocate: a record that does not fit is dropped and counted instead. The
+// consumer reads committed records in place and releases them in batches.
+class SnoopLoggerRing {
+ public:
+  // |capacity| is rounded up to a power of two
+  explicit SnoopLoggerRing(size_t capacity);
+
+  SnoopLoggerRing(const SnoopLoggerRing&) = delete;
+  SnoopLoggerRing& operator=(const SnoopLoggerRing&) = delete;
+
+  // Copy |header| followed by |payload| into the ring as one record. Safe to call from any thread. Returns false,
+  // and counts the record as dropped, when there is no room for it.
+  bool Push(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  // Consumer only: append one iovec per committed record to |records|, oldest first, stopping at a record that is
+  // still being written or after |max_records|. The iovecs stay valid until Release(). Returns the number of
+  // records appended.
+  size_t Peek(std::vector<struct iovec>* records, size_t max_records);
+
+  // Consumer only: free the records returned by the last Peek()
+  void Release();
+
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+  // Bytes reserved by producers and not released by the consumer yet
+  size_t GetUsedBytes() const;
+
+  uint64_t GetDroppedCount() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct RecordHeader {
+    uint32_t length;  // Record data length, or the total size of a padding record
+    uint32_t state;   // Accessed atomically
+  };
+
+  enum State : uint32_t {
+    kEmpty = 0,
+    kCommitted = 1,
+    kPadding = 2,
+  };
+
+  static size_t RecordSize(size_t length);
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_;
+  // Byte positions increase monotonically; the offset in |buffer_| is position % capacity_
+  std::atomic<uint64_t> reserve_position_{0};
+  std::atomic<uint64_t> release_position_{0};
+  uint64_t peek_position_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace hal
+}  // namespace bluetooth
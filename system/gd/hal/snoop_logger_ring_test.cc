@@ -0,0 +1,162 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snoop_logger_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+std::string ToString(const struct iovec& record) {
+  return std::string(static_cast<const char*>(record.iov_base), record.iov_len);
+}
+
+bool PushString(SnoopLoggerRing& ring, const std::string& header, const std::string& payload) {
+  return ring.Push(header.data(), header.size(), payload.data(), payload.size());
+}
+
+TEST(SnoopLoggerRingTest, capacity_is_rounded_up) {
+  SnoopLoggerRing ring(1000);
+  EXPECT_EQ(ring.GetCapacity(), 1024u);
+  EXPECT_EQ(ring.GetUsedBytes(), 0u);
+}
+
+TEST(SnoopLoggerRingTest, records_are_read_in_order) {
+  SnoopLoggerRing ring(256);
+  ASSERT_TRUE(PushString(ring, "hdr1", "payload1"));
+  ASSERT_TRUE(PushString(ring, "h2", ""));
+  ASSERT_TRUE(PushString(ring, "", "p3"));
+
+  std::vector<struct iovec> records;
+  ASSERT_EQ(ring.Peek(&records, 10), 3u);
+  EXPECT_EQ(ToString(records[0]), "hdr1payload1");
+  EXPECT_EQ(ToString(records[1]), "h2");
+  EXPECT_EQ(ToString(records[2]), "p3");
+  ring.Release();
+
+  records.clear();
+  EXPECT_EQ(ring.Peek(&records, 10), 0u);
+  EXPECT_EQ(ring.GetUsedBytes(), 0u);
+}
+
+TEST(SnoopLoggerRingTest, peek_stops_after_max_records) {
+  SnoopLoggerRing ring(256);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(PushString(ring, "r", std::to_string(i)));
+  }
+
+  std::vector<struct iovec> records;
+  ASSERT_EQ(ring.Peek(&records, 2), 2u);
+  EXPECT_EQ(ToString(records[1]), "r1");
+  ring.Release();
+
+  records.clear();
+  ASSERT_EQ(ring.Peek(&records, 2), 1u);
+  EXPECT_EQ(ToString(records[0]), "r2");
+  ring.Release();
+}
+
+TEST(SnoopLoggerRingTest, full_ring_drops_records) {
+  SnoopLoggerRing ring(64);
+  std::string payload(20, 'x');
+  // 8 byte record header + 20 bytes, rounded up to 32 bytes per record
+  ASSERT_TRUE(PushString(ring, "", payload));
+  ASSERT_TRUE(PushString(ring, "", payload));
+  EXPECT_FALSE(PushString(ring, "", payload));
+  EXPECT_EQ(ring.GetDroppedCount(), 1u);
+
+  std::vector<struct iovec> records;
+  ASSERT_EQ(ring.Peek(&records, 10), 2u);
+  ring.Release();
+  EXPECT_TRUE(PushString(ring, "", payload));
+  EXPECT_EQ(ring.GetDroppedCount(), 1u);
+}
+
+TEST(SnoopLoggerRingTest, oversized_record_is_dropped) {
+  SnoopLoggerRing ring(64);
+  EXPECT_FALSE(PushString(ring, "", std::string(64, 'x')));
+  EXPECT_EQ(ring.GetDroppedCount(), 1u);
+  EXPECT_EQ(ring.GetUsedBytes(), 0u);
+}
+
+TEST(SnoopLoggerRingTest, record_does_not_wrap_around) {
+  SnoopLoggerRing ring(64);
+  std::vector<struct iovec> records;
+  // Advance the ring to offset 40
+  ASSERT_TRUE(PushString(ring, "", std::string(32, 'a')));
+  ASSERT_EQ(ring.Peek(&records, 10), 1u);
+  ring.Release();
+
+  // Needs 32 bytes, only 24 are left before the end: skipped as padding
+  records.clear();
+  ASSERT_TRUE(PushString(ring, "bb", std::string(20, 'b')));
+  ASSERT_EQ(ring.Peek(&records, 10), 1u);
+  EXPECT_EQ(ToString(records[0]), "bb" + std::string(20, 'b'));
+  ring.Release();
+  EXPECT_EQ(ring.GetUsedBytes(), 0u);
+}
+
+TEST(SnoopLoggerRingTest, multiple_producers_keep_per_producer_order) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumPerProducer = 10000;
+  SnoopLoggerRing ring(4096);
+  std::vector<std::thread> producers;
+  std::atomic<int> pushed = 0;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&ring, &pushed, p]() {
+      for (int i = 0; i < kNumPerProducer; i++) {
+        if (ring.Push(&p, sizeof(p), &i, sizeof(i))) {
+          pushed++;
+        }
+      }
+    });
+  }
+
+  std::vector<int> last_seen(kNumProducers, -1);
+  int received = 0;
+  std::vector<struct iovec> records;
+  auto drain = [&]() {
+    records.clear();
+    ring.Peek(&records, 64);
+    for (const auto& record : records) {
+      ASSERT_EQ(record.iov_len, 2 * sizeof(int));
+      const int* values = static_cast<const int*>(record.iov_base);
+      ASSERT_GT(values[1], last_seen[values[0]]);
+      last_seen[values[0]] = values[1];
+      received++;
+    }
+    ring.Release();
+  };
+  while (received + (int)ring.GetDroppedCount() < kNumProducers * kNumPerProducer) {
+    drain();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  drain();
+  EXPECT_EQ(received, pushed.load());
+  EXPECT_EQ(received + ring.GetDroppedCount(), (uint64_t)kNumProducers * kNumPerProducer);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
@@ -124,17 +124,19 @@ class TestSnoopLoggerModule : public SnoopLogger {
       size_t max_packets_per_file,
       const std::string& btsnoop_mode,
       bool qualcomm_debug_log_enabled,
-      bool snoop_log_persists)
+      bool snoop_log_persists,
+      std::chrono::milliseconds async_flush_interval = 0ms)
       : SnoopLogger(
             std::move(snoop_log_path),
             std::move(snooz_log_path),
             max_packets_per_file,
-            SnoopLogger::GetMaxPacketsPerBuffer(),
+            SnoopLogger::GetMaxBytesPerBuffer(),
             btsnoop_mode,
             qualcomm_debug_log_enabled,
             20ms,
             5ms,
-            snoop_log_persists) {}
+            snoop_log_persists,
+            async_flush_interval) {}
 
   std::string ToString() const override {
     return std::string("TestSnoopLoggerModule");
@@ -294,6 +296,34 @@ TEST_F(SnoopLoggerModuleTest, capture_one_packet_test) {
       sizeof(SnoopLoggerCommon::FileHeaderType) + sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size());
 }
 
+TEST_F(SnoopLoggerModuleTest, capture_packets_async_test) {
+  // Actual test
+  auto* snoop_logger = new TestSnoopLoggerModule(
+      temp_snoop_log_.string(),
+      temp_snooz_log_.string(),
+      10,
+      SnoopLogger::kBtSnoopLogModeFull,
+      false,
+      false,
+      1000ms);
+  test_registry->InjectTestModule(&SnoopLogger::Factory, snoop_logger);
+
+  for (int i = 0; i < 5; i++) {
+    snoop_logger->Capture(kInformationRequest, SnoopLogger::Direction::OUTGOING, SnoopLogger::PacketType::CMD);
+  }
+
+  // Packets still queued for the writer are written when the module stops
+  test_registry->StopAll();
+
+  // Verify states after test
+  ASSERT_TRUE(std::filesystem::exists(temp_snoop_log_));
+  ASSERT_EQ(
+      std::filesystem::file_size(temp_snoop_log_),
+      sizeof(SnoopLoggerCommon::FileHeaderType) +
+          5 * (sizeof(SnoopLogger::PacketHeaderType) + kInformationRequest.size()));
+  ASSERT_EQ(snoop_logger->GetDroppedPacketCount(), 0u);
+}
+
 TEST_F(SnoopLoggerModuleTest, capture_hci_cmd_btsnooz_test) {
   // Actual test
   auto* snoop_logger = new TestSnoopLoggerModule(
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snooz_log_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bluetooth {
+namespace hal {
+
+SnoozLogBuffer::SnoozLogBuffer(size_t capacity) : buffer_(new uint8_t[capacity]), capacity_(capacity) {}
+
+bool SnoozLogBuffer::Push(const void* header, size_t header_length, const void* payload, size_t payload_length) {
+  size_t length = header_length + payload_length;
+  size_t record_size = sizeof(uint32_t) + length;
+  if (record_size > capacity_) {
+    return false;
+  }
+
+  while (capacity_ - used_ < record_size) {
+    size_t evicted_size = sizeof(uint32_t) + ReadLength(head_);
+    head_ = Advance(head_, evicted_size);
+    used_ -= evicted_size;
+    record_count_--;
+  }
+
+  uint32_t record_length = length;
+  size_t offset = Advance(head_, used_);
+  offset = Write(offset, &record_length, sizeof(record_length));
+  offset = Write(offset, header, header_length);
+  Write(offset, payload, payload_length);
+  used_ += record_size;
+  record_count_++;
+  return true;
+}
+
+void SnoozLogBuffer::Clear() {
+  head_ = 0;
+  used_ = 0;
+  record_count_ = 0;
+}
+
+uint32_t SnoozLogBuffer::ReadLength(size_t offset) const {
+  uint8_t bytes[sizeof(uint32_t)];
+  size_t first_length = std::min(sizeof(bytes), capacity_ - offset);
+  std::memcpy(bytes, &buffer_[offset], first_length);
+  std::memcpy(bytes + first_length, &buffer_[0], sizeof(bytes) - first_length);
+  uint32_t length;
+  std::memcpy(&length, bytes, sizeof(length));
+  return length;
+}
+
+size_t SnoozLogBuffer::Write(size_t offset, const void* data, size_t length) {
+  size_t first_length = std::min(length, capacity_ - offset);
+  std::memcpy(&buffer_[offset], data, first_length);
+  std::memcpy(&buffer_[0], static_cast<const uint8_t*>(data) + first_length, length - first_length);
+  return Advance(offset, length);
+}
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bluetooth {
+namespace hal {
+
+// Fixed-size ring of variable length records kept in one contiguous byte arena, used for the in-memory btsnooz log.
+// Each record is stored as a 32 bit length followed by its bytes and may wrap around the end of the arena. Pushing
+// never allocates: the oldest records are evicted until the new one fits. Not thread safe; the caller serializes
+// access.
+class SnoozLogBuffer {
+ public:
+  explicit SnoozLogBuffer(size_t capacity);
+
+  SnoozLogBuffer(const SnoozLogBuffer&) = delete;
+  SnoozLogBuffer& operator=(const SnoozLogBuffer&) = delete;
+
+  // Copy |header| followed by |payload| into the arena as one record, evicting the oldest records to make room.
+  // Returns false if the record is larger than the whole arena, in which case it is dropped.
+  bool Push(const void* header, size_t header_length, const void* payload, size_t payload_length);
+
+  // Call |visitor(data, length, wrapped_data, wrapped_length)| for every record, oldest first. The record bytes are
+  // |data| followed by |wrapped_data|; |wrapped_length| is zero unless the record wraps around the end of the arena.
+  template <typename Visitor>
+  void ForEach(Visitor&& visitor) const {
+    size_t offset = head_;
+    for (size_t i = 0; i < record_count_; i++) {
+      uint32_t length = ReadLength(offset);
+      offset = Advance(offset, sizeof(uint32_t));
+      size_t first_length = std::min<size_t>(length, capacity_ - offset);
+      visitor(&buffer_[offset], first_length, &buffer_[0], length - first_length);
+      offset = Advance(offset, length);
+    }
+  }
+
+  // Drop every record
+  void Clear();
+
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+  // Bytes used by the stored records, including their length prefixes
+  size_t GetUsedBytes() const {
+    return used_;
+  }
+
+  size_t GetRecordCount() const {
+    return record_count_;
+  }
+
+ private:
+  size_t Advance(size_t offset, size_t length) const {
+    offset += length;
+    return offset >= capacity_ ? offset - capacity_ : offset;
+  }
+  uint32_t ReadLength(size_t offset) const;
+  // Copy |length| bytes to |offset|, wrapping around the end of the arena. Returns the offset following them.
+  size_t Write(size_t offset, const void* data, size_t length);
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_;
+  size_t head_ = 0;  // Offset of the oldest record
+  size_t used_ = 0;
+  size_t record_count_ = 0;
+};
+
+}  // namespace hal
+}  // namespace bluetooth
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/snooz_log_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace bluetooth {
+namespace hal {
+namespace {
+
+bool PushString(SnoozLogBuffer& buffer, const std::string& header, const std::string& payload) {
+  return buffer.Push(header.data(), header.size(), payload.data(), payload.size());
+}
+
+std::vector<std::string> GetRecords(const SnoozLogBuffer& buffer) {
+  std::vector<std::string> records;
+  buffer.ForEach([&records](const uint8_t* data, size_t length, const uint8_t* wrapped_data, size_t wrapped_length) {
+    std::string record(reinterpret_cast<const char*>(data), length);
+    record.append(reinterpret_cast<const char*>(wrapped_data), wrapped_length);
+    records.push_back(record);
+  });
+  return records;
+}
+
+TEST(SnoozLogBufferTest, records_are_read_in_order) {
+  SnoozLogBuffer buffer(256);
+  ASSERT_TRUE(PushString(buffer, "hdr1", "payload1"));
+  ASSERT_TRUE(PushString(buffer, "h2", ""));
+  ASSERT_TRUE(PushString(buffer, "", "p3"));
+
+  EXPECT_EQ(GetRecords(buffer), (std::vector<std::string>{"hdr1payload1", "h2", "p3"}));
+  EXPECT_EQ(buffer.GetRecordCount(), 3u);
+  EXPECT_EQ(buffer.GetUsedBytes(), 3 * sizeof(uint32_t) + 16);
+}
+
+TEST(SnoozLogBufferTest, oldest_records_are_evicted) {
+  // Room for exactly three 12 byte records
+  SnoozLogBuffer buffer(36);
+  ASSERT_TRUE(PushString(buffer, "aaaa", "aaaa"));
+  ASSERT_TRUE(PushString(buffer, "bbbb", "bbbb"));
+  ASSERT_TRUE(PushString(buffer, "cccc", "cccc"));
+  EXPECT_EQ(buffer.GetUsedBytes(), 36u);
+
+  ASSERT_TRUE(PushString(buffer, "dddd", "dddd"));
+  EXPECT_EQ(GetRecords(buffer), (std::vector<std::string>{"bbbbbbbb", "cccccccc", "dddddddd"}));
+
+  // A larger record evicts as many records as it needs
+  ASSERT_TRUE(PushString(buffer, "eeeeeeee", "eeeeeeee"));
+  EXPECT_EQ(GetRecords(buffer), (std::vector<std::string>{"dddddddd", "eeeeeeeeeeeeeeee"}));
+}
+
+TEST(SnoozLogBufferTest, records_wrap_around_the_end) {
+  // Three 14 byte records leave 3 bytes at the end, so the fourth length prefix is split
+  SnoozLogBuffer buffer(45);
+  ASSERT_TRUE(PushString(buffer, "0123", "456789"));
+  ASSERT_TRUE(PushString(buffer, "abcd", "efghij"));
+  ASSERT_TRUE(PushString(buffer, "ABCD", "EFGHIJ"));
+  ASSERT_TRUE(PushString(buffer, "klmn", "opqrst"));
+  ASSERT_TRUE(PushString(buffer, "KLMN", "OPQRST"));
+  EXPECT_EQ(
+      GetRecords(buffer), (std::vector<std::string>{"ABCDEFGHIJ", "klmnopqrst", "KLMNOPQRST"}));
+
+  // Keep pushing so that both record data and length prefixes land across the end of the arena
+  for (int i = 0; i < 50; i++) {
+    std::string header(1 + i % 5, static_cast<char>('a' + i % 26));
+    std::string payload(i % 7, static_cast<char>('A' + i % 26));
+    ASSERT_TRUE(PushString(buffer, header, payload));
+    auto records = GetRecords(buffer);
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(records.back(), header + payload);
+    EXPECT_LE(buffer.GetUsedBytes(), buffer.GetCapacity());
+  }
+}
+
+TEST(SnoozLogBufferTest, oversized_record_is_dropped) {
+  SnoozLogBuffer buffer(16);
+  ASSERT_TRUE(PushString(buffer, "keep", ""));
+  EXPECT_FALSE(PushString(buffer, "0123456789", "abc"));
+  EXPECT_EQ(GetRecords(buffer), (std::vector<std::string>{"keep"}));
+}
+
+TEST(SnoozLogBufferTest, clear_drops_all_records) {
+  SnoozLogBuffer buffer(64);
+  ASSERT_TRUE(PushString(buffer, "hdr", "payload"));
+  buffer.Clear();
+  EXPECT_EQ(buffer.GetRecordCount(), 0u);
+  EXPECT_EQ(buffer.GetUsedBytes(), 0u);
+  EXPECT_TRUE(GetRecords(buffer).empty());
+  ASSERT_TRUE(PushString(buffer, "new", ""));
+  EXPECT_EQ(GetRecords(buffer), (std::vector<std::string>{"new"}));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace bluetooth
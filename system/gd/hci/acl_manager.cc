@@ -35,6 +35,7 @@
 #include "hci/hci_layer.h"
 #include "hci/remote_name_request.h"
 #include "hci_acl_manager_generated.h"
+#include "os/system_properties.h"
 #include "security/security_module.h"
 #include "storage/config_keys.h"
 #include "storage/storage_module.h"
@@ -44,6 +45,9 @@ namespace hci {
 
 constexpr uint16_t kQualcommDebugHandle = 0xedc;
 
+static const std::string kPropertyAclDeficitRoundRobin = "bluetooth.core.acl.deficit_round_robin";
+static const std::string kPropertyAclSchedulerQuantum = "bluetooth.core.acl.scheduler_quantum";
+
 using acl_manager::AclConnection;
 using common::Bind;
 using common::BindOnce;
@@ -69,6 +73,13 @@ struct AclManager::impl {
     handler_ = acl_manager_.GetHandler();
     controller_ = acl_manager_.GetDependency<Controller>();
     round_robin_scheduler_ = new RoundRobinScheduler(handler_, controller_, hci_layer_->GetAclQueueEnd());
+    if (os::GetSystemPropertyBool(kPropertyAclDeficitRoundRobin, false)) {
+      round_robin_scheduler_->SetSchedulingMode(RoundRobinScheduler::SchedulingMode::DEFICIT_ROUND_ROBIN);
+    }
+    auto quantum = os::GetSystemPropertyUint32(kPropertyAclSchedulerQuantum, 0);
+    if (quantum != 0) {
+      round_robin_scheduler_->SetQuantum(quantum);
+    }
     acl_scheduler_ = acl_manager_.GetDependency<AclScheduler>();
 
     remote_name_request_module_ = acl_manager_.GetDependency<RemoteNameRequestModule>();
@@ -109,7 +120,11 @@ struct AclManager::impl {
     unknown_acl_alarm_.reset();
     waiting_packets_.clear();
 
-    delete round_robin_scheduler_;
+    {
+      const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+      delete round_robin_scheduler_;
+      round_robin_scheduler_ = nullptr;
+    }
     hci_queue_end_ = nullptr;
     handler_ = nullptr;
     hci_layer_ = nullptr;
@@ -422,6 +437,10 @@ void AclManager::HACK_SetAclTxPriority(uint8_t handle, bool high_priority) {
   CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkPriority, handle, high_priority);
 }
 
+void AclManager::SetAclTxWeight(uint16_t handle, uint16_t weight) {
+  CallOn(pimpl_->round_robin_scheduler_, &RoundRobinScheduler::SetLinkWeight, handle, weight);
+}
+
 void AclManager::ListDependencies(ModuleList* list) const {
   list->add<HciLayer>();
   list->add<Controller>();
@@ -466,12 +485,36 @@ void AclManager::impl::Dump(
   }
   auto vecofstrings = fb_builder->CreateVector(strings, accept_list.size());
 
+  const auto scheduling_mode_text = (round_robin_scheduler_ != nullptr)
+                                        ? fmt::format("{}", round_robin_scheduler_->GetSchedulingMode())
+                                        : "INDETERMINATE";
+  const auto link_stats = (round_robin_scheduler_ != nullptr) ? round_robin_scheduler_->GetLinkStats()
+                                                              : std::vector<RoundRobinScheduler::LinkStats>();
+  auto acl_scheduling_mode = fb_builder->CreateString(scheduling_mode_text);
+  std::vector<flatbuffers::Offset<AclSchedulerLinkData>> scheduler_links;
+  for (const auto& it : link_stats) {
+    auto connection_type = fb_builder->CreateString(fmt::format("{}", it.connection_type));
+    AclSchedulerLinkDataBuilder link_builder(*fb_builder);
+    link_builder.add_handle(it.handle);
+    link_builder.add_connection_type(connection_type);
+    link_builder.add_weight(it.weight);
+    link_builder.add_credits_used(it.credits_used);
+    link_builder.add_bytes_sent(it.bytes_sent);
+    link_builder.add_average_queueing_delay_us(
+        it.credits_used == 0 ? 0 : it.total_queueing_delay.count() / it.credits_used);
+    link_builder.add_max_queueing_delay_us(it.max_queueing_delay.count());
+    scheduler_links.push_back(link_builder.Finish());
+  }
+  auto acl_scheduler_links = fb_builder->CreateVector(scheduler_links);
+
   AclManagerDataBuilder builder(*fb_builder);
   builder.add_title(title);
   builder.add_le_filter_accept_list_count(accept_list.size());
   builder.add_le_filter_accept_list(vecofstrings);
   builder.add_le_connectability_state(le_connectability_state);
   builder.add_le_create_connection_timeout_alarms_count(le_create_connection_timeout_alarms_count);
+  builder.add_acl_scheduling_mode(acl_scheduling_mode);
+  builder.add_acl_scheduler_links(acl_scheduler_links);
 
   flatbuffers::Offset<AclManagerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
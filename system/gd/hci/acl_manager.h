@@ -146,6 +146,9 @@ class AclManager : public Module {
   virtual void OnLeSuspendInitiatedDisconnect(uint16_t handle, ErrorCode reason);
   virtual void SetSystemSuspendState(bool suspended);
 
+  // Relative share of the controller ACL buffers for |handle| when deficit round robin scheduling is enabled
+  virtual void SetAclTxWeight(uint16_t handle, uint16_t weight);
+
   static const ModuleFactory Factory;
 
  protected:
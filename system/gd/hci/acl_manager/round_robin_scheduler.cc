@@ -18,6 +18,9 @@
 
 #include <bluetooth/log.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "hci/acl_manager/acl_fragmenter.h"
 namespace bluetooth {
 namespace hci {
@@ -33,6 +36,7 @@ RoundRobinScheduler::RoundRobinScheduler(
   le_max_acl_packet_credits_ = le_buffer_size.total_num_le_packets_;
   le_acl_packet_credits_ = le_max_acl_packet_credits_;
   le_hci_mtu_ = le_buffer_size.le_data_packet_length_;
+  quantum_bytes_ = std::max<size_t>({hci_mtu_, le_hci_mtu_, 1});
   controller_->RegisterCompletedAclPacketsCallback(handler->BindOn(this, &RoundRobinScheduler::incoming_acl_credits));
 }
 
@@ -44,20 +48,34 @@ RoundRobinScheduler::~RoundRobinScheduler() {
 void RoundRobinScheduler::Register(ConnectionType connection_type, uint16_t handle,
                                    std::shared_ptr<acl_manager::AclConnection::Queue> queue) {
   log::assert_that(
-      acl_queue_handlers_.count(handle) == 0,
-      "assert failed: acl_queue_handlers_.count(handle) == 0");
-  acl_queue_handler acl_queue_handler = {connection_type, std::move(queue), false, 0};
-  acl_queue_handlers_.insert(std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
+      find_acl_queue_handler(handle) == acl_queue_handlers_.end(),
+      "assert failed: find_acl_queue_handler(handle) == acl_queue_handlers_.end()");
+  acl_queue_handler acl_queue_handler = {handle, connection_type, std::move(queue), false, 0};
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto position = std::lower_bound(
+        acl_queue_handlers_.begin(), acl_queue_handlers_.end(), handle,
+        [](const RoundRobinScheduler::acl_queue_handler& a, uint16_t h) { return a.handle_ < h; });
+    size_t index = position - acl_queue_handlers_.begin();
+    // Keep the round robin positions on the same links
+    if (index <= starting_point_ && starting_point_ < acl_queue_handlers_.size()) {
+      starting_point_++;
+    }
+    if (index <= drr_cursor_ && drr_cursor_ < acl_queue_handlers_.size()) {
+      drr_cursor_++;
+    }
+    acl_queue_handlers_.insert(position, std::move(acl_queue_handler));
+  }
   if (fragments_to_send_.size() == 0) {
     start_round_robin();
   }
 }
 
 void RoundRobinScheduler::Unregister(uint16_t handle) {
+  auto acl_queue_handler = find_acl_queue_handler(handle);
   log::assert_that(
-      acl_queue_handlers_.count(handle) == 1,
-      "assert failed: acl_queue_handlers_.count(handle) == 1");
-  auto acl_queue_handler = acl_queue_handlers_.find(handle)->second;
+      acl_queue_handler != acl_queue_handlers_.end(),
+      "assert failed: acl_queue_handler != acl_queue_handlers_.end()");
 
   //Clear fragments which did not send
   while (!fragments_to_send_.empty()) {
@@ -69,19 +87,26 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
     }
   }
   // Reclaim outstanding packets
-  if (acl_queue_handler.connection_type_ == ConnectionType::CLASSIC) {
-    acl_packet_credits_ += acl_queue_handler.number_of_sent_packets_;
+  if (acl_queue_handler->connection_type_ == ConnectionType::CLASSIC) {
+    acl_packet_credits_ += acl_queue_handler->number_of_sent_packets_;
   } else {
-    le_acl_packet_credits_ += acl_queue_handler.number_of_sent_packets_;
+    le_acl_packet_credits_ += acl_queue_handler->number_of_sent_packets_;
   }
-  acl_queue_handler.number_of_sent_packets_ = 0;
+  acl_queue_handler->number_of_sent_packets_ = 0;
 
-  if (acl_queue_handler.dequeue_is_registered_) {
-    acl_queue_handler.dequeue_is_registered_ = false;
-    acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
+  if (acl_queue_handler->dequeue_is_registered_) {
+    acl_queue_handler->dequeue_is_registered_ = false;
+    acl_queue_handler->queue_->GetDownEnd()->UnregisterDequeue();
+  }
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    size_t index = acl_queue_handler - acl_queue_handlers_.begin();
+    if (index < drr_cursor_) {
+      drr_cursor_--;
+    }
+    acl_queue_handlers_.erase(acl_queue_handler);
   }
-  acl_queue_handlers_.erase(handle);
-  starting_point_ = acl_queue_handlers_.begin();
+  starting_point_ = 0;
 
   if (!enqueue_registered_.load() &&
       !acl_queue_handlers_.empty()) {
@@ -91,12 +116,45 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
 }
 
 void RoundRobinScheduler::SetLinkPriority(uint16_t handle, bool high_priority) {
-  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  auto acl_queue_handler = find_acl_queue_handler(handle);
   if (acl_queue_handler == acl_queue_handlers_.end()) {
     log::warn("handle {} is invalid", handle);
     return;
   }
-  acl_queue_handler->second.high_priority_ = high_priority;
+  acl_queue_handler->high_priority_ = high_priority;
+}
+
+void RoundRobinScheduler::SetSchedulingMode(SchedulingMode mode) {
+  if (mode == scheduling_mode_) {
+    return;
+  }
+  log::info("ACL scheduling mode {}", mode);
+  scheduling_mode_ = mode;
+  for (auto& acl_queue_handler : acl_queue_handlers_) {
+    acl_queue_handler.deficit_ = 0;
+  }
+}
+
+void RoundRobinScheduler::SetLinkWeight(uint16_t handle, uint16_t weight) {
+  auto acl_queue_handler = find_acl_queue_handler(handle);
+  if (acl_queue_handler == acl_queue_handlers_.end()) {
+    log::warn("handle {} is invalid", handle);
+    return;
+  }
+  if (weight == 0) {
+    log::warn("weight 0 is invalid for handle {}, using 1", handle);
+    weight = 1;
+  }
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  acl_queue_handler->weight_ = weight;
+}
+
+void RoundRobinScheduler::SetQuantum(size_t quantum_bytes) {
+  if (quantum_bytes == 0) {
+    log::warn("quantum must be at least 1 byte");
+    return;
+  }
+  quantum_bytes_ = quantum_bytes;
 }
 
 uint16_t RoundRobinScheduler::GetCredits() {
@@ -107,6 +165,37 @@ uint16_t RoundRobinScheduler::GetLeCredits() {
   return le_acl_packet_credits_;
 }
 
+RoundRobinScheduler::SchedulingMode RoundRobinScheduler::GetSchedulingMode() const {
+  return scheduling_mode_;
+}
+
+std::vector<RoundRobinScheduler::LinkStats> RoundRobinScheduler::GetLinkStats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  std::vector<LinkStats> link_stats;
+  link_stats.reserve(acl_queue_handlers_.size());
+  for (const auto& acl_queue_handler : acl_queue_handlers_) {
+    link_stats.push_back(
+        {acl_queue_handler.handle_,
+         acl_queue_handler.connection_type_,
+         acl_queue_handler.weight_,
+         acl_queue_handler.credits_used_,
+         acl_queue_handler.bytes_sent_,
+         acl_queue_handler.total_queueing_delay_,
+         acl_queue_handler.max_queueing_delay_});
+  }
+  return link_stats;
+}
+
+RoundRobinScheduler::AclQueueHandlers::iterator RoundRobinScheduler::find_acl_queue_handler(uint16_t handle) {
+  auto acl_queue_handler = std::lower_bound(
+      acl_queue_handlers_.begin(), acl_queue_handlers_.end(), handle,
+      [](const RoundRobinScheduler::acl_queue_handler& a, uint16_t h) { return a.handle_ < h; });
+  if (acl_queue_handler == acl_queue_handlers_.end() || acl_queue_handler->handle_ != handle) {
+    return acl_queue_handlers_.end();
+  }
+  return acl_queue_handler;
+}
+
 void RoundRobinScheduler::start_round_robin() {
   if (acl_packet_credits_ == 0 && le_acl_packet_credits_ == 0) {
     return;
@@ -127,69 +216,84 @@ void RoundRobinScheduler::start_round_robin() {
     return;
   }
 
-  if (acl_queue_handlers_.size() == 1 || starting_point_ == acl_queue_handlers_.end()) {
-    starting_point_ = acl_queue_handlers_.begin();
+  if (acl_queue_handlers_.size() == 1 || starting_point_ >= acl_queue_handlers_.size()) {
+    starting_point_ = 0;
   }
   size_t count = acl_queue_handlers_.size();
 
-  for (auto acl_queue_handler = starting_point_; count > 0; count--) {
+  for (size_t index = starting_point_; count > 0; count--) {
+    auto& acl_queue_handler = acl_queue_handlers_[index];
     // Prevent registration when credits is zero
     bool classic_buffer_full =
-        acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::CLASSIC;
-    bool le_buffer_full =
-        le_acl_packet_credits_ == 0 && acl_queue_handler->second.connection_type_ == ConnectionType::LE;
-    if (!acl_queue_handler->second.dequeue_is_registered_ && !classic_buffer_full && !le_buffer_full) {
-      acl_queue_handler->second.dequeue_is_registered_ = true;
-      uint16_t acl_handle = acl_queue_handler->first;
-      acl_queue_handler->second.queue_->GetDownEnd()->RegisterDequeue(
+        acl_packet_credits_ == 0 && acl_queue_handler.connection_type_ == ConnectionType::CLASSIC;
+    bool le_buffer_full = le_acl_packet_credits_ == 0 && acl_queue_handler.connection_type_ == ConnectionType::LE;
+    if (!acl_queue_handler.dequeue_is_registered_ && !classic_buffer_full && !le_buffer_full) {
+      acl_queue_handler.dequeue_is_registered_ = true;
+      uint16_t acl_handle = acl_queue_handler.handle_;
+      acl_queue_handler.queue_->GetDownEnd()->RegisterDequeue(
           handler_, common::Bind(&RoundRobinScheduler::buffer_packet, common::Unretained(this), acl_handle));
     }
-    acl_queue_handler = std::next(acl_queue_handler);
-    if (acl_queue_handler == acl_queue_handlers_.end()) {
-      acl_queue_handler = acl_queue_handlers_.begin();
-    }
+    index = (index + 1) % acl_queue_handlers_.size();
   }
 
-  starting_point_ = std::next(starting_point_);
+  starting_point_++;
 }
 
 void RoundRobinScheduler::buffer_packet(uint16_t acl_handle) {
   BroadcastFlag broadcast_flag = BroadcastFlag::POINT_TO_POINT;
-  auto acl_queue_handler = acl_queue_handlers_.find(acl_handle);
+  auto acl_queue_handler = find_acl_queue_handler(acl_handle);
   if( acl_queue_handler == acl_queue_handlers_.end()) {
     log::error("Ignore since ACL connection vanished with handle: 0x{:X}", acl_handle);
     return;
   }
 
-  // Wrap packet and enqueue it
-  uint16_t handle = acl_queue_handler->first;
-  auto packet = acl_queue_handler->second.queue_->GetDownEnd()->TryDequeue();
+  std::unique_ptr<packet::BasePacketBuilder> packet;
+  if (scheduling_mode_ == SchedulingMode::DEFICIT_ROUND_ROBIN) {
+    // The link that became ready is not necessarily the one whose turn it is
+    packet = dequeue_deficit_round_robin(&acl_queue_handler);
+  } else {
+    packet = acl_queue_handler->queue_->GetDownEnd()->TryDequeue();
+  }
   log::assert_that(packet != nullptr, "assert failed: packet != nullptr");
 
-  ConnectionType connection_type = acl_queue_handler->second.connection_type_;
+  // Wrap packet and enqueue it
+  uint16_t handle = acl_queue_handler->handle_;
+  size_t packet_size = packet->size();
+  auto enqueue_time = std::chrono::steady_clock::now();
+
+  ConnectionType connection_type = acl_queue_handler->connection_type_;
   size_t mtu = connection_type == ConnectionType::CLASSIC ? hci_mtu_ : le_hci_mtu_;
   PacketBoundaryFlag packet_boundary_flag = (packet->IsFlushable())
                                                 ? PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE
                                                 : PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE;
 
-  int acl_priority = acl_queue_handler->second.high_priority_ ? 1 : 0;
-  if (packet->size() <= mtu) {
+  int acl_priority = acl_queue_handler->high_priority_ ? 1 : 0;
+  if (packet_size <= mtu) {
     fragments_to_send_.push(
         std::make_tuple(
-            connection_type, handle, AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))),
+            connection_type,
+            handle,
+            AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet)),
+            enqueue_time),
         acl_priority);
-    acl_queue_handler->second.number_of_sent_packets_ += 1;
+    acl_queue_handler->number_of_sent_packets_ += 1;
   } else {
     auto fragments = AclFragmenter(mtu, std::move(packet)).GetFragments();
     for (size_t i = 0; i < fragments.size(); i++) {
       fragments_to_send_.push(
           std::make_tuple(
-              connection_type, handle,
-              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))),
+              connection_type,
+              handle,
+              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i])),
+              enqueue_time),
           acl_priority);
       packet_boundary_flag = PacketBoundaryFlag::CONTINUING_FRAGMENT;
     }
-    acl_queue_handler->second.number_of_sent_packets_ += fragments.size();
+    acl_queue_handler->number_of_sent_packets_ += fragments.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    acl_queue_handler->bytes_sent_ += packet_size;
   }
   log::assert_that(fragments_to_send_.size() > 0, "assert failed: fragments_to_send_.size() > 0");
   unregister_all_connections();
@@ -197,12 +301,60 @@ void RoundRobinScheduler::buffer_packet(uint16_t acl_handle) {
   send_next_fragment();
 }
 
+// Deficit round robin with the quantum charged after the fact, since the size of a packet is only known once it
+// is dequeued. A link is served while its deficit is positive, so it overspends by less than one packet, and
+// pays that back in the following rounds. Only links registered for dequeue (those with controller buffers
+// available) take part; a link that turns out to be empty forfeits the rest of its quantum.
+std::unique_ptr<packet::BasePacketBuilder> RoundRobinScheduler::dequeue_deficit_round_robin(
+    AclQueueHandlers::iterator* acl_queue_handler) {
+  size_t count = acl_queue_handlers_.size();
+  drr_cursor_ %= count;
+  while (true) {
+    bool backlogged = false;
+    int64_t rounds = std::numeric_limits<int64_t>::max();
+    for (size_t n = 0; n < count; n++) {
+      size_t index = (drr_cursor_ + n) % count;
+      auto& link = acl_queue_handlers_[index];
+      if (!link.dequeue_is_registered_) {
+        continue;
+      }
+      int64_t quantum = quantum_bytes_ * link.weight_;
+      if (link.deficit_ <= 0) {
+        // Rounds until this link may send again
+        backlogged = true;
+        rounds = std::min(rounds, (quantum - link.deficit_) / quantum);
+        continue;
+      }
+      auto packet = link.queue_->GetDownEnd()->TryDequeue();
+      if (packet == nullptr) {
+        link.deficit_ = 0;
+        link.dequeue_is_registered_ = false;
+        link.queue_->GetDownEnd()->UnregisterDequeue();
+        continue;
+      }
+      link.deficit_ -= packet->size();
+      // Stay on this link until its deficit is used up
+      drr_cursor_ = link.deficit_ > 0 ? index : (index + 1) % count;
+      *acl_queue_handler = acl_queue_handlers_.begin() + index;
+      return packet;
+    }
+    if (!backlogged) {
+      return nullptr;
+    }
+    // Nobody may send in the current round: skip ahead to the first round in which some link can
+    for (auto& link : acl_queue_handlers_) {
+      if (link.dequeue_is_registered_) {
+        link.deficit_ += rounds * static_cast<int64_t>(quantum_bytes_ * link.weight_);
+      }
+    }
+  }
+}
+
 void RoundRobinScheduler::unregister_all_connections() {
-  for (auto acl_queue_handler = acl_queue_handlers_.begin(); acl_queue_handler != acl_queue_handlers_.end();
-       acl_queue_handler = std::next(acl_queue_handler)) {
-    if (acl_queue_handler->second.dequeue_is_registered_) {
-      acl_queue_handler->second.dequeue_is_registered_ = false;
-      acl_queue_handler->second.queue_->GetDownEnd()->UnregisterDequeue();
+  for (auto& acl_queue_handler : acl_queue_handlers_) {
+    if (acl_queue_handler.dequeue_is_registered_) {
+      acl_queue_handler.dequeue_is_registered_ = false;
+      acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
     }
   }
 }
@@ -234,6 +386,16 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     le_acl_packet_credits_ -= 1;
   }
 
+  auto acl_queue_handler = find_acl_queue_handler(std::get<1>(fragments_to_send_.front()));
+  if (acl_queue_handler != acl_queue_handlers_.end()) {
+    auto queueing_delay = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - std::get<3>(fragments_to_send_.front()));
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    acl_queue_handler->credits_used_++;
+    acl_queue_handler->total_queueing_delay_ += queueing_delay;
+    acl_queue_handler->max_queueing_delay_ = std::max(acl_queue_handler->max_queueing_delay_, queueing_delay);
+  }
+
   auto raw_pointer = std::get<2>(fragments_to_send_.front()).release();
   fragments_to_send_.pop();
   if (fragments_to_send_.empty()) {
@@ -253,20 +415,20 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
 }
 
 void RoundRobinScheduler::incoming_acl_credits(uint16_t handle, uint16_t credits) {
-  auto acl_queue_handler = acl_queue_handlers_.find(handle);
+  auto acl_queue_handler = find_acl_queue_handler(handle);
   if (acl_queue_handler == acl_queue_handlers_.end()) {
     return;
   }
 
-  if (acl_queue_handler->second.number_of_sent_packets_ >= credits) {
-    acl_queue_handler->second.number_of_sent_packets_ -= credits;
+  if (acl_queue_handler->number_of_sent_packets_ >= credits) {
+    acl_queue_handler->number_of_sent_packets_ -= credits;
   } else {
     log::warn("receive more credits than we sent");
-    acl_queue_handler->second.number_of_sent_packets_ = 0;
+    acl_queue_handler->number_of_sent_packets_ = 0;
   }
 
   bool credit_was_zero = false;
-  if (acl_queue_handler->second.connection_type_ == ConnectionType::CLASSIC) {
+  if (acl_queue_handler->connection_type_ == ConnectionType::CLASSIC) {
     if (acl_packet_credits_ == 0) {
       credit_was_zero = true;
     }
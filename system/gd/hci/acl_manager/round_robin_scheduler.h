@@ -19,6 +19,10 @@
 #include <bluetooth/log.h>
 #include <stdint.h>
 
+#include <chrono>
+#include <mutex>
+#include <vector>
+
 #include "common/bidi_queue.h"
 #include "common/multi_priority_queue.h"
 #include "hci/acl_manager/acl_connection.h"
@@ -38,24 +42,63 @@ class RoundRobinScheduler {
 
   enum ConnectionType { CLASSIC, LE };
 
+  // ROUND_ROBIN serves one packet per ready link in turn. DEFICIT_ROUND_ROBIN shares the controller buffers in
+  // proportion to the link weights: each round a backlogged link may send up to weight * quantum bytes.
+  enum SchedulingMode { ROUND_ROBIN, DEFICIT_ROUND_ROBIN };
+
+  static constexpr uint16_t kDefaultLinkWeight = 1;
+
   struct acl_queue_handler {
+    uint16_t handle_;
     ConnectionType connection_type_;
     std::shared_ptr<acl_manager::AclConnection::Queue> queue_;
     bool dequeue_is_registered_ = false;
     uint16_t number_of_sent_packets_ = 0;  // Track credits
     bool high_priority_ = false;           // For A2dp use
+    uint16_t weight_ = kDefaultLinkWeight;
+    int64_t deficit_ = 0;  // Bytes the link may still send in the current round, negative when overspent
+    // Counters reported in dumpsys
+    uint64_t credits_used_ = 0;
+    uint64_t bytes_sent_ = 0;
+    std::chrono::microseconds total_queueing_delay_{0};
+    std::chrono::microseconds max_queueing_delay_{0};
+  };
+
+  // Snapshot of the counters of one link
+  struct LinkStats {
+    uint16_t handle;
+    ConnectionType connection_type;
+    uint16_t weight;
+    uint64_t credits_used;
+    uint64_t bytes_sent;
+    // Time fragments waited in the scheduler for a controller buffer
+    std::chrono::microseconds total_queueing_delay;
+    std::chrono::microseconds max_queueing_delay;
   };
 
   void Register(ConnectionType connection_type, uint16_t handle,
                 std::shared_ptr<acl_manager::AclConnection::Queue> queue);
   void Unregister(uint16_t handle);
   void SetLinkPriority(uint16_t handle, bool high_priority);
+  void SetSchedulingMode(SchedulingMode mode);
+  // Relative share of the controller buffers of |handle| in DEFICIT_ROUND_ROBIN mode, must be at least 1
+  void SetLinkWeight(uint16_t handle, uint16_t weight);
+  // Bytes a link of weight 1 may send per round in DEFICIT_ROUND_ROBIN mode, defaults to the larger ACL MTU
+  void SetQuantum(size_t quantum_bytes);
   uint16_t GetCredits();
   uint16_t GetLeCredits();
+  SchedulingMode GetSchedulingMode() const;
+  // Safe to call from any thread
+  std::vector<LinkStats> GetLinkStats() const;
 
  private:
+  using AclQueueHandlers = std::vector<acl_queue_handler>;
+
+  // Links are kept sorted by handle
+  AclQueueHandlers::iterator find_acl_queue_handler(uint16_t handle);
   void start_round_robin();
   void buffer_packet(uint16_t acl_handle);
+  std::unique_ptr<packet::BasePacketBuilder> dequeue_deficit_round_robin(AclQueueHandlers::iterator* acl_queue_handler);
   void unregister_all_connections();
   void send_next_fragment();
   std::unique_ptr<AclBuilder> handle_enqueue_next_fragment();
@@ -63,8 +106,13 @@ class RoundRobinScheduler {
 
   os::Handler* handler_ = nullptr;
   Controller* controller_ = nullptr;
-  std::map<uint16_t, acl_queue_handler> acl_queue_handlers_;
-  common::MultiPriorityQueue<std::tuple<ConnectionType, uint16_t, std::unique_ptr<AclBuilder>>, 2> fragments_to_send_;
+  AclQueueHandlers acl_queue_handlers_;
+  // Guards |acl_queue_handlers_| membership and counters against GetLinkStats()
+  mutable std::mutex stats_mutex_;
+  common::MultiPriorityQueue<
+      std::tuple<ConnectionType, uint16_t, std::unique_ptr<AclBuilder>, std::chrono::steady_clock::time_point>,
+      2>
+      fragments_to_send_;
   uint16_t max_acl_packet_credits_ = 0;
   uint16_t acl_packet_credits_ = 0;
   uint16_t le_max_acl_packet_credits_ = 0;
@@ -74,7 +122,11 @@ class RoundRobinScheduler {
   std::atomic_bool enqueue_registered_ = false;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
   // first register queue end for the Round-robin schedule
-  std::map<uint16_t, acl_queue_handler>::iterator starting_point_;
+  size_t starting_point_ = 0;
+  SchedulingMode scheduling_mode_ = SchedulingMode::ROUND_ROBIN;
+  size_t quantum_bytes_ = 0;
+  // Link the deficit round robin serves next
+  size_t drr_cursor_ = 0;
 };
 
 }  // namespace acl_manager
@@ -85,4 +137,7 @@ namespace fmt {
 template <>
 struct formatter<bluetooth::hci::acl_manager::RoundRobinScheduler::ConnectionType>
     : enum_formatter<bluetooth::hci::acl_manager::RoundRobinScheduler::ConnectionType> {};
+template <>
+struct formatter<bluetooth::hci::acl_manager::RoundRobinScheduler::SchedulingMode>
+    : enum_formatter<bluetooth::hci::acl_manager::RoundRobinScheduler::SchedulingMode> {};
 }  // namespace fmt
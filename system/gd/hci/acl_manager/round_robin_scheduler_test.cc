@@ -413,6 +413,65 @@ TEST_F(RoundRobinSchedulerTest, receive_le_credit_when_next_fragment_is_classic)
   round_robin_scheduler_->Unregister(le_handle);
 }
 
+TEST_F(RoundRobinSchedulerTest, deficit_round_robin_shares_credits_by_weight) {
+  uint16_t handle1 = 0x01;
+  uint16_t handle2 = 0x02;
+  auto connection_queue1 = std::make_shared<AclConnection::Queue>(10);
+  auto connection_queue2 = std::make_shared<AclConnection::Queue>(10);
+  AclConnection::QueueUpEnd* queue_up_end1 = connection_queue1->GetUpEnd();
+  AclConnection::QueueUpEnd* queue_up_end2 = connection_queue2->GetUpEnd();
+
+  // Fill both queues before the links are registered, so that both are backlogged from the start
+  for (uint8_t i = 0; i < 6; i++) {
+    EnqueueAclUpEnd(queue_up_end1, {0x01, 0x02, 0x03, i});
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    EnqueueAclUpEnd(queue_up_end2, {0x02, 0x02, 0x03, i});
+  }
+  enqueue_future_->wait();
+  sync_handler();
+
+  // One packet per quantum of weight: handle1 sends three packets for each packet of handle2
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(8));
+  round_robin_scheduler_->SetSchedulingMode(RoundRobinScheduler::SchedulingMode::DEFICIT_ROUND_ROBIN);
+  round_robin_scheduler_->SetQuantum(4);
+  handler_->Post(common::BindOnce(
+      [](RoundRobinScheduler* scheduler,
+         std::shared_ptr<AclConnection::Queue> queue1,
+         std::shared_ptr<AclConnection::Queue> queue2) {
+        scheduler->Register(RoundRobinScheduler::ConnectionType::CLASSIC, 0x01, queue1);
+        scheduler->SetLinkWeight(0x01, 3);
+        scheduler->Register(RoundRobinScheduler::ConnectionType::CLASSIC, 0x02, queue2);
+      },
+      round_robin_scheduler_,
+      connection_queue1,
+      connection_queue2));
+
+  packet_future_->wait();
+  for (uint8_t round = 0; round < 2; round++) {
+    for (uint8_t i = 0; i < 3; i++) {
+      VerifyPacket(handle1, {0x01, 0x02, 0x03, static_cast<uint8_t>(round * 3 + i)});
+    }
+    VerifyPacket(handle2, {0x02, 0x02, 0x03, round});
+  }
+  ASSERT_EQ(round_robin_scheduler_->GetCredits(), controller_->max_acl_packet_credits_ - 8);
+
+  sync_handler();
+  auto link_stats = round_robin_scheduler_->GetLinkStats();
+  ASSERT_EQ(link_stats.size(), 2u);
+  ASSERT_EQ(link_stats[0].handle, handle1);
+  ASSERT_EQ(link_stats[0].weight, 3);
+  ASSERT_EQ(link_stats[0].credits_used, 6u);
+  ASSERT_EQ(link_stats[0].bytes_sent, 24u);
+  ASSERT_EQ(link_stats[1].handle, handle2);
+  ASSERT_EQ(link_stats[1].weight, RoundRobinScheduler::kDefaultLinkWeight);
+  ASSERT_EQ(link_stats[1].credits_used, 2u);
+  ASSERT_EQ(link_stats[1].bytes_sent, 8u);
+
+  round_robin_scheduler_->Unregister(handle1);
+  round_robin_scheduler_->Unregister(handle2);
+}
+
 }  // namespace
 }  // namespace acl_manager
 }  // namespace hci
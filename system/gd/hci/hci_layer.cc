@@ -19,6 +19,9 @@
 #include <signal.h>
 #include <bluetooth/log.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <map>
 #include <utility>
 
@@ -31,11 +34,17 @@
 #include "os/alarm.h"
 #include "os/metrics.h"
 #include "os/queue.h"
+#include "os/system_properties.h"
 #include "osi/include/properties.h"
 #include "osi/include/stack_power_telemetry.h"
 #include "packet/raw_builder.h"
 #include "storage/storage_module.h"
 
+#ifdef USE_FAKE_TIMERS
+#include "os/fake_timer/fake_timerfd.h"
+using bluetooth::os::fake_timer::fake_timerfd_get_clock;
+#endif
+
 #define SIGKILL 9
 
 namespace bluetooth {
@@ -58,6 +67,17 @@ using os::Alarm;
 using os::Handler;
 using std::unique_ptr;
 
+static const std::string kPropertyPipelinedCommands = "bluetooth.core.hci.pipelined_commands";
+
+// When commands are sent, to time them out. Follows the fake timers in tests.
+static std::chrono::milliseconds get_command_clock() {
+#ifdef USE_FAKE_TIMERS
+  return std::chrono::milliseconds(fake_timerfd_get_clock());
+#else
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+#endif
+}
+
 static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
   auto reset_complete = ResetCompleteView::Create(complete);
   log::assert_that(reset_complete.IsValid(), "assert failed: reset_complete.IsValid()");
@@ -67,6 +87,32 @@ static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
       "assert failed: reset_complete.GetStatus() == ErrorCode::SUCCESS");
 }
 
+// Commands that change state later commands depend on, e.g. the filter accept list and the resolving list can not be
+// modified while advertising, scanning or initiating uses them. In pipelined mode they are only sent once all the
+// previous commands completed, and no other command is sent until they complete.
+static bool must_serialize_command(OpCode op_code) {
+  switch (op_code) {
+    case OpCode::RESET:
+    case OpCode::SET_EVENT_MASK:
+    case OpCode::WRITE_SCAN_ENABLE:
+    case OpCode::LE_SET_EVENT_MASK:
+    case OpCode::LE_SET_RANDOM_ADDRESS:
+    case OpCode::LE_SET_ADVERTISING_ENABLE:
+    case OpCode::LE_SET_SCAN_ENABLE:
+    case OpCode::LE_CREATE_CONNECTION:
+    case OpCode::LE_CREATE_CONNECTION_CANCEL:
+    case OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE:
+    case OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE:
+    case OpCode::LE_SET_PERIODIC_ADVERTISING_ENABLE:
+    case OpCode::LE_SET_EXTENDED_SCAN_ENABLE:
+    case OpCode::LE_EXTENDED_CREATE_CONNECTION:
+      return true;
+    default:
+      // Vendor specific commands, which may get a Command Status where a Command Complete is expected
+      return (static_cast<uint16_t>(op_code) >> 10) == 0x3f;
+  }
+}
+
 static void abort_after_time_out(OpCode op_code) {
   log::warn("Done waiting for debug information after HCI timeout ({})", OpCodeText(op_code));
   kill(getpid(), SIGKILL);
@@ -89,7 +135,12 @@ class CommandQueueEntry {
         on_status(std::move(on_status_function)) {}
 
   unique_ptr<CommandBuilder> command;
+  // Set when the command is serialized, before it is sent
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
   unique_ptr<CommandView> command_view;
+  OpCode op_code{OpCode::NONE};
+  // Set when the command is sent
+  std::chrono::milliseconds sent_time{0};
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -117,6 +168,9 @@ struct HciLayer::impl {
 
     hal_test_supported = osi_property_get_bool("persist.vendor.bluetooth.haltest", false);
     log::warn("hal_test_supported: {}", hal_test_supported);
+
+    pipelined_commands_ = os::GetSystemPropertyBool(kPropertyPipelinedCommands, false);
+    log::info("pipelined_commands: {}", pipelined_commands_);
   }
 
   ~impl() {
@@ -201,20 +255,21 @@ struct HciLayer::impl {
         "Unexpected {} event with OpCode {}",
         logging_id,
         OpCodeText(op_code));
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
+    if (get_waiting_command() == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
       log::error("Discarding event that came after timeout {}", OpCodeText(op_code));
       common::StopWatch::DumpStopWatchLog();
       return;
     }
+    auto command = find_sent_command(op_code);
     log::assert_that(
-        waiting_command_ == op_code,
+        command != command_queue_.end(),
         "Waiting for {}, got {}",
-        OpCodeText(waiting_command_),
+        OpCodeText(get_waiting_command()),
         OpCodeText(op_code));
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !command->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected,
       // we can't treat this as hard failure since we have no way of probing this lack of support at
@@ -233,15 +288,15 @@ struct HciLayer::impl {
           CommandCompleteView::Create(EventView::Create(PacketView<kLittleEndian>(complete)));
       log::assert_that(
           command_complete_view.IsValid(), "assert failed: command_complete_view.IsValid()");
-      (*command_queue_.front().GetCallback<CommandCompleteView>())(command_complete_view);
+      (*command->GetCallback<CommandCompleteView>())(command_complete_view);
     } else {
       log::assert_that(
-          command_queue_.front().waiting_for_status_ == is_status,
+          command->waiting_for_status_ == is_status,
           "{} was not expecting {} event",
           OpCodeText(op_code),
           logging_id);
 
-      (*command_queue_.front().GetCallback<TResponse>())(std::move(response_view));
+      (*command->GetCallback<TResponse>())(std::move(response_view));
     }
 
 #ifdef TARGET_FLOSS
@@ -252,7 +307,7 @@ struct HciLayer::impl {
     // would return UNKNOWN_CONNECTION in some cases.
     if (op_code == OpCode::LE_READ_REMOTE_FEATURES && is_status && status_view.IsValid() &&
         status_view.GetStatus() == ErrorCode::UNKNOWN_CONNECTION) {
-      auto& command_view = *command_queue_.front().command_view;
+      auto& command_view = *command->command_view;
       auto le_read_features_view = bluetooth::hci::LeReadRemoteFeaturesView::Create(
           LeConnectionManagementCommandView::Create(AclCommandView::Create(command_view)));
       if (le_read_features_view.IsValid()) {
@@ -262,14 +317,43 @@ struct HciLayer::impl {
     }
 #endif
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    command_queue_.erase(command);
+    commands_in_flight_--;
     if (hci_timeout_alarm_ != nullptr) {
       hci_timeout_alarm_->Cancel();
+      if (commands_in_flight_ != 0) {
+        schedule_hci_timeout(command_queue_.front());
+      }
       send_next_command();
     }
   }
 
+  // Sent commands stay at the front of |command_queue_|, in the order they were sent, until they complete. Responses
+  // are matched to the oldest sent command with the same opcode.
+  std::list<CommandQueueEntry>::iterator find_sent_command(OpCode op_code) {
+    auto command = command_queue_.begin();
+    for (size_t i = 0; i < commands_in_flight_; i++, command++) {
+      if (command->op_code == op_code) {
+        return command;
+      }
+    }
+    return command_queue_.end();
+  }
+
+  // The oldest command waiting for a response
+  OpCode get_waiting_command() const {
+    return commands_in_flight_ == 0 ? OpCode::NONE : command_queue_.front().op_code;
+  }
+
+  // Times out |command| kHciTimeoutMs after it was sent, not after it became the oldest outstanding command
+  void schedule_hci_timeout(const CommandQueueEntry& command) {
+    auto remaining = kHciTimeoutMs - (get_command_clock() - command.sent_time);
+    // A zero delay would disarm the alarm
+    remaining = std::max(remaining, std::chrono::milliseconds(1));
+    hci_timeout_alarm_->Schedule(
+        BindOnce(&impl::on_hci_timeout, common::Unretained(this), command.op_code), remaining);
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     log::error("Timed out waiting for {}", OpCodeText(op_code));
@@ -280,7 +364,7 @@ struct HciLayer::impl {
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
+    commands_in_flight_ = 0;
     // Ignore the response, since we don't know what might come back.
     enqueue_command(ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce([](CommandCompleteView) {}));
     // Don't time out for this one;
@@ -297,35 +381,58 @@ struct HciLayer::impl {
     }
   }
 
+  void serialize_command(CommandQueueEntry& command) {
+    command.command_bytes = std::make_shared<std::vector<uint8_t>>();
+    BitInserter bi(*command.command_bytes);
+    command.command->Serialize(bi);
+
+    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(command.command_bytes));
+    log::assert_that(cmd_view.IsValid(), "assert failed: cmd_view.IsValid()");
+    command.op_code = cmd_view.GetOpCode();
+    command.command_view = std::make_unique<CommandView>(std::move(cmd_view));
+  }
+
+  // Without pipelining, one command is outstanding at a time. With pipelining, commands are sent as long as the
+  // controller has credits for them, except around the commands that must be serialized.
   void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
-    }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
-    }
-    if (command_queue_.size() == 0) {
-      return;
+    while (command_credits_ != 0 && commands_in_flight_ < command_queue_.size()) {
+      if (commands_in_flight_ != 0 && !pipelined_commands_) {
+        return;
+      }
+      auto& command = *std::next(command_queue_.begin(), commands_in_flight_);
+      if (command.command_view == nullptr) {
+        serialize_command(command);
+      }
+      if (commands_in_flight_ != 0 &&
+          (must_serialize_command(command_queue_.front().op_code) || must_serialize_command(command.op_code))) {
+        return;
+      }
+      send_command(command);
     }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
+  }
 
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    log::assert_that(cmd_view.IsValid(), "assert failed: cmd_view.IsValid()");
-    OpCode op_code = cmd_view.GetOpCode();
+  void send_command(CommandQueueEntry& command) {
+    hal_->sendHciCommand(*command.command_bytes);
+    command.command_bytes.reset();
+
+    OpCode op_code = command.op_code;
+    command.sent_time = get_command_clock();
     power_telemetry::GetInstance().LogHciCmdDetail();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
+    log_link_layer_connection_command(command.command_view);
+    log_classic_pairing_command_status(command.command_view, ErrorCode::STATUS_UNKNOWN);
+    if (pipelined_commands_) {
+      // Until the next Command Complete or Command Status event refreshes the count
+      command_credits_--;
     } else {
+      command_credits_ = 0;  // Only allow one outstanding command
+    }
+    if (hci_timeout_alarm_ == nullptr) {
       log::warn("{} sent without an hci-timeout timer", OpCodeText(op_code));
+    } else if (commands_in_flight_ == 0) {
+      // The timer tracks the oldest outstanding command
+      schedule_hci_timeout(command);
     }
+    commands_in_flight_++;
   }
 
   void register_event(EventCode event, ContextualCallback<void(EventView)> handler) {
@@ -447,7 +554,11 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      auto command = find_sent_command(get_response_op_code(event));
+      if (command == command_queue_.end()) {
+        command = command_queue_.begin();
+      }
+      log_hci_event(command->command_view, event, module_.GetDependency<storage::StorageModule>());
     }
     power_telemetry::GetInstance().LogHciEvtDetail();
     EventCode event_code = event.GetEventCode();
@@ -489,6 +600,22 @@ struct HciLayer::impl {
     }
   }
 
+  // The opcode of the command a Command Complete or Command Status event responds to
+  static OpCode get_response_op_code(EventView event) {
+    switch (event.GetEventCode()) {
+      case EventCode::COMMAND_COMPLETE: {
+        auto view = CommandCompleteView::Create(event);
+        return view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+      }
+      case EventCode::COMMAND_STATUS: {
+        auto view = CommandStatusView::Create(event);
+        return view.IsValid() ? view.GetCommandOpCode() : OpCode::NONE;
+      }
+      default:
+        return OpCode::NONE;
+    }
+  }
+
   void on_hardware_error(EventView event) {
     HardwareErrorView event_view = HardwareErrorView::Create(event);
     log::assert_that(event_view.IsValid(), "assert failed: event_view.IsValid()");
@@ -537,8 +664,9 @@ struct HciLayer::impl {
   std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> le_event_handlers_;
   std::map<VseSubeventCode, ContextualCallback<void(VendorSpecificEventView)>> vs_event_handlers_;
 
-  OpCode waiting_command_{OpCode::NONE};
-  uint8_t command_credits_{1};  // Send reset first
+  bool pipelined_commands_{false};
+  size_t commands_in_flight_{0};  // Sent commands at the front of command_queue_
+  uint8_t command_credits_{1};    // Send reset first
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
 
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "common/blocking_queue.h"
+#include "hal/hci_hal.h"
+#include "hci/hci_layer.h"
+#include "hci/hci_packets.h"
+#include "module.h"
+#include "os/system_properties.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+using std::chrono::steady_clock;
+
+// Time for a command to reach the controller plus time for its response to come back, e.g. over UART
+constexpr std::chrono::microseconds kTransportLatency(250);
+// Time the controller takes to execute one command
+constexpr std::chrono::microseconds kProcessingTime(20);
+constexpr size_t kAcceptListSize = 128;
+
+// Answers every command with a successful Command Complete. Commands are executed one after the other, and each
+// response is delivered no earlier than kTransportLatency after its command was sent.
+class FakeControllerHal : public hal::HciHal {
+ public:
+  explicit FakeControllerHal(uint8_t num_hci_command_packets) : num_hci_command_packets_(num_hci_command_packets) {}
+
+  void registerIncomingPacketCallback(hal::HciHalCallbacks* callback) override {
+    callbacks_ = callback;
+    controller_thread_ = std::thread(&FakeControllerHal::RunController, this);
+  }
+
+  void unregisterIncomingPacketCallback() override {
+    sent_commands_.push({steady_clock::time_point::max(), {}});
+    controller_thread_.join();
+    callbacks_ = nullptr;
+  }
+
+  void sendHciCommand(hal::HciPacket command) override {
+    sent_commands_.push({steady_clock::now(), std::move(command)});
+  }
+
+  void sendAclData(hal::HciPacket /* data */) override {}
+  void sendScoData(hal::HciPacket /* data */) override {}
+  void sendIsoData(hal::HciPacket /* data */) override {}
+
+  void Start() override {}
+  void Stop() override {}
+  void ListDependencies(ModuleList* /* list */) const override {}
+
+  std::string ToString() const override {
+    return std::string("FakeControllerHal");
+  }
+
+ private:
+  struct SentCommand {
+    steady_clock::time_point sent;
+    hal::HciPacket bytes;
+  };
+
+  void RunController() {
+    steady_clock::time_point done = steady_clock::now();
+    while (true) {
+      SentCommand command = sent_commands_.take();
+      if (command.sent == steady_clock::time_point::max()) {
+        return;
+      }
+      done = std::max(done, command.sent + kTransportLatency) + kProcessingTime;
+      std::this_thread::sleep_until(done);
+
+      auto view = CommandView::Create(
+          packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(command.bytes)));
+      auto payload = std::make_unique<packet::RawBuilder>();
+      payload->AddOctets1(static_cast<uint8_t>(ErrorCode::SUCCESS));
+      auto response = CommandCompleteBuilder::Create(num_hci_command_packets_, view.GetOpCode(), std::move(payload));
+      callbacks_->hciEventReceived(response->SerializeToBytes());
+    }
+  }
+
+  uint8_t num_hci_command_packets_;
+  hal::HciHalCallbacks* callbacks_ = nullptr;
+  common::BlockingQueue<SentCommand> sent_commands_;
+  std::thread controller_thread_;
+};
+
+void OnCommandComplete(std::atomic<size_t>* remaining, std::promise<void>* done, CommandCompleteView /* view */) {
+  if (--*remaining == 0) {
+    done->set_value();
+  }
+}
+
+// Fill the filter accept list, as done when the stack starts with many bonded LE devices: address resolution is
+// disabled, kAcceptListSize devices are added, then address resolution is enabled again. Reports the time until the
+// last command completes, for |num_hci_command_packets| controller credits.
+void BM_AcceptListSetup(State& state, bool pipelined) {
+  os::SetSystemProperty("bluetooth.core.hci.pipelined_commands", pipelined ? "true" : "false");
+  auto num_hci_command_packets = static_cast<uint8_t>(state.range(0));
+
+  TestModuleRegistry registry;
+  registry.InjectTestModule(&hal::HciHal::Factory, new FakeControllerHal(num_hci_command_packets));
+  registry.Start<HciLayer>(&registry.GetTestThread());
+  auto* hci = registry.GetModuleUnderTest<HciLayer>();
+  auto* handler = registry.GetTestModuleHandler(&HciLayer::Factory);
+
+  for (auto _ : state) {
+    std::atomic<size_t> remaining = kAcceptListSize + 2;
+    std::promise<void> done;
+    auto on_complete = [&]() {
+      return handler->BindOnce(&OnCommandComplete, common::Unretained(&remaining), common::Unretained(&done));
+    };
+
+    hci->EnqueueCommand(LeSetAddressResolutionEnableBuilder::Create(Enable::DISABLED), on_complete());
+    for (size_t i = 0; i < kAcceptListSize; i++) {
+      Address address{static_cast<uint8_t>(i), 0x01, 0x02, 0x03, 0x04, 0xc5};
+      hci->EnqueueCommand(
+          LeAddDeviceToFilterAcceptListBuilder::Create(FilterAcceptListAddressType::RANDOM, address), on_complete());
+    }
+    hci->EnqueueCommand(LeSetAddressResolutionEnableBuilder::Create(Enable::ENABLED), on_complete());
+    done.get_future().wait();
+  }
+  state.SetItemsProcessed(state.iterations() * (kAcceptListSize + 2));
+
+  registry.StopAll();
+  os::ClearSystemPropertiesForHost();
+}
+
+}  // namespace
+}  // namespace hci
+}  // namespace bluetooth
+
+BENCHMARK_CAPTURE(bluetooth::hci::BM_AcceptListSetup, serial, false)
+    ->ArgName("num_hci_command_packets")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(bluetooth::hci::BM_AcceptListSetup, pipelined, true)
+    ->ArgName("num_hci_command_packets")
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
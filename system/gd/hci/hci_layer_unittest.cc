@@ -33,6 +33,7 @@
 #include "module.h"
 #include "os/fake_timer/fake_timerfd.h"
 #include "os/handler.h"
+#include "os/system_properties.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
 
@@ -521,5 +522,117 @@ TEST_F(HciLayerTest, command_status_callback_is_invoked_with_failure_status) {
   sync_handler();
 }
 
+class HciLayerPipelinedTest : public HciLayerTest {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(os::SetSystemProperty("bluetooth.core.hci.pipelined_commands", "true"));
+    HciLayerTest::SetUp();
+    FailIfResetNotSent();
+  }
+
+  void TearDown() override {
+    HciLayerTest::TearDown();
+    os::ClearSystemPropertiesForHost();
+  }
+
+  void EnqueueAddToAcceptList(uint8_t index) {
+    hci_->EnqueueCommand(
+        LeAddDeviceToFilterAcceptListBuilder::Create(
+            FilterAcceptListAddressType::RANDOM, Address{index, 0x01, 0x02, 0x03, 0x04, 0xc5}),
+        hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  }
+
+  void ExpectSentCommand(OpCode op_code) {
+    auto sent_command = hal_->GetSentCommand();
+    ASSERT_TRUE(sent_command.has_value());
+    ASSERT_EQ(op_code, sent_command->GetOpCode());
+  }
+
+  void ExpectNoSentCommand() {
+    sync_handler();
+    ASSERT_FALSE(hal_->GetSentCommand(std::chrono::milliseconds(10)).has_value());
+  }
+};
+
+TEST_F(HciLayerPipelinedTest, commands_sent_up_to_controller_credits) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+  for (uint8_t i = 0; i < 4; i++) {
+    EnqueueAddToAcceptList(i);
+  }
+  for (uint8_t i = 0; i < 3; i++) {
+    ExpectSentCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  }
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(1, ErrorCode::SUCCESS));
+  ExpectSentCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+}
+
+TEST_F(HciLayerPipelinedTest, responses_matched_by_opcode) {
+  std::promise<void> status_promise;
+  auto status_future = status_promise.get_future();
+  std::promise<void> complete_promise;
+  auto complete_future = complete_promise.get_future();
+  hal_->InjectEvent(ResetCompleteBuilder::Create(2, ErrorCode::SUCCESS));
+  hci_->EnqueueCommand(
+      ReadLocalVersionInformationBuilder::Create(),
+      hci_handler_->BindOnce(
+          [](std::promise<void> promise, CommandCompleteView /* view */) { promise.set_value(); },
+          std::move(complete_promise)));
+  hci_->EnqueueCommand(
+      ReadClockOffsetBuilder::Create(0x001),
+      hci_handler_->BindOnce(
+          [](std::promise<void> promise, CommandStatusView /* view */) { promise.set_value(); },
+          std::move(status_promise)));
+  ExpectSentCommand(OpCode::READ_LOCAL_VERSION_INFORMATION);
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+
+  // The second command is answered first
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 1));
+  ASSERT_EQ(std::future_status::ready, status_future.wait_for(std::chrono::seconds(1)));
+  hal_->InjectEvent(
+      ReadLocalVersionInformationCompleteBuilder::Create(1, ErrorCode::SUCCESS, LocalVersionInformation()));
+  ASSERT_EQ(std::future_status::ready, complete_future.wait_for(std::chrono::seconds(1)));
+}
+
+TEST_F(HciLayerPipelinedTest, serialized_command_waits_for_outstanding_commands) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  EnqueueAddToAcceptList(0);
+  hci_->EnqueueCommand(
+      LeSetScanEnableBuilder::Create(Enable::ENABLED, Enable::DISABLED),
+      hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  EnqueueAddToAcceptList(1);
+  ExpectSentCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  ExpectSentCommand(OpCode::LE_SET_SCAN_ENABLE);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(LeSetScanEnableCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  ExpectSentCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+}
+
+TEST_F(HciLayerPipelinedTest, timeout_counts_from_when_oldest_command_was_sent) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(2, ErrorCode::SUCCESS));
+  hci_->EnqueueCommand(
+      ReadLocalVersionInformationBuilder::Create(), hci_handler_->BindOnce([](CommandCompleteView /* view */) {}));
+  EnqueueAddToAcceptList(0);
+  ExpectSentCommand(OpCode::READ_LOCAL_VERSION_INFORMATION);
+  ExpectSentCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+
+  // The later command completes, the oldest one still has half of its time left
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  hal_->InjectEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(2, ErrorCode::SUCCESS));
+  ExpectNoSentCommand();
+
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  sync_handler();
+  auto sent_command = hal_->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  auto debug_info_view = ControllerDebugInfoView::Create(VendorCommandView::Create(*sent_command));
+  ASSERT_TRUE(debug_info_view.IsValid());
+}
+
 }  // namespace hci
 }  // namespace bluetooth
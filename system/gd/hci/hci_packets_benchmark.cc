@@ -0,0 +1,148 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <forward_list>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "packet/packet_view.h"
+
+using ::benchmark::State;
+using ::bluetooth::packet::kLittleEndian;
+using ::bluetooth::packet::PacketView;
+using ::bluetooth::packet::View;
+
+// Count heap allocations so that each parser benchmark can report allocations per packet. This replaces the
+// global operator new, so this file is built into its own bluetooth_benchmark_gd_hci_packets binary.
+static std::atomic<uint64_t> g_allocation_count = 0;
+
+void* operator new(size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+  std::free(ptr);
+}
+
+namespace bluetooth {
+namespace hci {
+namespace {
+
+// Packets from hci_packets_test.cc
+const std::vector<uint8_t> le_set_scan_parameters{
+    0x0b, 0x20, 0x07, 0x01, 0x12, 0x00, 0x12, 0x00, 0x01, 0x00,
+};
+
+const std::vector<uint8_t> le_get_vendor_capabilities_complete{
+    0x0e, 0x0c, 0x01, 0x53, 0xfd, 0x00, 0x05, 0x01, 0x00, 0x04, 0x80, 0x01, 0x10, 0x01,
+};
+
+const std::vector<uint8_t> le_set_extended_scan_parameters{
+    0x41, 0x20, 0x08, 0x01, 0x00, 0x01, 0x01, 0x12, 0x00, 0x12, 0x00,
+};
+
+const std::vector<uint8_t> le_set_extended_advertising_parameters_complete{0x0e, 0x05, 0x01, 0x36, 0x20, 0x00, 0xf5};
+
+// A single fragment takes the contiguous fast path; splitting the same bytes in two takes the fragmented path.
+PacketView<kLittleEndian> MakePacketView(const std::vector<uint8_t>& bytes, bool fragmented) {
+  auto data = std::make_shared<const std::vector<uint8_t>>(bytes);
+  if (!fragmented) {
+    return PacketView<kLittleEndian>(data);
+  }
+  size_t split = bytes.size() / 2;
+  return PacketView<kLittleEndian>(std::forward_list<View>{View(data, 0, split), View(data, split, bytes.size())});
+}
+
+template <typename ParseFunction>
+void RunParserBenchmark(State& state, const std::vector<uint8_t>& bytes, ParseFunction parse) {
+  auto packet = MakePacketView(bytes, state.range(0) != 0);
+  uint64_t allocations_before = g_allocation_count.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(packet));
+  }
+  uint64_t allocations = g_allocation_count.load(std::memory_order_relaxed) - allocations_before;
+  state.counters["allocs_per_packet"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.SetLabel(state.range(0) != 0 ? "fragmented" : "contiguous");
+}
+
+void BM_ParseLeSetScanParameters(State& state) {
+  RunParserBenchmark(state, le_set_scan_parameters, [](const PacketView<kLittleEndian>& packet) {
+    auto view = LeSetScanParametersView::Create(LeScanningCommandView::Create(CommandView::Create(packet)));
+    if (!view.IsValid()) {
+      return 0;
+    }
+    return static_cast<int>(view.GetLeScanType()) + view.GetLeScanInterval() + view.GetLeScanWindow() +
+           static_cast<int>(view.GetOwnAddressType()) + static_cast<int>(view.GetScanningFilterPolicy());
+  });
+}
+
+void BM_ParseLeGetVendorCapabilitiesComplete(State& state) {
+  RunParserBenchmark(state, le_get_vendor_capabilities_complete, [](const PacketView<kLittleEndian>& packet) {
+    auto view = LeGetVendorCapabilitiesCompleteView::Create(CommandCompleteView::Create(EventView::Create(packet)));
+    if (!view.IsValid()) {
+      return 0;
+    }
+    auto capabilities = view.GetBaseVendorCapabilities();
+    return capabilities.max_advt_instances_ + capabilities.total_scan_results_storage_ + capabilities.max_filter_;
+  });
+}
+
+void BM_ParseLeSetExtendedScanParameters(State& state) {
+  RunParserBenchmark(state, le_set_extended_scan_parameters, [](const PacketView<kLittleEndian>& packet) {
+    auto view = LeSetExtendedScanParametersView::Create(LeScanningCommandView::Create(CommandView::Create(packet)));
+    if (!view.IsValid()) {
+      return 0;
+    }
+    auto params = view.GetParameters();
+    return static_cast<int>(params.size()) + params[0].le_scan_interval_ + params[0].le_scan_window_;
+  });
+}
+
+void BM_ParseLeSetExtendedAdvertisingParametersComplete(State& state) {
+  RunParserBenchmark(
+      state, le_set_extended_advertising_parameters_complete, [](const PacketView<kLittleEndian>& packet) {
+        auto view = LeSetExtendedAdvertisingParametersCompleteView::Create(
+            CommandCompleteView::Create(EventView::Create(packet)));
+        if (!view.IsValid()) {
+          return 0;
+        }
+        return static_cast<int>(view.GetStatus()) + view.GetSelectedTxPower();
+      });
+}
+
+}  // namespace
+
+BENCHMARK(BM_ParseLeSetScanParameters)->Arg(0)->Arg(1);
+BENCHMARK(BM_ParseLeGetVendorCapabilitiesComplete)->Arg(0)->Arg(1);
+BENCHMARK(BM_ParseLeSetExtendedScanParameters)->Arg(0)->Arg(1);
+BENCHMARK(BM_ParseLeSetExtendedAdvertisingParametersComplete)->Arg(0)->Arg(1);
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 namespace bluetooth {
 namespace l2cap {
@@ -28,6 +29,8 @@ class Fcs {
 
   void AddByte(uint8_t byte);
 
+  void AddBytes(std::span<const uint8_t> bytes);
+
   uint16_t GetChecksum() const;
 
  private:
@@ -33,8 +33,21 @@ Handler::Handler(Thread* thread) : tasks_(new std::queue<OnceClosure>()), thread
       event_->Id(), common::Bind(&Handler::handle_next_event, common::Unretained(this)), common::Closure());
 }
 
+Handler::Handler(Thread* thread, size_t max_tasks_per_wakeup)
+    : tasks_(nullptr),
+      batched_tasks_(new common::MpscQueue<OnceClosure>()),
+      max_tasks_per_wakeup_(max_tasks_per_wakeup),
+      thread_(thread) {
+  log::assert_that(max_tasks_per_wakeup_ > 0, "Must run at least one task per wakeup");
+  event_ = thread_->GetReactor()->NewEvent();
+  reactable_ = thread_->GetReactor()->Register(
+      event_->Id(), common::Bind(&Handler::handle_batched_events, common::Unretained(this)), common::Closure());
+}
+
 Handler::~Handler() {
-  {
+  if (is_batched()) {
+    log::assert_that(batched_cleared_.load(), "Handlers must be cleared before they are destroyed");
+  } else {
     std::lock_guard<std::mutex> lock(mutex_);
     log::assert_that(was_cleared(), "Handlers must be cleared before they are destroyed");
   }
@@ -42,6 +55,18 @@ Handler::~Handler() {
 }
 
 void Handler::Post(OnceClosure closure) {
+  if (is_batched()) {
+    if (batched_cleared_.load(std::memory_order_acquire)) {
+      log::warn("Posting to a handler which has been cleared");
+      return;
+    }
+    batched_tasks_->push(std::move(closure));
+    // Only the first post after the handler went idle has to wake up the reactor
+    if (!notified_.exchange(true, std::memory_order_acq_rel)) {
+      event_->Notify();
+    }
+    return;
+  }
   {
     std::lock_guard<std::mutex> lock(mutex_);
     if (was_cleared()) {
@@ -54,13 +79,19 @@ void Handler::Post(OnceClosure closure) {
 }
 
 void Handler::Clear() {
-  std::queue<OnceClosure>* tmp = nullptr;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    log::assert_that(!was_cleared(), "Handlers must only be cleared once");
-    std::swap(tasks_, tmp);
+  if (is_batched()) {
+    // The queue can only be drained by the reactor thread, pending tasks are released in the destructor
+    bool already_cleared = batched_cleared_.exchange(true, std::memory_order_acq_rel);
+    log::assert_that(!already_cleared, "Handlers must only be cleared once");
+  } else {
+    std::queue<OnceClosure>* tmp = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      log::assert_that(!was_cleared(), "Handlers must only be cleared once");
+      std::swap(tasks_, tmp);
+    }
+    delete tmp;
   }
-  delete tmp;
 
   event_->Clear();
 
@@ -92,5 +123,27 @@ void Handler::handle_next_event() {
   std::move(closure).Run();
 }
 
+void Handler::handle_batched_events() {
+  event_->Read();
+  // Re-arm the notification before draining, so that a post racing with the drain below signals again
+  notified_.exchange(false, std::memory_order_acq_rel);
+
+  common::OnceClosure closure;
+  for (size_t i = 0; i < max_tasks_per_wakeup_; i++) {
+    if (batched_cleared_.load(std::memory_order_acquire)) {
+      return;
+    }
+    if (!batched_tasks_->try_pop(&closure)) {
+      return;
+    }
+    std::move(closure).Run();
+  }
+
+  // Budget exhausted: yield to the other reactables and resume on the next wakeup
+  if (!batched_tasks_->empty() && !notified_.exchange(true, std::memory_order_acq_rel)) {
+    event_->Notify();
+  }
+}
+
 }  // namespace os
 }  // namespace bluetooth
@@ -16,12 +16,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <queue>
 
 #include "common/bind.h"
 #include "common/callback.h"
+#include "common/mpsc_queue.h"
 #include "common/postable_context.h"
 #include "os/thread.h"
 
@@ -36,6 +38,12 @@ class Handler : public common::PostableContext {
   // Create and register a handler on given thread
   explicit Handler(Thread* thread);
 
+  // Create and register a handler on given thread whose tasks are stored in a lock-free multi-producer/single-consumer
+  // queue. Post() only signals the reactor when the handler is idle, and each wakeup runs up to max_tasks_per_wakeup
+  // closures before yielding to the other reactables of the thread. Tasks still pending when Clear() is called are
+  // discarded when the handler is destroyed.
+  Handler(Thread* thread, size_t max_tasks_per_wakeup);
+
   Handler(const Handler&) = delete;
   Handler& operator=(const Handler&) = delete;
 
@@ -72,12 +80,20 @@ class Handler : public common::PostableContext {
   inline bool was_cleared() const {
     return tasks_ == nullptr;
   };
+  inline bool is_batched() const {
+    return batched_tasks_ != nullptr;
+  };
   std::queue<common::OnceClosure>* tasks_;
+  std::unique_ptr<common::MpscQueue<common::OnceClosure>> batched_tasks_;
+  const size_t max_tasks_per_wakeup_ = 1;
+  std::atomic<bool> batched_cleared_{false};
+  std::atomic<bool> notified_{false};
   Thread* thread_;
   std::unique_ptr<Reactor::Event> event_;
   Reactor::Reactable* reactable_;
   mutable std::mutex mutex_;
   void handle_next_event();
+  void handle_batched_events();
 };
 
 }  // namespace os
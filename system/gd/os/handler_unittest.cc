@@ -16,8 +16,10 @@
 
 #include "os/handler.h"
 
+#include <atomic>
 #include <future>
 #include <thread>
+#include <vector>
 
 #include "common/bind.h"
 #include "common/callback.h"
@@ -116,6 +118,105 @@ TEST_F(HandlerTest, callback_with_promise) {
   handler_->Clear();
 }
 
+class BatchedHandlerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new Thread("test_thread", Thread::Priority::NORMAL);
+    handler_ = new Handler(thread_, kMaxTasksPerWakeup);
+  }
+  void TearDown() override {
+    delete handler_;
+    delete thread_;
+  }
+
+  static constexpr size_t kMaxTasksPerWakeup = 4;
+  Handler* handler_;
+  Thread* thread_;
+};
+
+TEST_F(BatchedHandlerTest, empty) {
+  handler_->Clear();
+}
+
+TEST_F(BatchedHandlerTest, post_tasks_invoked_in_order) {
+  constexpr int kNumTasks = 1000;
+  std::vector<int> order;
+  std::promise<void> all_ran;
+  auto future = all_ran.get_future();
+  for (int i = 0; i < kNumTasks; i++) {
+    handler_->Post(common::BindOnce(
+        [](std::vector<int>* order, std::promise<void>* all_ran, int i) {
+          order->push_back(i);
+          if (i == kNumTasks - 1) {
+            all_ran->set_value();
+          }
+        },
+        common::Unretained(&order),
+        common::Unretained(&all_ran),
+        i));
+  }
+  future.wait();
+  ASSERT_EQ(order.size(), static_cast<size_t>(kNumTasks));
+  for (int i = 0; i < kNumTasks; i++) {
+    ASSERT_EQ(order[i], i);
+  }
+  handler_->Clear();
+}
+
+TEST_F(BatchedHandlerTest, post_from_multiple_threads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumTasksPerThread = 1000;
+  std::atomic<int> counter = 0;
+  std::promise<void> all_ran;
+  auto future = all_ran.get_future();
+  std::vector<std::thread> posters;
+  for (int t = 0; t < kNumThreads; t++) {
+    posters.emplace_back([this, &counter, &all_ran]() {
+      for (int i = 0; i < kNumTasksPerThread; i++) {
+        handler_->Post(common::BindOnce(
+            [](std::atomic<int>* counter, std::promise<void>* all_ran) {
+              if (++(*counter) == kNumThreads * kNumTasksPerThread) {
+                all_ran->set_value();
+              }
+            },
+            common::Unretained(&counter),
+            common::Unretained(&all_ran)));
+      }
+    });
+  }
+  for (auto& poster : posters) {
+    poster.join();
+  }
+  future.wait();
+  ASSERT_EQ(counter.load(), kNumThreads * kNumTasksPerThread);
+  handler_->Clear();
+}
+
+TEST_F(BatchedHandlerTest, post_task_cleared) {
+  std::promise<void> closure_started;
+  auto closure_started_future = closure_started.get_future();
+  std::promise<void> closure_can_continue;
+  auto can_continue_future = closure_can_continue.get_future();
+  std::promise<void> closure_finished;
+  auto closure_finished_future = closure_finished.get_future();
+  handler_->Post(common::BindOnce(
+      [](std::promise<void> closure_started,
+         std::future<void> can_continue_future,
+         std::promise<void> closure_finished) {
+        closure_started.set_value();
+        can_continue_future.wait();
+        closure_finished.set_value();
+      },
+      std::move(closure_started),
+      std::move(can_continue_future),
+      std::move(closure_finished)));
+  handler_->Post(common::BindOnce([]() { ASSERT_TRUE(false); }));
+  closure_started_future.wait();
+  handler_->Clear();
+  closure_can_continue.set_value();
+  closure_finished_future.wait();
+}
+
 // For Death tests, all the threading needs to be done in the ASSERT_DEATH call
 class HandlerDeathTest : public ::testing::Test {
  protected:
@@ -64,6 +64,7 @@ class BM_ReactorThread : public BM_ThreadPerformance {
     handler_ = std::make_unique<Handler>(thread_.get());
   }
   void TearDown(State& st) override {
+    handler_->Clear();
     handler_ = nullptr;
     thread_->Stop();
     thread_ = nullptr;
@@ -85,6 +86,7 @@ BENCHMARK_DEFINE_F(BM_ReactorThread, batch_enque_dequeue)(State& state) {
     }
     counter_future.wait();
   }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
 };
 
 BENCHMARK_REGISTER_F(BM_ReactorThread, batch_enque_dequeue)
@@ -106,6 +108,7 @@ BENCHMARK_DEFINE_F(BM_ReactorThread, sequential_execution)(State& state) {
       counter_future.wait();
     }
   }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
 };
 
 BENCHMARK_REGISTER_F(BM_ReactorThread, sequential_execution)
@@ -115,3 +118,68 @@ BENCHMARK_REGISTER_F(BM_ReactorThread, sequential_execution)
     ->Arg(100000)
     ->Iterations(1)
     ->UseRealTime();
+
+class BM_BatchedReactorThread : public BM_ThreadPerformance {
+ protected:
+  void SetUp(State& st) override {
+    BM_ThreadPerformance::SetUp(st);
+    thread_ = std::make_unique<Thread>("BM_BatchedReactorThread thread", Thread::Priority::NORMAL);
+    handler_ = std::make_unique<Handler>(thread_.get(), kMaxTasksPerWakeup);
+  }
+  void TearDown(State& st) override {
+    handler_->Clear();
+    handler_ = nullptr;
+    thread_->Stop();
+    thread_ = nullptr;
+    BM_ThreadPerformance::TearDown(st);
+  }
+  static constexpr size_t kMaxTasksPerWakeup = 64;
+  std::unique_ptr<Thread> thread_;
+  std::unique_ptr<Handler> handler_;
+};
+
+BENCHMARK_DEFINE_F(BM_BatchedReactorThread, batch_enque_dequeue)(State& state) {
+  for (auto _ : state) {
+    num_messages_to_send_ = state.range(0);
+    counter_ = 0;
+    counter_promise_ = std::promise<void>();
+    std::future<void> counter_future = counter_promise_.get_future();
+    for (int i = 0; i < num_messages_to_send_; i++) {
+      handler_->Post(BindOnce(
+          &BM_BatchedReactorThread_batch_enque_dequeue_Benchmark::callback_batch,
+          bluetooth::common::Unretained(this)));
+    }
+    counter_future.wait();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_BatchedReactorThread, batch_enque_dequeue)
+    ->Arg(10)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Iterations(1)
+    ->UseRealTime();
+
+BENCHMARK_DEFINE_F(BM_BatchedReactorThread, sequential_execution)(State& state) {
+  for (auto _ : state) {
+    num_messages_to_send_ = state.range(0);
+    for (int i = 0; i < num_messages_to_send_; i++) {
+      counter_promise_ = std::promise<void>();
+      std::future<void> counter_future = counter_promise_.get_future();
+      handler_->Post(BindOnce(
+          &BM_BatchedReactorThread_sequential_execution_Benchmark::callback, bluetooth::common::Unretained(this)));
+      counter_future.wait();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+};
+
+BENCHMARK_REGISTER_F(BM_BatchedReactorThread, sequential_execution)
+    ->Arg(10)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Iterations(1)
+    ->UseRealTime();
@@ -18,13 +18,14 @@
 
 #undef NDEBUG
 #include <cassert>
+#include <iterator>
 
 namespace bluetooth {
 namespace packet {
 
 template <bool little_endian>
 Iterator<little_endian>::Iterator(const std::forward_list<View>& data, size_t offset) {
-  data_ = data;
+  SetData(data);
   index_ = offset;
   begin_ = 0;
   end_ = 0;
@@ -35,10 +36,24 @@ Iterator<little_endian>::Iterator(const std::forward_list<View>& data, size_t of
 
 template <bool little_endian>
 Iterator<little_endian>::Iterator(std::shared_ptr<std::vector<uint8_t>> data) {
-  data_.emplace_front(data, 0, data->size());
+  contiguous_view_.emplace(data, 0, data->size());
+  contiguous_data_ = contiguous_view_->data();
   index_ = 0;
   begin_ = 0;
-  end_ = data_.front().size();
+  end_ = contiguous_view_->size();
+}
+
+template <bool little_endian>
+void Iterator<little_endian>::SetData(const std::forward_list<View>& data) {
+  if (!data.empty() && std::next(data.begin()) == data.end()) {
+    data_.clear();
+    contiguous_view_ = data.front();
+    contiguous_data_ = contiguous_view_->data();
+  } else {
+    data_ = data;
+    contiguous_view_.reset();
+    contiguous_data_ = nullptr;
+  }
 }
 
 template <bool little_endian>
@@ -93,6 +108,8 @@ Iterator<little_endian>& Iterator<little_endian>::operator=(const Iterator<littl
     return *this;
   }
   this->data_ = itr.data_;
+  this->contiguous_view_ = itr.contiguous_view_;
+  this->contiguous_data_ = itr.contiguous_data_;
   this->begin_ = itr.begin_;
   this->end_ = itr.end_;
   this->index_ = itr.index_;
@@ -132,9 +149,12 @@ bool Iterator<little_endian>::operator>=(const Iterator<little_endian>& itr) con
 template <bool little_endian>
 uint8_t Iterator<little_endian>::operator*() const {
   assert(NumBytesRemaining() > 0);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index_];
+  }
   size_t index = index_;
 
-  for (auto view : data_) {
+  for (const auto& view : data_) {
     if (index < view.size()) {
       return view[index];
     }
@@ -17,8 +17,10 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <forward_list>
 #include <memory>
+#include <optional>
 #include <type_traits>
 
 #include "packet/custom_field_fixed_size_interface.h"
@@ -84,6 +86,19 @@ class Iterator : public IteratorTraits {
     T extracted_value{};
     uint8_t* value_ptr = (uint8_t*)&extracted_value;
 
+    if (contiguous_data_ != nullptr && NumBytesRemaining() >= sizeof(T)) {
+      const uint8_t* bytes = contiguous_data_ + index_;
+      if (little_endian) {
+        std::memcpy(value_ptr, bytes, sizeof(T));
+      } else {
+        for (size_t i = 0; i < sizeof(T); i++) {
+          value_ptr[sizeof(T) - i - 1] = bytes[i];
+        }
+      }
+      index_ += sizeof(T);
+      return extracted_value;
+    }
+
     for (size_t i = 0; i < sizeof(T); i++) {
       size_t index = (little_endian ? i : sizeof(T) - i - 1);
       value_ptr[index] = this->operator*();
@@ -95,6 +110,15 @@ class Iterator : public IteratorTraits {
   template <typename T, typename std::enable_if<std::is_base_of_v<CustomFieldFixedSizeInterface<T>, T>, int>::type = 0>
   T extract() {
     T extracted_value{};
+    if (contiguous_data_ != nullptr && NumBytesRemaining() >= CustomFieldFixedSizeInterface<T>::length()) {
+      const uint8_t* bytes = contiguous_data_ + index_;
+      for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
+        size_t index = (little_endian ? i : CustomFieldFixedSizeInterface<T>::length() - i - 1);
+        extracted_value.data()[index] = bytes[i];
+      }
+      index_ += CustomFieldFixedSizeInterface<T>::length();
+      return extracted_value;
+    }
     for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
       size_t index = (little_endian ? i : CustomFieldFixedSizeInterface<T>::length() - i - 1);
       extracted_value.data()[index] = this->operator*();
@@ -104,7 +128,13 @@ class Iterator : public IteratorTraits {
   }
 
  private:
+  void SetData(const std::forward_list<View>& data);
+
+  // Fragmented data. Left empty when the data is a single fragment: that fragment is then held by
+  // |contiguous_view_| and read through |contiguous_data_| without walking or copying a list.
   std::forward_list<View> data_;
+  std::optional<View> contiguous_view_;
+  const uint8_t* contiguous_data_ = nullptr;
   size_t index_;
   size_t begin_;
   size_t end_;
@@ -19,21 +19,25 @@
 #undef NDEBUG
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 
 namespace bluetooth {
 namespace packet {
 
 template <bool little_endian>
 PacketView<little_endian>::PacketView(const std::forward_list<class View> fragments)
-    : fragments_(fragments), length_(0) {
-  for (auto fragment : fragments_) {
+    : fragments_(fragments), length_(0), contiguous_data_(nullptr) {
+  for (const auto& fragment : fragments_) {
     length_ += fragment.size();
   }
+  UpdateContiguousData();
 }
 
 template <bool little_endian>
 PacketView<little_endian>::PacketView(std::shared_ptr<const std::vector<uint8_t>> packet)
-    : fragments_({View(packet, 0, packet->size())}), length_(packet->size()) {}
+    : fragments_({View(packet, 0, packet->size())}), length_(packet->size()), contiguous_data_(nullptr) {
+  UpdateContiguousData();
+}
 
 template <bool little_endian>
 Iterator<little_endian> PacketView<little_endian>::begin() const {
@@ -53,6 +57,9 @@ uint8_t PacketView<little_endian>::operator[](size_t index) const {
 template <bool little_endian>
 uint8_t PacketView<little_endian>::at(size_t index) const {
   assert(index < length_);
+  if (contiguous_data_ != nullptr) {
+    return contiguous_data_[index];
+  }
   for (const auto& fragment : fragments_) {
     if (index < fragment.size()) {
       return fragment[index];
@@ -116,6 +123,16 @@ void PacketView<little_endian>::Append(PacketView to_add) {
     insertion_point++;
   }
   length_ += to_add.length_;
+  UpdateContiguousData();
+}
+
+template <bool little_endian>
+void PacketView<little_endian>::UpdateContiguousData() {
+  if (!fragments_.empty() && std::next(fragments_.begin()) == fragments_.end()) {
+    contiguous_data_ = fragments_.front().data();
+  } else {
+    contiguous_data_ = nullptr;
+  }
 }
 
 // Explicit instantiations for both types of PacketViews.
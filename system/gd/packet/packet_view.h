@@ -57,8 +57,11 @@ class PacketView {
  private:
   std::forward_list<View> fragments_;
   size_t length_;
+  // First byte of the only fragment, or nullptr when the packet has several fragments.
+  const uint8_t* contiguous_data_;
 
   std::forward_list<View> GetSubviewList(size_t begin, size_t end) const;
+  void UpdateContiguousData();
 };
 
 }  // namespace packet
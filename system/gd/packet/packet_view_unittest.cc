@@ -563,6 +563,23 @@ TEST_F(PacketViewMultiViewTest, arrayOperatorTest) {
   ASSERT_DEATH(multi_view[single_view.size()], "");
 }
 
+TEST_F(PacketViewMultiViewTest, contiguousAndFragmentedExtractMatch) {
+  auto single_itr = single_view.begin();
+  auto multi_itr = multi_view.begin();
+  // Values straddle the fragment boundaries of multi_view at offsets 3 and 13
+  ASSERT_EQ(single_itr.extract<uint16_t>(), multi_itr.extract<uint16_t>());
+  ASSERT_EQ(single_itr.extract<uint32_t>(), multi_itr.extract<uint32_t>());
+  ASSERT_EQ(single_itr.extract<uint64_t>(), multi_itr.extract<uint64_t>());
+  ASSERT_EQ(single_itr.extract<Address>(), multi_itr.extract<Address>());
+  ASSERT_EQ(single_itr.NumBytesRemaining(), multi_itr.NumBytesRemaining());
+
+  auto single_be = single_view.GetBigEndianSubview(0, single_view.size()).begin();
+  auto multi_be = multi_view.GetBigEndianSubview(0, multi_view.size()).begin();
+  ASSERT_EQ(single_be.extract<uint32_t>(), multi_be.extract<uint32_t>());
+  ASSERT_EQ(single_be.extract<uint64_t>(), multi_be.extract<uint64_t>());
+  ASSERT_EQ(single_be.extract<Address>(), multi_be.extract<Address>());
+}
+
 TEST_F(PacketViewMultiViewAppendTest, sizeTestAppend) {
   ASSERT_EQ(single_view.size(), multi_view.size());
 }
@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+
 #include "security/ecc/p_256_ecc_pp.h"
 
 namespace bluetooth {
@@ -107,6 +109,31 @@ TEST(SmpEccValidationTest, test_invalid_points) {
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
 
+TEST(SmpEccPointMultTest, matches_bin_naf) {
+  std::mt19937 generator(1);
+  Point peer;
+  for (int i = 0; i < 10; i++) {
+    uint32_t k[KEY_LENGTH_DWORDS_P256];
+    for (auto& word : k) {
+      word = generator();
+    }
+    // ECC_PointMult_Bin_NAF() consumes its scalar
+    uint32_t k_copy[KEY_LENGTH_DWORDS_P256];
+    multiprecision_copy(k_copy, k);
+
+    Point expected, actual;
+    const Point* p = i % 2 == 0 ? &curve_p256.G : &peer;
+    ECC_PointMult_Bin_NAF(&expected, p, k_copy);
+    ECC_PointMult(&actual, p, k);
+    EXPECT_EQ(0, multiprecision_compare(actual.x, expected.x));
+    EXPECT_EQ(0, multiprecision_compare(actual.y, expected.y));
+
+    if (i % 2 == 0) {
+      peer = actual;
+    }
+  }
+}
+
 }  // namespace ecc
 }  // namespace security
 }  // namespace bluetooth
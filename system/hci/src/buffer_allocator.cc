@@ -26,7 +26,7 @@
 static void* buffer_alloc(size_t size) {
   bluetooth::log::assert_that(size <= BT_DEFAULT_BUFFER_SIZE,
                               "assert failed: size <= BT_DEFAULT_BUFFER_SIZE");
-  return osi_malloc(size);
+  return osi_pool_malloc(size);
 }
 
 static const allocator_t interface = {buffer_alloc, osi_free};
@@ -134,7 +134,7 @@ static BT_HDR* WrapPacketAndCopy(
     uint16_t event,
     bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>* data) {
   size_t packet_size = data->size() + kBtHdrSize;
-  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_malloc(packet_size));
+  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_pool_malloc(packet_size));
   packet->offset = 0;
   packet->len = data->size();
   packet->layer_specific = 0;
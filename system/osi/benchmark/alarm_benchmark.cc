@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <hardware/bluetooth.h>
+
+#include <string>
+#include <vector>
+
+#include "common/message_loop_thread.h"
+#include "osi/include/alarm.h"
+#include "osi/include/wakelock.h"
+
+using ::benchmark::State;
+
+// Alarms are armed far enough in the future that none of them fires while the
+// benchmark is running, so only the arm/cancel bookkeeping is measured.
+static constexpr uint64_t kLongTimeoutMs = 60 * 60 * 1000;
+
+bluetooth::common::MessageLoopThread* get_main_thread() { return nullptr; }
+
+static int acquire_wake_lock_cb(const char* /* lock_name */) {
+  return BT_STATUS_SUCCESS;
+}
+
+static int release_wake_lock_cb(const char* /* lock_name */) {
+  return BT_STATUS_SUCCESS;
+}
+
+static bt_os_callouts_t bt_wakelock_callouts = {
+    sizeof(bt_os_callouts_t), acquire_wake_lock_cb, release_wake_lock_cb};
+
+static void noop_cb(void* /* data */) {}
+
+class BM_AlarmPerformance : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    wakelock_set_os_callouts(&bt_wakelock_callouts);
+    size_t num_pending = st.range(0);
+    for (size_t i = 0; i < num_pending; i++) {
+      alarm_t* alarm = alarm_new(
+          ("alarm_benchmark.pending[" + std::to_string(i) + "]").c_str());
+      // Spread the deadlines so new alarms land in the middle of the set
+      alarm_set(alarm, kLongTimeoutMs + (i * 7919) % (2 * num_pending), noop_cb,
+                nullptr);
+      pending_.push_back(alarm);
+    }
+  }
+
+  void TearDown(State& st) override {
+    for (alarm_t* alarm : pending_) {
+      alarm_free(alarm);
+    }
+    pending_.clear();
+    alarm_cleanup();
+    wakelock_cleanup();
+    wakelock_set_os_callouts(nullptr);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<alarm_t*> pending_;
+};
+
+BENCHMARK_DEFINE_F(BM_AlarmPerformance, arm_and_cancel)(State& state) {
+  alarm_t* alarm = alarm_new("alarm_benchmark.arm_and_cancel");
+  uint64_t offset = 0;
+  for (auto _ : state) {
+    alarm_set(alarm, kLongTimeoutMs + (offset++ % state.range(0)), noop_cb,
+              nullptr);
+    alarm_cancel(alarm);
+  }
+  alarm_free(alarm);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(BM_AlarmPerformance, arm_and_cancel)
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
+
+// Re-arming an already pending alarm, as done for supervision and
+// retransmission timeouts on every received packet.
+BENCHMARK_DEFINE_F(BM_AlarmPerformance, rearm_pending)(State& state) {
+  size_t index = 0;
+  for (auto _ : state) {
+    alarm_t* alarm = pending_[index];
+    alarm_set(alarm, kLongTimeoutMs + index, noop_cb, nullptr);
+    index = (index + 1) % pending_.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(BM_AlarmPerformance, rearm_pending)
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000);
@@ -47,6 +47,33 @@ void osi_free(void* ptr);
 // |p_ptr| cannot be NULL.
 void osi_free_and_reset(void** p_ptr);
 
+// Allocate a buffer from the size-class pools intended for frequently recycled
+// buffers such as |BT_HDR| packets on the HCI, L2CAP and A2DP data paths.
+// Blocks are kept in per-thread caches backed by a shared free list per size
+// class, so a steady-state allocate/free cycle does not reach the system
+// allocator. Requests larger than the biggest size class, or made while the
+// class is exhausted, are served by |osi_malloc|. The returned buffer is
+// released with |osi_free| like any other osi allocation.
+//
+// Recycled blocks never reach the system allocator, which would hide use after
+// free and overflows from the address sanitizers. Sanitized builds therefore
+// serve these with |osi_malloc| and OSI_POOL_USE_MALLOC is defined.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(hwaddress_sanitizer)
+#define OSI_POOL_USE_MALLOC 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_HWADDRESS__)
+#define OSI_POOL_USE_MALLOC 1
+#endif
+void* osi_pool_malloc(size_t size);
+void* osi_pool_calloc(size_t size);
+
+// Dump per size class statistics of the buffer pools to the |fd| file
+// descriptor. The information is in user-readable text format. The |fd| must
+// be valid.
+void osi_pool_debug_dump(int fd);
+
 class OsiObject {
  public:
   OsiObject(void* ptr);
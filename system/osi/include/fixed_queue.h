@@ -36,6 +36,19 @@ typedef void (*fixed_queue_cb)(fixed_queue_t* queue, void* context);
 // the returned queue with |fixed_queue_free|.
 fixed_queue_t* fixed_queue_new(size_t capacity);
 
+// Creates a new fixed queue with the given |capacity| that is backed by a
+// preallocated ring buffer instead of a locked list. Any number of threads
+// may enqueue and dequeue concurrently without taking a lock, and the file
+// descriptors returned by |fixed_queue_get_enqueue_fd| and
+// |fixed_queue_get_dequeue_fd| are only signalled when the queue leaves the
+// full or empty state respectively. |capacity| must be non-zero and no larger
+// than FIXED_QUEUE_RING_MAX_CAPACITY. The queue supports the whole fixed_queue
+// API except |fixed_queue_try_remove_from_queue| and |fixed_queue_get_list|.
+// Returns NULL on failure. The caller must free the returned queue with
+// |fixed_queue_free|.
+#define FIXED_QUEUE_RING_MAX_CAPACITY (1u << 16)
+fixed_queue_t* fixed_queue_new_ring(size_t capacity);
+
 // Frees a queue and (optionally) the enqueued elements.
 // |queue| is the queue to free. If the |free_cb| callback is not null,
 // it is called on each queue element to free it.
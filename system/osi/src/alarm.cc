@@ -30,12 +30,14 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "os/log.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
-#include "osi/include/list.h"
 #include "osi/include/thread.h"
 #include "osi/include/wakelock.h"
 #include "osi/semaphore.h"
@@ -98,8 +100,24 @@ struct alarm_t {
 
   bool for_msg_loop;  // True, if the alarm should be processed on message loop
   CancelableClosureInStruct closure;  // posted to message loop for processing
+
+  // Intrusive pairing heap links, owned by |alarms|. |heap_prev| points to
+  // the parent for the first child and to the left sibling otherwise.
+  alarm_t* heap_child;
+  alarm_t* heap_sibling;
+  alarm_t* heap_prev;
+  uint64_t heap_seq;  // Insertion order, keeps equal deadlines FIFO
 };
 
+// Pending alarms ordered by deadline (earliest first). A pairing heap gives
+// O(1) insertion and O(log n) amortized removal of any alarm, so arming and
+// canceling stay cheap with thousands of pending alarms.
+typedef struct {
+  alarm_t* root;
+  size_t size;
+  uint64_t next_seq;
+} alarm_heap_t;
+
 // If the next wakeup time is less than this threshold, we should acquire
 // a wakelock instead of setting a wake alarm so we're not bouncing in
 // and out of suspend frequently. This value is externally visible to allow
@@ -109,9 +127,9 @@ static const clockid_t CLOCK_ID = CLOCK_BOOTTIME;
 
 // This mutex ensures that the |alarm_set|, |alarm_cancel|, and alarm callback
 // functions execute serially and not concurrently. As a result, this mutex
-// also protects the |alarms| list.
+// also protects the |alarms| heap.
 static std::mutex alarms_mutex;
-static list_t* alarms;
+static alarm_heap_t* alarms;
 static timer_t timer;
 static timer_t wakeup_timer;
 static bool timer_set;
@@ -146,6 +164,103 @@ static void update_scheduling_stats(alarm_stats_t* stats, uint64_t now_ms,
 static void alarm_register_processing_queue(fixed_queue_t* queue,
                                             thread_t* thread);
 
+static bool alarm_heap_less(const alarm_t* a, const alarm_t* b) {
+  if (a->deadline_ms != b->deadline_ms) return a->deadline_ms < b->deadline_ms;
+  return a->heap_seq < b->heap_seq;
+}
+
+// Links two detached heap roots and returns the new root.
+static alarm_t* alarm_heap_meld(alarm_t* a, alarm_t* b) {
+  if (a == NULL) return b;
+  if (b == NULL) return a;
+  if (alarm_heap_less(b, a)) std::swap(a, b);
+
+  b->heap_sibling = a->heap_child;
+  if (a->heap_child != NULL) a->heap_child->heap_prev = b;
+  b->heap_prev = a;
+  a->heap_child = b;
+  return a;
+}
+
+// Two-pass pairing of a sibling chain into a single detached root.
+static alarm_t* alarm_heap_merge_pairs(alarm_t* first) {
+  if (first == NULL) return NULL;
+
+  // First pass: meld pairs left to right, chaining the results in reverse.
+  alarm_t* pairs = NULL;
+  while (first != NULL) {
+    alarm_t* a = first;
+    alarm_t* b = a->heap_sibling;
+    first = (b != NULL) ? b->heap_sibling : NULL;
+
+    a->heap_sibling = NULL;
+    a->heap_prev = NULL;
+    if (b != NULL) {
+      b->heap_sibling = NULL;
+      b->heap_prev = NULL;
+    }
+    alarm_t* melded = alarm_heap_meld(a, b);
+    melded->heap_sibling = pairs;
+    pairs = melded;
+  }
+
+  // Second pass: meld the results right to left.
+  alarm_t* root = pairs;
+  pairs = pairs->heap_sibling;
+  root->heap_sibling = NULL;
+  while (pairs != NULL) {
+    alarm_t* next = pairs->heap_sibling;
+    pairs->heap_sibling = NULL;
+    root = alarm_heap_meld(root, pairs);
+    pairs = next;
+  }
+  return root;
+}
+
+static bool alarm_heap_contains(const alarm_heap_t* heap,
+                                const alarm_t* alarm) {
+  return heap->root == alarm || alarm->heap_prev != NULL;
+}
+
+static alarm_t* alarm_heap_front(const alarm_heap_t* heap) {
+  return heap->root;
+}
+
+static void alarm_heap_insert(alarm_heap_t* heap, alarm_t* alarm) {
+  alarm->heap_child = NULL;
+  alarm->heap_sibling = NULL;
+  alarm->heap_prev = NULL;
+  alarm->heap_seq = heap->next_seq++;
+  heap->root = alarm_heap_meld(heap->root, alarm);
+  heap->size++;
+}
+
+// Removes |alarm| from |heap|. No-op if |alarm| is not pending.
+static void alarm_heap_remove(alarm_heap_t* heap, alarm_t* alarm) {
+  if (!alarm_heap_contains(heap, alarm)) return;
+
+  alarm_t* children = alarm_heap_merge_pairs(alarm->heap_child);
+  if (heap->root == alarm) {
+    heap->root = children;
+  } else {
+    // Detach the subtree rooted at |alarm| from its parent or left sibling.
+    if (alarm->heap_prev->heap_child == alarm) {
+      alarm->heap_prev->heap_child = alarm->heap_sibling;
+    } else {
+      alarm->heap_prev->heap_sibling = alarm->heap_sibling;
+    }
+    if (alarm->heap_sibling != NULL) {
+      alarm->heap_sibling->heap_prev = alarm->heap_prev;
+    }
+    heap->root = alarm_heap_meld(heap->root, children);
+  }
+
+  alarm->heap_child = NULL;
+  alarm->heap_sibling = NULL;
+  alarm->heap_prev = NULL;
+  heap->size--;
+}
+
 static void update_stat(stat_t* stat, uint64_t delta_ms) {
   if (stat->max_ms < delta_ms) stat->max_ms = delta_ms;
   stat->total_ms += delta_ms;
@@ -159,7 +274,7 @@ alarm_t* alarm_new_periodic(const char* name) {
 }
 
 static alarm_t* alarm_new_internal(const char* name, bool is_periodic) {
-  // Make sure we have a list we can insert alarms into.
+  // Make sure we have a heap we can insert alarms into.
   if (!alarms && !lazy_initialize()) {
     log::fatal("initialization failed");  // if initialization failed, we
                                           // should not continue
@@ -255,8 +370,7 @@ void alarm_cancel(alarm_t* alarm) {
 // Internal implementation of canceling an alarm.
 // The caller must hold the |alarms_mutex|
 static void alarm_cancel_internal(alarm_t* alarm) {
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarm_heap_front(alarms) == alarm);
 
   remove_pending_alarm(alarm);
 
@@ -296,7 +410,7 @@ void alarm_cleanup(void) {
   semaphore_free(alarm_expired);
   alarm_expired = NULL;
 
-  list_free(alarms);
+  osi_free(alarms);
   alarms = NULL;
 }
 
@@ -310,11 +424,7 @@ static bool lazy_initialize(void) {
 
   std::lock_guard<std::mutex> lock(alarms_mutex);
 
-  alarms = list_new(NULL);
-  if (!alarms) {
-    log::error("unable to allocate alarm list.");
-    goto error;
-  }
+  alarms = static_cast<alarm_heap_t*>(osi_calloc(sizeof(alarm_heap_t)));
 
   if (!timer_create_internal(CLOCK_ID, &timer)) goto error;
   timer_initialized = true;
@@ -375,7 +485,7 @@ error:
 
   if (timer_initialized) timer_delete(timer);
 
-  list_free(alarms);
+  osi_free(alarms);
   alarms = NULL;
 
   return false;
@@ -393,10 +503,10 @@ static uint64_t now_ms(void) {
   return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000LL);
 }
 
-// Remove alarm from internal alarm list and the processing queue
+// Remove alarm from internal alarm heap and the processing queue
 // The caller must hold the |alarms_mutex|
 static void remove_pending_alarm(alarm_t* alarm) {
-  list_remove(alarms, alarm);
+  alarm_heap_remove(alarms, alarm);
 
   if (alarm->for_msg_loop) {
     alarm->closure.i.Cancel();
@@ -411,10 +521,9 @@ static void remove_pending_alarm(alarm_t* alarm) {
 
 // Must be called with |alarms_mutex| held
 static void schedule_next_instance(alarm_t* alarm) {
-  // If the alarm is currently set and it's at the start of the list,
+  // If the alarm is currently set and it's at the root of the heap,
   // we'll need to re-schedule since we've adjusted the earliest deadline.
-  bool needs_reschedule =
-      (!list_is_empty(alarms) && list_front(alarms) == alarm);
+  bool needs_reschedule = (alarm_heap_front(alarms) == alarm);
   if (alarm->callback) remove_pending_alarm(alarm);
 
   // Calculate the next deadline for this alarm
@@ -425,26 +534,12 @@ static void schedule_next_instance(alarm_t* alarm) {
         ((just_now_ms - alarm->creation_time_ms) % alarm->period_ms);
   alarm->deadline_ms = just_now_ms + (alarm->period_ms - ms_into_period);
 
-  // Add it into the timer list sorted by deadline (earliest deadline first).
-  if (list_is_empty(alarms) ||
-      ((alarm_t*)list_front(alarms))->deadline_ms > alarm->deadline_ms) {
-    list_prepend(alarms, alarm);
-  } else {
-    for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-         node = list_next(node)) {
-      list_node_t* next = list_next(node);
-      if (next == list_end(alarms) ||
-          ((alarm_t*)list_node(next))->deadline_ms > alarm->deadline_ms) {
-        list_insert_after(alarms, node, alarm);
-        break;
-      }
-    }
-  }
+  // Add it into the timer heap ordered by deadline (earliest deadline first).
+  alarm_heap_insert(alarms, alarm);
 
   // If the new alarm has the earliest deadline, we need to re-evaluate our
   // schedule.
-  if (needs_reschedule ||
-      (!list_is_empty(alarms) && list_front(alarms) == alarm)) {
+  if (needs_reschedule || alarm_heap_front(alarms) == alarm) {
     reschedule_root_alarm();
   }
 }
@@ -461,9 +556,9 @@ static void reschedule_root_alarm(void) {
   struct itimerspec timer_time;
   memset(&timer_time, 0, sizeof(timer_time));
 
-  if (list_is_empty(alarms)) goto done;
+  next = alarm_heap_front(alarms);
+  if (next == NULL) goto done;
 
-  next = static_cast<alarm_t*>(list_front(alarms));
   next_expiration = next->deadline_ms - now_ms();
   if (next_expiration < TIMER_INTERVAL_FOR_WAKELOCK_IN_MS) {
     if (!timer_set) {
@@ -618,14 +713,13 @@ static void callback_dispatch(void* /* context */) {
     // Take into account that the alarm may get cancelled before we get to it.
     // We're done here if there are no alarms or the alarm at the front is in
     // the future. Exit right away since there's nothing left to do.
-    if (list_is_empty(alarms) ||
-        (alarm = static_cast<alarm_t*>(list_front(alarms)))->deadline_ms >
-            now_ms()) {
+    alarm = alarm_heap_front(alarms);
+    if (alarm == NULL || alarm->deadline_ms > now_ms()) {
       reschedule_root_alarm();
       continue;
     }
 
-    list_remove(alarms, alarm);
+    alarm_heap_remove(alarms, alarm);
 
     if (alarm->is_periodic) {
       alarm->prev_deadline_ms = alarm->deadline_ms;
@@ -723,12 +817,22 @@ void alarm_debug_dump(int fd) {
 
   uint64_t just_now_ms = now_ms();
 
-  dprintf(fd, "  Total Alarms: %zu\n\n", list_length(alarms));
+  dprintf(fd, "  Total Alarms: %zu\n\n", alarms->size);
+
+  // Dump info for each alarm, in the order they will expire
+  std::vector<alarm_t*> sorted;
+  std::vector<alarm_t*> pending;
+  if (alarms->root != NULL) pending.push_back(alarms->root);
+  while (!pending.empty()) {
+    alarm_t* alarm = pending.back();
+    pending.pop_back();
+    if (alarm->heap_sibling != NULL) pending.push_back(alarm->heap_sibling);
+    if (alarm->heap_child != NULL) pending.push_back(alarm->heap_child);
+    sorted.push_back(alarm);
+  }
+  std::sort(sorted.begin(), sorted.end(), alarm_heap_less);
 
-  // Dump info for each alarm
-  for (list_node_t* node = list_begin(alarms); node != list_end(alarms);
-       node = list_next(node)) {
-    alarm_t* alarm = (alarm_t*)list_node(node);
+  for (alarm_t* alarm : sorted) {
     alarm_stats_t* stats = &alarm->stats;
 
     dprintf(fd, "  Alarm : %s (%s)\n", stats->name,
@@ -18,11 +18,235 @@
 #include "osi/include/allocator.h"
 
 #include <bluetooth/log.h>
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <mutex>
 
 using namespace bluetooth;
 
+namespace {
+
+// Block sizes served by the buffer pools. The largest class holds a
+// BT_DEFAULT_BUFFER_SIZE packet, the one below it a BR/EDR 3-DH5 ACL payload
+// with its preamble and BT_HDR. All sizes are multiples of 16 so every block
+// keeps the alignment guaranteed by malloc.
+constexpr size_t kPoolClassSizes[] = {128, 512, 1280, 2304, 4608};
+constexpr size_t kPoolClassCount =
+    sizeof(kPoolClassSizes) / sizeof(kPoolClassSizes[0]);
+
+// Every class owns a fixed slice of one reserved address range, so a pointer
+// can be mapped back to its class (and told apart from a malloc block) with a
+// range check. Pages are only backed by memory once blocks are carved.
+constexpr size_t kPoolClassRegionSize = 4 * 1024 * 1024;
+constexpr size_t kPoolRegionSize = kPoolClassCount * kPoolClassRegionSize;
+
+// Blocks cached per thread and class before half of them are handed back to
+// the shared free list.
+constexpr size_t kThreadCacheCapacity = 32;
+constexpr size_t kThreadCacheBatch = kThreadCacheCapacity / 2;
+
+#ifdef OSI_POOL_USE_MALLOC
+constexpr bool kPoolUseMalloc = true;
+#else
+constexpr bool kPoolUseMalloc = false;
+#endif
+
+typedef struct pool_block_t {
+  struct pool_block_t* next;
+} pool_block_t;
+
+typedef struct {
+  std::mutex mutex;
+  pool_block_t* free_list;  // guarded by |mutex|
+  size_t carved;            // guarded by |mutex|, blocks taken from the region
+  size_t capacity;
+  uint8_t* region;
+
+  std::atomic<size_t> allocations;
+  std::atomic<size_t> frees;
+  std::atomic<size_t> fallbacks;
+} pool_class_t;
+
+typedef struct {
+  pool_class_t classes[kPoolClassCount];
+} pool_t;
+
+// Set once the address range is reserved. Never unmapped, since blocks may be
+// freed from any thread until the process exits.
+std::atomic<uint8_t*> pool_region;
+pool_t* pool;
+std::once_flag pool_init_flag;
+
+// Trivially destructible so that it remains usable while other thread_local
+// destructors run; |thread_cache_flusher| hands the blocks back on thread exit.
+typedef struct {
+  pool_block_t* blocks[kPoolClassCount][kThreadCacheCapacity];
+  size_t count[kPoolClassCount];
+  bool registered;
+  bool disabled;
+} pool_thread_cache_t;
+
+thread_local pool_thread_cache_t thread_cache;
+
+void pool_release_to_class(pool_class_t* pool_class, pool_block_t** blocks,
+                           size_t count);
+
+struct PoolThreadCacheFlusher {
+  ~PoolThreadCacheFlusher() {
+    thread_cache.disabled = true;
+    for (size_t i = 0; i < kPoolClassCount; i++) {
+      pool_release_to_class(&pool->classes[i], thread_cache.blocks[i],
+                            thread_cache.count[i]);
+      thread_cache.count[i] = 0;
+    }
+  }
+};
+
+thread_local PoolThreadCacheFlusher thread_cache_flusher;
+
+void pool_thread_cache_register(pool_thread_cache_t* cache) {
+  if (cache->registered) return;
+  // Odr-use the flusher so its destructor runs when this thread exits
+  (void)&thread_cache_flusher;
+  cache->registered = true;
+}
+
+void pool_init() {
+  void* region = mmap(NULL, kPoolRegionSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED) {
+    log::error("unable to reserve buffer pool region: {}", strerror(errno));
+    return;
+  }
+
+  pool = new pool_t();
+  for (size_t i = 0; i < kPoolClassCount; i++) {
+    pool_class_t* pool_class = &pool->classes[i];
+    pool_class->free_list = NULL;
+    pool_class->carved = 0;
+    pool_class->capacity = kPoolClassRegionSize / kPoolClassSizes[i];
+    pool_class->region = (uint8_t*)region + i * kPoolClassRegionSize;
+  }
+  pool_region.store((uint8_t*)region, std::memory_order_release);
+}
+
+// Returns the index of the smallest class holding |size| bytes, or
+// kPoolClassCount if |size| is too big for every class.
+size_t pool_class_index(size_t size) {
+  size_t i = 0;
+  while (i < kPoolClassCount && kPoolClassSizes[i] < size) i++;
+  return i;
+}
+
+bool pool_owns(const void* ptr) {
+  const uint8_t* region = pool_region.load(std::memory_order_acquire);
+  return region != NULL && (const uint8_t*)ptr >= region &&
+         (const uint8_t*)ptr < region + kPoolRegionSize;
+}
+
+// Move up to |count| blocks of |pool_class| into |blocks|, carving fresh
+// blocks from the region once the free list runs dry. Returns the number of
+// blocks obtained.
+size_t pool_acquire_from_class(pool_class_t* pool_class, size_t block_size,
+                               pool_block_t** blocks, size_t count) {
+  std::lock_guard<std::mutex> lock(pool_class->mutex);
+  size_t obtained = 0;
+  while (obtained < count && pool_class->free_list != NULL) {
+    blocks[obtained++] = pool_class->free_list;
+    pool_class->free_list = pool_class->free_list->next;
+  }
+  while (obtained < count && pool_class->carved < pool_class->capacity) {
+    blocks[obtained++] =
+        (pool_block_t*)(pool_class->region + pool_class->carved * block_size);
+    pool_class->carved++;
+  }
+  return obtained;
+}
+
+void pool_release_to_class(pool_class_t* pool_class, pool_block_t** blocks,
+                           size_t count) {
+  if (count == 0) return;
+  std::lock_guard<std::mutex> lock(pool_class->mutex);
+  for (size_t i = 0; i < count; i++) {
+    blocks[i]->next = pool_class->free_list;
+    pool_class->free_list = blocks[i];
+  }
+}
+
+void* pool_alloc(size_t size) {
+  size_t index = pool_class_index(size);
+  if (kPoolUseMalloc || index == kPoolClassCount) return osi_malloc(size);
+
+  std::call_once(pool_init_flag, pool_init);
+  if (pool == NULL) return osi_malloc(size);
+
+  pool_class_t* pool_class = &pool->classes[index];
+  pool_thread_cache_t* cache = &thread_cache;
+  if (cache->disabled) {
+    // The thread is exiting; go straight to the shared free list
+    pool_block_t* block = NULL;
+    if (pool_acquire_from_class(pool_class, kPoolClassSizes[index], &block,
+                                1) == 0) {
+      pool_class->fallbacks.fetch_add(1, std::memory_order_relaxed);
+      return osi_malloc(size);
+    }
+    pool_class->allocations.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+
+  pool_thread_cache_register(cache);
+
+  if (cache->count[index] == 0) {
+    cache->count[index] =
+        pool_acquire_from_class(pool_class, kPoolClassSizes[index],
+                                cache->blocks[index], kThreadCacheBatch);
+    if (cache->count[index] == 0) {
+      pool_class->fallbacks.fetch_add(1, std::memory_order_relaxed);
+      return osi_malloc(size);
+    }
+  }
+
+  pool_class->allocations.fetch_add(1, std::memory_order_relaxed);
+  return cache->blocks[index][--cache->count[index]];
+}
+
+void pool_free(void* ptr) {
+  const uint8_t* region = pool_region.load(std::memory_order_relaxed);
+  size_t index = ((const uint8_t*)ptr - region) / kPoolClassRegionSize;
+  log::assert_that(
+      ((const uint8_t*)ptr - region) % kPoolClassRegionSize %
+              kPoolClassSizes[index] ==
+          0,
+      "assert failed: freeing a pointer inside a pool block");
+
+  pool_class_t* pool_class = &pool->classes[index];
+  pool_class->frees.fetch_add(1, std::memory_order_relaxed);
+
+  pool_block_t* block = (pool_block_t*)ptr;
+  pool_thread_cache_t* cache = &thread_cache;
+  if (cache->disabled) {
+    pool_release_to_class(pool_class, &block, 1);
+    return;
+  }
+
+  pool_thread_cache_register(cache);
+
+  if (cache->count[index] == kThreadCacheCapacity) {
+    cache->count[index] -= kThreadCacheBatch;
+    pool_release_to_class(pool_class,
+                          &cache->blocks[index][cache->count[index]],
+                          kThreadCacheBatch);
+  }
+  cache->blocks[index][cache->count[index]++] = block;
+}
+
+}  // namespace
+
 char* osi_strdup(const char* str) {
   size_t size = strlen(str) + 1;  // + 1 for the null terminator
   char* new_string = (char*)malloc(size);
@@ -66,7 +290,13 @@ void* osi_calloc(size_t size) {
   return ptr;
 }
 
-void osi_free(void* ptr) { free(ptr); }
+void osi_free(void* ptr) {
+  if (pool_owns(ptr)) {
+    pool_free(ptr);
+    return;
+  }
+  free(ptr);
+}
 
 void osi_free_and_reset(void** p_ptr) {
   log::assert_that(p_ptr != NULL, "assert failed: p_ptr != NULL");
@@ -74,6 +304,48 @@ void osi_free_and_reset(void** p_ptr) {
   *p_ptr = NULL;
 }
 
+
+void* osi_pool_malloc(size_t size) {
+  log::assert_that(static_cast<ssize_t>(size) >= 0,
+                   "assert failed: static_cast<ssize_t>(size) >= 0");
+  return pool_alloc(size);
+}
+
+void* osi_pool_calloc(size_t size) {
+  void* ptr = osi_pool_malloc(size);
+  memset(ptr, 0, size);
+  return ptr;
+}
+
+void osi_pool_debug_dump(int fd) {
+  dprintf(fd, "\nBluetooth Buffer Pool Statistics:\n");
+
+  if (pool_region.load(std::memory_order_acquire) == NULL) {
+    dprintf(fd, "  None\n");
+    return;
+  }
+
+  dprintf(fd, "  %-10s %12s %12s %10s %10s %10s %10s\n", "Block size",
+          "Allocations", "Frees", "In use", "Carved", "Capacity",
+          "Fallbacks");
+  for (size_t i = 0; i < kPoolClassCount; i++) {
+    pool_class_t* pool_class = &pool->classes[i];
+    size_t carved;
+    {
+      std::lock_guard<std::mutex> lock(pool_class->mutex);
+      carved = pool_class->carved;
+    }
+    size_t allocations =
+        pool_class->allocations.load(std::memory_order_relaxed);
+    size_t frees = pool_class->frees.load(std::memory_order_relaxed);
+    dprintf(fd, "  %-10zu %12zu %12zu %10zu %10zu %10zu %10zu\n",
+            kPoolClassSizes[i], allocations, frees,
+            allocations >= frees ? allocations - frees : 0, carved,
+            pool_class->capacity,
+            pool_class->fallbacks.load(std::memory_order_relaxed));
+  }
+}
+
 const allocator_t allocator_calloc = {osi_calloc, osi_free};
 
 const allocator_t allocator_malloc = {osi_malloc, osi_free};
@@ -19,9 +19,14 @@
 #include "osi/include/fixed_queue.h"
 
 #include <bluetooth/log.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <mutex>
+#include <thread>
 
 #include "osi/include/allocator.h"
 #include "osi/include/list.h"
@@ -31,7 +36,32 @@
 
 using namespace bluetooth;
 
+// A slot of the ring. |sequence| tells which lap of the ring the slot belongs
+// to: it equals the enqueue position while the slot is free and that position
+// plus one once |data| is published (Vyukov's bounded MPMC queue).
+typedef struct {
+  std::atomic<size_t> sequence;
+  void* data;
+} fixed_queue_slot_t;
+
+typedef struct {
+  fixed_queue_slot_t* slots;
+  size_t mask;
+
+  // Producers and consumers touch different cache lines
+  alignas(64) std::atomic<size_t> enqueue_pos;
+  alignas(64) std::atomic<size_t> dequeue_pos;
+
+  // Elements published or being published, bounded by the queue capacity.
+  // The eventfds are only written when |length| leaves zero or the capacity.
+  alignas(64) std::atomic<size_t> length;
+  int enqueue_fd;
+  int dequeue_fd;
+} fixed_queue_ring_t;
+
 typedef struct fixed_queue_t {
+  fixed_queue_ring_t* ring;  // NULL unless created by fixed_queue_new_ring
+
   list_t* list;
   semaphore_t* enqueue_sem;
   semaphore_t* dequeue_sem;
@@ -45,6 +75,14 @@ typedef struct fixed_queue_t {
 
 static void internal_dequeue_ready(void* context);
 
+static fixed_queue_ring_t* ring_new(size_t capacity);
+static void ring_free(fixed_queue_ring_t* ring, fixed_queue_free_cb free_cb);
+static bool ring_try_enqueue(fixed_queue_t* queue, void* data);
+static void* ring_try_dequeue(fixed_queue_t* queue);
+static void ring_wait(int fd);
+static void ring_reset_enqueue_fd(fixed_queue_t* queue);
+static void ring_reset_dequeue_fd(fixed_queue_t* queue);
+
 fixed_queue_t* fixed_queue_new(size_t capacity) {
   fixed_queue_t* ret =
       static_cast<fixed_queue_t*>(osi_calloc(sizeof(fixed_queue_t)));
@@ -68,11 +106,31 @@ error:
   return NULL;
 }
 
+fixed_queue_t* fixed_queue_new_ring(size_t capacity) {
+  log::assert_that(capacity > 0 && capacity <= FIXED_QUEUE_RING_MAX_CAPACITY,
+                   "assert failed: invalid ring capacity {}", capacity);
+
+  fixed_queue_ring_t* ring = ring_new(capacity);
+  if (!ring) return NULL;
+
+  fixed_queue_t* ret =
+      static_cast<fixed_queue_t*>(osi_calloc(sizeof(fixed_queue_t)));
+  ret->ring = ring;
+  ret->capacity = capacity;
+  return ret;
+}
+
 void fixed_queue_free(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
   if (!queue) return;
 
   fixed_queue_unregister_dequeue(queue);
 
+  if (queue->ring) {
+    ring_free(queue->ring, free_cb);
+    osi_free(queue);
+    return;
+  }
+
   if (free_cb)
     for (const list_node_t* node = list_begin(queue->list);
          node != list_end(queue->list); node = list_next(node))
@@ -88,8 +146,8 @@ void fixed_queue_free(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
 void fixed_queue_flush(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
   if (!queue) return;
 
-  while (!fixed_queue_is_empty(queue)) {
-    void* data = fixed_queue_try_dequeue(queue);
+  void* data;
+  while ((data = fixed_queue_try_dequeue(queue)) != NULL) {
     if (free_cb != NULL) {
       free_cb(data);
     }
@@ -99,6 +157,8 @@ void fixed_queue_flush(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   if (queue == NULL) return true;
 
+  if (queue->ring) return queue->ring->length.load() == 0;
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list);
 }
@@ -106,6 +166,8 @@ bool fixed_queue_is_empty(fixed_queue_t* queue) {
 size_t fixed_queue_length(fixed_queue_t* queue) {
   if (queue == NULL) return 0;
 
+  if (queue->ring) return queue->ring->length.load();
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_length(queue->list);
 }
@@ -120,6 +182,14 @@ void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
   log::assert_that(data != NULL, "assert failed: data != NULL");
 
+  if (queue->ring) {
+    while (!ring_try_enqueue(queue, data)) {
+      ring_reset_enqueue_fd(queue);
+      ring_wait(queue->ring->enqueue_fd);
+    }
+    return;
+  }
+
   semaphore_wait(queue->enqueue_sem);
 
   {
@@ -133,6 +203,14 @@ void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
 void* fixed_queue_dequeue(fixed_queue_t* queue) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
 
+  if (queue->ring) {
+    void* ret;
+    while ((ret = ring_try_dequeue(queue)) == NULL) {
+      ring_wait(queue->ring->dequeue_fd);
+    }
+    return ret;
+  }
+
   semaphore_wait(queue->dequeue_sem);
 
   void* ret = NULL;
@@ -151,6 +229,8 @@ bool fixed_queue_try_enqueue(fixed_queue_t* queue, void* data) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
   log::assert_that(data != NULL, "assert failed: data != NULL");
 
+  if (queue->ring) return ring_try_enqueue(queue, data);
+
   if (!semaphore_try_wait(queue->enqueue_sem)) return false;
 
   {
@@ -165,6 +245,8 @@ bool fixed_queue_try_enqueue(fixed_queue_t* queue, void* data) {
 void* fixed_queue_try_dequeue(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
+  if (queue->ring) return ring_try_dequeue(queue);
+
   if (!semaphore_try_wait(queue->dequeue_sem)) return NULL;
 
   void* ret = NULL;
@@ -182,6 +264,15 @@ void* fixed_queue_try_dequeue(fixed_queue_t* queue) {
 void* fixed_queue_try_peek_first(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
+  if (queue->ring) {
+    fixed_queue_ring_t* ring = queue->ring;
+    size_t pos = ring->dequeue_pos.load(std::memory_order_acquire);
+    fixed_queue_slot_t* slot = &ring->slots[pos & ring->mask];
+    return slot->sequence.load(std::memory_order_acquire) == pos + 1
+               ? slot->data
+               : NULL;
+  }
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list) ? NULL : list_front(queue->list);
 }
@@ -189,6 +280,15 @@ void* fixed_queue_try_peek_first(fixed_queue_t* queue) {
 void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
+  if (queue->ring) {
+    fixed_queue_ring_t* ring = queue->ring;
+    size_t pos = ring->enqueue_pos.load(std::memory_order_acquire);
+    if (pos == ring->dequeue_pos.load(std::memory_order_acquire)) return NULL;
+    fixed_queue_slot_t* slot = &ring->slots[(pos - 1) & ring->mask];
+    return slot->sequence.load(std::memory_order_acquire) == pos ? slot->data
+                                                                 : NULL;
+  }
+
   std::lock_guard<std::mutex> lock(*queue->mutex);
   return list_is_empty(queue->list) ? NULL : list_back(queue->list);
 }
@@ -196,6 +296,9 @@ void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
 void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
   if (queue == NULL) return NULL;
 
+  log::assert_that(queue->ring == NULL,
+                   "assert failed: cannot remove from a ring queue");
+
   bool removed = false;
   {
     std::lock_guard<std::mutex> lock(*queue->mutex);
@@ -215,6 +318,8 @@ void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
 
 list_t* fixed_queue_get_list(fixed_queue_t* queue) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
+  log::assert_that(queue->ring == NULL,
+                   "assert failed: a ring queue has no list");
 
   // NOTE: Using the list in this way is not thread-safe.
   // Using this list in any context where threads can call other functions
@@ -224,11 +329,13 @@ list_t* fixed_queue_get_list(fixed_queue_t* queue) {
 
 int fixed_queue_get_dequeue_fd(const fixed_queue_t* queue) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
+  if (queue->ring) return queue->ring->dequeue_fd;
   return semaphore_get_fd(queue->dequeue_sem);
 }
 
 int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue) {
   log::assert_that(queue != NULL, "assert failed: queue != NULL");
+  if (queue->ring) return queue->ring->enqueue_fd;
   return semaphore_get_fd(queue->enqueue_sem);
 }
 
@@ -263,3 +370,146 @@ static void internal_dequeue_ready(void* context) {
   fixed_queue_t* queue = static_cast<fixed_queue_t*>(context);
   queue->dequeue_ready(queue, queue->dequeue_context);
 }
+
+static fixed_queue_ring_t* ring_new(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) size <<= 1;
+
+  fixed_queue_ring_t* ring = new fixed_queue_ring_t();
+  ring->slots = new fixed_queue_slot_t[size];
+  for (size_t i = 0; i < size; i++) {
+    ring->slots[i].sequence.store(i, std::memory_order_relaxed);
+    ring->slots[i].data = NULL;
+  }
+  ring->mask = size - 1;
+  ring->enqueue_pos.store(0, std::memory_order_relaxed);
+  ring->dequeue_pos.store(0, std::memory_order_relaxed);
+  ring->length.store(0, std::memory_order_relaxed);
+
+  // The queue starts out with room for |capacity| elements
+  ring->enqueue_fd = eventfd(1, EFD_NONBLOCK);
+  ring->dequeue_fd = eventfd(0, EFD_NONBLOCK);
+  if (ring->enqueue_fd == INVALID_FD || ring->dequeue_fd == INVALID_FD) {
+    log::error("unable to create ring queue eventfd: {}", strerror(errno));
+    ring_free(ring, NULL);
+    return NULL;
+  }
+  return ring;
+}
+
+static void ring_free(fixed_queue_ring_t* ring, fixed_queue_free_cb free_cb) {
+  // Nobody may use the queue any more, so every slot in the occupied range
+  // has been published
+  size_t end = ring->enqueue_pos.load(std::memory_order_acquire);
+  for (size_t pos = ring->dequeue_pos.load(std::memory_order_acquire);
+       pos != end; pos++) {
+    if (free_cb) free_cb(ring->slots[pos & ring->mask].data);
+  }
+
+  if (ring->enqueue_fd != INVALID_FD) close(ring->enqueue_fd);
+  if (ring->dequeue_fd != INVALID_FD) close(ring->dequeue_fd);
+  delete[] ring->slots;
+  delete ring;
+}
+
+static void ring_signal(int fd) {
+  if (eventfd_write(fd, 1) == -1)
+    log::error("unable to signal ring queue: {}", strerror(errno));
+}
+
+// Clears a non-blocking eventfd; it is fine if it was not signalled
+static void ring_clear(int fd) {
+  eventfd_t value;
+  eventfd_read(fd, &value);
+}
+
+// Blocks until |fd| becomes readable, without consuming the signal
+static void ring_wait(int fd) {
+  struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+  int ret;
+  OSI_NO_INTR(ret = poll(&pfd, 1, -1));
+  if (ret == -1) log::error("unable to wait on ring queue: {}", strerror(errno));
+}
+
+// A signal may land after the state it announced has already changed again.
+// These clear the enqueue (dequeue) fd if the queue is full (empty), and then
+// signal it again if a concurrent operation changed that in the meantime.
+static void ring_reset_enqueue_fd(fixed_queue_t* queue) {
+  fixed_queue_ring_t* ring = queue->ring;
+  if (ring->length.load() < queue->capacity) return;
+  ring_clear(ring->enqueue_fd);
+  if (ring->length.load() < queue->capacity) ring_signal(ring->enqueue_fd);
+}
+
+static void ring_reset_dequeue_fd(fixed_queue_t* queue) {
+  fixed_queue_ring_t* ring = queue->ring;
+  if (ring->length.load() != 0) return;
+  ring_clear(ring->dequeue_fd);
+  if (ring->length.load() != 0) ring_signal(ring->dequeue_fd);
+}
+
+static bool ring_try_enqueue(fixed_queue_t* queue, void* data) {
+  fixed_queue_ring_t* ring = queue->ring;
+
+  // Reserve room first; this keeps the ring from ever wrapping onto a slot
+  // that has not been dequeued
+  size_t length = ring->length.load();
+  do {
+    if (length >= queue->capacity) return false;
+  } while (!ring->length.compare_exchange_weak(length, length + 1));
+
+  size_t pos = ring->enqueue_pos.load(std::memory_order_relaxed);
+  fixed_queue_slot_t* slot;
+  for (;;) {
+    slot = &ring->slots[pos & ring->mask];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if (diff == 0) {
+      if (ring->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      // Another consumer still has to release this slot
+      std::this_thread::yield();
+      pos = ring->enqueue_pos.load(std::memory_order_relaxed);
+    } else {
+      pos = ring->enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  slot->data = data;
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  if (length == 0) ring_signal(ring->dequeue_fd);
+  if (length + 1 == queue->capacity) ring_reset_enqueue_fd(queue);
+  return true;
+}
+
+static void* ring_try_dequeue(fixed_queue_t* queue) {
+  fixed_queue_ring_t* ring = queue->ring;
+
+  size_t pos = ring->dequeue_pos.load(std::memory_order_relaxed);
+  fixed_queue_slot_t* slot;
+  for (;;) {
+    slot = &ring->slots[pos & ring->mask];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+    if (diff == 0) {
+      if (ring->dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      // Empty, or the next element is still being published
+      ring_reset_dequeue_fd(queue);
+      return NULL;
+    } else {
+      pos = ring->dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  void* data = slot->data;
+  slot->sequence.store(pos + ring->mask + 1, std::memory_order_release);
+
+  size_t length = ring->length.fetch_sub(1);
+  if (length == queue->capacity) ring_signal(ring->enqueue_fd);
+  if (length == 1) ring_reset_dequeue_fd(queue);
+  return data;
+}
@@ -318,6 +318,48 @@ TEST_F(AlarmTest, test_callback_ordering) {
   EXPECT_FALSE(is_wake_lock_acquired);
 }
 
+// Test that alarms armed out of deadline order, with some of them canceled or
+// re-armed while pending, still fire in deadline order
+TEST_F(AlarmTest, test_callback_ordering_out_of_order_arming) {
+  const int kNumAlarms = 100;
+  alarm_t* alarms[kNumAlarms];
+
+  for (int i = 0; i < kNumAlarms; i++) {
+    const std::string alarm_name =
+        "alarm_test.test_callback_ordering_out_of_order_arming[" +
+        std::to_string(i) + "]";
+    alarms[i] = alarm_new(alarm_name.c_str());
+  }
+
+  // Arm the alarms latest deadline first, plus a decoy on every odd alarm
+  for (int i = kNumAlarms - 1; i >= 0; i--) {
+    if (i % 2 == 1) alarm_set(alarms[i], 80, cb, NULL);
+  }
+  for (int i = kNumAlarms - 1; i >= 0; i--) {
+    if (i % 2 == 0) alarm_set(alarms[i], 1000, cb, NULL);
+  }
+  // Re-arm them with their final deadlines, which reschedules them in the heap
+  for (int i = kNumAlarms - 1; i >= 0; i--) {
+    if (i % 2 == 0) {
+      alarm_set(alarms[i], 100 + 2 * i, ordered_cb, INT_TO_PTR(i / 2));
+    }
+  }
+  for (int i = 0; i < kNumAlarms; i++) {
+    if (i % 2 == 1) alarm_cancel(alarms[i]);
+  }
+
+  for (int i = 1; i <= kNumAlarms / 2; i++) {
+    semaphore_wait(semaphore);
+    EXPECT_GE(cb_counter, i);
+  }
+  EXPECT_EQ(cb_counter, kNumAlarms / 2);
+  EXPECT_EQ(cb_misordered_counter, 0);
+
+  for (int i = 0; i < kNumAlarms; i++) alarm_free(alarms[i]);
+
+  EXPECT_FALSE(is_wake_lock_acquired);
+}
+
 // Test whether the callbacks are involed in the expected order on a
 // message loop.
 TEST_F(AlarmTest, test_callback_ordering_on_mloop) {
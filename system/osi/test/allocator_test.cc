@@ -19,10 +19,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 class AllocatorTest : public ::testing::Test {};
 
+// Sanitized builds do not pool, so blocks are not recycled by the allocator
+#ifdef OSI_POOL_USE_MALLOC
+#define SKIP_IF_POOL_USES_MALLOC() GTEST_SKIP() << "pools use malloc"
+#else
+#define SKIP_IF_POOL_USES_MALLOC()
+#endif
+
 TEST_F(AllocatorTest, test_osi_strndup) {
   char str[] = "IloveBluetooth";
   size_t len = strlen(str);
@@ -48,3 +60,99 @@ TEST_F(AllocatorTest, test_osi_strndup) {
   EXPECT_EQ(0, strcmp(str, copy_str));
   osi_free(copy_str);
 }
+
+TEST_F(AllocatorTest, test_osi_pool_reuses_freed_block) {
+  SKIP_IF_POOL_USES_MALLOC();
+  void* first = osi_pool_malloc(100);
+  ASSERT_NE(first, nullptr);
+  osi_free(first);
+
+  // The thread cache hands back the most recently freed block of the class
+  void* second = osi_pool_malloc(120);
+  EXPECT_EQ(first, second);
+  osi_free(second);
+}
+
+TEST_F(AllocatorTest, test_osi_pool_size_classes_do_not_overlap) {
+  const size_t sizes[] = {1, 128, 129, 1000, 2000, 4112};
+  uint8_t* buffers[sizeof(sizes) / sizeof(sizes[0])];
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    buffers[i] = (uint8_t*)osi_pool_malloc(sizes[i]);
+    ASSERT_NE(buffers[i], nullptr);
+    EXPECT_EQ(0u, (uintptr_t)buffers[i] % alignof(max_align_t));
+    memset(buffers[i], (int)i, sizes[i]);
+  }
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    for (size_t j = 0; j < sizes[i]; j++) {
+      ASSERT_EQ(i, buffers[i][j]);
+    }
+    osi_free(buffers[i]);
+  }
+}
+
+TEST_F(AllocatorTest, test_osi_pool_calloc_zeroes_recycled_block) {
+  uint8_t* buffer = (uint8_t*)osi_pool_malloc(64);
+  memset(buffer, 0xff, 64);
+  osi_free(buffer);
+
+  buffer = (uint8_t*)osi_pool_calloc(64);
+  for (size_t i = 0; i < 64; i++) {
+    ASSERT_EQ(0, buffer[i]);
+  }
+  osi_free(buffer);
+}
+
+TEST_F(AllocatorTest, test_osi_pool_oversized_falls_back_to_malloc) {
+  uint8_t* buffer = (uint8_t*)osi_pool_malloc(64 * 1024);
+  ASSERT_NE(buffer, nullptr);
+  memset(buffer, 0x5a, 64 * 1024);
+  osi_free(buffer);
+}
+
+TEST_F(AllocatorTest, test_osi_pool_free_on_other_thread) {
+  SKIP_IF_POOL_USES_MALLOC();
+  constexpr int kNumBuffers = 1000;
+  std::vector<void*> buffers;
+  for (int i = 0; i < kNumBuffers; i++) {
+    buffers.push_back(osi_pool_malloc(600));
+  }
+  std::thread consumer([&buffers]() {
+    for (void* buffer : buffers) {
+      osi_free(buffer);
+    }
+  });
+  consumer.join();
+
+  // Blocks cached by the exited thread are back on the shared free list. The
+  // calling thread may still cache a few blocks of its own, which come first.
+  std::vector<void*> reused;
+  for (int i = 0; i < kNumBuffers + 32; i++) {
+    reused.push_back(osi_pool_malloc(600));
+  }
+  for (void* buffer : buffers) {
+    EXPECT_TRUE(std::find(reused.begin(), reused.end(), buffer) !=
+                reused.end());
+  }
+  for (void* buffer : reused) {
+    osi_free(buffer);
+  }
+}
+
+TEST_F(AllocatorTest, test_osi_pool_debug_dump) {
+  SKIP_IF_POOL_USES_MALLOC();
+  osi_free(osi_pool_malloc(16));
+
+  FILE* file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  osi_pool_debug_dump(fileno(file));
+  rewind(file);
+
+  char line[256];
+  std::string output;
+  while (fgets(line, sizeof(line), file) != nullptr) output += line;
+  fclose(file);
+
+  EXPECT_NE(std::string::npos,
+            output.find("Bluetooth Buffer Pool Statistics"));
+  EXPECT_NE(std::string::npos, output.find("4608"));
+}
@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 
 #include <climits>
+#include <thread>
+#include <vector>
 
 #include "osi/include/allocator.h"
 #include "osi/include/future.h"
@@ -346,3 +348,161 @@ TEST_F(FixedQueueTest, test_fixed_queue_register_dequeue) {
   thread_free(worker_thread);
   fixed_queue_free(queue, NULL);
 }
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_enqueue_dequeue) {
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+  EXPECT_EQ(TEST_QUEUE_SIZE, fixed_queue_capacity(queue));
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  // Test blocking enqueue and blocking dequeue
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+  EXPECT_EQ((size_t)1, fixed_queue_length(queue));
+  EXPECT_EQ(DUMMY_DATA_STRING, fixed_queue_dequeue(queue));
+  EXPECT_EQ((size_t)0, fixed_queue_length(queue));
+
+  // The capacity is honored even though the ring is rounded up to 16 slots.
+  // Go around the ring a few times to exercise the wrap-around.
+  for (int lap = 0; lap < 5; lap++) {
+    for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+      EXPECT_TRUE(fixed_queue_try_enqueue(queue, (void*)(DUMMY_DATA_STRING + i)));
+    }
+    EXPECT_FALSE(fixed_queue_try_enqueue(queue, (void*)DUMMY_DATA_STRING));
+    EXPECT_EQ(TEST_QUEUE_SIZE, fixed_queue_length(queue));
+    for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+      EXPECT_EQ(DUMMY_DATA_STRING + i, fixed_queue_try_dequeue(queue));
+    }
+    EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+    EXPECT_TRUE(fixed_queue_is_empty(queue));
+  }
+
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_try_peek_first_last) {
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  EXPECT_EQ(NULL, fixed_queue_try_peek_first(queue));
+  EXPECT_EQ(NULL, fixed_queue_try_peek_last(queue));
+
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING1);
+  EXPECT_EQ(DUMMY_DATA_STRING1, fixed_queue_try_peek_first(queue));
+  EXPECT_EQ(DUMMY_DATA_STRING1, fixed_queue_try_peek_last(queue));
+
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING2);
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING3);
+  EXPECT_EQ(DUMMY_DATA_STRING1, fixed_queue_try_peek_first(queue));
+  EXPECT_EQ(DUMMY_DATA_STRING3, fixed_queue_try_peek_last(queue));
+
+  fixed_queue_try_dequeue(queue);
+  EXPECT_EQ(DUMMY_DATA_STRING2, fixed_queue_try_peek_first(queue));
+
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_flush_free) {
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  test_queue_entry_free_counter = 0;
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING1);
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING2);
+  fixed_queue_flush(queue, test_queue_entry_free_cb);
+  EXPECT_EQ(2, test_queue_entry_free_counter);
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  test_queue_entry_free_counter = 0;
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING3);
+  fixed_queue_free(queue, test_queue_entry_free_cb);
+  EXPECT_EQ(1, test_queue_entry_free_counter);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_get_enqueue_dequeue_fd) {
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  int enqueue_fd = fixed_queue_get_enqueue_fd(queue);
+  int dequeue_fd = fixed_queue_get_dequeue_fd(queue);
+  EXPECT_TRUE(enqueue_fd >= 0);
+  EXPECT_TRUE(dequeue_fd >= 0);
+
+  // Empty queue: only the enqueue_fd should be readable
+  EXPECT_TRUE(is_fd_readable(enqueue_fd));
+  EXPECT_FALSE(is_fd_readable(dequeue_fd));
+
+  // Non-empty queue: both should be readable
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+  EXPECT_TRUE(is_fd_readable(enqueue_fd));
+  EXPECT_TRUE(is_fd_readable(dequeue_fd));
+  fixed_queue_dequeue(queue);
+  EXPECT_FALSE(is_fd_readable(dequeue_fd));
+
+  // Full queue: only the dequeue_fd should be readable
+  for (size_t i = 0; i < TEST_QUEUE_SIZE; i++) {
+    EXPECT_TRUE(fixed_queue_try_enqueue(queue, (void*)DUMMY_DATA_STRING));
+  }
+  EXPECT_FALSE(is_fd_readable(enqueue_fd));
+  EXPECT_TRUE(is_fd_readable(dequeue_fd));
+
+  // Leaving the full state signals the enqueue_fd again
+  fixed_queue_dequeue(queue);
+  EXPECT_TRUE(is_fd_readable(enqueue_fd));
+
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_register_dequeue) {
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  received_message_future = future_new();
+  ASSERT_TRUE(received_message_future != NULL);
+
+  thread_t* worker_thread = thread_new("test_fixed_queue_worker_thread");
+  ASSERT_TRUE(worker_thread != NULL);
+
+  fixed_queue_register_dequeue(queue, thread_get_reactor(worker_thread),
+                               fixed_queue_ready, NULL);
+
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+  const char* msg = (const char*)future_await(received_message_future);
+  EXPECT_EQ(DUMMY_DATA_STRING, msg);
+
+  fixed_queue_unregister_dequeue(queue);
+  thread_free(worker_thread);
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_ring_multiple_producers_blocking) {
+  constexpr size_t kNumProducers = 4;
+  constexpr uintptr_t kNumPerProducer = 20000;
+  fixed_queue_t* queue = fixed_queue_new_ring(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  // Producers block on the full queue; each element encodes its producer and
+  // sequence number, which must arrive in order per producer
+  std::vector<std::thread> producers;
+  for (uintptr_t p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([queue, p]() {
+      for (uintptr_t i = 1; i <= kNumPerProducer; i++) {
+        fixed_queue_enqueue(queue, (void*)(i * kNumProducers + p));
+      }
+    });
+  }
+
+  std::vector<uintptr_t> last(kNumProducers, 0);
+  for (size_t n = 0; n < kNumProducers * kNumPerProducer; n++) {
+    uintptr_t value = (uintptr_t)fixed_queue_dequeue(queue);
+    uintptr_t p = value % kNumProducers;
+    EXPECT_EQ(last[p] + 1, value / kNumProducers);
+    last[p] = value / kNumProducers;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+  EXPECT_EQ(NULL, fixed_queue_try_dequeue(queue));
+
+  fixed_queue_free(queue, NULL);
+}
@@ -323,7 +323,7 @@ static void a2dp_aac_encode_frames(uint8_t nb_frame) {
       return;
     }
 
-    BT_HDR* p_buf = (BT_HDR*)osi_calloc(BT_DEFAULT_BUFFER_SIZE);
+    BT_HDR* p_buf = (BT_HDR*)osi_pool_calloc(BT_DEFAULT_BUFFER_SIZE);
     p_buf->offset = AVDT_MEDIA_OFFSET;
     p_buf->len = 0;
     p_buf->layer_specific = 0;
@@ -66,6 +66,7 @@ bool btm_ble_init_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
                               const RawAddress& new_pseudo_addr) {
   if (p_dev_rec->ble.pseudo_addr.IsEmpty()) {
     p_dev_rec->ble.pseudo_addr = new_pseudo_addr;
+    btm_sec_cb.UpdateDevRecKeys(p_dev_rec);
     return true;
   }
 
@@ -113,37 +114,13 @@ bool btm_ble_addr_resolvable(const RawAddress& rpa,
   return false;
 }
 
-/** This function match the random address to the appointed device record,
- * starting from calculating IRK. If the record index exceeds the maximum record
- * number, matching failed and send a callback. */
-static bool btm_ble_match_random_bda(void* data, void* context) {
-  tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
-  RawAddress* random_bda = static_cast<RawAddress*>(context);
-
-  if (!(p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) ||
-      !(p_dev_rec->sec_rec.ble_keys.key_type & BTM_LE_KEY_PID))
-    // Match fails preconditions
-    return true;
-
-  if (rpa_matches_irk(*random_bda, p_dev_rec->sec_rec.ble_keys.irk)) {
-    // Matched
-    return false;
-  }
-
-  // This item not a match, continue iteration
-  return true;
-}
-
 /** This function is called to resolve a random address.
  * Returns pointer to the security record of the device whom a random address is
  * matched to.
  */
 tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
-  list_node_t* n = list_foreach(btm_sec_cb.sec_dev_rec,
-                                btm_ble_match_random_bda, (void*)&random_bda);
-  return (n == nullptr) ? (nullptr)
-                        : (static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+  return btm_sec_cb.rpa_resolver.Resolve(random_bda);
 }
 
 /*******************************************************************************
@@ -154,23 +131,37 @@ static tBTM_SEC_DEV_REC* btm_find_dev_by_identity_addr(
     const RawAddress& bd_addr, uint8_t addr_type) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  tBTM_SEC_DEV_REC* p_match = nullptr;
+  auto it = btm_sec_cb.dev_rec_by_identity_addr.find(bd_addr);
+  if (it != btm_sec_cb.dev_rec_by_identity_addr.end()) {
+    if (it->second->ble.identity_address_with_type.bda == bd_addr) {
+      p_match = it->second;
+    } else {
+      btm_sec_cb.dev_rec_by_identity_addr.erase(it);
+    }
+  }
+
   list_node_t* end = list_end(btm_sec_cb.sec_dev_rec);
-  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec); node != end;
-       node = list_next(node)) {
+  for (list_node_t* node = list_begin(btm_sec_cb.sec_dev_rec);
+       p_match == nullptr && node != end; node = list_next(node)) {
     tBTM_SEC_DEV_REC* p_dev_rec =
         static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
     if (p_dev_rec->ble.identity_address_with_type.bda == bd_addr) {
-      if ((p_dev_rec->ble.identity_address_with_type.type &
-           (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
-        log::warn("pseudo->random match with diff addr type: {} vs {}",
-                  p_dev_rec->ble.identity_address_with_type.type, addr_type);
-
-      /* found the match */
-      return p_dev_rec;
+      p_match = p_dev_rec;
+      if (!bd_addr.IsEmpty())
+        btm_sec_cb.dev_rec_by_identity_addr[bd_addr] = p_dev_rec;
     }
   }
 
-  return NULL;
+  if (p_match == nullptr) return NULL;
+
+  if ((p_match->ble.identity_address_with_type.type &
+       (~BLE_ADDR_TYPE_ID_BIT)) != (addr_type & (~BLE_ADDR_TYPE_ID_BIT)))
+    log::warn("pseudo->random match with diff addr type: {} vs {}",
+              p_match->ble.identity_address_with_type.type, addr_type);
+
+  /* found the match */
+  return p_match;
 }
 
 /*******************************************************************************
@@ -2413,14 +2413,14 @@ void btm_ble_process_adv_pkt_cont(uint16_t evt_type, tBLE_ADDR_TYPE addr_type,
     p_i = btm_inq_db_new(bda, true);
     if (p_i != NULL) {
       btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_update_time_of_resp(p_i);
     } else
       return;
   } else if (p_i->inq_count !=
              btm_cb.btm_inq_vars
                  .inq_counter) /* first time seen in this inquiry */
   {
-    p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+    btm_inq_db_update_time_of_resp(p_i);
     btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
   }
 
@@ -2525,7 +2525,7 @@ void btm_ble_process_adv_pkt_cont_for_inquiry(
     p_i = btm_inq_db_new(bda, true);
     if (p_i != NULL) {
       btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_update_time_of_resp(p_i);
       btm_cb.neighbor.le_inquiry.results++;
       btm_cb.neighbor.le_legacy_scan.results++;
     } else {
@@ -2536,7 +2536,7 @@ void btm_ble_process_adv_pkt_cont_for_inquiry(
              btm_cb.btm_inq_vars
                  .inq_counter) /* first time seen in this inquiry */
   {
-    p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+    btm_inq_db_update_time_of_resp(p_i);
     btm_cb.btm_inq_vars.inq_cmpl_info.num_resp++;
   }
 
@@ -589,6 +589,7 @@ void btm_ble_resolving_list_load_dev(tBTM_SEC_DEV_REC& dev_rec) {
         .type = dev_rec.ble.AddressType(),
         .bda = dev_rec.bd_addr,
     };
+    btm_sec_cb.UpdateDevRecKeys(&dev_rec);
   }
 
   if (!is_ble_addr_type_known(dev_rec.ble.identity_address_with_type.type)) {
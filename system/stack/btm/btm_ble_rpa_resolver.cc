@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "stack/btm/btm_ble_rpa_resolver.h"
+
+#include <array>
+#include <cstdint>
+
+#include "stack/btm/security_device_record.h"
+#include "stack/include/bt_device_type.h"
+#include "stack/include/btm_sec_api_types.h"
+
+void BleRpaResolver::AddIrk(tBTM_SEC_DEV_REC* p_dev_rec, const Octet16& irk) {
+  Forget(p_dev_rec);
+  entries_.push_back({p_dev_rec, irk, RawAddress::kEmpty});
+  irks_.Add(irk);
+
+  unresolved_.clear();
+  unresolved_order_.clear();
+}
+
+void BleRpaResolver::Forget(const tBTM_SEC_DEV_REC* p_dev_rec) {
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (entries_[i].p_dev_rec == p_dev_rec) {
+      Remove(i);
+      return;
+    }
+  }
+}
+
+void BleRpaResolver::Clear() {
+  irks_.Clear();
+  entries_.clear();
+  resolved_.clear();
+  unresolved_.clear();
+  unresolved_order_.clear();
+}
+
+tBTM_SEC_DEV_REC* BleRpaResolver::Resolve(const RawAddress& rpa) {
+  auto it = resolved_.find(rpa);
+  if (it != resolved_.end()) {
+    size_t index = it->second;
+    if (!IsCurrent(entries_[index])) {
+      Remove(index);
+    } else if (entries_[index].p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) {
+      return entries_[index].p_dev_rec;
+    }
+  }
+
+  if (unresolved_.count(rpa) != 0) return nullptr;
+
+  /* prand is the 3 MSB of the address and hash the 3 LSB */
+  const std::array<uint8_t, 3> prand{rpa.address[2], rpa.address[1],
+                                     rpa.address[0]};
+  const std::array<uint8_t, 3> hash{rpa.address[5], rpa.address[4],
+                                    rpa.address[3]};
+
+  bool skipped = false;
+  size_t index = irks_.Find(prand, hash);
+  while (index < irks_.Size()) {
+    const Entry& entry = entries_[index];
+    if (!IsCurrent(entry)) {
+      /* The last entry took its index and has not been tried yet */
+      Remove(index);
+      index = irks_.Find(prand, hash, index);
+      continue;
+    }
+    if (entry.p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) {
+      RememberResolved(index, rpa);
+      return entry.p_dev_rec;
+    }
+    /* The record may become an LE one, so the address is not remembered as
+     * unresolved */
+    skipped = true;
+    index = irks_.Find(prand, hash, index + 1);
+  }
+
+  if (!skipped) RememberUnresolved(rpa);
+  return nullptr;
+}
+
+bool BleRpaResolver::IsCurrent(const Entry& entry) const {
+  const tBTM_SEC_DEV_REC* p_dev_rec = entry.p_dev_rec;
+  return (p_dev_rec->sec_rec.ble_keys.key_type & BTM_LE_KEY_PID) &&
+         p_dev_rec->sec_rec.ble_keys.irk == entry.irk;
+}
+
+void BleRpaResolver::Remove(size_t index) {
+  if (!entries_[index].rpa.IsEmpty()) resolved_.erase(entries_[index].rpa);
+
+  /* Same as IrkSet::Remove(): the last entry takes the index */
+  size_t last = entries_.size() - 1;
+  entries_[index] = entries_[last];
+  entries_.pop_back();
+  irks_.Remove(index);
+
+  if (index != last && !entries_[index].rpa.IsEmpty()) {
+    resolved_[entries_[index].rpa] = index;
+  }
+}
+
+void BleRpaResolver::RememberResolved(size_t index, const RawAddress& rpa) {
+  Entry& entry = entries_[index];
+  if (!entry.rpa.IsEmpty()) resolved_.erase(entry.rpa);
+
+  /* Another record with the same IRK may have resolved it before */
+  auto it = resolved_.find(rpa);
+  if (it != resolved_.end()) entries_[it->second].rpa = RawAddress::kEmpty;
+
+  entry.rpa = rpa;
+  resolved_[rpa] = index;
+}
+
+void BleRpaResolver::RememberUnresolved(const RawAddress& rpa) {
+  if (unresolved_order_.size() == kMaxUnresolved) {
+    unresolved_.erase(unresolved_order_.front());
+    unresolved_order_.pop_front();
+  }
+  unresolved_.insert(rpa);
+  unresolved_order_.push_back(rpa);
+}
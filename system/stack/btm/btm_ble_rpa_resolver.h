@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "crypto_toolbox/irk_set.h"
+#include "stack/include/bt_octets.h"
+#include "types/raw_address.h"
+
+class tBTM_SEC_DEV_REC;
+
+/* Resolves a Resolvable Private Address against the IRKs of all the bonded
+ * devices at once, instead of running ah() on one security record after the
+ * other.
+ *
+ * The IRK of a record is registered when it is saved. Records are updated in
+ * place throughout the stack, so an entry is checked against its record before
+ * use and dropped once the record no longer has that IRK. Entries are removed
+ * when their record is freed. */
+class BleRpaResolver {
+ public:
+  /* Register |irk| as the IRK of |p_dev_rec|, replacing the previous one */
+  void AddIrk(tBTM_SEC_DEV_REC* p_dev_rec, const Octet16& irk);
+  void Forget(const tBTM_SEC_DEV_REC* p_dev_rec);
+  void Clear();
+
+  /* Return the LE record whose IRK resolves |rpa|, or nullptr. When several
+   * do, the first one registered is returned. */
+  tBTM_SEC_DEV_REC* Resolve(const RawAddress& rpa);
+
+  size_t NumIrks() const { return entries_.size(); }
+
+ private:
+  /* Addresses that no IRK resolves, typically those of the devices around that
+   * are not bonded. They are forgotten whenever an IRK is registered. */
+  static constexpr size_t kMaxUnresolved = 256;
+
+  struct Entry {
+    tBTM_SEC_DEV_REC* p_dev_rec;
+    Octet16 irk;
+    /* The last RPA resolved by |irk|, until the peer rotates it */
+    RawAddress rpa;
+  };
+
+  bool IsCurrent(const Entry& entry) const;
+  void Remove(size_t index);
+  void RememberResolved(size_t index, const RawAddress& rpa);
+  void RememberUnresolved(const RawAddress& rpa);
+
+  /* Key i of |irks_| is the IRK of entries_[i] */
+  crypto_toolbox::IrkSet irks_;
+  std::vector<Entry> entries_;
+  std::unordered_map<RawAddress, size_t> resolved_;
+  std::unordered_set<RawAddress> unresolved_;
+  std::deque<RawAddress> unresolved_order_;
+};
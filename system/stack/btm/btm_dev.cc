@@ -95,6 +95,7 @@ void BTM_SecAddDevice(const RawAddress& bd_addr, DEV_CLASS dev_class,
 
     p_dev_rec->bd_addr = bd_addr;
     p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+    btm_sec_cb.UpdateDevRecKeys(p_dev_rec);
 
     /* use default value for background connection params */
     /* update conn params, use default value for background connection params */
@@ -285,6 +286,7 @@ tBTM_SEC_DEV_REC* btm_sec_alloc_dev(const RawAddress& bd_addr) {
 
   p_dev_rec->ble_hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_LE);
   p_dev_rec->hci_handle = BTM_GetHCIConnHandle(bd_addr, BT_TRANSPORT_BR_EDR);
+  btm_sec_cb.UpdateDevRecKeys(p_dev_rec);
 
   return (p_dev_rec);
 }
@@ -312,9 +314,23 @@ static bool is_handle_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t handle) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  /* Any disconnected record matches the invalid handle, keep the first one */
+  bool indexed = handle != HCI_INVALID_HANDLE;
+  if (indexed) {
+    auto it = btm_sec_cb.dev_rec_by_handle.find(handle);
+    if (it != btm_sec_cb.dev_rec_by_handle.end()) {
+      if (!is_handle_equal(it->second, &handle)) return it->second;
+      btm_sec_cb.dev_rec_by_handle.erase(it);
+    }
+  }
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_handle_equal, &handle);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    if (indexed) btm_sec_cb.dev_rec_by_handle[handle] = p_dev_rec;
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -331,6 +347,25 @@ static bool is_address_equal(void* data, void* context) {
   return true;
 }
 
+/* Resolvable private addresses are not indexed: the first record whose IRK
+ * resolves one must win over a later record holding it as its address, and
+ * resolving it updates the pseudo address of the record. */
+static bool is_address_indexed(const RawAddress& bd_addr) {
+  return !bd_addr.IsEmpty() && !BTM_BLE_IS_RESOLVE_BDA(bd_addr);
+}
+
+static tBTM_SEC_DEV_REC* find_dev_in_index(const RawAddress& bd_addr) {
+  auto it = btm_sec_cb.dev_rec_by_addr.find(bd_addr);
+  if (it == btm_sec_cb.dev_rec_by_addr.end()) return nullptr;
+
+  tBTM_SEC_DEV_REC* p_dev_rec = it->second;
+  if (p_dev_rec->bd_addr == bd_addr || p_dev_rec->ble.pseudo_addr == bd_addr)
+    return p_dev_rec;
+
+  btm_sec_cb.dev_rec_by_addr.erase(it);
+  return nullptr;
+}
+
 /*******************************************************************************
  *
  * Function         btm_find_dev
@@ -344,9 +379,19 @@ static bool is_address_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev(const RawAddress& bd_addr) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  bool indexed = is_address_indexed(bd_addr);
+  if (indexed) {
+    tBTM_SEC_DEV_REC* p_dev_rec = find_dev_in_index(bd_addr);
+    if (p_dev_rec) return p_dev_rec;
+  }
+
   list_node_t* n =
       list_foreach(btm_sec_cb.sec_dev_rec, is_address_equal, (void*)&bd_addr);
-  if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+  if (n) {
+    tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
+    if (indexed) btm_sec_cb.dev_rec_by_addr[bd_addr] = p_dev_rec;
+    return p_dev_rec;
+  }
 
   return NULL;
 }
@@ -371,6 +416,12 @@ static bool has_lenc_and_address_is_equal(void* data, void* context) {
 tBTM_SEC_DEV_REC* btm_find_dev_with_lenc(const RawAddress& bd_addr) {
   if (btm_sec_cb.sec_dev_rec == nullptr) return nullptr;
 
+  if (is_address_indexed(bd_addr)) {
+    tBTM_SEC_DEV_REC* p_dev_rec = find_dev_in_index(bd_addr);
+    if (p_dev_rec && (p_dev_rec->sec_rec.ble_keys.key_type & BTM_LE_KEY_LENC))
+      return p_dev_rec;
+  }
+
   list_node_t* n = list_foreach(btm_sec_cb.sec_dev_rec,
                                 has_lenc_and_address_is_equal, (void*)&bd_addr);
   if (n) return static_cast<tBTM_SEC_DEV_REC*>(list_node(n));
@@ -415,6 +466,7 @@ void btm_consolidate_dev(tBTM_SEC_DEV_REC* p_target_rec) {
       p_target_rec->sec_rec.new_encryption_key_is_p256 =
           temp_rec.sec_rec.new_encryption_key_is_p256;
       p_target_rec->sec_rec.bond_type = temp_rec.sec_rec.bond_type;
+      btm_sec_cb.UpdateDevRecKeys(p_target_rec);
 
       /* remove the combined record */
       wipe_secrets_and_remove(p_dev_rec);
@@ -484,6 +536,7 @@ void btm_dev_consolidate_existing_connections(const RawAddress& bd_addr) {
 
       RawAddress ble_conn_addr = p_dev_rec->bd_addr;
       p_target_rec->ble_hci_handle = p_dev_rec->ble_hci_handle;
+      btm_sec_cb.UpdateDevRecKeys(p_target_rec);
 
       /* remove the old LE record */
       wipe_secrets_and_remove(p_dev_rec);
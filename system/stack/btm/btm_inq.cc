@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <mutex>
 
 #include "advertise_data_parser.h"
@@ -109,6 +110,163 @@ std::mutex inq_db_lock_;
 // Inquiry database
 tINQ_DB_ENT inq_db_[BTM_INQ_DB_SIZE];
 
+// BR/EDR entries are kept in the first half of the inquiry database, LE
+// entries in the second half
+constexpr uint16_t kInqDbHalfSize = BTM_INQ_DB_SIZE / 2;
+constexpr size_t kInqDbHalfWords = (kInqDbHalfSize + 63) / 64;
+
+constexpr size_t inq_db_index_size() {
+  size_t size = 1;
+  while (size < 2 * BTM_INQ_DB_SIZE) size <<= 1;
+  return size;
+}
+
+// Address index and least recently used order of the in use entries of
+// inq_db_, so that inquiry results and advertising reports do not scan the
+// whole database. Entry numbers are stored plus one so that the zero
+// initialized index matches the zero initialized database. Guarded by
+// inq_db_lock_.
+class InqDbIndex {
+ public:
+  int Find(const RawAddress& bda) const {
+    for (size_t slot = Hash(bda);; slot = (slot + 1) & kMask) {
+      if (slots_[slot] == 0) return -1;
+      int entry = slots_[slot] - 1;
+      if (inq_db_[entry].inq_info.results.remote_bd_addr == bda) return entry;
+    }
+  }
+
+  // |entry| must be in use, with its address set
+  void Insert(int entry) {
+    size_t slot = Hash(inq_db_[entry].inq_info.results.remote_bd_addr);
+    while (slots_[slot] != 0) slot = (slot + 1) & kMask;
+    slots_[slot] = entry + 1;
+    SetInUse(entry, true);
+    Link(entry);
+  }
+
+  // Must be called before the address of |entry| is cleared
+  void Remove(int entry) {
+    size_t hole = Hash(inq_db_[entry].inq_info.results.remote_bd_addr);
+    while (slots_[hole] != entry + 1) hole = (hole + 1) & kMask;
+    // Shift back the following entries that are not at their home slot, so
+    // that probing does not stop at the hole
+    for (size_t slot = (hole + 1) & kMask; slots_[slot] != 0;
+         slot = (slot + 1) & kMask) {
+      size_t home =
+          Hash(inq_db_[slots_[slot] - 1].inq_info.results.remote_bd_addr);
+      if (((slot - home) & kMask) >= ((slot - hole) & kMask)) {
+        slots_[hole] = slots_[slot];
+        hole = slot;
+      }
+    }
+    slots_[hole] = 0;
+    SetInUse(entry, false);
+    Unlink(entry);
+  }
+
+  // Mark |entry| as the most recently used of its half, when its time of
+  // response is updated. Lookups alone do not count, so that the least
+  // recently used entry is the one with the oldest time of response.
+  void Touch(int entry) {
+    Unlink(entry);
+    Link(entry);
+  }
+
+  // Lowest free entry of |half|, or -1 if it is full
+  int FirstFree(int half) const {
+    for (size_t word = 0; word < kInqDbHalfWords; word++) {
+      uint64_t free = ~in_use_[half][word];
+      if (free == 0) continue;
+      size_t entry = word * 64 + __builtin_ctzll(free);
+      if (entry >= kInqDbHalfSize) break;
+      return half * kInqDbHalfSize + entry;
+    }
+    return -1;
+  }
+
+  int LeastRecentlyUsed(int half) const { return lru_[half] - 1; }
+
+  void Clear() { *this = {}; }
+
+  // Recompute the index after entries were moved around in inq_db_, with the
+  // least recently used order given by their time of response
+  void Rebuild() {
+    Clear();
+    for (int half = 0; half < 2; half++) {
+      int entries[kInqDbHalfSize];
+      int count = 0;
+      for (int entry = half * kInqDbHalfSize;
+           entry < (half + 1) * kInqDbHalfSize; entry++) {
+        if (inq_db_[entry].in_use) entries[count++] = entry;
+      }
+      std::stable_sort(entries, entries + count, [](int a, int b) {
+        return inq_db_[a].time_of_resp < inq_db_[b].time_of_resp;
+      });
+      for (int i = 0; i < count; i++) Insert(entries[i]);
+    }
+  }
+
+ private:
+  static constexpr size_t kMask = inq_db_index_size() - 1;
+
+  static size_t Hash(const RawAddress& bda) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < RawAddress::kLength; i++) {
+      key = (key << 8) | bda.address[i];
+    }
+    return ((key * 0x9e3779b97f4a7c15ull) >> 32) & kMask;
+  }
+
+  static int HalfOf(int entry) { return entry < kInqDbHalfSize ? 0 : 1; }
+
+  void SetInUse(int entry, bool in_use) {
+    int half = HalfOf(entry);
+    size_t bit = entry - half * kInqDbHalfSize;
+    if (in_use) {
+      in_use_[half][bit / 64] |= 1ull << (bit % 64);
+    } else {
+      in_use_[half][bit / 64] &= ~(1ull << (bit % 64));
+    }
+  }
+
+  // Append |entry| as the most recently used of its half
+  void Link(int entry) {
+    int half = HalfOf(entry);
+    prev_[entry] = mru_[half];
+    next_[entry] = 0;
+    if (mru_[half] != 0) {
+      next_[mru_[half] - 1] = entry + 1;
+    } else {
+      lru_[half] = entry + 1;
+    }
+    mru_[half] = entry + 1;
+  }
+
+  void Unlink(int entry) {
+    int half = HalfOf(entry);
+    if (prev_[entry] != 0) {
+      next_[prev_[entry] - 1] = next_[entry];
+    } else {
+      lru_[half] = next_[entry];
+    }
+    if (next_[entry] != 0) {
+      prev_[next_[entry] - 1] = prev_[entry];
+    } else {
+      mru_[half] = prev_[entry];
+    }
+  }
+
+  uint16_t slots_[inq_db_index_size()] = {};
+  uint16_t prev_[BTM_INQ_DB_SIZE] = {};
+  uint16_t next_[BTM_INQ_DB_SIZE] = {};
+  uint16_t lru_[2] = {};
+  uint16_t mru_[2] = {};
+  uint64_t in_use_[2][kInqDbHalfWords] = {};
+};
+
+InqDbIndex inq_db_index_;
+
 // Inquiry bluetooth device database lock
 std::mutex bd_db_lock_;
 tINQ_BDADDR* p_bd_db_;    /* Pointer to memory that holds bdaddrs */
@@ -1007,8 +1165,10 @@ void btm_clear_all_pending_le_entry(void) {
      * response outstanding */
     if ((p_ent->in_use) &&
         (p_ent->inq_info.results.device_type == BT_DEVICE_TYPE_BLE) &&
-        !p_ent->scan_rsp)
+        !p_ent->scan_rsp) {
+      inq_db_index_.Remove(xx);
       p_ent->in_use = false;
+    }
   }
 }
 
@@ -1106,14 +1266,18 @@ void btm_clr_inq_db(const RawAddress* p_bda) {
                btm_cb.btm_inq_vars.inq_active, btm_cb.btm_inq_vars.state);
 #endif
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use) {
-      /* If this is the specified BD_ADDR or clearing all devices */
-      if (p_bda == NULL || (p_ent->inq_info.results.remote_bd_addr == *p_bda)) {
-        p_ent->in_use = false;
-      }
+  if (p_bda != NULL) {
+    int entry = inq_db_index_.Find(*p_bda);
+    if (entry >= 0) {
+      inq_db_index_.Remove(entry);
+      inq_db_[entry].in_use = false;
+    }
+  } else {
+    tINQ_DB_ENT* p_ent = inq_db_;
+    for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
+      p_ent->in_use = false;
     }
+    inq_db_index_.Clear();
   }
 #if (BTM_INQ_DEBUG == TRUE)
   log::verbose("inq_active:0x{:x} state:{}", btm_cb.btm_inq_vars.inq_active,
@@ -1199,17 +1363,13 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = inq_db_;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda)
-      return (p_ent);
-  }
+  int entry = inq_db_index_.Find(p_bda);
 
   /* If here, not found */
-  return (NULL);
+  if (entry < 0) return (NULL);
+
+  return (&inq_db_[entry]);
 }
 
 /*******************************************************************************
@@ -1224,46 +1384,53 @@ tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble) {
-  uint16_t xx = 0, yy = 0;
-  uint32_t ot = 0xFFFFFFFF;
-  int8_t i_rssi = 0;
-
-  if (is_ble) yy = BTM_INQ_DB_SIZE / 2;
-  else yy = 0;
+  int half = is_ble ? 1 : 0;
 
   std::lock_guard<std::mutex> lock(inq_db_lock_);
-  tINQ_DB_ENT* p_ent = &inq_db_[yy];
-  tINQ_DB_ENT* p_old = &inq_db_[yy];
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE / 2; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
-
-      return (p_ent);
-    }
+  int entry = inq_db_index_.FirstFree(half);
 
+  if (entry < 0) {
+    /* If here, no free entry found. Return the oldest, or the weakest one when
+     * inquiring by RSSI. */
+    entry = inq_db_index_.LeastRecentlyUsed(half);
     if (is_inquery_by_rssi()) {
-      if (p_ent->inq_info.results.rssi < i_rssi) {
-        p_old = p_ent;
-        i_rssi = p_ent->inq_info.results.rssi;
-      }
-    } else {
-      if (p_ent->time_of_resp < ot) {
-        p_old = p_ent;
-        ot = p_ent->time_of_resp;
+      int8_t i_rssi = 0;
+      entry = half * kInqDbHalfSize;
+      for (int xx = half * kInqDbHalfSize; xx < (half + 1) * kInqDbHalfSize;
+           xx++) {
+        if (inq_db_[xx].inq_info.results.rssi < i_rssi) {
+          entry = xx;
+          i_rssi = inq_db_[xx].inq_info.results.rssi;
+        }
       }
     }
+    inq_db_index_.Remove(entry);
   }
 
-  /* If here, no free entry found. Return the oldest. */
+  tINQ_DB_ENT* p_ent = &inq_db_[entry];
+  memset(p_ent, 0, sizeof(tINQ_DB_ENT));
+  p_ent->inq_info.results.remote_bd_addr = p_bda;
+  p_ent->in_use = true;
+  inq_db_index_.Insert(entry);
 
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
+  return (p_ent);
+}
 
-  return (p_old);
+/*******************************************************************************
+ *
+ * Function         btm_inq_db_update_time_of_resp
+ *
+ * Description      This function records that a response was just received
+ *                  for an entry of the inquiry database, which makes it the
+ *                  last one of its half to be reused by btm_inq_db_new().
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_inq_db_update_time_of_resp(tINQ_DB_ENT* p_ent) {
+  std::lock_guard<std::mutex> lock(inq_db_lock_);
+  p_ent->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+  inq_db_index_.Touch(p_ent - inq_db_);
 }
 
 /*******************************************************************************
@@ -1348,7 +1515,7 @@ static void btm_process_inq_results_standard(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_update_time_of_resp(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1496,7 +1663,7 @@ static void btm_process_inq_results_rssi(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_update_time_of_resp(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1646,7 +1813,7 @@ static void btm_process_inq_results_extended(bluetooth::hci::EventView event) {
       p_cur->dev_class[2] = dc[2];
       p_cur->clock_offset = clock_offset | BTM_CLOCK_OFFSET_VALID;
 
-      p_i->time_of_resp = bluetooth::common::time_get_os_boottime_ms();
+      btm_inq_db_update_time_of_resp(p_i);
 
       if (p_i->inq_count != btm_cb.btm_inq_vars.inq_counter) {
         /* A new response was found */
@@ -1735,6 +1902,7 @@ void btm_sort_inq_result(void) {
   }
 
   osi_free(p_tmp);
+  inq_db_index_.Rebuild();
 }
 
 /*******************************************************************************
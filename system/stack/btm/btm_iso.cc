@@ -15,10 +15,12 @@
  * limitations under the License.
  */
 
+#include <cstring>
 #include <memory>
 
 #include "btm_iso_api.h"
 #include "btm_iso_impl.h"
+#include "osi/include/allocator.h"
 #include "stack/include/bt_hdr.h"
 
 using bluetooth::hci::iso_manager::BigCallbacks;
@@ -29,6 +31,21 @@ using bluetooth::hci::iso_manager::iso_impl;
 namespace bluetooth {
 namespace hci {
 
+namespace iso_manager {
+
+BT_HDR* AllocateIsoSdu(const uint8_t* data, uint16_t data_len) {
+  BT_HDR* sdu = static_cast<BT_HDR*>(
+      osi_pool_malloc(sizeof(BT_HDR) + kIsoSduHeadroom + data_len));
+  sdu->event = 0;
+  sdu->len = data_len;
+  sdu->offset = kIsoSduHeadroom;
+  sdu->layer_specific = 0;
+  memcpy(sdu->data + sdu->offset, data, data_len);
+  return sdu;
+}
+
+}  // namespace iso_manager
+
 struct IsoManager::impl {
   impl(const IsoManager& iso_manager) : iso_manager_(iso_manager) {}
 
@@ -113,6 +130,10 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->iso_impl_->send_iso_data(iso_handle, data, data_len);
 }
 
+void IsoManager::SendIsoSdu(uint16_t iso_handle, BT_HDR* sdu) {
+  pimpl_->iso_impl_->send_iso_sdu(iso_handle, sdu);
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   pimpl_->iso_impl_->create_big(big_id, std::move(big_params));
@@ -17,10 +17,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <list>
-#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "base/functional/bind.h"
 #include "base/functional/callback.h"
@@ -47,6 +49,7 @@ namespace hci {
 namespace iso_manager {
 static constexpr uint8_t kIsoHeaderWithTsLen = 12;
 static constexpr uint8_t kIsoHeaderWithoutTsLen = 8;
+static_assert(kIsoSduHeadroom >= kIsoHeaderWithoutTsLen);
 
 static constexpr uint8_t kStateFlagsNone = 0x00;
 static constexpr uint8_t kStateFlagIsConnecting = 0x01;
@@ -90,6 +93,64 @@ struct iso_base {
 typedef iso_base iso_cis;
 typedef iso_base iso_bis;
 
+/* Map from ISO connection handles, kept as a vector sorted by handle. There
+ * are only a few CISes or BISes at a time, so a binary search over contiguous
+ * memory is cheaper than walking a tree on every SDU sent or received.
+ */
+template <typename T>
+class iso_handle_map {
+ public:
+  using value_type = std::pair<uint16_t, T>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.cbegin(); }
+  const_iterator end() const { return entries_.cend(); }
+  const_iterator cbegin() const { return entries_.cbegin(); }
+  const_iterator cend() const { return entries_.cend(); }
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  iterator find(uint16_t handle) {
+    auto it = lower_bound(handle);
+    return (it != entries_.end() && it->first == handle) ? it : entries_.end();
+  }
+
+  const_iterator find(uint16_t handle) const {
+    return const_cast<iso_handle_map*>(this)->find(handle);
+  }
+
+  T& operator[](uint16_t handle) {
+    auto it = lower_bound(handle);
+    if (it == entries_.end() || it->first != handle) {
+      it = entries_.emplace(it, handle, T());
+    }
+    return it->second;
+  }
+
+  iterator erase(const_iterator it) { return entries_.erase(it); }
+
+  size_t erase(uint16_t handle) {
+    auto it = find(handle);
+    if (it == entries_.end()) return 0;
+    entries_.erase(it);
+    return 1;
+  }
+
+  void clear() { entries_.clear(); }
+
+ private:
+  iterator lower_bound(uint16_t handle) {
+    return std::lower_bound(
+        entries_.begin(), entries_.end(), handle,
+        [](const value_type& entry, uint16_t h) { return entry.first < h; });
+  }
+
+  std::vector<value_type> entries_;
+};
+
 struct iso_impl {
   iso_impl() {
     iso_credits_ = shim::GetController()
@@ -542,8 +603,11 @@ struct iso_impl {
     return packet;
   }
 
-  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
-                     uint16_t data_len) {
+  /* Checks that an SDU of |data_len| bytes can be sent on |iso_handle| now and
+   * takes a controller buffer for it. Returns false if it has to be dropped.
+   */
+  bool reserve_iso_sdu(uint16_t iso_handle, uint16_t data_len,
+                       uint16_t* seq_nb) {
     iso_base* iso = GetIsoIfKnown(iso_handle);
     log::assert_that(iso != nullptr, "No such iso connection handle: {}",
                      loghex(iso_handle));
@@ -551,20 +615,20 @@ struct iso_impl {
     if (!(iso->state_flags & kStateFlagIsBroadcast)) {
       if (!(iso->state_flags & kStateFlagIsConnected)) {
         log::warn("Cis handle: 0x{:x} not established", iso_handle);
-        return;
+        return false;
       }
     }
 
     if (!(iso->state_flags & kStateFlagHasDataPathSet)) {
       log::warn("Data path not set for handle: 0x{:04x}", iso_handle);
-      return;
+      return false;
     }
 
     /* Calculate sequence number for the ISO data packet.
      * It should be incremented by 1 every SDU Interval.
      */
-    uint16_t seq_nb = iso->sync_info.seq_nb;
-    iso->sync_info.seq_nb = (seq_nb + 1) & 0xffff;
+    *seq_nb = iso->sync_info.seq_nb;
+    iso->sync_info.seq_nb = (*seq_nb + 1) & 0xffff;
 
     if (iso_credits_ == 0 || data_len > iso_buffer_size_) {
       iso->cr_stats.credits_underflow_bytes += data_len;
@@ -576,11 +640,18 @@ struct iso_impl {
           ", dropping ISO packet, len: {}, iso credits: {}, iso handle: 0x{:x}",
           static_cast<int>(data_len), static_cast<int>(iso_credits_),
           iso_handle);
-      return;
+      return false;
     }
 
     iso_credits_--;
     iso->used_credits++;
+    return true;
+  }
+
+  void send_iso_data(uint16_t iso_handle, const uint8_t* data,
+                     uint16_t data_len) {
+    uint16_t seq_nb;
+    if (!reserve_iso_sdu(iso_handle, data_len, &seq_nb)) return;
 
     BT_HDR* packet = prepare_hci_packet(iso_handle, seq_nb, data_len);
     memcpy(packet->data + kIsoHeaderWithoutTsLen, data, data_len);
@@ -589,6 +660,33 @@ struct iso_impl {
     hci->transmit_downward(packet, iso_buffer_size_);
   }
 
+  void send_iso_sdu(uint16_t iso_handle, BT_HDR* sdu) {
+    log::assert_that(sdu->offset >= kIsoHeaderWithoutTsLen,
+                     "No room for the ISO header, offset: {}", sdu->offset);
+
+    uint16_t seq_nb;
+    if (!reserve_iso_sdu(iso_handle, sdu->len, &seq_nb)) {
+      osi_free(sdu);
+      return;
+    }
+
+    /* Same header as prepare_hci_packet(), written in front of the payload */
+    uint16_t data_len = sdu->len;
+    sdu->offset -= kIsoHeaderWithoutTsLen;
+    sdu->len += kIsoHeaderWithoutTsLen;
+    sdu->layer_specific = 0;
+    sdu->event = MSG_STACK_TO_HC_HCI_ISO | 0x0001;
+
+    uint8_t* p = sdu->data + sdu->offset;
+    UINT16_TO_STREAM(p, iso_handle);
+    UINT16_TO_STREAM(p, data_len + 4);
+    UINT16_TO_STREAM(p, seq_nb);
+    UINT16_TO_STREAM(p, data_len);
+
+    auto hci = bluetooth::shim::hci_layer_get_interface();
+    hci->transmit_downward(sdu, iso_buffer_size_);
+  }
+
   void process_cis_est_pkt(uint8_t len, uint8_t* data) {
     cis_establish_cmpl_evt evt;
 
@@ -974,9 +1072,9 @@ struct iso_impl {
     dprintf(fd, "  ----------------\n ");
   }
 
-  std::map<uint16_t, std::unique_ptr<iso_cis>> conn_hdl_to_cis_map_;
-  std::map<uint16_t, std::unique_ptr<iso_bis>> conn_hdl_to_bis_map_;
-  std::map<uint16_t, RawAddress> cis_hdl_to_addr;
+  iso_handle_map<std::unique_ptr<iso_cis>> conn_hdl_to_cis_map_;
+  iso_handle_map<std::unique_ptr<iso_bis>> conn_hdl_to_bis_map_;
+  iso_handle_map<RawAddress> cis_hdl_to_addr;
 
   std::atomic_uint16_t iso_credits_;
   uint16_t iso_buffer_size_;
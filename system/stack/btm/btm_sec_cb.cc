@@ -54,6 +54,7 @@ void tBTM_SEC_CB::Init(uint8_t initial_security_mode) {
   security_mode = initial_security_mode;
   pairing_bda = RawAddress::kAny;
   sec_dev_rec = list_new([](void* ptr) {
+    btm_sec_cb.ForgetDevRec(static_cast<tBTM_SEC_DEV_REC*>(ptr));
     // Invoke destructor for all record objects and reset to default
     // initialized value so memory may be properly freed
     *((tBTM_SEC_DEV_REC*)ptr) = {};
@@ -65,6 +66,11 @@ void tBTM_SEC_CB::Free() {
   fixed_queue_free(sec_pending_q, nullptr);
   sec_pending_q = nullptr;
 
+  // Cleared first so that freeing each record does not sweep them
+  dev_rec_by_addr.clear();
+  dev_rec_by_identity_addr.clear();
+  dev_rec_by_handle.clear();
+  rpa_resolver.Clear();
   list_free(sec_dev_rec);
   sec_dev_rec = nullptr;
 
@@ -194,6 +200,38 @@ bool tBTM_SEC_CB::IsLinkKeyKnown(const RawAddress bd_addr,
   return false;
 }
 
+template <typename Key>
+static void forget_dev_rec(std::unordered_map<Key, tBTM_SEC_DEV_REC*>& index,
+                           const tBTM_SEC_DEV_REC* p_dev_rec) {
+  for (auto it = index.begin(); it != index.end();) {
+    if (it->second == p_dev_rec) {
+      it = index.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/* Records are only freed on unbond, consolidation or when the list is full, so
+ * sweeping the indexes is cheaper than tracking every key a record had */
+void tBTM_SEC_CB::ForgetDevRec(const tBTM_SEC_DEV_REC* p_dev_rec) {
+  forget_dev_rec(dev_rec_by_addr, p_dev_rec);
+  forget_dev_rec(dev_rec_by_identity_addr, p_dev_rec);
+  forget_dev_rec(dev_rec_by_handle, p_dev_rec);
+  rpa_resolver.Forget(p_dev_rec);
+}
+
+/* Must be called after the address, pseudo address, identity address or a
+ * handle of |p_dev_rec| is written: an entry of the new key may be on a later
+ * record, and |p_dev_rec| now has to win over it */
+void tBTM_SEC_CB::UpdateDevRecKeys(const tBTM_SEC_DEV_REC* p_dev_rec) {
+  dev_rec_by_addr.erase(p_dev_rec->bd_addr);
+  dev_rec_by_addr.erase(p_dev_rec->ble.pseudo_addr);
+  dev_rec_by_identity_addr.erase(p_dev_rec->ble.identity_address_with_type.bda);
+  dev_rec_by_handle.erase(p_dev_rec->hci_handle);
+  dev_rec_by_handle.erase(p_dev_rec->ble_hci_handle);
+}
+
 bool tBTM_SEC_CB::IsDeviceBonded(const RawAddress bd_addr) {
   tBTM_SEC_DEV_REC* p_dev_rec = btm_find_dev(bd_addr);
   bool is_bonded = false;
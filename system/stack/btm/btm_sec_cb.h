@@ -18,11 +18,13 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
 
 #include "internal_include/bt_target.h"
 #include "osi/include/alarm.h"
 #include "osi/include/fixed_queue.h"
 #include "osi/include/list.h"
+#include "stack/btm/btm_ble_rpa_resolver.h"
 #include "stack/btm/btm_sec_int_types.h"
 #include "stack/btm/security_device_record.h"
 #include "stack/include/bt_octets.h"
@@ -68,6 +70,21 @@ class tBTM_SEC_CB {
   alarm_t* pairing_timer{nullptr};        /* Timer for pairing process    */
   alarm_t* execution_wait_timer{nullptr}; /* To avoid concurrent auth request */
   list_t* sec_dev_rec{nullptr}; /* list of tBTM_SEC_DEV_REC */
+
+  /* Where btm_find_dev() and friends last found a record, by address, LE
+   * identity address and ACL handle. Records are updated in place throughout
+   * the stack, so an entry is only a hint that is checked against the record
+   * before use. Entries are dropped when their record is freed, and those of
+   * a key when it is written to a record by UpdateDevRecKeys(): records are
+   * never reordered, so that keeps every entry on the first matching record,
+   * as the list walk would return. */
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> dev_rec_by_addr;
+  std::unordered_map<RawAddress, tBTM_SEC_DEV_REC*> dev_rec_by_identity_addr;
+  std::unordered_map<uint16_t, tBTM_SEC_DEV_REC*> dev_rec_by_handle;
+
+  /* IRKs of the records, to resolve RPAs without walking |sec_dev_rec| */
+  BleRpaResolver rpa_resolver;
+
   tBTM_SEC_SERV_REC* p_out_serv{nullptr};
   tBTM_MKEY_CALLBACK* mkey_cback{nullptr};
 
@@ -95,6 +112,9 @@ class tBTM_SEC_CB {
 
   tBTM_SEC_REC* getSecRec(const RawAddress bd_addr);
 
+  void ForgetDevRec(const tBTM_SEC_DEV_REC* p_dev_rec);
+  void UpdateDevRecKeys(const tBTM_SEC_DEV_REC* p_dev_rec);
+
   bool AddService(bool is_originator, const char* p_name, uint8_t service_id,
                   uint16_t sec_level, uint16_t psm, uint32_t mx_proto_id,
                   uint32_t mx_chan_id);
@@ -140,9 +140,11 @@ static void gatt_update_last_srv_info() {
   }
 }
 
-/** Update database hash and client status */
+/** Invalidate database hash and update client status */
 static void gatt_update_for_database_change() {
-  gatt_cb.database_hash = gatts_calculate_database_hash(gatt_cb.srv_list_info);
+  /* The hash is recomputed when it is needed next, so registering several
+   * services in a row only pays for it once */
+  gatt_cb.database_hash_stale = true;
 
   uint8_t i = 0;
   for (i = 0; i < GATT_MAX_PHY_CHANNEL; i++) {
@@ -341,6 +343,7 @@ tGATT_STATUS GATTS_AddService(tGATT_IF gatt_if, btgatt_db_element_t* service,
     elem.sdp_handle = 0;
   }
 
+  gatt_sr_rebuild_index();
   gatt_update_last_srv_info();
 
   log::verbose(
@@ -443,6 +446,7 @@ void GATTS_StopService(uint16_t service_handle) {
   }
 
   gatt_cb.srv_list_info->erase(it);
+  gatt_sr_rebuild_index();
   gatt_update_last_srv_info();
 }
 /*******************************************************************************
@@ -25,6 +25,8 @@
 #include <bluetooth/log.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "gatt_int.h"
 #include "l2c_api.h"
 #include "osi/include/osi.h"
@@ -261,12 +263,12 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
  *
  * Description      Query attribute value by attribute type.
  *
- * Parameter        p_db: pointer to the attribute database.
+ * Parameter        postings: all attributes of the requested type, sorted by
+ *                            handle (see gatt_sr_find_attr_postings()).
  *                  p_rsp: Read By type response data.
  *                  s_handle: starting handle of the range we are looking for.
  *                  e_handle: ending handle of the range we are looking for.
- *                  type: Attribute type.
- *                  mtu: MTU.
+ *                  p_len: remaining space in the response.
  *                  sec_flag: current link security status.
  *                  key_size: encryption key size.
  *
@@ -274,49 +276,56 @@ static tGATT_STATUS read_attr_value(tGATT_ATTR& attr16, uint16_t offset,
  *
  ******************************************************************************/
 tGATT_STATUS gatts_db_read_attr_value_by_type(
-    tGATT_TCB& tcb, uint16_t cid, tGATT_SVC_DB* p_db, uint8_t op_code,
-    BT_HDR* p_rsp, uint16_t s_handle, uint16_t /* e_handle */, const Uuid& type,
-    uint16_t* p_len, tGATT_SEC_FLAG sec_flag, uint8_t key_size,
-    uint32_t trans_id, uint16_t* p_cur_handle) {
+    tGATT_TCB& tcb, uint16_t cid,
+    const std::vector<tGATT_ATTR_POSTING>& postings, uint8_t op_code,
+    BT_HDR* p_rsp, uint16_t s_handle, uint16_t e_handle, uint16_t* p_len,
+    tGATT_SEC_FLAG sec_flag, uint8_t key_size, uint32_t trans_id,
+    uint16_t* p_cur_handle) {
   tGATT_STATUS status = GATT_NOT_FOUND;
   uint16_t len = 0;
   uint8_t* p = (uint8_t*)(p_rsp + 1) + p_rsp->len + L2CAP_MIN_OFFSET;
 
-  if (p_db) {
-    for (tGATT_ATTR& attr : p_db->attr_list) {
-      if (attr.handle >= s_handle && type == attr.uuid) {
-        if (*p_len <= 2) {
-          status = GATT_NO_RESOURCES;
-          break;
-        }
+  auto it = std::lower_bound(
+      postings.begin(), postings.end(), s_handle,
+      [](const tGATT_ATTR_POSTING& posting, uint16_t handle) {
+        return posting.handle < handle;
+      });
 
-        UINT16_TO_STREAM(p, attr.handle);
+  /* Every attribute of a service overlapping the requested range is
+   * eligible, including those of the last service past |e_handle|. */
+  for (; it != postings.end() && it->p_el->s_hdl <= e_handle; it++) {
+    tGATT_ATTR& attr = *it->p_attr;
 
-        status = read_attr_value(attr, 0, &p, false, (uint16_t)(*p_len - 2),
-                                 &len, sec_flag, key_size);
+    if (*p_len <= 2) {
+      status = GATT_NO_RESOURCES;
+      break;
+    }
 
-        if (status == GATT_PENDING) {
-          status = gatts_send_app_read_request(tcb, cid, op_code, attr.handle,
-                                               0, trans_id, attr.gatt_type);
+    UINT16_TO_STREAM(p, attr.handle);
 
-          /* one callback at a time */
-          break;
-        } else if (status == GATT_SUCCESS) {
-          if (p_rsp->offset == 0) p_rsp->offset = len + 2;
-
-          if (p_rsp->offset == len + 2) {
-            p_rsp->len += (len + 2);
-            *p_len -= (len + 2);
-          } else {
-            log::error("format mismatch");
-            status = GATT_NO_RESOURCES;
-            break;
-          }
-        } else {
-          *p_cur_handle = attr.handle;
-          break;
-        }
+    status = read_attr_value(attr, 0, &p, false, (uint16_t)(*p_len - 2), &len,
+                             sec_flag, key_size);
+
+    if (status == GATT_PENDING) {
+      status = gatts_send_app_read_request(tcb, cid, op_code, attr.handle, 0,
+                                           trans_id, attr.gatt_type);
+
+      /* one callback at a time */
+      break;
+    } else if (status == GATT_SUCCESS) {
+      if (p_rsp->offset == 0) p_rsp->offset = len + 2;
+
+      if (p_rsp->offset == len + 2) {
+        p_rsp->len += (len + 2);
+        *p_len -= (len + 2);
+      } else {
+        log::error("format mismatch");
+        status = GATT_NO_RESOURCES;
+        break;
       }
+    } else {
+      *p_cur_handle = attr.handle;
+      break;
     }
   }
 
@@ -444,12 +453,14 @@ uint16_t gatts_add_char_descr(tGATT_SVC_DB& db, tGATT_PERM perm,
 tGATT_ATTR* find_attr_by_handle(tGATT_SVC_DB* p_db, uint16_t handle) {
   if (!p_db) return nullptr;
 
-  for (auto& attr : p_db->attr_list) {
-    if (attr.handle == handle) return &attr;
-    if (attr.handle > handle) return nullptr;
-  }
+  /* attr_list is sorted by handle */
+  auto it = std::lower_bound(p_db->attr_list.begin(), p_db->attr_list.end(),
+                             handle, [](const tGATT_ATTR& attr, uint16_t h) {
+                               return attr.handle < h;
+                             });
+  if (it == p_db->attr_list.end() || it->handle != handle) return nullptr;
 
-  return nullptr;
+  return &*it;
 }
 
 /*******************************************************************************
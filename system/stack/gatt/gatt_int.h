@@ -29,6 +29,7 @@
 
 #include <deque>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -186,6 +187,9 @@ typedef struct {
   std::vector<tGATT_ATTR> attr_list; /* pointer to the attributes */
   uint16_t end_handle;       /* Last handle number           */
   uint16_t next_handle;      /* Next usable handle value     */
+  /* Database Hash input of this service, byte reversed. Built on first use
+   * by gatts_calculate_database_hash(). */
+  std::vector<uint8_t> hash_segment;
 } tGATT_SVC_DB;
 
 /* Data Structure used for GATT server */
@@ -294,6 +298,23 @@ typedef struct {
   bool is_primary;
 } tGATT_SRV_LIST_ELEM;
 
+/* Entry of the handle range index over the started services, which is sorted
+ * by start handle. Services never overlap, so a handle belongs to at most one
+ * entry. */
+typedef struct {
+  uint16_t s_hdl;
+  uint16_t e_hdl;
+  std::list<tGATT_SRV_LIST_ELEM>::iterator it;
+} tGATT_SRV_INDEX_ELEM;
+
+/* Attribute of a started service, as listed in the per attribute type
+ * postings. Postings are sorted by attribute handle. */
+typedef struct {
+  uint16_t handle;
+  tGATT_ATTR* p_attr;
+  tGATT_SRV_LIST_ELEM* p_el;
+} tGATT_ATTR_POSTING;
+
 typedef struct {
   std::deque<tGATT_CLCB*> pending_enc_clcb; /* pending encryption channel q */
   tGATT_SEC_ACTION sec_act;
@@ -418,6 +439,16 @@ typedef struct {
   std::list<tGATT_HDL_LIST_ELEM>* hdl_list_info;
   std::list<tGATT_SRV_LIST_ELEM>* srv_list_info;
 
+  /* Lookup structures derived from srv_list_info. They are rebuilt by
+   * gatt_sr_rebuild_index() whenever a service is started or stopped. */
+  std::vector<tGATT_SRV_INDEX_ELEM> srv_index;
+  /* attribute type -> attributes of that type */
+  std::unordered_map<bluetooth::Uuid, std::vector<tGATT_ATTR_POSTING>>
+      attr_type_index;
+  /* service UUID -> primary services with that UUID, sorted by start handle */
+  std::unordered_map<bluetooth::Uuid, std::vector<tGATT_SRV_LIST_ELEM*>>
+      pri_srv_index;
+
   fixed_queue_t* srv_chg_clt_q; /* service change clients queue */
   tGATT_REG cl_rcb[GATT_MAX_APPS];
 
@@ -452,6 +483,7 @@ typedef struct {
 
   uint16_t handle_of_database_hash;
   Octet16 database_hash;
+  bool database_hash_stale; /* database_hash must be recomputed before use */
 
   tGATT_APPL_INFO cb_info;
 
@@ -573,6 +605,13 @@ bool gatt_auto_connect_dev_remove(tGATT_IF gatt_if, const RawAddress& bd_addr);
 /* server function */
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle);
+void gatt_sr_rebuild_index();
+std::vector<tGATT_SRV_INDEX_ELEM>::const_iterator gatt_sr_find_first_srv_index(
+    uint16_t s_hdl);
+const std::vector<tGATT_ATTR_POSTING>* gatt_sr_find_attr_postings(
+    const bluetooth::Uuid& type);
+const std::vector<tGATT_SRV_LIST_ELEM*>* gatt_sr_find_pri_srv_postings(
+    const bluetooth::Uuid& svc_uuid);
 tGATT_STATUS gatt_sr_process_app_rsp(tGATT_TCB& tcb, tGATT_IF gatt_if,
                                      uint32_t trans_id, uint8_t op_code,
                                      tGATT_STATUS status, tGATTS_RSP* p_msg,
@@ -676,10 +715,11 @@ uint16_t gatts_add_char_ext_prop_descr(tGATT_SVC_DB& db,
 uint16_t gatts_add_char_descr(tGATT_SVC_DB& db, tGATT_PERM perm,
                               const bluetooth::Uuid& dscp_uuid);
 tGATT_STATUS gatts_db_read_attr_value_by_type(
-    tGATT_TCB& tcb, uint16_t cid, tGATT_SVC_DB* p_db, uint8_t op_code,
-    BT_HDR* p_rsp, uint16_t s_handle, uint16_t e_handle,
-    const bluetooth::Uuid& type, uint16_t* p_len, tGATT_SEC_FLAG sec_flag,
-    uint8_t key_size, uint32_t trans_id, uint16_t* p_cur_handle);
+    tGATT_TCB& tcb, uint16_t cid,
+    const std::vector<tGATT_ATTR_POSTING>& postings, uint8_t op_code,
+    BT_HDR* p_rsp, uint16_t s_handle, uint16_t e_handle, uint16_t* p_len,
+    tGATT_SEC_FLAG sec_flag, uint8_t key_size, uint32_t trans_id,
+    uint16_t* p_cur_handle);
 tGATT_STATUS gatts_read_attr_value_by_handle(
     tGATT_TCB& tcb, uint16_t cid, tGATT_SVC_DB* p_db, uint8_t op_code,
     uint16_t handle, uint16_t offset, uint8_t* p_value, uint16_t* p_len,
@@ -697,6 +737,7 @@ bluetooth::Uuid* gatts_get_service_uuid(tGATT_SVC_DB* p_db);
 
 /* gatt_sr_hash.cc */
 Octet16 gatts_calculate_database_hash(std::list<tGATT_SRV_LIST_ELEM>* lst_ptr);
+const Octet16& gatts_get_database_hash();
 
 namespace fmt {
 template <>
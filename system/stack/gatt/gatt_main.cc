@@ -199,6 +199,7 @@ void gatt_free(void) {
   gatt_cb.srv_list_info->clear();
   delete gatt_cb.srv_list_info;
   gatt_cb.srv_list_info = nullptr;
+  gatt_sr_rebuild_index();
 
   EattExtension::GetInstance()->Stop();
 }
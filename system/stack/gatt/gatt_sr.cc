@@ -567,14 +567,10 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
   uint16_t payload_size = gatt_tcb_get_payload_size(tcb, cid);
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl < s_hdl || el.s_hdl > e_hdl ||
-        el.type != GATT_UUID_PRI_SERVICE) {
-      continue;
-    }
-
+  /* Returns false once the response is full */
+  auto add_service = [&](tGATT_SRV_LIST_ELEM& el) -> bool {
     Uuid* p_uuid = gatts_get_service_uuid(el.p_db);
-    if (!p_uuid) continue;
+    if (!p_uuid) return true;
 
     if (op_code == GATT_REQ_READ_BY_GRP_TYPE)
       handle_len = 4 + gatt_build_uuid_to_stream_len(*p_uuid);
@@ -593,11 +589,9 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
     if (p_msg->len + p_msg->offset > payload_size ||
         handle_len != p_msg->offset) {
-      break;
+      return false;
     }
 
-    if (op_code == GATT_REQ_FIND_TYPE_VALUE && value != *p_uuid) continue;
-
     UINT16_TO_STREAM(p, el.s_hdl);
 
     if (gatt_cb.last_service_handle &&
@@ -614,6 +608,27 @@ static tGATT_STATUS gatt_build_primary_service_rsp(
 
     status = GATT_SUCCESS;
     p_msg->len += p_msg->offset;
+    return true;
+  };
+
+  if (op_code == GATT_REQ_FIND_TYPE_VALUE) {
+    /* only the primary services with the requested UUID can match */
+    const std::vector<tGATT_SRV_LIST_ELEM*>* p_services =
+        gatt_sr_find_pri_srv_postings(value);
+    if (p_services) {
+      for (tGATT_SRV_LIST_ELEM* p_el : *p_services) {
+        if (p_el->s_hdl < s_hdl) continue;
+        if (p_el->s_hdl > e_hdl || !add_service(*p_el)) break;
+      }
+    }
+  } else {
+    for (auto it = gatt_sr_find_first_srv_index(s_hdl);
+         it != gatt_cb.srv_index.cend() && it->s_hdl <= e_hdl; it++) {
+      if (it->s_hdl < s_hdl || it->it->type != GATT_UUID_PRI_SERVICE) {
+        continue;
+      }
+      if (!add_service(*it->it)) break;
+    }
   }
   p_msg->offset = L2CAP_MIN_OFFSET;
 
@@ -818,13 +833,12 @@ static void gatts_process_find_info(tGATT_TCB& tcb, uint16_t cid,
 
   buf_len = payload_size - 2;
 
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      reason = gatt_build_find_info_rsp(el, p_msg, buf_len, s_hdl, e_hdl);
-      if (reason == GATT_NO_RESOURCES) {
-        reason = GATT_SUCCESS;
-        break;
-      }
+  for (auto it = gatt_sr_find_first_srv_index(s_hdl);
+       it != gatt_cb.srv_index.cend() && it->s_hdl <= e_hdl; it++) {
+    reason = gatt_build_find_info_rsp(*it->it, p_msg, buf_len, s_hdl, e_hdl);
+    if (reason == GATT_NO_RESOURCES) {
+      reason = GATT_SUCCESS;
+      break;
     }
   }
 
@@ -962,24 +976,23 @@ static void gatts_process_read_by_type_req(tGATT_TCB& tcb, uint16_t cid,
   uint16_t buf_len = payload_size - 2;
 
   reason = GATT_NOT_FOUND;
-  for (tGATT_SRV_LIST_ELEM& el : *gatt_cb.srv_list_info) {
-    if (el.s_hdl <= e_hdl && el.e_hdl >= s_hdl) {
-      tGATT_SEC_FLAG sec_flag;
-      uint8_t key_size;
-      gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
-
-      tGATT_STATUS ret = gatts_db_read_attr_value_by_type(
-          tcb, cid, el.p_db, op_code, p_msg, s_hdl, e_hdl, uuid, &buf_len,
-          sec_flag, key_size, 0, &err_hdl);
-      if (ret != GATT_NOT_FOUND) {
-        reason = ret;
-        if (ret == GATT_NO_RESOURCES) reason = GATT_SUCCESS;
-      }
+  const std::vector<tGATT_ATTR_POSTING>* p_postings =
+      gatt_sr_find_attr_postings(uuid);
+  if (p_postings) {
+    tGATT_SEC_FLAG sec_flag;
+    uint8_t key_size;
+    gatt_sr_get_sec_info(tcb.peer_bda, tcb.transport, &sec_flag, &key_size);
+
+    tGATT_STATUS ret = gatts_db_read_attr_value_by_type(
+        tcb, cid, *p_postings, op_code, p_msg, s_hdl, e_hdl, &buf_len,
+        sec_flag, key_size, 0, &err_hdl);
+    if (ret != GATT_NOT_FOUND) {
+      reason = ret;
+      if (ret == GATT_NO_RESOURCES) reason = GATT_SUCCESS;
+    }
 
-      if (ret != GATT_SUCCESS && ret != GATT_NOT_FOUND) {
-        s_hdl = err_hdl;
-        break;
-      }
+    if (ret != GATT_SUCCESS && ret != GATT_NOT_FOUND) {
+      s_hdl = err_hdl;
     }
   }
   *p = (uint8_t)p_msg->offset;
@@ -1185,31 +1198,31 @@ void gatts_process_attribute_req(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code,
 #endif
 
   if (GATT_HANDLE_IS_VALID(handle)) {
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        for (const auto& attr : el.p_db->attr_list) {
-          if (attr.handle == handle) {
-            switch (op_code) {
-              case GATT_REQ_READ: /* read char/char descriptor value */
-              case GATT_REQ_READ_BLOB:
-                gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
-                break;
-
-              case GATT_REQ_WRITE: /* write char/char descriptor value */
-              case GATT_CMD_WRITE:
-              case GATT_SIGN_CMD_WRITE:
-              case GATT_REQ_PREPARE_WRITE:
-                gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
-                                        attr.gatt_type);
-                break;
-              default:
-                break;
-            }
-            status = GATT_SUCCESS;
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    if (it != gatt_cb.srv_list_info->end() && it->p_db) {
+      tGATT_SRV_LIST_ELEM& el = *it;
+      auto& attr_list = el.p_db->attr_list;
+      auto attr = std::lower_bound(
+          attr_list.begin(), attr_list.end(), handle,
+          [](const tGATT_ATTR& a, uint16_t h) { return a.handle < h; });
+      if (attr != attr_list.end() && attr->handle == handle) {
+        switch (op_code) {
+          case GATT_REQ_READ: /* read char/char descriptor value */
+          case GATT_REQ_READ_BLOB:
+            gatts_process_read_req(tcb, cid, el, op_code, handle, len, p);
+            break;
+
+          case GATT_REQ_WRITE: /* write char/char descriptor value */
+          case GATT_CMD_WRITE:
+          case GATT_SIGN_CMD_WRITE:
+          case GATT_REQ_PREPARE_WRITE:
+            gatts_process_write_req(tcb, cid, el, handle, op_code, len, p,
+                                    attr->gatt_type);
+            break;
+          default:
             break;
-          }
         }
-        break;
+        status = GATT_SUCCESS;
       }
     }
   }
@@ -1324,13 +1337,12 @@ void gatts_process_value_conf(tGATT_TCB& tcb, uint16_t cid, uint8_t op_code) {
   if (continue_processing) {
     tGATTS_DATA gatts_data;
     gatts_data.handle = handle;
-    for (auto& el : *gatt_cb.srv_list_info) {
-      if (el.s_hdl <= handle && el.e_hdl >= handle) {
-        uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
-        uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, el.gatt_if);
-        gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
-                                  &gatts_data);
-      }
+    auto it = gatt_sr_find_i_rcb_by_handle(handle);
+    if (it != gatt_cb.srv_list_info->end()) {
+      uint32_t trans_id = gatt_sr_enqueue_cmd(tcb, cid, op_code, handle);
+      uint16_t conn_id = GATT_CREATE_CONN_ID(tcb.tcb_idx, it->gatt_if);
+      gatt_sr_send_req_callback(conn_id, trans_id, GATTS_REQ_TYPE_CONF,
+                                &gatts_data);
     }
   }
 }
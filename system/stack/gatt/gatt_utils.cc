@@ -27,6 +27,7 @@
 #include <bluetooth/log.h>
 #include <com_android_bluetooth_flags.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 
@@ -819,25 +820,113 @@ void gatt_ind_ack_timeout(void* data) {
    */
   attp_send_cl_confirmation_msg(*p_tcb, L2CAP_ATT_CID);
 }
+/*******************************************************************************
+ *
+ * Function         gatt_sr_rebuild_index
+ *
+ * Description      Rebuild the handle range, attribute type and primary
+ *                  service indexes from gatt_cb.srv_list_info. Must be called
+ *                  whenever a service is added to or removed from the list.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void gatt_sr_rebuild_index() {
+  gatt_cb.srv_index.clear();
+  gatt_cb.attr_type_index.clear();
+  gatt_cb.pri_srv_index.clear();
+
+  if (gatt_cb.srv_list_info == nullptr) return;
+
+  gatt_cb.srv_index.reserve(gatt_cb.srv_list_info->size());
+
+  /* srv_list_info is sorted by start handle and every attr_list by handle, so
+   * all the postings come out sorted as well */
+  for (auto it = gatt_cb.srv_list_info->begin();
+       it != gatt_cb.srv_list_info->end(); it++) {
+    gatt_cb.srv_index.push_back({it->s_hdl, it->e_hdl, it});
+
+    if (it->p_db == nullptr) continue;
+
+    if (it->type == GATT_UUID_PRI_SERVICE) {
+      Uuid* p_uuid = gatts_get_service_uuid(it->p_db);
+      if (p_uuid) gatt_cb.pri_srv_index[*p_uuid].push_back(&*it);
+    }
+
+    for (tGATT_ATTR& attr : it->p_db->attr_list) {
+      gatt_cb.attr_type_index[attr.uuid].push_back({attr.handle, &attr, &*it});
+    }
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_first_srv_index
+ *
+ * Description      Find the first started service that ends at or after
+ *                  |s_hdl|.
+ *
+ * Returns          Iterator into gatt_cb.srv_index, end() if there is none.
+ *
+ ******************************************************************************/
+std::vector<tGATT_SRV_INDEX_ELEM>::const_iterator gatt_sr_find_first_srv_index(
+    uint16_t s_hdl) {
+  return std::lower_bound(
+      gatt_cb.srv_index.cbegin(), gatt_cb.srv_index.cend(), s_hdl,
+      [](const tGATT_SRV_INDEX_ELEM& elem, uint16_t handle) {
+        return elem.e_hdl < handle;
+      });
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_attr_postings
+ *
+ * Description      Find all attributes of the given type in the started
+ *                  services.
+ *
+ * Returns          Postings sorted by handle, nullptr if there are none.
+ *
+ ******************************************************************************/
+const std::vector<tGATT_ATTR_POSTING>* gatt_sr_find_attr_postings(
+    const Uuid& type) {
+  auto it = gatt_cb.attr_type_index.find(type);
+  if (it == gatt_cb.attr_type_index.end()) return nullptr;
+  return &it->second;
+}
+
+/*******************************************************************************
+ *
+ * Function         gatt_sr_find_pri_srv_postings
+ *
+ * Description      Find all started primary services with the given UUID.
+ *
+ * Returns          Services sorted by start handle, nullptr if there are none.
+ *
+ ******************************************************************************/
+const std::vector<tGATT_SRV_LIST_ELEM*>* gatt_sr_find_pri_srv_postings(
+    const Uuid& svc_uuid) {
+  auto it = gatt_cb.pri_srv_index.find(svc_uuid);
+  if (it == gatt_cb.pri_srv_index.end()) return nullptr;
+  return &it->second;
+}
+
 /*******************************************************************************
  *
  * Description      Search for a service that owns a specific handle.
  *
- * Returns          GATT_MAX_SR_PROFILES if not found. Otherwise the index of
- *                  the service.
+ * Returns          gatt_cb.srv_list_info->end() if not found. Otherwise the
+ *                  iterator of the service.
  *
  ******************************************************************************/
 std::list<tGATT_SRV_LIST_ELEM>::iterator gatt_sr_find_i_rcb_by_handle(
     uint16_t handle) {
-  auto it = gatt_cb.srv_list_info->begin();
-
-  for (; it != gatt_cb.srv_list_info->end(); it++) {
-    if (it->s_hdl <= handle && it->e_hdl >= handle) {
-      return it;
-    }
+  auto it = gatt_sr_find_first_srv_index(handle);
+  if (it == gatt_cb.srv_index.cend() || it->s_hdl > handle) {
+    return gatt_cb.srv_list_info->end();
   }
 
-  return it;
+  return it->it;
 }
 
 /*******************************************************************************
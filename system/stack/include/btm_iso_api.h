@@ -58,6 +58,14 @@ struct VscCallback {
   virtual void OnVscEvent(uint16_t delay, uint8_t mode,
                           uint64_t bdAddr) = 0;
 };
+
+/**
+ * Builds an SDU for IsoManager::SendIsoSdu() from |data_len| bytes at |data|,
+ * with kIsoSduHeadroom bytes left in front of them. The buffer comes from the
+ * osi buffer pools, so an SDU sent every SDU interval recycles the same few
+ * blocks instead of reaching the system allocator.
+ */
+BT_HDR* AllocateIsoSdu(const uint8_t* data, uint16_t data_len);
 }  // namespace iso_manager
 
 class IsoManager {
@@ -177,6 +185,16 @@ class IsoManager {
   virtual void SendIsoData(uint16_t conn_handle, const uint8_t* data,
                            uint16_t data_len);
 
+  /**
+   * Sends iso data to the controller without copying it
+   *
+   * @param conn_handle handle of BIS or CIS connection
+   * @param sdu SDU from iso_manager::AllocateIsoSdu(), or any osi allocation
+   * with at least kIsoSduHeadroom bytes in front of its payload. The ISO header
+   * is written there and the ownership of sdu is transferred.
+   */
+  virtual void SendIsoSdu(uint16_t conn_handle, BT_HDR* sdu);
+
   /**
    * Creates the Broadcast Isochronous Group
    *
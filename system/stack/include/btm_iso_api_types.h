@@ -45,6 +45,10 @@ constexpr uint8_t kIsoCigPhyC = 0x04;
 
 namespace iso_manager {
 
+/* Room to leave in front of the payload of an SDU passed to
+ * IsoManager::SendIsoSdu(), for the ISO data packet header */
+constexpr uint16_t kIsoSduHeadroom = 8;
+
 constexpr uint8_t kIsoDataPathDirectionIn = 0x00;
 constexpr uint8_t kIsoDataPathDirectionOut = 0x01;
 
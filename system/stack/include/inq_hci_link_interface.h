@@ -31,4 +31,5 @@ void btm_process_inq_complete(tHCI_STATUS status, uint8_t mode);
 
 void btm_acl_process_sca_cmpl_pkt(uint8_t len, uint8_t* data);
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble);
+void btm_inq_db_update_time_of_resp(tINQ_DB_ENT* p_ent);
 void btm_inq_db_set_inq_by_rssi(void);
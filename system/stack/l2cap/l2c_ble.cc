@@ -77,7 +77,7 @@ void L2CA_Consolidate(const RawAddress& identity_addr, const RawAddress& rpa) {
   }
 
   log::info("consolidating l2c_lcb record {} -> {}", rpa, identity_addr);
-  p_lcb->remote_bd_addr = identity_addr;
+  l2cu_set_lcb_bd_addr(*p_lcb, identity_addr);
 }
 
 hci_role_t L2CA_GetBleConnRole(const RawAddress& bd_addr) {
@@ -104,8 +104,10 @@ void l2cble_notify_le_connection(const RawAddress& bda) {
     return;
   }
 
-  if (BTM_IsAclConnectionUp(bda, BT_TRANSPORT_LE) &&
-      p_lcb->link_state != LST_CONNECTED) {
+  /* Checked first since it is called for every received packet, and the link
+   * is connected for all but the first ones */
+  if (p_lcb->link_state != LST_CONNECTED &&
+      BTM_IsAclConnectionUp(bda, BT_TRANSPORT_LE)) {
     /* update link status */
     // TODO Move this back into acl layer
     btm_establish_continue_from_address(bda, BT_TRANSPORT_LE);
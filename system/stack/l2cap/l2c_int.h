@@ -56,6 +56,13 @@
 
 #define MAX_ACTIVE_AVDT_CONN 2
 
+/* Number of buckets of the LCB address hash, a power of two */
+#define L2C_LCB_ADDR_HASH_SIZE 32
+/* Number of entries of the LCB handle index, one per 12 bit HCI handle */
+#define L2C_LCB_HANDLE_INDEX_SIZE 0x1000
+
+static_assert(MAX_L2CAP_LINKS < 0xFF, "LCB indices must fit in uint8_t");
+
 constexpr uint16_t L2CAP_CREDIT_BASED_MIN_MTU = 64;
 constexpr uint16_t L2CAP_CREDIT_BASED_MIN_MPS = 64;
 
@@ -449,6 +456,7 @@ typedef struct t_l2c_linkcb {
   tL2C_CCB* p_pending_ccb;  /* ccb of waiting channel during link disconnect */
   alarm_t* info_resp_timer; /* Timer entry for info resp timeout evt */
   RawAddress remote_bd_addr; /* The BD address of the remote */
+  uint8_t addr_hash_next; /* Next LCB of the address hash bucket, plus one */
 
  private:
   tHCI_ROLE link_role_{HCI_ROLE_CENTRAL}; /* Central or peripheral */
@@ -610,6 +618,14 @@ typedef struct {
   bool is_cong_cback_context;
 
   tL2C_LCB lcb_pool[MAX_L2CAP_LINKS];    /* Link Control Block pool */
+
+  /* Indices in lcb_pool plus one, so that the zeroed tables are empty.
+   * Received ACL data looks its LCB up by handle, and many APIs by address:
+   * the handle index has one entry per HCI handle, and the address hash
+   * chains its LCBs through addr_hash_next. */
+  uint8_t lcb_handle_index[L2C_LCB_HANDLE_INDEX_SIZE];
+  uint8_t lcb_addr_hash[L2C_LCB_ADDR_HASH_SIZE];
+
   tL2C_CCB ccb_pool[MAX_L2CAP_CHANNELS]; /* Channel Control Block pool */
   tL2C_RCB rcb_pool[MAX_L2CAP_CLIENTS];  /* Registration info pool */
 
@@ -724,6 +740,7 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb);
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport);
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle);
+void l2cu_set_lcb_bd_addr(tL2C_LCB& lcb, const RawAddress& bd_addr);
 
 bool l2cu_set_acl_priority(const RawAddress& bd_addr, tL2CAP_PRIORITY priority,
                            bool reset_after_rs);
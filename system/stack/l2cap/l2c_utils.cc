@@ -63,6 +63,53 @@ using namespace bluetooth;
 
 tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb); // TODO Move
 
+/* Entry of |p_lcb| in the lcb_handle_index and lcb_addr_hash tables */
+static uint8_t l2cu_lcb_index_entry(const tL2C_LCB* p_lcb) {
+  return static_cast<uint8_t>(p_lcb - l2cb.lcb_pool + 1);
+}
+
+static uint8_t& l2cu_lcb_addr_hash_bucket(const RawAddress& bd_addr) {
+  uint32_t hash = 0;
+  for (uint8_t octet : bd_addr.address) hash = hash * 31 + octet;
+  return l2cb.lcb_addr_hash[hash & (L2C_LCB_ADDR_HASH_SIZE - 1)];
+}
+
+static void l2cu_remove_lcb_from_addr_hash(tL2C_LCB* p_lcb) {
+  uint8_t* p_entry = &l2cu_lcb_addr_hash_bucket(p_lcb->remote_bd_addr);
+  while (*p_entry != 0) {
+    tL2C_LCB* p_cur = &l2cb.lcb_pool[*p_entry - 1];
+    if (p_cur == p_lcb) {
+      *p_entry = p_lcb->addr_hash_next;
+      p_lcb->addr_hash_next = 0;
+      return;
+    }
+    p_entry = &p_cur->addr_hash_next;
+  }
+}
+
+static void l2cu_add_lcb_to_addr_hash(tL2C_LCB* p_lcb) {
+  uint8_t& bucket = l2cu_lcb_addr_hash_bucket(p_lcb->remote_bd_addr);
+  p_lcb->addr_hash_next = bucket;
+  bucket = l2cu_lcb_index_entry(p_lcb);
+}
+
+static void l2cu_remove_lcb_from_handle_index(tL2C_LCB* p_lcb) {
+  uint16_t slot = p_lcb->Handle() & (L2C_LCB_HANDLE_INDEX_SIZE - 1);
+  uint8_t& entry = l2cb.lcb_handle_index[slot];
+  if (entry != l2cu_lcb_index_entry(p_lcb)) return;
+
+  /* Another active LCB may wrongly have the same handle, or one out of the
+   * 12 bit range in the same entry; keep it reachable */
+  entry = 0;
+  for (tL2C_LCB& lcb : l2cb.lcb_pool) {
+    if (&lcb != p_lcb && lcb.in_use && lcb.Handle() != HCI_INVALID_HANDLE &&
+        (lcb.Handle() & (L2C_LCB_HANDLE_INDEX_SIZE - 1)) == slot) {
+      entry = l2cu_lcb_index_entry(&lcb);
+      return;
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_lcb
@@ -82,9 +129,11 @@ tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
     if (!p_lcb->in_use) {
       alarm_free(p_lcb->l2c_lcb_timer);
       alarm_free(p_lcb->info_resp_timer);
+      l2cu_remove_lcb_from_addr_hash(p_lcb);
       memset(p_lcb, 0, sizeof(tL2C_LCB));
 
       p_lcb->remote_bd_addr = p_bd_addr;
+      l2cu_add_lcb_to_addr_hash(p_lcb);
 
       p_lcb->in_use = true;
       p_lcb->with_active_local_clients = false;
@@ -124,7 +173,26 @@ void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle) {
   if (p_lcb.Handle() != HCI_INVALID_HANDLE) {
     log::warn("Should not replace active handle:{} with new handle:{}", p_lcb.Handle(), handle);
   }
+  l2cu_remove_lcb_from_handle_index(&p_lcb);
   p_lcb.SetHandle(handle);
+  l2cb.lcb_handle_index[handle & (L2C_LCB_HANDLE_INDEX_SIZE - 1)] =
+      l2cu_lcb_index_entry(&p_lcb);
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cu_set_lcb_bd_addr
+ *
+ * Description      Change the remote BD address of an LCB, e.g. once its
+ *                  RPA is resolved, and move it in the address hash
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2cu_set_lcb_bd_addr(tL2C_LCB& lcb, const RawAddress& bd_addr) {
+  l2cu_remove_lcb_from_addr_hash(&lcb);
+  lcb.remote_bd_addr = bd_addr;
+  l2cu_add_lcb_to_addr_hash(&lcb);
 }
 
 /*******************************************************************************
@@ -167,6 +235,9 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
   p_lcb->in_use = false;
   p_lcb->ResetBonding();
 
+  l2cu_remove_lcb_from_addr_hash(p_lcb);
+  l2cu_remove_lcb_from_handle_index(p_lcb);
+
   /* Stop and free timers */
   alarm_free(p_lcb->l2c_lcb_timer);
   p_lcb->l2c_lcb_timer = NULL;
@@ -244,18 +315,19 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
  *
  * Function         l2cu_find_lcb_by_bd_addr
  *
- * Description      Look through all active LCBs for a match based on the
- *                  remote BD address.
+ * Description      Look through the active LCBs of the address hash bucket
+ *                  of the remote BD address for a match.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport) {
-  int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  tL2C_LCB* p_lcb;
 
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  for (uint8_t entry = l2cu_lcb_addr_hash_bucket(p_bd_addr); entry != 0;
+       entry = p_lcb->addr_hash_next) {
+    p_lcb = &l2cb.lcb_pool[entry - 1];
     if ((p_lcb->in_use) && p_lcb->transport == transport &&
         (p_lcb->remote_bd_addr == p_bd_addr)) {
       return (p_lcb);
@@ -3413,17 +3485,27 @@ void l2cu_send_peer_ble_credit_based_disconn_req(tL2C_CCB* p_ccb) {
  *
  * Function         l2cu_find_lcb_by_handle
  *
- * Description      Look through all active LCBs for a match based on the
- *                  HCI handle.
+ * Description      Look for the active LCB of an HCI handle. The handle index
+ *                  gives it directly; all active LCBs are only searched for
+ *                  the invalid handle, or when the index entry is stale.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle) {
   int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  tL2C_LCB* p_lcb;
 
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  uint8_t entry =
+      l2cb.lcb_handle_index[handle & (L2C_LCB_HANDLE_INDEX_SIZE - 1)];
+  if (entry == 0 && handle != HCI_INVALID_HANDLE) return (NULL);
+  if (entry != 0) {
+    p_lcb = &l2cb.lcb_pool[entry - 1];
+    if ((p_lcb->in_use) && (p_lcb->Handle() == handle)) return (p_lcb);
+  }
+
+  for (xx = 0, p_lcb = &l2cb.lcb_pool[0]; xx < MAX_L2CAP_LINKS;
+       xx++, p_lcb++) {
     if ((p_lcb->in_use) && (p_lcb->Handle() == handle)) {
       return (p_lcb);
     }
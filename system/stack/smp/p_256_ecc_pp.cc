@@ -27,6 +27,7 @@
 #include <cstdint>
 #include <cstring>
 
+#include "crypto_toolbox/p256.h"
 #include "p_256_multprecision.h"
 
 elliptic_curve_t curve;
@@ -241,6 +242,18 @@ void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n) {
   multiprecision_mersenns_mult_mod(q->y, q->y, q->z);
 }
 
+void ECC_PointMult(Point* q, const Point* p, const uint32_t* n) {
+  p_256_init_curve();
+  if (memcmp(p->x, curve_p256.G.x, sizeof(p->x)) == 0 &&
+      memcmp(p->y, curve_p256.G.y, sizeof(p->y)) == 0) {
+    crypto_toolbox::p256::ScalarMultBase(n, q->x, q->y);
+  } else {
+    crypto_toolbox::p256::ScalarMult(n, p->x, p->y, q->x, q->y);
+  }
+  multiprecision_init(q->z);
+  q->z[0] = 1;
+}
+
 bool ECC_ValidatePoint(const Point& pt) {
   p_256_init_curve();
 
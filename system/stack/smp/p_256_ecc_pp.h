@@ -60,6 +60,8 @@ bool ECC_ValidatePoint(const Point& p);
 
 void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n);
 
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+/* q = n * p in constant time, with the base point table when p is G. p must
+ * be on the curve and q is affine. */
+void ECC_PointMult(Point* q, const Point* p, const uint32_t* n);
 
 void p_256_init_curve();
@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "crypto_toolbox/crypto_toolbox.h"
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "stack/btm/btm_ble_int.h"
+#include "stack/btm/btm_dev.h"
+#include "stack/btm/btm_sec_cb.h"
+#include "stack/include/hcidefs.h"
+#include "test/fake/fake_osi.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+namespace {
+
+RawAddress DeviceAddress(uint16_t index) {
+  return RawAddress({0x00, 0x11, 0x22, 0x33, static_cast<uint8_t>(index >> 8),
+                     static_cast<uint8_t>(index)});
+}
+
+Octet16 DeviceIrk(uint16_t index) {
+  Octet16 irk{};
+  irk[0] = static_cast<uint8_t>(index);
+  irk[1] = static_cast<uint8_t>(index >> 8);
+  irk[15] = 0xa5;
+  return irk;
+}
+
+// A Resolvable Private Address of device |index|, prand being |prand|
+RawAddress DeviceRpa(uint16_t index, uint32_t prand) {
+  Octet16 r{};
+  r[0] = static_cast<uint8_t>(prand);
+  r[1] = static_cast<uint8_t>(prand >> 8);
+  r[2] = static_cast<uint8_t>(prand >> 16);
+  Octet16 hash = crypto_toolbox::aes_128(DeviceIrk(index), r);
+  return RawAddress({r[2], r[1], r[0], hash[2], hash[1], hash[0]});
+}
+
+// Fills the security database with |num_devices| bonded devices, each with a
+// public address and a BR/EDR connection. Records are appended directly since
+// btm_sec_allocate_dev_rec() evicts above BTM_SEC_MAX_DEVICE_RECORDS, which
+// is raised on products that bond with that many devices.
+class SecDevRecs {
+ public:
+  explicit SecDevRecs(int num_devices) {
+    ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+    for (int i = 0; i < num_devices; i++) {
+      tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(
+          osi_calloc(sizeof(tBTM_SEC_DEV_REC)));
+      p_dev_rec->bd_addr = DeviceAddress(i);
+      p_dev_rec->ble.identity_address_with_type.bda = DeviceAddress(i);
+      p_dev_rec->hci_handle = i;
+      p_dev_rec->ble_hci_handle = HCI_INVALID_HANDLE;
+      p_dev_rec->device_type = BT_DEVICE_TYPE_DUMO;
+      p_dev_rec->sec_rec.ble_keys.key_type = BTM_LE_KEY_LENC | BTM_LE_KEY_PID;
+      p_dev_rec->sec_rec.ble_keys.irk = DeviceIrk(i);
+      list_append(::btm_sec_cb.sec_dev_rec, p_dev_rec);
+      ::btm_sec_cb.rpa_resolver.AddIrk(p_dev_rec, DeviceIrk(i));
+    }
+  }
+  ~SecDevRecs() { ::btm_sec_cb.Free(); }
+
+ private:
+  test::fake::FakeOsi fake_osi_;
+};
+
+// Look up every device in turn, as events for all of them come in
+void BM_btm_find_dev(State& state) {
+  int num_devices = state.range(0);
+  SecDevRecs recs(num_devices);
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_find_dev(DeviceAddress(i)));
+    i = (i + 1) % num_devices;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_btm_find_dev_by_handle(State& state) {
+  int num_devices = state.range(0);
+  SecDevRecs recs(num_devices);
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_find_dev_by_handle(i));
+    i = (i + 1) % num_devices;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_btm_find_dev_with_lenc(State& state) {
+  int num_devices = state.range(0);
+  SecDevRecs recs(num_devices);
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_find_dev_with_lenc(DeviceAddress(i)));
+    i = (i + 1) % num_devices;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// A device that is not in the database still walks the whole list, which is
+// what every lookup cost before the index
+void BM_btm_find_dev_unknown(State& state) {
+  SecDevRecs recs(state.range(0));
+  RawAddress unknown({0x00, 0x11, 0x22, 0xff, 0xff, 0xff});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_find_dev(unknown));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Advertising from the last device bonded, with a new RPA every time: the
+// cache never hits and every IRK is tried
+void BM_btm_ble_resolve_random_addr(State& state) {
+  int num_devices = state.range(0);
+  SecDevRecs recs(num_devices);
+  std::vector<RawAddress> rpas;
+  for (uint32_t prand = 0; prand < 1024; prand++) {
+    rpas.push_back(DeviceRpa(num_devices - 1, 0x400000 | prand));
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_ble_resolve_random_addr(rpas[i]));
+    i = (i + 1) % rpas.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Advertising from every device in turn, each keeping its RPA
+void BM_btm_ble_resolve_random_addr_cached(State& state) {
+  int num_devices = state.range(0);
+  SecDevRecs recs(num_devices);
+  std::vector<RawAddress> rpas;
+  for (int i = 0; i < num_devices; i++) {
+    rpas.push_back(DeviceRpa(i, 0x400000 | i));
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(btm_ble_resolve_random_addr(rpas[i]));
+    i = (i + 1) % rpas.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_btm_find_dev)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(BM_btm_find_dev_by_handle)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(BM_btm_find_dev_with_lenc)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(BM_btm_find_dev_unknown)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(BM_btm_ble_resolve_random_addr)->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK(BM_btm_ble_resolve_random_addr_cached)->Arg(1)->Arg(100)->Arg(1000);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
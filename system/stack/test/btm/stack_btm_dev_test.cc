@@ -18,11 +18,31 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "stack/btm/btm_ble_int.h"
 #include "stack/btm/btm_dev.h"
 #include "stack/btm/btm_sec_cb.h"
+#include "stack/include/btm_ble_addr.h"
+#include "stack/include/hcidefs.h"
 #include "stack/test/btm/btm_test_fixtures.h"
 #include "test/mock/mock_main_shim_entry.h"
 
+namespace bluetooth {
+namespace testing {
+namespace legacy {
+
+void wipe_secrets_and_remove(tBTM_SEC_DEV_REC* p_dev_rec);
+
+}  // namespace legacy
+}  // namespace testing
+}  // namespace bluetooth
+
+using bluetooth::testing::legacy::wipe_secrets_and_remove;
+
+namespace {
+const RawAddress kAddress1 = RawAddress({0x00, 0x11, 0x22, 0x33, 0x44, 0x01});
+const RawAddress kAddress2 = RawAddress({0x00, 0x11, 0x22, 0x33, 0x44, 0x02});
+}  // namespace
+
 class StackBtmDevTest : public BtmWithMocksTest {
  protected:
   void SetUp() override { BtmWithMocksTest::SetUp(); }
@@ -41,3 +61,161 @@ TEST_F(StackBtmDevTest, btm_sec_allocate_dev_rec__with_list) {
   ASSERT_NE(nullptr, btm_sec_allocate_dev_rec());
   ::btm_sec_cb.Free();
 }
+
+TEST_F(StackBtmDevTest, btm_find_dev__record_address_changed) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_sec_allocate_dev_rec();
+  p_dev_rec->bd_addr = kAddress1;
+  ASSERT_EQ(p_dev_rec, btm_find_dev(kAddress1));
+
+  p_dev_rec->bd_addr = kAddress2;
+  ASSERT_EQ(nullptr, btm_find_dev(kAddress1));
+  ASSERT_EQ(p_dev_rec, btm_find_dev(kAddress2));
+
+  p_dev_rec->bd_addr = RawAddress::kEmpty;
+  p_dev_rec->ble.pseudo_addr = kAddress2;
+  ASSERT_EQ(p_dev_rec, btm_find_dev(kAddress2));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev__record_removed) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_removed = btm_sec_allocate_dev_rec();
+  p_removed->bd_addr = kAddress1;
+  p_removed->hci_handle = 0x0001;
+  p_removed->ble.identity_address_with_type.bda = kAddress1;
+  ASSERT_EQ(p_removed, btm_find_dev(kAddress1));
+  ASSERT_EQ(p_removed, btm_find_dev_by_handle(0x0001));
+
+  wipe_secrets_and_remove(p_removed);
+  ASSERT_EQ(nullptr, btm_find_dev(kAddress1));
+  ASSERT_EQ(nullptr, btm_find_dev_by_handle(0x0001));
+  ASSERT_TRUE(::btm_sec_cb.dev_rec_by_addr.empty());
+  ASSERT_TRUE(::btm_sec_cb.dev_rec_by_handle.empty());
+
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_sec_allocate_dev_rec();
+  p_dev_rec->bd_addr = kAddress1;
+  p_dev_rec->hci_handle = 0x0001;
+  ASSERT_EQ(p_dev_rec, btm_find_dev(kAddress1));
+  ASSERT_EQ(p_dev_rec, btm_find_dev_by_handle(0x0001));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev_by_handle__handle_reused) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec1 = btm_sec_allocate_dev_rec();
+  p_dev_rec1->hci_handle = 0x0001;
+  p_dev_rec1->ble_hci_handle = HCI_INVALID_HANDLE;
+  tBTM_SEC_DEV_REC* p_dev_rec2 = btm_sec_allocate_dev_rec();
+  p_dev_rec2->hci_handle = HCI_INVALID_HANDLE;
+  p_dev_rec2->ble_hci_handle = 0x0002;
+  ASSERT_EQ(p_dev_rec1, btm_find_dev_by_handle(0x0001));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0002));
+
+  // Disconnected, then the handle is used for a connection to another device
+  p_dev_rec1->hci_handle = HCI_INVALID_HANDLE;
+  p_dev_rec2->hci_handle = 0x0001;
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_by_handle(0x0001));
+  ASSERT_EQ(p_dev_rec1, btm_find_dev_by_handle(HCI_INVALID_HANDLE));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev__earlier_record_gets_address) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_le_rec = btm_sec_allocate_dev_rec();
+  p_le_rec->bd_addr = kAddress2;
+  tBTM_SEC_DEV_REC* p_classic_rec = btm_sec_allocate_dev_rec();
+  p_classic_rec->bd_addr = kAddress1;
+  ASSERT_EQ(p_classic_rec, btm_find_dev(kAddress1));
+
+  // As for a dual mode device whose LE record learns its identity address
+  ASSERT_TRUE(btm_ble_init_pseudo_addr(p_le_rec, kAddress1));
+  ASSERT_EQ(p_le_rec, btm_find_dev(kAddress1));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_find_dev_with_lenc__indexed_record_without_lenc) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec1 = btm_sec_allocate_dev_rec();
+  p_dev_rec1->bd_addr = kAddress1;
+  tBTM_SEC_DEV_REC* p_dev_rec2 = btm_sec_allocate_dev_rec();
+  p_dev_rec2->bd_addr = kAddress1;
+  p_dev_rec2->sec_rec.ble_keys.key_type = BTM_LE_KEY_LENC;
+  ASSERT_EQ(p_dev_rec1, btm_find_dev(kAddress1));
+  ASSERT_EQ(p_dev_rec2, btm_find_dev_with_lenc(kAddress1));
+  ::btm_sec_cb.Free();
+}
+
+namespace {
+// BT Spec 5.0 | Vol 3, Part H D.7: ah(IRK, 0x708194) = 0x0dfbaa
+const Octet16 kIrk{0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34,
+                   0x05, 0xad, 0xc8, 0x57, 0xa3, 0x34, 0x02, 0xec};
+const RawAddress kRpa = RawAddress({0x70, 0x81, 0x94, 0x0d, 0xfb, 0xaa});
+const RawAddress kOtherRpa = RawAddress({0x70, 0x81, 0x94, 0x0d, 0xfb, 0xab});
+
+tBTM_SEC_DEV_REC* allocate_dev_rec_with_irk(const Octet16& irk) {
+  tBTM_SEC_DEV_REC* p_dev_rec = btm_sec_allocate_dev_rec();
+  p_dev_rec->device_type = BT_DEVICE_TYPE_BLE;
+  p_dev_rec->sec_rec.ble_keys.irk = irk;
+  p_dev_rec->sec_rec.ble_keys.key_type = BTM_LE_KEY_PID;
+  ::btm_sec_cb.rpa_resolver.AddIrk(p_dev_rec, irk);
+  return p_dev_rec;
+}
+}  // namespace
+
+TEST_F(StackBtmDevTest, btm_ble_resolve_random_addr) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  Octet16 other_irk = kIrk;
+  other_irk[0] ^= 0x01;
+  allocate_dev_rec_with_irk(other_irk);
+  tBTM_SEC_DEV_REC* p_dev_rec = allocate_dev_rec_with_irk(kIrk);
+  ASSERT_EQ(2u, ::btm_sec_cb.rpa_resolver.NumIrks());
+
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(kOtherRpa));
+  ::btm_sec_cb.Free();
+  ASSERT_EQ(0u, ::btm_sec_cb.rpa_resolver.NumIrks());
+}
+
+TEST_F(StackBtmDevTest, btm_ble_resolve_random_addr__irk_changed) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec = allocate_dev_rec_with_irk(kIrk);
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+
+  // Keys wiped in place, without the resolver being told
+  p_dev_rec->sec_rec.ble_keys.key_type = BTM_LE_KEY_NONE;
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(kRpa));
+  ASSERT_EQ(0u, ::btm_sec_cb.rpa_resolver.NumIrks());
+
+  // An unresolved address resolves once the IRK is saved again
+  p_dev_rec->sec_rec.ble_keys.key_type = BTM_LE_KEY_PID;
+  ::btm_sec_cb.rpa_resolver.AddIrk(p_dev_rec, kIrk);
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_ble_resolve_random_addr__record_removed) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_removed = allocate_dev_rec_with_irk(kIrk);
+  ASSERT_EQ(p_removed, btm_ble_resolve_random_addr(kRpa));
+
+  wipe_secrets_and_remove(p_removed);
+  ASSERT_EQ(0u, ::btm_sec_cb.rpa_resolver.NumIrks());
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(kRpa));
+
+  tBTM_SEC_DEV_REC* p_dev_rec = allocate_dev_rec_with_irk(kIrk);
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+  ::btm_sec_cb.Free();
+}
+
+TEST_F(StackBtmDevTest, btm_ble_resolve_random_addr__not_le_device) {
+  ::btm_sec_cb.Init(BTM_SEC_MODE_SC);
+  tBTM_SEC_DEV_REC* p_dev_rec = allocate_dev_rec_with_irk(kIrk);
+  p_dev_rec->device_type = BT_DEVICE_TYPE_BREDR;
+  ASSERT_EQ(nullptr, btm_ble_resolve_random_addr(kRpa));
+
+  p_dev_rec->device_type |= BT_DEVICE_TYPE_BLE;
+  ASSERT_EQ(p_dev_rec, btm_ble_resolve_random_addr(kRpa));
+  ::btm_sec_cb.Free();
+}
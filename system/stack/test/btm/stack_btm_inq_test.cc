@@ -18,8 +18,11 @@
 #include <gtest/gtest.h>
 #include <stdlib.h>
 
+#include <chrono>
+
 #include "hci_error_code.h"
 #include "stack/btm/btm_int_types.h"
+#include "stack/btm/neighbor_inquiry.h"
 #include "stack/include/inq_hci_link_interface.h"
 #include "stack/test/btm/btm_test_fixtures.h"
 #include "test/fake/fake_looper.h"
@@ -29,6 +32,14 @@
 
 extern tBTM_CB btm_cb;
 
+namespace bluetooth {
+namespace legacy {
+namespace testing {
+void btm_clr_inq_db(const RawAddress* p_bda);
+}  // namespace testing
+}  // namespace legacy
+}  // namespace bluetooth
+
 namespace {
 const RawAddress kRawAddress = RawAddress({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
 const RawAddress kRawAddress2 =
@@ -142,3 +153,99 @@ TEST_F(BtmInqActiveTest, btm_process_remote_name__different_address) {
 
   ASSERT_FALSE(gBTM_REMOTE_DEV_NAME_sent);
 }
+
+class BtmInqDbTest : public BtmInqTest {
+ protected:
+  void SetUp() override {
+    BtmInqTest::SetUp();
+    bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+  }
+
+  void TearDown() override {
+    bluetooth::legacy::testing::btm_clr_inq_db(nullptr);
+    BtmInqTest::TearDown();
+  }
+
+  static RawAddress Address(int index) {
+    return RawAddress({0x40, 0x11, 0x22, 0x33, static_cast<uint8_t>(index >> 8),
+                       static_cast<uint8_t>(index)});
+  }
+
+  // What the stack does for every inquiry result or advertising report
+  static tINQ_DB_ENT* ReportFrom(const RawAddress& bda, bool is_ble) {
+    tINQ_DB_ENT* p_i = btm_inq_db_find(bda);
+    if (p_i == nullptr) p_i = btm_inq_db_new(bda, is_ble);
+    btm_inq_db_update_time_of_resp(p_i);
+    return p_i;
+  }
+};
+
+TEST_F(BtmInqDbTest, btm_inq_db_find__new_entries) {
+  ASSERT_EQ(nullptr, btm_inq_db_find(kRawAddress));
+
+  tINQ_DB_ENT* p_bredr = btm_inq_db_new(kRawAddress, false);
+  tINQ_DB_ENT* p_ble = btm_inq_db_new(kRawAddress2, true);
+  ASSERT_EQ(p_bredr, btm_inq_db_find(kRawAddress));
+  ASSERT_EQ(p_ble, btm_inq_db_find(kRawAddress2));
+  ASSERT_EQ(kRawAddress, p_bredr->inq_info.results.remote_bd_addr);
+  ASSERT_TRUE(p_bredr->in_use);
+
+  bluetooth::legacy::testing::btm_clr_inq_db(&kRawAddress);
+  ASSERT_EQ(nullptr, btm_inq_db_find(kRawAddress));
+  ASSERT_FALSE(p_bredr->in_use);
+  ASSERT_EQ(p_ble, btm_inq_db_find(kRawAddress2));
+
+  // The freed entry is reused first
+  ASSERT_EQ(p_bredr, btm_inq_db_new(Address(1), false));
+}
+
+TEST_F(BtmInqDbTest, btm_inq_db_new__evicts_oldest_response) {
+  constexpr int kHalfSize = BTM_INQ_DB_SIZE / 2;
+  for (int i = 0; i < kHalfSize; i++) {
+    ASSERT_NE(nullptr, ReportFrom(Address(i), true));
+  }
+  // Seen again, so the second oldest becomes the oldest
+  ASSERT_NE(nullptr, ReportFrom(Address(0), true));
+  // Looked up for its name, which is not a response
+  ASSERT_NE(nullptr, btm_inq_db_find(Address(1)));
+
+  tINQ_DB_ENT* p_ent = btm_inq_db_new(Address(kHalfSize), true);
+  ASSERT_EQ(p_ent, btm_inq_db_find(Address(kHalfSize)));
+  ASSERT_EQ(nullptr, btm_inq_db_find(Address(1)));
+  for (int i = 0; i < kHalfSize + 1; i++) {
+    if (i != 1) ASSERT_NE(nullptr, btm_inq_db_find(Address(i))) << i;
+  }
+
+  // BR/EDR entries are not evicted for LE ones
+  tINQ_DB_ENT* p_bredr = btm_inq_db_new(kRawAddress, false);
+  for (int i = 0; i < kHalfSize; i++) {
+    btm_inq_db_new(Address(1000 + i), true);
+  }
+  ASSERT_EQ(p_bredr, btm_inq_db_find(kRawAddress));
+}
+
+// Many more advertisers than entries, each reporting at the same rate, as in a
+// dense environment. Reports the cost of each report, from the lookup to the
+// eviction of another advertiser.
+TEST_F(BtmInqDbTest, btm_inq_db__dense_advertising_workload) {
+  constexpr int kNumAdvertisers = 500;
+  constexpr int kNumReports = 200000;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumReports; i++) {
+    RawAddress bda = Address((i * 7919) % kNumAdvertisers);
+    tINQ_DB_ENT* p_i = ReportFrom(bda, true);
+    ASSERT_EQ(bda, p_i->inq_info.results.remote_bd_addr);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  auto ns_per_report =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+      kNumReports;
+  RecordProperty("ns_per_report", static_cast<int>(ns_per_report));
+
+  int in_use = 0;
+  for (int i = 0; i < kNumAdvertisers; i++) {
+    if (btm_inq_db_find(Address(i)) != nullptr) in_use++;
+  }
+  ASSERT_EQ(BTM_INQ_DB_SIZE / 2, in_use);
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+#include "btm_iso_api.h"
+#include "hci/controller_interface_mock.h"
+#include "hci/include/hci_layer.h"
+#include "mock_hcic_layer.h"
+#include "osi/include/allocator.h"
+#include "stack/btm/btm_dev.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/hcidefs.h"
+#include "test/mock/mock_main_shim_entry.h"
+#include "test/mock/mock_main_shim_hci_layer.h"
+
+using ::benchmark::State;
+using bluetooth::hci::IsoManager;
+using testing::NiceMock;
+using testing::Return;
+
+namespace iso_manager = bluetooth::hci::iso_manager;
+
+tBTM_SEC_DEV_REC* btm_find_dev_by_handle(uint16_t /* handle */) {
+  return nullptr;
+}
+void BTM_LogHistory(const std::string& /* tag */,
+                    const RawAddress& /* bd_addr */,
+                    const std::string& /* msg */,
+                    const std::string& /* extra */) {}
+
+namespace bluetooth::shim {
+
+static void set_data_cb(
+    base::Callback<void(const base::Location&, BT_HDR*)> /* send_data_cb */) {}
+
+static void transmit_command(const BT_HDR* /* command */,
+                             command_complete_cb /* complete_callback */,
+                             command_status_cb /* status_cb */,
+                             void* /* context */) {}
+
+static void transmit_downward(void* data, uint16_t /* iso_Data_size */) {
+  osi_free(data);
+}
+
+static hci_t interface = {.set_data_cb = set_data_cb,
+                          .transmit_command = transmit_command,
+                          .transmit_downward = transmit_downward};
+
+}  // namespace bluetooth::shim
+
+namespace {
+
+constexpr uint8_t kBigId = 0x01;
+constexpr uint16_t kFirstBisHandle = 0x0EF0;
+constexpr uint16_t kSduLen = 120;
+
+class NoopBigCallbacks : public iso_manager::BigCallbacks {
+ public:
+  void OnSetupIsoDataPath(uint8_t /* status */, uint16_t /* conn_handle */,
+                          uint8_t /* big_id */) override {}
+  void OnRemoveIsoDataPath(uint8_t /* status */, uint16_t /* conn_handle */,
+                           uint8_t /* big_id */) override {}
+  void OnBigEvent(uint8_t /* event */, void* /* data */) override {}
+};
+
+// Brings up a BIG with |num_bis| BISes, each with its data path set up, the
+// way the broadcaster does before it starts streaming
+class Big {
+ public:
+  explicit Big(uint8_t num_bis) {
+    hcic::SetMockHcicInterface(&hcic_interface_);
+    bluetooth::shim::testing::hci_layer_set_interface(
+        &bluetooth::shim::interface);
+    bluetooth::hci::testing::mock_controller_ = &controller_;
+
+    bluetooth::hci::LeBufferSize iso_sizes;
+    iso_sizes.total_num_le_packets_ = 16;
+    iso_sizes.le_data_packet_length_ = 1024;
+    ON_CALL(controller_, GetControllerIsoBufferSize())
+        .WillByDefault(Return(iso_sizes));
+
+    ON_CALL(hcic_interface_, CreateBig)
+        .WillByDefault(
+            [](auto big_handle, iso_manager::big_create_params big_params) {
+              std::vector<uint8_t> buf(big_params.num_bis * sizeof(uint16_t) +
+                                       18);
+              uint8_t* p = buf.data();
+              UINT8_TO_STREAM(p, HCI_SUCCESS);
+              UINT8_TO_STREAM(p, big_handle);
+              UINT24_TO_STREAM(p, 0x000080);  // BIG sync delay
+              UINT24_TO_STREAM(p, 0x000080);  // transport latency
+              UINT8_TO_STREAM(p, big_params.phy);
+              UINT8_TO_STREAM(p, 0x02);       // nse
+              UINT8_TO_STREAM(p, 0x01);       // bn
+              UINT8_TO_STREAM(p, 0x00);       // pto
+              UINT8_TO_STREAM(p, 0x02);       // irc
+              UINT16_TO_STREAM(p, 0x0078);    // max PDU
+              UINT16_TO_STREAM(p, 0x0008);    // ISO interval
+              UINT8_TO_STREAM(p, big_params.num_bis);
+              for (auto i = 0; i < big_params.num_bis; ++i) {
+                UINT16_TO_STREAM(p, kFirstBisHandle + i);
+              }
+
+              IsoManager::GetInstance()->HandleHciEvent(
+                  HCI_BLE_CREATE_BIG_CPL_EVT, buf.data(), buf.size());
+            });
+
+    ON_CALL(hcic_interface_, SetupIsoDataPath)
+        .WillByDefault(
+            [](uint16_t iso_handle, uint8_t /* data_path_dir */,
+               uint8_t /* data_path_id */, uint8_t /* codec_id_format */,
+               uint16_t /* codec_id_company */, uint16_t /* codec_id_vendor */,
+               uint32_t /* controller_delay */,
+               std::vector<uint8_t> /* codec_conf */,
+               base::OnceCallback<void(uint8_t*, uint16_t)> cb) {
+              std::vector<uint8_t> buf(3);
+              uint8_t* p = buf.data();
+              UINT8_TO_STREAM(p, HCI_SUCCESS);
+              UINT16_TO_STREAM(p, iso_handle);
+
+              std::move(cb).Run(buf.data(), buf.size());
+            });
+
+    auto manager = IsoManager::GetInstance();
+    manager->Start();
+    manager->RegisterBigCallbacks(&big_callbacks_);
+    manager->CreateBig(kBigId, {.adv_handle = 0x00,
+                                .num_bis = num_bis,
+                                .sdu_itv = 0x002710,
+                                .max_sdu_size = kSduLen,
+                                .max_transport_latency = 0x3c,
+                                .rtn = 3,
+                                .phy = 0x02,
+                                .packing = 0x00,
+                                .framing = 0x00,
+                                .enc = 0,
+                                .enc_code = std::array<uint8_t, 16>({0})});
+
+    for (uint16_t i = 0; i < num_bis; ++i) {
+      handles_.push_back(kFirstBisHandle + i);
+      manager->SetupIsoDataPath(
+          handles_.back(),
+          {.data_path_dir = iso_manager::kIsoDataPathDirectionIn,
+           .data_path_id = iso_manager::kIsoDataPathHci,
+           .codec_id_format = 0x06,
+           .codec_id_company = 0,
+           .codec_id_vendor = 0,
+           .controller_delay = 0,
+           .codec_conf = {}});
+    }
+  }
+
+  ~Big() {
+    IsoManager::GetInstance()->Stop();
+    hcic::SetMockHcicInterface(nullptr);
+    bluetooth::shim::testing::hci_layer_set_interface(nullptr);
+    bluetooth::hci::testing::mock_controller_ = nullptr;
+  }
+
+  const std::vector<uint16_t>& Handles() const { return handles_; }
+
+ private:
+  NiceMock<hcic::MockHcicInterface> hcic_interface_;
+  NiceMock<bluetooth::hci::testing::MockControllerInterface> controller_;
+  NoopBigCallbacks big_callbacks_;
+  std::vector<uint16_t> handles_;
+};
+
+// One SDU for each BIS of the BIG per ISO interval, copied by the ISO manager
+// into a freshly allocated HCI packet
+void BM_SendIsoData(State& state) {
+  Big big(state.range(0));
+  std::vector<uint8_t> sdu(kSduLen, 0xA5);
+  auto manager = IsoManager::GetInstance();
+  for (auto _ : state) {
+    for (auto handle : big.Handles()) {
+      manager->SendIsoData(handle, sdu.data(), sdu.size());
+      manager->HandleNumComplDataPkts(handle, 1);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * big.Handles().size());
+}
+
+// Same traffic with the SDU built the way the LE Audio senders build it: in a
+// pooled buffer with the headroom for the ISO header, which is then written in
+// place. The shim frees each SDU once sent, so the same blocks are recycled.
+void BM_SendIsoSdu(State& state) {
+  Big big(state.range(0));
+  std::vector<uint8_t> payload(kSduLen, 0xA5);
+  auto manager = IsoManager::GetInstance();
+  for (auto _ : state) {
+    for (auto handle : big.Handles()) {
+      manager->SendIsoSdu(
+          handle, iso_manager::AllocateIsoSdu(payload.data(), payload.size()));
+      manager->HandleNumComplDataPkts(handle, 1);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * big.Handles().size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_SendIsoData)->ArgName("bis")->DenseRange(1, 8);
+BENCHMARK(BM_SendIsoSdu)->ArgName("bis")->DenseRange(1, 8);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -2326,6 +2326,94 @@ TEST_F(IsoManagerTest, SendIsoDataCreditsReturned) {
   }
 }
 
+static BT_HDR* AllocateIsoSdu(uint16_t data_len, uint8_t fill) {
+  BT_HDR* sdu = (BT_HDR*)osi_malloc(
+      sizeof(BT_HDR) + bluetooth::hci::iso_manager::kIsoSduHeadroom + data_len);
+  sdu->offset = bluetooth::hci::iso_manager::kIsoSduHeadroom;
+  sdu->len = data_len;
+  memset(sdu->data + sdu->offset, fill, data_len);
+  return sdu;
+}
+
+TEST_F(IsoManagerTest, SendIsoSduCigValid) {
+  IsoManager::GetInstance()->CreateCig(
+      volatile_test_cig_create_cmpl_evt_.cig_id, kDefaultCigParams);
+
+  bluetooth::hci::iso_manager::cis_establish_params params;
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    params.conn_pairs.push_back({handle, 1});
+  }
+  IsoManager::GetInstance()->EstablishCis(params);
+
+  for (auto& handle : volatile_test_cig_create_cmpl_evt_.conn_handles) {
+    IsoManager::GetInstance()->SetupIsoDataPath(handle,
+                                                kDefaultIsoDataPathParams);
+
+    for (uint16_t expected_seq_nb = 0; expected_seq_nb < 2; expected_seq_nb++) {
+      constexpr uint8_t data_len = 108;
+
+      EXPECT_CALL(iso_interface_, HciSend)
+          .WillOnce([handle, data_len, expected_seq_nb](BT_HDR* p_msg) {
+            ASSERT_EQ(p_msg->offset, 0);
+            ASSERT_EQ(p_msg->len, data_len + 8);
+
+            uint8_t* p = p_msg->data + p_msg->offset;
+            uint16_t msg_handle, iso_load_len, seq_nb, msg_data_len;
+            STREAM_TO_UINT16(msg_handle, p);
+            STREAM_TO_UINT16(iso_load_len, p);
+            STREAM_TO_UINT16(seq_nb, p);
+            STREAM_TO_UINT16(msg_data_len, p);
+            ASSERT_EQ(msg_handle, handle);
+            ASSERT_EQ(iso_load_len, data_len + 4);
+            ASSERT_EQ(seq_nb, expected_seq_nb);
+            ASSERT_EQ(msg_data_len, data_len);
+
+            // The payload is sent from where the caller put it
+            for (uint8_t i = 0; i < data_len; i++) {
+              ASSERT_EQ(p[i], 0xA5);
+            }
+          })
+          .RetiresOnSaturation();
+
+      IsoManager::GetInstance()->SendIsoSdu(handle,
+                                            AllocateIsoSdu(data_len, 0xA5));
+    }
+  }
+}
+
+TEST_F(IsoManagerTest, SendIsoSduNoCredits) {
+  uint8_t num_buffers =
+      controller_.GetControllerIsoBufferSize().total_num_le_packets_;
+
+  IsoManager::GetInstance()->CreateBig(volatile_test_big_params_evt_.big_id,
+                                       kDefaultBigParams);
+  IsoManager::GetInstance()->SetupIsoDataPath(
+      volatile_test_big_params_evt_.conn_handles[0], kDefaultIsoDataPathParams);
+
+  /* The SDUs which do not get a controller buffer are released, instead of
+   * being passed down to the HCI.
+   */
+  EXPECT_CALL(iso_interface_, HciSend).Times(num_buffers);
+  for (uint8_t i = 0; i < (2 * num_buffers); i++) {
+    IsoManager::GetInstance()->SendIsoSdu(
+        volatile_test_big_params_evt_.conn_handles[0], AllocateIsoSdu(108, 0));
+  }
+}
+
+TEST_F(IsoManagerDeathTest, SendIsoSduWithoutHeadroom) {
+  IsoManager::GetInstance()->CreateBig(volatile_test_big_params_evt_.big_id,
+                                       kDefaultBigParams);
+  IsoManager::GetInstance()->SetupIsoDataPath(
+      volatile_test_big_params_evt_.conn_handles[0], kDefaultIsoDataPathParams);
+
+  BT_HDR* sdu = AllocateIsoSdu(108, 0);
+  sdu->offset = 0;
+  ASSERT_EXIT(IsoManager::GetInstance()->SendIsoSdu(
+                  volatile_test_big_params_evt_.conn_handles[0], sdu),
+              ::testing::KilledBySignal(SIGABRT), "No room for the ISO header");
+  osi_free(sdu);
+}
+
 TEST_F(IsoManagerTest, SendIsoDataCreditsReturnedByDisconnection) {
   uint8_t num_buffers =
       controller_.GetControllerIsoBufferSize().total_num_le_packets_;
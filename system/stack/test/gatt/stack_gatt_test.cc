@@ -389,3 +389,115 @@ TEST_F(StackGattTest, attp_build_value_cmd_read_by_type_test_long_data) {
       payload_size, op_code, handle, offset_0, data_size, data);
   ASSERT_EQ(ret, nullptr);
 }
+
+namespace {
+
+void add_service_to_list(std::list<tGATT_SRV_LIST_ELEM>& srv_list_info,
+                         tGATT_SVC_DB& db, bool is_primary, uint16_t s_hdl,
+                         uint16_t e_hdl) {
+  srv_list_info.emplace_back();
+  tGATT_SRV_LIST_ELEM& elem = srv_list_info.back();
+  elem.p_db = &db;
+  elem.s_hdl = s_hdl;
+  elem.e_hdl = e_hdl;
+  elem.is_primary = is_primary;
+  elem.type = is_primary ? GATT_UUID_PRI_SERVICE : GATT_UUID_SEC_SERVICE;
+}
+
+}  // namespace
+
+TEST_F(StackGattTest, gatt_sr_index_lookup) {
+  tGATT_SVC_DB local_db[3];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_info;
+
+  // Services at 0x0001-0x0005, 0x0010-0x0014 and 0x0020-0x0022, with a gap
+  // between each of them
+  gatts_init_service_db(local_db[0], bluetooth::Uuid::From16Bit(0x1800), true,
+                        0x0001, 5);
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ,
+                           GATT_CHAR_PROP_BIT_READ,
+                           bluetooth::Uuid::From16Bit(0x2A00));
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ,
+                           GATT_CHAR_PROP_BIT_READ,
+                           bluetooth::Uuid::From16Bit(0x2A01));
+  add_service_to_list(srv_list_info, local_db[0], true, 0x0001, 0x0005);
+
+  gatts_init_service_db(local_db[1], bluetooth::Uuid::From16Bit(0x180F), false,
+                        0x0010, 5);
+  gatts_add_characteristic(local_db[1], GATT_PERM_READ,
+                           GATT_CHAR_PROP_BIT_READ,
+                           bluetooth::Uuid::From16Bit(0x2A19));
+  add_service_to_list(srv_list_info, local_db[1], false, 0x0010, 0x0014);
+
+  gatts_init_service_db(local_db[2], bluetooth::Uuid::From16Bit(0x1800), true,
+                        0x0020, 3);
+  gatts_add_characteristic(local_db[2], GATT_PERM_READ,
+                           GATT_CHAR_PROP_BIT_READ,
+                           bluetooth::Uuid::From16Bit(0x2A00));
+  add_service_to_list(srv_list_info, local_db[2], true, 0x0020, 0x0022);
+
+  std::list<tGATT_SRV_LIST_ELEM>* saved_srv_list_info = gatt_cb.srv_list_info;
+  gatt_cb.srv_list_info = &srv_list_info;
+  gatt_sr_rebuild_index();
+
+  // Handle to service
+  auto first = srv_list_info.begin();
+  auto second = std::next(first);
+  auto third = std::next(second);
+  ASSERT_EQ(first, gatt_sr_find_i_rcb_by_handle(0x0001));
+  ASSERT_EQ(first, gatt_sr_find_i_rcb_by_handle(0x0005));
+  ASSERT_EQ(srv_list_info.end(), gatt_sr_find_i_rcb_by_handle(0x0006));
+  ASSERT_EQ(second, gatt_sr_find_i_rcb_by_handle(0x0012));
+  ASSERT_EQ(third, gatt_sr_find_i_rcb_by_handle(0x0022));
+  ASSERT_EQ(srv_list_info.end(), gatt_sr_find_i_rcb_by_handle(0x0023));
+  ASSERT_EQ(srv_list_info.end(), gatt_sr_find_i_rcb_by_handle(0xFFFF));
+
+  // First service overlapping a range
+  ASSERT_EQ(0x0010, gatt_sr_find_first_srv_index(0x0006)->s_hdl);
+  ASSERT_EQ(0x0010, gatt_sr_find_first_srv_index(0x0014)->s_hdl);
+  ASSERT_EQ(gatt_cb.srv_index.cend(), gatt_sr_find_first_srv_index(0x0023));
+
+  // Attributes by type, across services and in handle order
+  const std::vector<tGATT_ATTR_POSTING>* p_postings =
+      gatt_sr_find_attr_postings(bluetooth::Uuid::From16Bit(0x2A00));
+  ASSERT_NE(nullptr, p_postings);
+  ASSERT_EQ(2u, p_postings->size());
+  ASSERT_EQ(0x0003, (*p_postings)[0].handle);
+  ASSERT_EQ(&*first, (*p_postings)[0].p_el);
+  ASSERT_EQ(0x0022, (*p_postings)[1].handle);
+  ASSERT_EQ(&*third, (*p_postings)[1].p_el);
+
+  p_postings = gatt_sr_find_attr_postings(
+      bluetooth::Uuid::From16Bit(GATT_UUID_CHAR_DECLARE));
+  ASSERT_NE(nullptr, p_postings);
+  ASSERT_EQ(4u, p_postings->size());
+  for (size_t i = 1; i < p_postings->size(); i++) {
+    ASSERT_LT((*p_postings)[i - 1].handle, (*p_postings)[i].handle);
+  }
+
+  ASSERT_EQ(nullptr,
+            gatt_sr_find_attr_postings(bluetooth::Uuid::From16Bit(0x2A05)));
+
+  // Primary services by UUID; secondary services are not listed
+  const std::vector<tGATT_SRV_LIST_ELEM*>* p_services =
+      gatt_sr_find_pri_srv_postings(bluetooth::Uuid::From16Bit(0x1800));
+  ASSERT_NE(nullptr, p_services);
+  ASSERT_EQ(2u, p_services->size());
+  ASSERT_EQ(&*first, (*p_services)[0]);
+  ASSERT_EQ(&*third, (*p_services)[1]);
+  ASSERT_EQ(nullptr,
+            gatt_sr_find_pri_srv_postings(bluetooth::Uuid::From16Bit(0x180F)));
+
+  // Removing a service drops it from every index
+  srv_list_info.erase(first);
+  gatt_sr_rebuild_index();
+  ASSERT_EQ(srv_list_info.end(), gatt_sr_find_i_rcb_by_handle(0x0003));
+  ASSERT_EQ(1u, gatt_sr_find_attr_postings(bluetooth::Uuid::From16Bit(0x2A00))
+                    ->size());
+  ASSERT_EQ(1u, gatt_sr_find_pri_srv_postings(
+                    bluetooth::Uuid::From16Bit(0x1800))
+                    ->size());
+
+  gatt_cb.srv_list_info = saved_srv_list_info;
+  gatt_sr_rebuild_index();
+}
@@ -83,3 +83,36 @@ TEST(GattDatabaseTest, matchExampleInBtSpecV52) {
 
   ASSERT_EQ(result_hash, expected_hash);
 }
+
+TEST(GattDatabaseTest, cachedServiceSegmentsMatchFullSerialization) {
+  tGATT_SVC_DB local_db[2];
+  std::list<tGATT_SRV_LIST_ELEM> srv_list_info;
+
+  add_item_to_list(srv_list_info, &local_db[0], true);
+  gatts_init_service_db(local_db[0], Uuid::From16Bit(0x1800), true, 0x0001, 5);
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A00));
+  gatts_add_characteristic(local_db[0], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A01));
+
+  Octet16 one_service_hash = gatts_calculate_database_hash(&srv_list_info);
+  ASSERT_FALSE(local_db[0].hash_segment.empty());
+
+  // Starting a second service only serializes the new one
+  add_item_to_list(srv_list_info, &local_db[1], true);
+  gatts_init_service_db(local_db[1], Uuid::From16Bit(0x180F), true, 0x0006, 3);
+  gatts_add_characteristic(local_db[1], GATT_PERM_READ, GATT_CHAR_PROP_BIT_READ,
+    Uuid::From16Bit(0x2A19));
+
+  Octet16 incremental_hash = gatts_calculate_database_hash(&srv_list_info);
+  ASSERT_NE(one_service_hash, incremental_hash);
+
+  // Dropping every cached segment gives the same hash from scratch
+  local_db[0].hash_segment.clear();
+  local_db[1].hash_segment.clear();
+  ASSERT_EQ(incremental_hash, gatts_calculate_database_hash(&srv_list_info));
+
+  // Stopping the second service restores the first hash
+  srv_list_info.pop_back();
+  ASSERT_EQ(one_service_hash, gatts_calculate_database_hash(&srv_list_info));
+}
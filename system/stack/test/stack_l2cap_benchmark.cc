@@ -0,0 +1,132 @@
+/*
+ *  Copyright 2024 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "osi/include/alarm.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/l2cap_acl_interface.h"
+#include "stack/include/l2cdefs.h"
+#include "stack/l2cap/l2c_int.h"
+#include "types/raw_address.h"
+
+tBTM_CB btm_cb;
+extern tL2C_CB l2cb;
+
+using ::benchmark::State;
+
+namespace {
+
+constexpr uint16_t kPayloadSize = 20;
+
+uint16_t LinkHandle(int index) {
+  return static_cast<uint16_t>(0x0040 + index * 0x0101) & 0x0eff;
+}
+
+RawAddress LinkAddress(int index) {
+  return RawAddress(
+      {0x00, 0x11, 0x22, 0x33, 0x44, static_cast<uint8_t>(index)});
+}
+
+void OnFixedData(uint16_t /* cid */, const RawAddress& /* bd_addr */,
+                 BT_HDR* p_buf) {
+  benchmark::DoNotOptimize(p_buf);
+}
+
+// |num_links| connected links, each with an ATT channel, and one received
+// ATT packet per link. The packets are not freed by OnFixedData(), so they are
+// reused across iterations.
+class Links {
+ public:
+  Links(int num_links, tBT_TRANSPORT transport) {
+    l2c_init();
+    l2cb.fixed_reg[L2CAP_ATT_CID - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedData_Cb =
+        OnFixedData;
+    for (int i = 0; i < num_links; i++) {
+      tL2C_LCB* p_lcb = &l2cb.lcb_pool[i];
+      p_lcb->in_use = true;
+      p_lcb->transport = transport;
+      p_lcb->link_state = LST_CONNECTED;
+      l2cu_set_lcb_handle(*p_lcb, LinkHandle(i));
+      l2cu_set_lcb_bd_addr(*p_lcb, LinkAddress(i));
+      l2cu_initialize_fixed_ccb(p_lcb, L2CAP_ATT_CID);
+      packets_.push_back(Packet(LinkHandle(i)));
+    }
+  }
+
+  ~Links() {
+    for (tL2C_LCB& lcb : l2cb.lcb_pool) {
+      tL2C_CCB* p_ccb =
+          lcb.p_fixed_ccbs[L2CAP_ATT_CID - L2CAP_FIRST_FIXED_CHNL];
+      if (p_ccb == nullptr) continue;
+      alarm_free(p_ccb->fcrb.ack_timer);
+      alarm_free(p_ccb->fcrb.mon_retrans_timer);
+    }
+  }
+
+  BT_HDR* Receive(int index) {
+    BT_HDR* p_buf = reinterpret_cast<BT_HDR*>(packets_[index].data());
+    p_buf->offset = 0;
+    p_buf->len = HCI_DATA_PREAMBLE_SIZE + L2CAP_PKT_OVERHEAD + kPayloadSize;
+    return p_buf;
+  }
+
+ private:
+  static std::vector<uint8_t> Packet(uint16_t handle) {
+    std::vector<uint8_t> packet(sizeof(BT_HDR) + HCI_DATA_PREAMBLE_SIZE +
+                                L2CAP_PKT_OVERHEAD + kPayloadSize);
+    uint8_t* p = packet.data() + sizeof(BT_HDR);
+    uint16_t hci_handle = handle | (L2CAP_PKT_START << L2CAP_PKT_TYPE_SHIFT);
+    UINT16_TO_STREAM(p, hci_handle);
+    UINT16_TO_STREAM(p, L2CAP_PKT_OVERHEAD + kPayloadSize);
+    UINT16_TO_STREAM(p, kPayloadSize);
+    UINT16_TO_STREAM(p, L2CAP_ATT_CID);
+    return packet;
+  }
+
+  std::vector<std::vector<uint8_t>> packets_;
+};
+
+// l2c_rcv_acl_data() of ATT packets coming in on all links in turn, i.e. the
+// LCB lookup by handle and, on LE, by address of every received packet
+void BM_l2c_rcv_acl_data(State& state, tBT_TRANSPORT transport) {
+  int num_links = state.range(0);
+  Links links(num_links, transport);
+  int i = 0;
+  for (auto _ : state) {
+    l2c_rcv_acl_data(links.Receive(i));
+    i = (i + 1) % num_links;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_l2c_rcv_acl_data, br_edr, BT_TRANSPORT_BR_EDR)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(MAX_L2CAP_LINKS);
+BENCHMARK_CAPTURE(BM_l2c_rcv_acl_data, le, BT_TRANSPORT_LE)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(MAX_L2CAP_LINKS);
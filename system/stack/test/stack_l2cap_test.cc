@@ -90,6 +90,59 @@ TEST_F(StackL2capTest, l2cble_process_data_length_change_event) {
   ASSERT_EQ(0x001b, l2cb.lcb_pool[0].tx_data_len);
 }
 
+TEST_F(StackL2capTest, l2cu_find_lcb_by_handle) {
+  tL2C_LCB& lcb0 = l2cb.lcb_pool[0];
+  tL2C_LCB& lcb1 = l2cb.lcb_pool[MAX_L2CAP_LINKS - 1];
+  lcb0.in_use = true;
+  lcb1.in_use = true;
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0001));
+
+  l2cu_set_lcb_handle(lcb0, 0x0001);
+  l2cu_set_lcb_handle(lcb1, 0x0eff);
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_handle(0x0001));
+  ASSERT_EQ(&lcb1, l2cu_find_lcb_by_handle(0x0eff));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0002));
+
+  // Replaced, invalidated and out of range handles
+  l2cu_set_lcb_handle(lcb0, 0x0002);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0001));
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_handle(0x0002));
+  lcb0.InvalidateHandle();
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0002));
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_handle(HCI_INVALID_HANDLE));
+  l2cu_set_lcb_handle(lcb0, 0x1eff);
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_handle(0x1eff));
+  ASSERT_EQ(&lcb1, l2cu_find_lcb_by_handle(0x0eff));
+
+  lcb1.in_use = false;
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0eff));
+}
+
+TEST_F(StackL2capTest, l2cu_find_lcb_by_bd_addr) {
+  const RawAddress rpa({0x44, 0x11, 0x22, 0x33, 0x44, 0x55});
+  const RawAddress identity_addr({0x00, 0x11, 0x22, 0x33, 0x44, 0x55});
+  tL2C_LCB& lcb0 = l2cb.lcb_pool[0];
+  tL2C_LCB& lcb1 = l2cb.lcb_pool[1];
+  lcb0.in_use = true;
+  lcb0.transport = BT_TRANSPORT_LE;
+  lcb1.in_use = true;
+  lcb1.transport = BT_TRANSPORT_BR_EDR;
+  l2cu_set_lcb_bd_addr(lcb0, rpa);
+  l2cu_set_lcb_bd_addr(lcb1, identity_addr);
+
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_bd_addr(rpa, BT_TRANSPORT_LE));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(rpa, BT_TRANSPORT_BR_EDR));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(identity_addr, BT_TRANSPORT_LE));
+  ASSERT_EQ(&lcb1,
+            l2cu_find_lcb_by_bd_addr(identity_addr, BT_TRANSPORT_BR_EDR));
+
+  L2CA_Consolidate(identity_addr, rpa);
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_bd_addr(rpa, BT_TRANSPORT_LE));
+  ASSERT_EQ(&lcb0, l2cu_find_lcb_by_bd_addr(identity_addr, BT_TRANSPORT_LE));
+  ASSERT_EQ(&lcb1,
+            l2cu_find_lcb_by_bd_addr(identity_addr, BT_TRANSPORT_BR_EDR));
+}
+
 class StackL2capChannelTest : public StackL2capTest {
  protected:
   void SetUp() override { StackL2capTest::SetUp(); }
@@ -76,6 +76,17 @@ void* osi_malloc(size_t size) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_malloc(size);
 }
+// The buffer pools are not modelled separately; pool allocations go through
+// the osi_malloc and osi_calloc mocks.
+void* osi_pool_calloc(size_t size) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_allocator::osi_calloc(size);
+}
+void* osi_pool_malloc(size_t size) {
+  inc_func_call_count(__func__);
+  return test::mock::osi_allocator::osi_malloc(size);
+}
+void osi_pool_debug_dump(int /* fd */) { inc_func_call_count(__func__); }
 char* osi_strdup(const char* str) {
   inc_func_call_count(__func__);
   return test::mock::osi_allocator::osi_strdup(str);
@@ -160,6 +160,17 @@ struct fixed_queue_new {
 };
 extern struct fixed_queue_new fixed_queue_new;
 
+// Name: fixed_queue_new_ring
+// Params: size_t capacity
+// Return: fixed_queue_t*
+// Defaults to the fixed_queue_new mock, so fakes installed there apply to both
+struct fixed_queue_new_ring {
+  std::function<fixed_queue_t*(size_t capacity)> body{
+      [](size_t capacity) { return fixed_queue_new(capacity); }};
+  fixed_queue_t* operator()(size_t capacity) { return body(capacity); };
+};
+extern struct fixed_queue_new_ring fixed_queue_new_ring;
+
 // Name: fixed_queue_register_dequeue
 // Params: fixed_queue_t* queue, reactor_t* reactor, fixed_queue_cb ready_cb,
 // void* context Return: void
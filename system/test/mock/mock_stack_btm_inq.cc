@@ -60,6 +60,7 @@ struct btm_clr_inq_db btm_clr_inq_db;
 struct btm_clr_inq_result_flt btm_clr_inq_result_flt;
 struct btm_inq_db_find btm_inq_db_find;
 struct btm_inq_db_new btm_inq_db_new;
+struct btm_inq_db_update_time_of_resp btm_inq_db_update_time_of_resp;
 struct btm_inq_db_reset btm_inq_db_reset;
 struct btm_inq_find_bdaddr btm_inq_find_bdaddr;
 struct btm_inq_remote_name_timer_timeout btm_inq_remote_name_timer_timeout;
@@ -213,6 +214,10 @@ tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda, bool is_ble) {
   inc_func_call_count(__func__);
   return test::mock::stack_btm_inq::btm_inq_db_new(p_bda, is_ble);
 }
+void btm_inq_db_update_time_of_resp(tINQ_DB_ENT* p_ent) {
+  inc_func_call_count(__func__);
+  test::mock::stack_btm_inq::btm_inq_db_update_time_of_resp(p_ent);
+}
 void btm_inq_db_reset(void) {
   inc_func_call_count(__func__);
   test::mock::stack_btm_inq::btm_inq_db_reset();
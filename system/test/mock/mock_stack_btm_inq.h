@@ -342,6 +342,16 @@ struct btm_inq_db_new {
 };
 extern struct btm_inq_db_new btm_inq_db_new;
 
+// Name: btm_inq_db_update_time_of_resp
+// Params: tINQ_DB_ENT* p_ent
+// Return: void
+struct btm_inq_db_update_time_of_resp {
+  std::function<void(tINQ_DB_ENT* p_ent)> body{
+      [](tINQ_DB_ENT* /* p_ent */) {}};
+  void operator()(tINQ_DB_ENT* p_ent) { body(p_ent); };
+};
+extern struct btm_inq_db_update_time_of_resp btm_inq_db_update_time_of_resp;
+
 // Name: btm_inq_db_reset
 // Params: void
 // Return: void
@@ -17,6 +17,10 @@
 
 #include "mock_stack_btm_iso.h"
 
+#include <cstring>
+
+#include "osi/include/allocator.h"
+
 using bluetooth::hci::iso_manager::VscCallback;
 namespace {
 MockIsoManager* mock_pimpl_;
@@ -30,6 +34,21 @@ MockIsoManager* MockIsoManager::GetInstance() {
 namespace bluetooth {
 namespace hci {
 
+namespace iso_manager {
+
+BT_HDR* AllocateIsoSdu(const uint8_t* data, uint16_t data_len) {
+  BT_HDR* sdu = static_cast<BT_HDR*>(
+      osi_malloc(sizeof(BT_HDR) + kIsoSduHeadroom + data_len));
+  sdu->event = 0;
+  sdu->len = data_len;
+  sdu->offset = kIsoSduHeadroom;
+  sdu->layer_specific = 0;
+  memcpy(sdu->data + sdu->offset, data, data_len);
+  return sdu;
+}
+
+}  // namespace iso_manager
+
 struct IsoManager::impl : public MockIsoManager {
  public:
   impl() = default;
@@ -107,6 +126,13 @@ void IsoManager::SendIsoData(uint16_t iso_handle, const uint8_t* data,
   pimpl_->SendIsoData(iso_handle, data, data_len);
 }
 
+// The SDU is freed once the mock has seen it, as the real stack does once it
+// is sent
+void IsoManager::SendIsoSdu(uint16_t iso_handle, BT_HDR* sdu) {
+  if (pimpl_) pimpl_->SendIsoSdu(iso_handle, sdu);
+  osi_free(sdu);
+}
+
 void IsoManager::CreateBig(uint8_t big_id,
                            struct iso_manager::big_create_params big_params) {
   if (!pimpl_) return;
@@ -60,6 +60,7 @@ struct MockIsoManager {
               (uint16_t iso_handle, uint8_t data_path_dir));
   MOCK_METHOD((void), SendIsoData,
               (uint16_t iso_handle, const uint8_t* data, uint16_t data_len));
+  MOCK_METHOD((void), SendIsoSdu, (uint16_t iso_handle, BT_HDR* sdu));
   MOCK_METHOD((void), ReadIsoLinkQuality, (uint16_t iso_handle));
   MOCK_METHOD(
       (void), CreateBig,
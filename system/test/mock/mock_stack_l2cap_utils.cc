@@ -288,6 +288,10 @@ void l2cu_send_peer_info_rsp(tL2C_LCB* /* p_lcb */, uint8_t /* remote_id */,
 void l2cu_set_acl_hci_header(BT_HDR* /* p_buf */, tL2C_CCB* /* p_ccb */) {
   inc_func_call_count(__func__);
 }
+void l2cu_set_lcb_bd_addr(tL2C_LCB& /* lcb */,
+                          const RawAddress& /* bd_addr */) {
+  inc_func_call_count(__func__);
+}
 void l2cu_set_lcb_handle(struct t_l2c_linkcb& /* p_lcb */,
                          uint16_t /* handle */) {
   inc_func_call_count(__func__);
@@ -273,6 +273,15 @@ void* osi_malloc(size_t size) {
   inc_func_call_count(__func__);
   return nullptr;
 }
+void* osi_pool_calloc(size_t size) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+void* osi_pool_malloc(size_t size) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
+void osi_pool_debug_dump(int fd) { inc_func_call_count(__func__); }
 
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   inc_func_call_count(__func__);
@@ -286,6 +295,10 @@ fixed_queue_t* fixed_queue_new(size_t capacity) {
   inc_func_call_count(__func__);
   return nullptr;
 }
+fixed_queue_t* fixed_queue_new_ring(size_t capacity) {
+  inc_func_call_count(__func__);
+  return nullptr;
+}
 int fixed_queue_get_dequeue_fd(const fixed_queue_t* queue) {
   inc_func_call_count(__func__);
   return 0;